@@ -0,0 +1,290 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BATCH_SYM_EIGS_SOLVER_H
+#define BATCH_SYM_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+#include <thread>     // std::thread
+#include <atomic>     // std::atomic
+#include <exception>  // std::exception_ptr
+
+#include "SelectionRule.h"
+#include "LinAlg/TridiagEigen.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class solves a batch of many small independent symmetric eigen
+/// problems, for example the Laplacians of thousands of subgraphs, each
+/// with a few hundreds to a few thousands of rows.
+///
+/// For such problems, the fixed costs of a SymEigsSolver object, such as
+/// the sizing of its storage and the calls into LAPACK for the matrix
+/// \f$H\f$ of size `ncv`, are a large part of each solve. Here the problems are
+/// processed in groups of `lanes` problems, which go through the implicitly
+/// restarted Lanczos iterations in lockstep:
+///
+/// - The tridiagonal matrices \f$H\f$ and the accumulated rotations \f$Q\f$ of
+///   the problems in a group are stored interleaved, element by element, so
+///   that the shifted QR sweeps of the restart are carried out for all the
+///   problems of the group at once, with the innermost loops running over the
+///   problems. The convergence tests are vectorized in the same way.
+/// - The groups are spread over a pool of threads. The storage of a group,
+///   including the workspace of the decompositions, is allocated once and
+///   reused in all its restarts.
+///
+/// Each problem converges independently: a problem whose eigenvalues have
+/// converged stops applying its operator, while the rest of its group goes on.
+///
+/// All the problems share `nev`, `ncv` and the selection rule, but may have
+/// different sizes. The operators are only used through `rows()` and
+/// `perform_op()`, and each of them is only called by one thread at a time.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues. See SymEigsSolver.
+/// \tparam OpType        The name of the matrix operation class, for example
+///                       DenseGenMatProd or SparseGenMatProd.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <BatchSymEigsSolver.h>
+/// #include <MatOp/SparseGenMatProd.h>
+///
+/// int main()
+/// {
+///     // 1000 sparse symmetric matrices
+///     std::vector<arma::sp_mat> mats(1000);
+///     std::vector< SparseGenMatProd<double>* > ops(1000);
+///     for(int i = 0; i < 1000; i++)
+///     {
+///         arma::sp_mat A = arma::sprandu(500, 500, 0.01);
+///         mats[i] = A + A.t();
+///         ops[i] = new SparseGenMatProd<double>(mats[i]);
+///     }
+///
+///     BatchSymEigsSolver< double, SMALLEST_ALGE, SparseGenMatProd<double> > eigs(ops, 4, 12);
+///     eigs.init();
+///     eigs.compute();
+///
+///     arma::vec evalues = eigs.eigenvalues(0);
+///
+///     for(int i = 0; i < 1000; i++)
+///         delete ops[i];
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = LARGEST_MAGN,
+           typename OpType = DenseGenMatProd<double> >
+class BatchSymEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<Scalar> Array;
+    typedef BasisProduct<Scalar, Scalar> BasisOp;
+
+    std::vector<OpType*> ops;   // matrix operation objects of the problems
+    const int nprob;      // number of problems
+    const int nev;        // number of eigenvalues requested in each problem
+    const int ncv;        // number of ritz values
+    const int nlane;      // number of problems in a group
+    const int nthread;    // number of threads
+    unsigned long long seed;  // seed of the random vectors, see set_seed()
+
+    // Results of each problem
+    std::vector<Vector> init_resid;  // initial residual vectors
+    std::vector<Vector> eig_val;     // converged eigenvalues
+    std::vector<Matrix> eig_vec;     // converged eigenvectors
+    std::vector<int> niter;          // number of restarting iterations
+    std::vector<int> nmatop;         // number of matrix operations called
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // State of a group of problems, owned by the thread that solves it
+    // The small matrices are interleaved, i.e., element j of lane p is
+    // stored at index j * nb + p
+    struct Group
+    {
+        int p0;                   // index of the first problem
+        int nb;                   // number of problems, or lanes
+        std::vector<Matrix> V;    // V matrix of each problem
+        std::vector<Vector> f;    // residual of each problem
+        Array diag;               // ncv x nb, main diagonal of H
+        Array subdiag;            // ncv x nb, sub-diagonal of H, the last row unused
+        Array Q;                  // ncv x ncv x nb, accumulated rotations
+        Array theta;              // ncv x nb, Ritz values in the order of the selection rule
+        Array last;               // nev x nb, last elements of the wanted Ritz vectors
+        Array fnorm;              // nb, norms of the residuals
+        Array c;                  // nb, cosines of the current rotations
+        Array s;                  // nb, sines of the current rotations
+        Array bulge;              // nb, bulges chased down in the QR sweeps
+        std::vector<int> nconv;   // number of converged Ritz values
+        std::vector<int> k;       // number of Ritz values kept in the restart
+        std::vector<int> active;  // whether the problem is still iterating
+        std::vector<CounterRNG> rng;  // generator of each problem, continuing
+                                      // the stream of init(), used on breakdown
+
+        // Workspace
+        Vector w;                 // A * v
+        Vector h;                 // projection coefficients, of length ncv
+        Vector panel;             // block_rows x ncv, a panel of V * Q
+        Matrix H;                 // ncv x ncv, H of one problem
+        Matrix Qp;                // ncv x ncv, Q of one problem
+        TridiagEigen<Scalar> decomp_eigen;
+        SortEigenvalue<Scalar, SelectionRule> sorting;
+        std::vector<int> ind;
+        std::vector<int> ind_copy;
+    };
+
+    // Run task(i) for i = 0, ..., ntask - 1 in the thread pool
+    template <typename Task>
+    inline void run_parallel(int ntask, Task task);
+
+    // Lanczos factorization of lane p starting from step-k
+    inline void factorize_from(Group &g, int p, int from_k);
+
+    // Shifted QR sweeps on the H matrices of all the active lanes
+    inline void qr_sweeps(Group &g);
+
+    // Implicitly restarted Lanczos factorization of lane p, given Q
+    inline void restart(Group &g, int p);
+
+    // Eigen decomposition of H of lane p, with the indices of
+    // the Ritz values sorted by the selection rule in g.ind
+    inline void decompose(Group &g, int p);
+
+    // Retrieve the Ritz values and the last row of the Ritz vectors of lane p
+    inline void retrieve_ritzpair(Group &g, int p);
+
+    // Count the converged Ritz values of all the lanes
+    inline void num_converged(Group &g, Scalar tol);
+
+    // Store the converged eigenpairs of lane p
+    inline void finalize(Group &g, int p, Scalar tol);
+
+    // Solve the problems in the i-th group
+    inline void solve_group(int i, int maxit, Scalar tol);
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param ops_     Pointers to the matrix operation objects of the problems.
+    /// \param nev_     Number of eigenvalues requested in each problem. This should
+    ///                 satisfy \f$1\le nev \le n-1\f$, where \f$n\f$ is the size of each matrix.
+    /// \param ncv_     Parameter that controls the convergence speed of the algorithm.
+    ///                 This parameter must satisfy \f$nev < ncv \le n\f$ for each matrix,
+    ///                 and is advised to take \f$ncv \ge 2\cdot nev\f$.
+    /// \param nthread_ Number of threads. A nonpositive value means the number of
+    ///                 concurrent threads supported by the hardware.
+    /// \param lanes    Number of problems in a group that are iterated together.
+    ///
+    BatchSymEigsSolver(const std::vector<OpType*> &ops_, int nev_, int ncv_, int nthread_ = 0, int lanes = 8) :
+        ops(ops_),
+        nprob(ops_.size()),
+        nev(nev_),
+        ncv(ncv_),
+        nlane(lanes),
+        nthread(nthread_ > 0 ? nthread_ : std::max(1, int(std::thread::hardware_concurrency()))),
+        seed(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(lanes < 1)
+            throw std::invalid_argument("lanes must be positive");
+
+        for(int i = 0; i < nprob; i++)
+        {
+            const int n = ops[i]->rows();
+            if(nev_ < 1 || nev_ > n - 1)
+                throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of each matrix");
+
+            if(ncv_ <= nev_ || ncv_ > n)
+                throw std::invalid_argument("ncv must satisfy nev < ncv <= n, n is the size of each matrix");
+        }
+    }
+
+    ///
+    /// Setting the seed of the random number generators, which draw the
+    /// initial residual vectors in init() and the new residual vectors when
+    /// a factorization breaks down. This function should be called before init().
+    ///
+    /// Problem `i` uses its own CounterRNG seeded with `seed + i`, so its
+    /// random vectors are the ones of a SymEigsSolver on the same matrix after
+    /// `set_seed(seed + i)`, and do not depend on the number of threads
+    /// or lanes. The default seed is 0.
+    ///
+    inline void set_seed(unsigned long long seed_) { seed = seed_; }
+
+    ///
+    /// Providing random initial residual vectors for all the problems.
+    ///
+    /// Elements in the vectors follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generators described in set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed for each problem.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of problems in which all the requested eigenvalues have converged.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of problems in the batch.
+    ///
+    inline int num_problems() { return nprob; }
+
+    ///
+    /// Returning the number of iterations used in the i-th problem.
+    ///
+    inline int num_iterations(int i) { return niter[i]; }
+
+    ///
+    /// Returning the number of matrix operations used in the i-th problem.
+    ///
+    inline int num_operations(int i) { return nmatop[i]; }
+
+    ///
+    /// Returning the converged eigenvalues of the i-th problem, in the
+    /// same order as SymEigsSolver::eigenvalues().
+    ///
+    inline Vector eigenvalues(int i) { return eig_val[i]; }
+
+    ///
+    /// Returning the eigenvectors associated with the converged
+    /// eigenvalues of the i-th problem.
+    ///
+    inline Matrix eigenvectors(int i) { return eig_vec[i]; }
+};
+
+
+// Implementations
+#include "BatchSymEigsSolver_Impl.h"
+
+
+#endif // BATCH_SYM_EIGS_SOLVER_H
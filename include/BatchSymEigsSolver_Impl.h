@@ -0,0 +1,550 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Run task(i) for i = 0, ..., ntask - 1 in the thread pool
+// The tasks are taken one by one by the threads, in the order of i, and
+// the first exception thrown by a task is rethrown in the calling thread
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+template <typename Task>
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::run_parallel(int ntask, Task task)
+{
+    std::atomic<int> next(0);
+    std::vector<std::exception_ptr> errors(ntask);
+
+    auto worker = [&]()
+    {
+        for(int i = next++; i < ntask; i = next++)
+        {
+            try {
+                task(i);
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    // The calling thread is also one of the workers
+    const int nworker = std::min(nthread, ntask);
+    std::vector<std::thread> pool;
+    for(int t = 1; t < nworker; t++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for(size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+
+    for(int i = 0; i < ntask; i++)
+    {
+        if(errors[i])
+            std::rethrow_exception(errors[i]);
+    }
+}
+
+// Lanczos factorization of lane p starting from step-k
+// This is the factorization of SymEigsSolver with the full
+// reorthogonalization, writing H to the interleaved arrays
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(Group &g, int p, int from_k)
+{
+    const int nb = g.nb;
+    Matrix &V = g.V[p];
+    Vector &f = g.f[p];
+    Vector &w = g.w;
+    Scalar *h = g.h.memptr();
+    Scalar *d = &g.diag[0];
+    Scalar *e = &g.subdiag[0];
+    OpType *op = ops[g.p0 + p];
+
+    Scalar beta = arma::norm(f);
+    for(int i = from_k; i <= ncv - 1; i++)
+    {
+        bool restart = false;
+        // If beta = 0, then the next V is not full rank
+        // We need to generate a new residual vector that is orthogonal
+        // to the current V, which we call a restart
+        if(beta < prec)
+        {
+            g.rng[p].uniform(f.memptr(), f.n_elem);
+            // f <- f - V * V' * f, so that f is orthogonal to V
+            BasisOp::trans_mult(V, i, f.memptr(), h);
+            BasisOp::mult_sub(V, i, h, f.memptr());
+            beta = arma::norm(f);
+
+            restart = true;
+        }
+
+        // v <- f / ||f||, stored as the (i+1)-th column of V
+        f /= beta;
+        V.col(i) = f;
+
+        // Note that H[i+1, i] equals to the unrestarted beta
+        e[(i - 1) * nb + p] = restart ? Scalar(0) : beta;
+
+        // w <- A * v, v = V.col(i)
+        op->perform_op(V.colptr(i), w.memptr());
+        nmatop[g.p0 + p]++;
+
+        Scalar Hii = arma::dot(f, w);
+        d[i * nb + p] = Hii;
+
+        // f <- w - H[i+1, i] * V{i} - H[i+1, i+1] * V{i+1}
+        f = w - Hii * f;
+        if(!restart)
+            BasisOp::axpy(-e[(i - 1) * nb + p], V, i - 1, f.memptr());
+
+        beta = arma::norm(f);
+
+        // f/||f|| is going to be the next column of V, so we need to test
+        // whether V' * (f/||f||) ~= 0, and if not, iteratively correct the residual
+        BasisOp::trans_mult(V, i + 1, f.memptr(), h);
+        Vector Vf(h, i + 1, false);
+        int count = 0;
+        while(count < 5 && arma::abs(Vf).max() > prec * beta)
+        {
+            // f <- f - V * Vf
+            BasisOp::mult_sub(V, i + 1, h, f.memptr());
+            // h <- h + Vf
+            e[(i - 1) * nb + p] += Vf[i - 1];
+            d[i * nb + p] += Vf[i];
+
+            beta = arma::norm(f);
+            BasisOp::trans_mult(V, i + 1, f.memptr(), h);
+            count++;
+        }
+    }
+
+    g.fnorm[p] = beta;
+}
+
+// Shifted QR sweeps on the H matrices of all the active lanes
+//
+// Lane p is shifted by its unwanted Ritz values theta[k[p]], ..., theta[ncv-1],
+// using the implicit symmetric QR step of Golub and Van Loan (2013), Algorithm
+// 8.3.2. The same rotation position is processed for all the lanes at a time,
+// so the innermost loops run over the lanes and have no branches. The lanes
+// that are inactive or have fewer shifts are given identity rotations.
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::qr_sweeps(Group &g)
+{
+    const int nb = g.nb;
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    Scalar *d = &g.diag[0];
+    Scalar *e = &g.subdiag[0];
+    Scalar *Q = &g.Q[0];
+    Scalar *theta = &g.theta[0];
+    Scalar *c = &g.c[0];
+    Scalar *s = &g.s[0];
+    Scalar *bulge = &g.bulge[0];
+
+    // Q <- I
+    std::fill(g.Q.begin(), g.Q.end(), Scalar(0));
+    for(int j = 0; j < ncv; j++)
+    {
+        for(int p = 0; p < nb; p++)
+            Q[(j * ncv + j) * nb + p] = Scalar(1);
+    }
+
+    int kmin = ncv;
+    for(int p = 0; p < nb; p++)
+    {
+        if(g.active[p])
+            kmin = std::min(kmin, g.k[p]);
+    }
+
+    for(int i = kmin; i < ncv; i++)
+    {
+        // Split H at the negligible sub-diagonal elements, as ARPACK does
+        // in dsapps.f, so that each shift is applied to the unreduced blocks
+        for(int j = 0; j < ncv - 1; j++)
+        {
+            Scalar *ej = e + j * nb;
+            const Scalar *dj = d + j * nb;
+            const Scalar *dj1 = d + (j + 1) * nb;
+            for(int p = 0; p < nb; p++)
+            {
+                const bool small = std::abs(ej[p]) <= eps * (std::abs(dj[p]) + std::abs(dj1[p]));
+                ej[p] = small ? Scalar(0) : ej[p];
+            }
+        }
+
+        for(int p = 0; p < nb; p++)
+            bulge[p] = Scalar(0);
+
+        for(int j = 0; j < ncv - 1; j++)
+        {
+            Scalar *dj = d + j * nb;
+            Scalar *dj1 = d + (j + 1) * nb;
+            Scalar *ej = e + j * nb;
+            Scalar *ejm1 = (j > 0) ? e + (j - 1) * nb : e;
+            Scalar *ej1 = e + (j + 1) * nb;
+            const Scalar *mu = theta + i * nb;
+
+            // Rotation that zeroes the bulge, or that starts a new block
+            for(int p = 0; p < nb; p++)
+            {
+                const bool start = (j == 0) || (ejm1[p] == Scalar(0));
+                const Scalar x = start ? dj[p] - mu[p] : ejm1[p];
+                const Scalar z = start ? ej[p] : bulge[p];
+                const Scalar r = std::sqrt(x * x + z * z);
+                const bool skip = (!g.active[p]) || (i < g.k[p]) || (z == Scalar(0));
+                const Scalar rr = skip ? Scalar(1) : r;
+                c[p] = skip ? Scalar(1) : x / rr;
+                s[p] = skip ? Scalar(0) : -z / rr;
+                if(!start)
+                    ejm1[p] = skip ? ejm1[p] : r;
+            }
+
+            // H <- G' * H * G, G = [c s; -s c] on rows and columns j, j+1
+            for(int p = 0; p < nb; p++)
+            {
+                const Scalar cc = c[p] * c[p], ss = s[p] * s[p], cs = c[p] * s[p];
+                const Scalar a = dj[p], b = ej[p], dd = dj1[p];
+                dj[p] = cc * a - Scalar(2) * cs * b + ss * dd;
+                dj1[p] = ss * a + Scalar(2) * cs * b + cc * dd;
+                ej[p] = cs * (a - dd) + (cc - ss) * b;
+            }
+            if(j < ncv - 2)
+            {
+                for(int p = 0; p < nb; p++)
+                {
+                    bulge[p] = -s[p] * ej1[p];
+                    ej1[p] *= c[p];
+                }
+            }
+
+            // Q <- Q * G, columns j and j+1, in the rows that are nonzero
+            // Q is upper Hessenberg with i - kmin + 1 sub-diagonals at most
+            const int rmax = std::min(ncv - 1, j + 1 + (i - kmin));
+            for(int r = 0; r <= rmax; r++)
+            {
+                Scalar *qj = Q + (j * ncv + r) * nb;
+                Scalar *qj1 = Q + ((j + 1) * ncv + r) * nb;
+                for(int p = 0; p < nb; p++)
+                {
+                    const Scalar u = qj[p], v = qj1[p];
+                    qj[p] = c[p] * u - s[p] * v;
+                    qj1[p] = s[p] * u + c[p] * v;
+                }
+            }
+        }
+    }
+}
+
+// Implicitly restarted Lanczos factorization of lane p, given Q
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::restart(Group &g, int p)
+{
+    const int nb = g.nb;
+    const int k = g.k[p];
+
+    // Q of lane p, only the first k+1 columns are used
+    Matrix &Qp = g.Qp;
+    for(int j = 0; j <= k; j++)
+    {
+        for(int r = 0; r < ncv; r++)
+            Qp(r, j) = g.Q[(j * ncv + r) * nb + p];
+    }
+
+    // V -> VQ, only need to update the first k+1 columns
+    Matrix Qk(Qp.memptr(), ncv, k + 1, false);
+    BasisOp::mult_inplace(g.V[p], ncv, Qk, g.panel.memptr());
+
+    // f -> f * Q[ncv, k] + V[, k+1] * H[k+1, k]
+    Vector &f = g.f[p];
+    f *= Qp(ncv - 1, k - 1);
+    BasisOp::axpy(g.subdiag[(k - 1) * nb + p], g.V[p], k, f.memptr());
+
+    factorize_from(g, p, k);
+    retrieve_ritzpair(g, p);
+}
+
+// Eigen decomposition of H of lane p, with the indices of
+// the Ritz values sorted by the selection rule in g.ind
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::decompose(Group &g, int p)
+{
+    const int nb = g.nb;
+    // Only the main diagonal and the sub-diagonal are read by TridiagEigen
+    Matrix &H = g.H;
+    for(int j = 0; j < ncv; j++)
+        H(j, j) = g.diag[j * nb + p];
+    for(int j = 0; j < ncv - 1; j++)
+        H(j + 1, j) = g.subdiag[j * nb + p];
+
+    g.decomp_eigen.compute(H);
+    g.sorting.compute(g.decomp_eigen.eigenvalues().memptr(), ncv);
+    std::vector<int> &ind = g.ind;
+    g.sorting.index(ind);
+
+    // For BOTH_ENDS, the eigenvalues are sorted according
+    // to the LARGEST_ALGE rule, so we need to move those smallest
+    // values to the left, see SymEigsSolver
+    if(SelectionRule == BOTH_ENDS)
+    {
+        std::vector<int> &ind_copy = g.ind_copy;
+        ind_copy = ind;
+        for(int i = 0; i < ncv; i++)
+        {
+            if(i % 2 == 0)
+                ind[i] = ind_copy[i / 2];
+            else
+                ind[i] = ind_copy[ncv - 1 - i / 2];
+        }
+    }
+}
+
+// Retrieve the Ritz values and the last row of the Ritz vectors of lane p
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair(Group &g, int p)
+{
+    const int nb = g.nb;
+    decompose(g, p);
+    const Vector &evals = g.decomp_eigen.eigenvalues();
+    const Matrix &evecs = g.decomp_eigen.eigenvectors();
+
+    for(int i = 0; i < ncv; i++)
+        g.theta[i * nb + p] = evals[g.ind[i]];
+    for(int i = 0; i < nev; i++)
+        g.last[i * nb + p] = evecs(ncv - 1, g.ind[i]);
+}
+
+// Count the converged Ritz values of all the lanes
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Group &g, Scalar tol)
+{
+    const int nb = g.nb;
+    const Scalar *fnorm = &g.fnorm[0];
+    int *nconv = &g.nconv[0];
+
+    for(int p = 0; p < nb; p++)
+        nconv[p] = 0;
+
+    // thresh = tol * max(prec, abs(theta)), theta for ritz value
+    for(int i = 0; i < nev; i++)
+    {
+        const Scalar *theta = &g.theta[i * nb];
+        const Scalar *last = &g.last[i * nb];
+        for(int p = 0; p < nb; p++)
+        {
+            const Scalar thresh = tol * std::max(prec, std::abs(theta[p]));
+            const Scalar resid = std::abs(last[p]) * fnorm[p];
+            nconv[p] += (resid < thresh);
+        }
+    }
+}
+
+// Store the converged eigenpairs of lane p
+// The eigenpairs are sorted in decreasing magnitude order, as in SymEigsSolver
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::finalize(Group &g, int p, Scalar tol)
+{
+    decompose(g, p);
+    const Vector &evals = g.decomp_eigen.eigenvalues();
+    const Matrix &evecs = g.decomp_eigen.eigenvectors();
+
+    Vector val(nev);
+    for(int i = 0; i < nev; i++)
+        val[i] = evals[g.ind[i]];
+
+    SortEigenvalue<Scalar, LARGEST_MAGN> sorting(val.memptr(), nev);
+    std::vector<int> ind = sorting.index();
+
+    std::vector<int> conv;
+    for(int i = 0; i < nev; i++)
+    {
+        const int j = ind[i];
+        const Scalar thresh = tol * std::max(prec, std::abs(val[j]));
+        const Scalar resid = std::abs(evecs(ncv - 1, g.ind[j])) * g.fnorm[p];
+        if(resid < thresh)
+            conv.push_back(j);
+    }
+
+    const int nconv = conv.size();
+    Vector &res_val = eig_val[g.p0 + p];
+    Matrix ritz_vec(ncv, nconv);
+    res_val.set_size(nconv);
+    for(int i = 0; i < nconv; i++)
+    {
+        res_val[i] = val[conv[i]];
+        ritz_vec.col(i) = evecs.col(g.ind[conv[i]]);
+    }
+
+    Matrix &res_vec = eig_vec[g.p0 + p];
+    res_vec.set_size(g.V[p].n_rows, nconv);
+    if(nconv > 0)
+        BasisOp::mult(g.V[p], ncv, ritz_vec, res_vec);
+
+    // The basis is no longer needed
+    g.V[p].reset();
+    g.f[p].reset();
+}
+
+// Solve the problems in the i-th group
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::solve_group(int i, int maxit, Scalar tol)
+{
+    Group g;
+    g.p0 = i * nlane;
+    g.nb = std::min(nlane, nprob - g.p0);
+    const int nb = g.nb;
+
+    g.V.resize(nb);
+    g.f.resize(nb);
+    g.diag.assign(ncv * nb, Scalar(0));
+    g.subdiag.assign(ncv * nb, Scalar(0));
+    g.Q.assign(ncv * ncv * nb, Scalar(0));
+    g.theta.assign(ncv * nb, Scalar(0));
+    g.last.assign(nev * nb, Scalar(0));
+    g.fnorm.assign(nb, Scalar(0));
+    g.c.assign(nb, Scalar(1));
+    g.s.assign(nb, Scalar(0));
+    g.bulge.assign(nb, Scalar(0));
+    g.nconv.assign(nb, 0);
+    g.k.assign(nb, ncv);
+    g.active.assign(nb, 1);
+    g.rng.resize(nb);
+
+    int nmax = 0;
+    for(int p = 0; p < nb; p++)
+        nmax = std::max(nmax, int(ops[g.p0 + p]->rows()));
+    g.w.set_size(nmax);
+    g.h.set_size(ncv);
+    g.panel.set_size(std::min(nmax, int(BasisOp::block_rows)) * ncv);
+    g.H.zeros(ncv, ncv);
+    g.Qp.set_size(ncv, ncv);
+    g.ind.reserve(ncv);
+    g.ind_copy.reserve(ncv);
+
+    // The first column of V, and the m-step Lanczos factorization
+    for(int p = 0; p < nb; p++)
+    {
+        const int n = ops[g.p0 + p]->rows();
+        Matrix &V = g.V[p];
+        Vector &f = g.f[p];
+        V.zeros(n, ncv);
+        g.w.set_size(n);
+
+        // Continue the stream of problem g.p0 + p after the initial vector
+        g.rng[p].seed(seed + g.p0 + p);
+        g.rng[p].skip(n);
+
+        const Vector &r = init_resid[g.p0 + p];
+        V.col(0) = r / arma::norm(r);
+        ops[g.p0 + p]->perform_op(V.colptr(0), g.w.memptr());
+        nmatop[g.p0 + p]++;
+
+        g.diag[p] = arma::dot(V.col(0), g.w);
+        f = g.w - V.col(0) * g.diag[p];
+
+        factorize_from(g, p, 1);
+        retrieve_ritzpair(g, p);
+    }
+
+    // Restarting
+    for(int it = 0; ; it++)
+    {
+        num_converged(g, tol);
+
+        bool any_active = false;
+        for(int p = 0; p < nb; p++)
+        {
+            if(!g.active[p])
+                continue;
+
+            if(g.nconv[p] >= nev || it >= maxit)
+            {
+                niter[g.p0 + p] = it + 1;
+                finalize(g, p, tol);
+                g.active[p] = 0;
+                continue;
+            }
+
+            // Adjust k, according to dsaup2.f line 677~684 in ARPACK
+            int k = nev + std::min(g.nconv[p], (ncv - nev) / 2);
+            if(nev == 1 && ncv >= 6)
+                k = ncv / 2;
+            else if(nev == 1 && ncv > 2)
+                k = 2;
+            g.k[p] = k;
+            any_active = true;
+        }
+        if(!any_active)
+            break;
+
+        qr_sweeps(g);
+
+        for(int p = 0; p < nb; p++)
+        {
+            if(!g.active[p])
+                continue;
+
+            g.w.set_size(ops[g.p0 + p]->rows());
+            restart(g, p);
+        }
+    }
+}
+
+
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BatchSymEigsSolver<Scalar, SelectionRule, OpType>::init()
+{
+    // Each problem has its own stream, so the results do not depend
+    // on the number of threads
+    init_resid.resize(nprob);
+    for(int i = 0; i < nprob; i++)
+    {
+        const int n = ops[i]->rows();
+        CounterRNG rng(seed + i);
+        init_resid[i].set_size(n);
+        rng.uniform(init_resid[i].memptr(), n);
+    }
+}
+
+// Compute the eigenpairs of all the problems, and return the number of
+// problems in which all the requested eigenvalues have converged
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BatchSymEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+{
+    if((int) init_resid.size() != nprob)
+        throw std::logic_error("BatchSymEigsSolver: init() must be called before compute()");
+
+    eig_val.assign(nprob, Vector());
+    eig_vec.assign(nprob, Matrix());
+    niter.assign(nprob, 0);
+    nmatop.assign(nprob, 0);
+
+    const int ngroup = (nprob + nlane - 1) / nlane;
+    run_parallel(ngroup, [this, maxit, tol](int i) { solve_group(i, maxit, tol); });
+
+    int nsolved = 0;
+    for(int i = 0; i < nprob; i++)
+        nsolved += (int(eig_val[i].n_elem) == nev);
+
+    return nsolved;
+}
@@ -0,0 +1,256 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BLOCK_GEN_EIGS_SOLVER_H
+#define BLOCK_GEN_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <complex>    // std::complex, std::conj, std::norm
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the block Arnoldi eigen solver for general real matrices.
+///
+/// This is the block counterpart of GenEigsSolver, in the same way as
+/// BlockSymEigsSolver to SymEigsSolver. The Krylov subspace is extended by
+/// `bsize` vectors in each step, so that the matrix operation is applied to
+/// a block of vectors at once. See BlockSymEigsSolver for the requirements
+/// on the matrix operation class.
+///
+/// The solver uses a thick restart: in each restart an orthonormal basis
+/// of the wanted invariant subspace of \f$H\f$ is kept, with complex conjugate
+/// Ritz pairs represented by their real and imaginary parts.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues, for example `LARGEST_MAGN`
+///                       to retrieve eigenvalues with the largest magnitude.
+///                       The full list of enumeration values can be found in
+///                       SelectionRule.h .
+/// \tparam OpType        The name of the matrix operation class. Users could either
+///                       use the DenseGenMatProd and SparseGenMatProd wrapper classes,
+///                       or define their own that impelemnts all the public member
+///                       functions as in DenseGenMatProd.
+///
+template < typename Scalar = double,
+           int SelectionRule = LARGEST_MAGN,
+           typename OpType = DenseGenMatProd<double> >
+class BlockGenEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Mat<Complex> ComplexMatrix;
+    typedef arma::Col<Complex> ComplexVector;
+
+protected:
+    OpType *op;             // object to conduct matrix operation,
+                            // e.g. matrix-matrix product
+
+private:
+    const int dim_n;        // dimension of matrix A
+
+protected:
+    const int nev;          // number of eigenvalues requested
+
+private:
+    const int ncv;          // maximum dimension of the Krylov subspace
+    const int bsize;        // block size
+    int ncv_act;            // current dimension of the Krylov subspace
+    int nmatop;             // number of matrix operations called,
+                            // counted as matrix-vector products
+    int niter;              // number of restarting iterations
+    CounterRNG rng;         // random vectors of init() and of the breakdowns
+
+    Matrix fac_V;           // V matrix in the block Arnoldi factorization
+    Matrix fac_H;           // H matrix in the block Arnoldi factorization
+    Matrix fac_F;           // residual block in the block Arnoldi factorization
+
+protected:
+    ComplexVector ritz_val; // ritz values
+
+private:
+    ComplexMatrix ritz_vec; // ritz vectors
+    BoolVector ritz_conv;   // indicator of the convergence of ritz values
+
+    const Scalar prec;      // precision parameter used to test convergence
+                            // prec = epsilon^(2/3)
+                            // epsilon is the machine precision,
+                            // e.g. ~= 1e-16 for the "double" type
+
+    static bool is_complex(Complex v, Scalar eps)
+    {
+        return std::abs(v.imag()) > eps;
+    }
+
+    static bool is_conj(Complex v1, Complex v2, Scalar eps)
+    {
+        return std::abs(v1 - std::conj(v2)) < eps;
+    }
+
+    // W <- W - V * C, C = V' * W, using the first j columns of V
+    inline void project_block(int j, Matrix &W, Matrix &C);
+
+    // W = Q * R, overwriting W with Q, which is also orthogonal to
+    // the first j columns of V
+    inline void qr_block(int j, Matrix &W, Matrix &R);
+
+    // Block Arnoldi factorization starting from the block that
+    // ends at column from_j
+    inline void factorize_from(int from_j);
+
+    // Thick restart, keeping a k-dimensional invariant subspace of H
+    inline void restart(int k);
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+    // Return the adjusted nev for restarting
+    inline int nev_adjusted(int nconv);
+
+    // Retrieve and sort ritz values and ritz vectors
+    inline void retrieve_ritzpair();
+
+protected:
+    // Sort the first nev Ritz pairs in decreasing magnitude order
+    // This is used to return the final results
+    inline virtual void sort_ritzpair();
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_    Pointer to the matrix operation object, which should implement
+    ///               the matrix-vector and matrix-matrix multiplication operations
+    ///               of \f$A\f$. Users could either create the object from the
+    ///               DenseGenMatProd or SparseGenMatProd wrapper classes, or
+    ///               define their own that impelemnts all the public member functions
+    ///               as in DenseGenMatProd.
+    /// \param nev_   Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-2\f$,
+    ///               where \f$n\f$ is the size of matrix.
+    /// \param ncv_   Maximum dimension of the Krylov subspace. This parameter must satisfy
+    ///               \f$nev+2\cdot bsize+1 \le ncv \le n\f$, and is advised to take
+    ///               \f$ncv \ge 2\cdot nev + bsize + 1\f$.
+    /// \param bsize_ Block size, i.e., the number of vectors that the matrix operation
+    ///               is applied to at once. Typical values are between 2 and 8.
+    ///
+    BlockGenEigsSolver(OpType *op_, int nev_, int ncv_, int bsize_) :
+        op(op_),
+        dim_n(op->rows()),
+        nev(nev_),
+        ncv(ncv_ > dim_n ? dim_n : ncv_),
+        bsize(bsize_),
+        ncv_act(0),
+        nmatop(0),
+        niter(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(nev_ < 1 || nev_ > dim_n - 2)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 2, n is the size of matrix");
+
+        if(bsize_ < 1)
+            throw std::invalid_argument("bsize must be positive");
+
+        if(ncv_ < nev_ + 2 * bsize_ + 1 || ncv_ > dim_n)
+            throw std::invalid_argument("ncv must satisfy nev + 2 * bsize + 1 <= ncv <= n, n is the size of matrix");
+    }
+
+    ///
+    /// Providing the initial block of vectors for the algorithm.
+    ///
+    /// \param init_resid Pointer to the initial block, an \f$n\times bsize\f$
+    ///                   matrix stored in column-major order.
+    ///
+    inline void init(Scalar *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial block in init() and the new vectors when the block
+    /// becomes rank deficient. This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial block of vectors.
+    ///
+    /// This overloaded function generates a random initial block
+    /// for the algorithm. Elements in the block follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counted as the number of vectors that the matrix has been applied to.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues.
+    ///
+    /// \return A complex-valued vector containing the eigenvalues.
+    /// Returned vector type will be `arma::cx_vec` or `arma::cx_fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline ComplexVector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A complex-valued matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::cx_mat` or `arma::cx_fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline ComplexMatrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline ComplexMatrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "BlockGenEigsSolver_Impl.h"
+
+
+#endif // BLOCK_GEN_EIGS_SOLVER_H
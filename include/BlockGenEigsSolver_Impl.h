@@ -0,0 +1,416 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// W <- W - V * C, C = V' * W, using the first j columns of V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::project_block(int j, Matrix &W, Matrix &C)
+{
+    if(j < 1)
+    {
+        C.zeros(0, W.n_cols);
+        return;
+    }
+
+    Matrix Vs(fac_V.memptr(), dim_n, j, false); // First j columns
+    C = Vs.t() * W;
+    W -= Vs * C;
+
+    // Classical Gram-Schmidt is applied twice to maintain orthogonality
+    Matrix C2 = Vs.t() * W;
+    W -= Vs * C2;
+    C += C2;
+}
+
+// W = Q * R, overwriting W with Q, which is also orthogonal to
+// the first j columns of V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::qr_block(int j, Matrix &W, Matrix &R)
+{
+    const int ncol = W.n_cols;
+    R.zeros(ncol, ncol);
+
+    for(int c = 0; c < ncol; c++)
+    {
+        Scalar w_norm = arma::norm(W.col(c));
+        // Modified Gram-Schmidt against the previous columns, applied twice
+        for(int pass = 0; pass < 2; pass++)
+        {
+            for(int d = 0; d < c; d++)
+            {
+                Scalar r = arma::dot(W.col(d), W.col(c));
+                W.col(c) -= r * W.col(d);
+                R(d, c) += r;
+            }
+        }
+
+        Scalar r = arma::norm(W.col(c));
+        if(r > prec * w_norm)
+        {
+            R(c, c) = r;
+            W.col(c) /= r;
+            continue;
+        }
+
+        // The block is rank deficient, so we replace this column
+        // by a random vector orthogonal to V and the previous columns
+        Vector v(dim_n);
+        rng.uniform(v.memptr(), dim_n);
+        for(int pass = 0; pass < 2; pass++)
+        {
+            if(j > 0)
+            {
+                Matrix Vs(fac_V.memptr(), dim_n, j, false);
+                Vector Vv = Vs.t() * v;
+                v -= Vs * Vv;
+            }
+            for(int d = 0; d < c; d++)
+                v -= arma::dot(W.col(d), v) * W.col(d);
+        }
+        W.col(c) = v / arma::norm(v);
+        R(c, c) = 0.0;
+    }
+}
+
+// Block Arnoldi factorization starting from the block that
+// ends at column from_j
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int from_j)
+{
+    Matrix C, R;
+    int j = from_j;
+    for(;;)
+    {
+        // W <- A * V{j-b}, ..., A * V{j-1}, stored in fac_F
+        op->perform_op(fac_V.colptr(j - bsize), fac_F.memptr(), bsize);
+        nmatop += bsize;
+
+        // W <- W - V * V' * W, H[0:j, (j-b):j] <- V' * W
+        project_block(j, fac_F, C);
+        fac_H.submat(0, j - bsize, j - 1, j - 1) = C;
+
+        // If the next block does not fit into the subspace,
+        // W is kept as the residual block
+        if(j + bsize > ncv)
+            break;
+
+        // V{j}, ..., V{j+b-1} <- Q, H[j:(j+b), (j-b):j] <- R
+        qr_block(j, fac_F, R);
+        fac_V.cols(j, j + bsize - 1) = fac_F;
+        fac_H.submat(j, j - bsize, j + bsize - 1, j - 1) = R;
+
+        j += bsize;
+    }
+
+    ncv_act = j;
+}
+
+// Thick restart, keeping a k-dimensional invariant subspace of H
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+{
+    const int m = ncv_act;
+    if(k >= m - bsize + 1)
+        return;
+
+    // Real basis of the subspace spanned by the first k Ritz vectors
+    // For a conjugate pair, the real and imaginary parts are used
+    Matrix Y(m, k);
+    for(int i = 0; i < k; i++)
+    {
+        Y.col(i) = arma::real(ritz_vec(arma::span(0, m - 1), i));
+        if(i < k - 1 && is_complex(ritz_val[i], prec) && is_conj(ritz_val[i], ritz_val[i + 1], prec))
+        {
+            Y.col(i + 1) = arma::imag(ritz_vec(arma::span(0, m - 1), i));
+            i++;
+        }
+    }
+    Matrix Q, Rq;
+    arma::qr_econ(Q, Rq, Y);
+
+    // The subspace is invariant under H, so H * Q = Q * Hk with Hk = Q' * H * Q
+    Matrix Hk = Q.t() * fac_H.submat(0, 0, m - 1, m - 1) * Q;
+
+    // V -> V * Q
+    Matrix Vs(fac_V.memptr(), dim_n, m, false);
+    fac_V.head_cols(k) = Vs * Q;
+
+    // A * V * Q = V * Q * Hk + F * E' * Q, and E' * Q consists of
+    // the last bsize rows of Q
+    Matrix S = Q.rows(m - bsize, m - 1);
+
+    // F = Qf * R, and Qf will be the next block of V
+    Matrix C, R;
+    project_block(k, fac_F, C);
+    qr_block(k, fac_F, R);
+    fac_V.cols(k, k + bsize - 1) = fac_F;
+
+    // [Hk     *]
+    // [R*S    *]
+    fac_H.zeros();
+    fac_H.submat(0, 0, k - 1, k - 1) = Hk;
+    fac_H.submat(k, 0, k + bsize - 1, k - 1) = R * S;
+
+    factorize_from(k + bsize);
+    retrieve_ritzpair();
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockGenEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar tol)
+{
+    const int m = ncv_act;
+    // ||A * V * y - theta * V * y|| = ||F * y_b||, where y_b is the last
+    // bsize elements of y, and ||F * y_b||^2 = y_b^H * (F' * F) * y_b
+    // Since F' * F is symmetric, the imaginary part of the quadratic form is zero
+    Matrix FtF = fac_F.t() * fac_F;
+    for(int i = 0; i < nev; i++)
+    {
+        ComplexVector yb = ritz_vec(arma::span(m - bsize, m - 1), i);
+        Vector yr = arma::real(yb);
+        Vector yi = arma::imag(yb);
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        Scalar resid = std::sqrt(std::abs(arma::dot(yr, FtF * yr) + arma::dot(yi, FtF * yi)));
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.end(), true);
+}
+
+// Return the adjusted nev for restarting
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockGenEigsSolver<Scalar, SelectionRule, OpType>::nev_adjusted(int nconv)
+{
+    // At most ncv_act - bsize vectors can be kept,
+    // since the residual block takes bsize columns
+    const int kmax = ncv_act - bsize;
+    int nev_new = nev;
+
+    // Increase nev by one if ritz_val[nev - 1] and
+    // ritz_val[nev] are conjugate pairs
+    if(is_complex(ritz_val[nev - 1], prec) &&
+       is_conj(ritz_val[nev - 1], ritz_val[nev], prec))
+    {
+        nev_new = nev + 1;
+    }
+    // Adjust nev_new again, following the rule of the single vector solver
+    nev_new = nev_new + std::min(nconv, (kmax - nev_new) / 2);
+    if(nev_new == 1 && kmax >= 6)
+        nev_new = kmax / 2;
+    else if(nev_new == 1 && kmax > 3)
+        nev_new = 2;
+
+    if(nev_new > kmax - 1)
+        nev_new = kmax - 1;
+
+    // Examine conjugate pairs again
+    if(is_complex(ritz_val[nev_new - 1], prec) &&
+       is_conj(ritz_val[nev_new - 1], ritz_val[nev_new], prec))
+    {
+        nev_new++;
+    }
+
+    return nev_new;
+}
+
+// Retrieve and sort ritz values and ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
+{
+    const int m = ncv_act;
+    // H is block upper Hessenberg, or has a full leading block after
+    // restarting, so a dense eigen solver is used
+    ComplexVector evals(m);
+    ComplexMatrix evecs(m, m);
+    Matrix Hm = fac_H.submat(0, 0, m - 1, m - 1);
+    if(!arma::eig_gen(evals, evecs, Hm))
+        throw std::logic_error("BlockGenEigsSolver: failed to compute the eigen decomposition of H");
+
+    SortEigenvalue<Complex, SelectionRule> sorting(evals.memptr(), m);
+    std::vector<int> ind = sorting.index();
+
+    // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
+    ritz_val.zeros();
+    ritz_vec.zeros();
+    for(int i = 0; i < m; i++)
+    {
+        ritz_val[i] = evals[ind[i]];
+        ritz_vec(arma::span(0, m - 1), i) = evecs.col(ind[i]);
+    }
+}
+
+
+
+// Sort the first nev Ritz pairs in decreasing magnitude order
+// This is used to return the final results
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair()
+{
+    SortEigenvalue<Complex, LARGEST_MAGN> sorting(ritz_val.memptr(), nev);
+    std::vector<int> ind = sorting.index();
+
+    // Only the first nev pairs are permuted, and ritz_vec keeps its
+    // ncv columns, which retrieve_ritzpair() writes to
+    ComplexVector new_ritz_val(nev);
+    ComplexMatrix new_ritz_vec(ncv, nev);
+    BoolVector new_ritz_conv(nev);
+
+    for(int i = 0; i < nev; i++)
+    {
+        new_ritz_val[i] = ritz_val[ind[i]];
+        new_ritz_vec.col(i) = ritz_vec.col(ind[i]);
+        new_ritz_conv[i] = ritz_conv[ind[i]];
+    }
+
+    ritz_val.head(nev) = new_ritz_val;
+    ritz_vec.head_cols(nev) = new_ritz_vec;
+    ritz_conv.swap(new_ritz_conv);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_resid)
+{
+    // Reset all matrices/vectors to zero
+    fac_V.zeros(dim_n, ncv);
+    fac_H.zeros(ncv, ncv);
+    fac_F.zeros(dim_n, bsize);
+    ritz_val.zeros(ncv);
+    ritz_vec.zeros(ncv, ncv);
+    ritz_conv.assign(nev, false);
+
+    ncv_act = 0;
+    nmatop = 0;
+    niter = 0;
+
+    // The first block of fac_V
+    Matrix R0(init_resid, dim_n, bsize);
+    if(arma::norm(R0, "fro") < prec)
+        throw std::invalid_argument("initial residual block cannot be zero");
+
+    Matrix R;
+    qr_block(0, R0, R);
+    fac_V.head_cols(bsize) = R0;
+    ncv_act = bsize;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockGenEigsSolver<Scalar, SelectionRule, OpType>::init()
+{
+    Matrix init_resid(dim_n, bsize);
+    rng.uniform(init_resid.memptr(), dim_n * bsize);
+    init(init_resid.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockGenEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+{
+    // The block Arnoldi factorization starting from the initial block
+    factorize_from(bsize);
+    retrieve_ritzpair();
+    // Restarting
+    int i, nconv = 0, nev_adj;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nev)
+            break;
+
+        nev_adj = nev_adjusted(nconv);
+        restart(nev_adj);
+    }
+    // If maxit is reached, the convergence flags still refer to
+    // the Ritz pairs before the last restart
+    if(i == maxit)
+        nconv = num_converged(tol);
+    // Sorting results
+    sort_ritzpair();
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename BlockGenEigsSolver<Scalar, SelectionRule, OpType>::ComplexVector BlockGenEigsSolver<Scalar, SelectionRule, OpType>::eigenvalues()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    ComplexVector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename BlockGenEigsSolver<Scalar, SelectionRule, OpType>::ComplexMatrix BlockGenEigsSolver<Scalar, SelectionRule, OpType>::eigenvectors(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    ComplexMatrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    const int m = ncv_act;
+    ComplexMatrix ritz_vec_conv(m, nvec);
+    int j = 0;
+    for(int i = 0; i < nev && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_vec_conv.col(j) = ritz_vec(arma::span(0, m - 1), i);
+            j++;
+        }
+    }
+
+    Matrix Vs(fac_V.memptr(), dim_n, m, false);
+    res = Vs * ritz_vec_conv;
+
+    return res;
+}
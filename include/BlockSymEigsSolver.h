@@ -0,0 +1,278 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BLOCK_SYM_EIGS_SOLVER_H
+#define BLOCK_SYM_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the block Lanczos eigen solver for real symmetric matrices.
+///
+/// The usage of this class is the same as SymEigsSolver, but rather than
+/// extending the Krylov subspace by one vector at a time, the block solver
+/// extends the subspace by `bsize` vectors in each step. The matrix operation
+/// is therefore applied to a block of vectors at once, which turns the
+/// matrix-vector products into matrix-matrix products. This is much faster
+/// when the matrix is large and memory-bound, since the matrix only needs to be
+/// read once for the whole block. The block algorithm is also more reliable
+/// for clustered or repeated eigenvalues.
+///
+/// The solver uses a thick restart: in each restart the wanted Ritz vectors
+/// are kept and the residual block is appended to them.
+///
+/// In addition to the public member functions of DenseGenMatProd used by
+/// SymEigsSolver, the matrix operation class must implement
+/// `perform_op(const Scalar *x_in, Scalar *y_out, int ncols)`, which computes
+/// \f$Y=AX\f$ for a column-major matrix \f$X\f$ with `ncols` columns.
+/// DenseGenMatProd and SparseGenMatProd both implement this function.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues, for example `LARGEST_MAGN`
+///                       to retrieve eigenvalues with the largest magnitude.
+///                       The full list of enumeration values can be found in
+///                       SelectionRule.h .
+/// \tparam OpType        The name of the matrix operation class. Users could either
+///                       use the DenseGenMatProd and SparseGenMatProd wrapper classes,
+///                       or define their own that impelemnts all the public member
+///                       functions as in DenseGenMatProd.
+///
+/// Below is an example that uses a block size of 4.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <BlockSymEigsSolver.h>
+///
+/// int main()
+/// {
+///     arma::sp_mat A = arma::sprandu(1000, 1000, 0.01);
+///     arma::sp_mat M = A + A.t();
+///
+///     SparseGenMatProd<double> op(M);
+///
+///     // Requesting the largest ten eigenvalues, with ncv = 40 and block size 4
+///     BlockSymEigsSolver< double, LARGEST_ALGE, SparseGenMatProd<double> > eigs(&op, 10, 40, 4);
+///
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     arma::vec evalues;
+///     if(nconv > 0)
+///         evalues = eigs.eigenvalues();
+///
+///     evalues.print("Eigenvalues found:");
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = LARGEST_MAGN,
+           typename OpType = DenseGenMatProd<double> >
+class BlockSymEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+
+protected:
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-matrix product
+
+private:
+    const int dim_n;      // dimension of matrix A
+
+protected:
+    const int nev;        // number of eigenvalues requested
+
+private:
+    const int ncv;        // maximum dimension of the Krylov subspace
+    const int bsize;      // block size
+    int ncv_act;          // current dimension of the Krylov subspace
+    int nmatop;           // number of matrix operations called,
+                          // counted as matrix-vector products
+    int niter;            // number of restarting iterations
+    CounterRNG rng;       // random vectors of init() and of the breakdowns
+
+    Matrix fac_V;         // V matrix in the block Lanczos factorization
+    Matrix fac_H;         // H matrix in the block Lanczos factorization
+    Matrix fac_F;         // residual block in the block Lanczos factorization
+
+protected:
+    Vector ritz_val;      // ritz values
+
+private:
+    Matrix ritz_vec;      // ritz vectors
+    BoolVector ritz_conv; // indicator of the convergence of ritz values
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // W <- W - V * C, C = V' * W, using the first j columns of V
+    inline void project_block(int j, Matrix &W, Matrix &C);
+
+    // W = Q * R, overwriting W with Q, which is also orthogonal to
+    // the first j columns of V
+    inline void qr_block(int j, Matrix &W, Matrix &R);
+
+    // Block Lanczos factorization starting from the block that
+    // ends at column from_j
+    inline void factorize_from(int from_j);
+
+    // Thick restart, keeping k Ritz vectors
+    inline void restart(int k);
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+    // Return the adjusted nev for restarting
+    inline int nev_adjusted(int nconv);
+
+    // Retrieve and sort ritz values and ritz vectors
+    inline void retrieve_ritzpair();
+
+protected:
+    // Sort the first nev Ritz pairs in decreasing magnitude order
+    // This is used to return the final results
+    inline virtual void sort_ritzpair();
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_    Pointer to the matrix operation object, which should implement
+    ///               the matrix-vector and matrix-matrix multiplication operations
+    ///               of \f$A\f$. Users could either create the object from the
+    ///               DenseGenMatProd or SparseGenMatProd wrapper classes, or
+    ///               define their own that impelemnts all the public member functions
+    ///               as in DenseGenMatProd.
+    /// \param nev_   Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///               where \f$n\f$ is the size of matrix.
+    /// \param ncv_   Maximum dimension of the Krylov subspace. This parameter must satisfy
+    ///               \f$nev+2\cdot bsize \le ncv \le n\f$, and is advised to take
+    ///               \f$ncv \ge 2\cdot nev + bsize\f$.
+    /// \param bsize_ Block size, i.e., the number of vectors that the matrix operation
+    ///               is applied to at once. Typical values are between 2 and 8.
+    ///
+    BlockSymEigsSolver(OpType *op_, int nev_, int ncv_, int bsize_) :
+        op(op_),
+        dim_n(op->rows()),
+        nev(nev_),
+        ncv(ncv_ > dim_n ? dim_n : ncv_),
+        bsize(bsize_),
+        ncv_act(0),
+        nmatop(0),
+        niter(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(bsize_ < 1)
+            throw std::invalid_argument("bsize must be positive");
+
+        if(ncv_ < nev_ + 2 * bsize_ || ncv_ > dim_n)
+            throw std::invalid_argument("ncv must satisfy nev + 2 * bsize <= ncv <= n, n is the size of matrix");
+    }
+
+    ///
+    /// Providing the initial block of vectors for the algorithm.
+    ///
+    /// \param init_resid Pointer to the initial block, an \f$n\times bsize\f$
+    ///                   matrix stored in column-major order.
+    ///
+    inline void init(Scalar *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial block in init() and the new vectors when the block
+    /// becomes rank deficient. This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial block of vectors.
+    ///
+    /// This overloaded function generates a random initial block
+    /// for the algorithm. Elements in the block follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counted as the number of vectors that the matrix has been applied to.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues.
+    ///
+    /// \return A vector containing the eigenvalues.
+    /// Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Matrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline Matrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "BlockSymEigsSolver_Impl.h"
+
+
+#endif // BLOCK_SYM_EIGS_SOLVER_H
@@ -0,0 +1,403 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// W <- W - V * C, C = V' * W, using the first j columns of V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::project_block(int j, Matrix &W, Matrix &C)
+{
+    if(j < 1)
+    {
+        C.zeros(0, W.n_cols);
+        return;
+    }
+
+    Matrix Vs(fac_V.memptr(), dim_n, j, false); // First j columns
+    C = Vs.t() * W;
+    W -= Vs * C;
+
+    // Classical Gram-Schmidt is applied twice to maintain orthogonality
+    Matrix C2 = Vs.t() * W;
+    W -= Vs * C2;
+    C += C2;
+}
+
+// W = Q * R, overwriting W with Q, which is also orthogonal to
+// the first j columns of V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::qr_block(int j, Matrix &W, Matrix &R)
+{
+    const int ncol = W.n_cols;
+    R.zeros(ncol, ncol);
+
+    for(int c = 0; c < ncol; c++)
+    {
+        Scalar w_norm = arma::norm(W.col(c));
+        // Modified Gram-Schmidt against the previous columns, applied twice
+        for(int pass = 0; pass < 2; pass++)
+        {
+            for(int d = 0; d < c; d++)
+            {
+                Scalar r = arma::dot(W.col(d), W.col(c));
+                W.col(c) -= r * W.col(d);
+                R(d, c) += r;
+            }
+        }
+
+        Scalar r = arma::norm(W.col(c));
+        if(r > prec * w_norm)
+        {
+            R(c, c) = r;
+            W.col(c) /= r;
+            continue;
+        }
+
+        // The block is rank deficient, so we replace this column
+        // by a random vector orthogonal to V and the previous columns
+        Vector v(dim_n);
+        rng.uniform(v.memptr(), dim_n);
+        for(int pass = 0; pass < 2; pass++)
+        {
+            if(j > 0)
+            {
+                Matrix Vs(fac_V.memptr(), dim_n, j, false);
+                Vector Vv = Vs.t() * v;
+                v -= Vs * Vv;
+            }
+            for(int d = 0; d < c; d++)
+                v -= arma::dot(W.col(d), v) * W.col(d);
+        }
+        W.col(c) = v / arma::norm(v);
+        R(c, c) = 0.0;
+    }
+}
+
+// Block Lanczos factorization starting from the block that
+// ends at column from_j
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int from_j)
+{
+    Matrix C, R;
+    int j = from_j;
+    for(;;)
+    {
+        // W <- A * V{j-b}, ..., A * V{j-1}, stored in fac_F
+        op->perform_op(fac_V.colptr(j - bsize), fac_F.memptr(), bsize);
+        nmatop += bsize;
+
+        // W <- W - V * V' * W
+        project_block(j, fac_F, C);
+
+        // Only the diagonal block is recorded, since the projections on the
+        // previous blocks are known from the symmetry of H
+        Matrix D = C.rows(j - bsize, j - 1);
+        fac_H.submat(j - bsize, j - bsize, j - 1, j - 1) = (D + D.t()) / 2;
+
+        // If the next block does not fit into the subspace,
+        // W is kept as the residual block
+        if(j + bsize > ncv)
+            break;
+
+        // V{j}, ..., V{j+b-1} <- Q, H[j:(j+b), (j-b):j] <- R
+        qr_block(j, fac_F, R);
+        fac_V.cols(j, j + bsize - 1) = fac_F;
+        fac_H.submat(j, j - bsize, j + bsize - 1, j - 1) = R;
+        fac_H.submat(j - bsize, j, j - 1, j + bsize - 1) = R.t();
+
+        j += bsize;
+    }
+
+    ncv_act = j;
+}
+
+// Thick restart, keeping k Ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+{
+    const int m = ncv_act;
+    if(k >= m - bsize + 1)
+        return;
+
+    // V -> V * Y, Y contains the first k Ritz vectors
+    Matrix Vs(fac_V.memptr(), dim_n, m, false);
+    Matrix Yk = ritz_vec.submat(0, 0, m - 1, k - 1);
+    fac_V.head_cols(k) = Vs * Yk;
+
+    // A * V * Y = V * Y * Theta + F * E' * Y, and E' * Y consists of
+    // the last bsize rows of Y
+    Matrix S = Yk.rows(m - bsize, m - 1);
+
+    // F = Q * R, and Q will be the next block of V
+    Matrix C, R;
+    project_block(k, fac_F, C);
+    qr_block(k, fac_F, R);
+    fac_V.cols(k, k + bsize - 1) = fac_F;
+
+    // H becomes an arrowhead matrix
+    // [Theta  S'R']
+    // [R*S        ]
+    Matrix RS = R * S;
+    fac_H.zeros();
+    for(int i = 0; i < k; i++)
+        fac_H(i, i) = ritz_val[i];
+    fac_H.submat(k, 0, k + bsize - 1, k - 1) = RS;
+    fac_H.submat(0, k, k - 1, k + bsize - 1) = RS.t();
+
+    factorize_from(k + bsize);
+    retrieve_ritzpair();
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockSymEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar tol)
+{
+    const int m = ncv_act;
+    // ||A * V * y - theta * V * y|| = ||F * y_b||, where y_b is the last
+    // bsize elements of y, and ||F * y_b||^2 = y_b' * (F' * F) * y_b
+    Matrix FtF = fac_F.t() * fac_F;
+    for(int i = 0; i < nev; i++)
+    {
+        Vector yb = ritz_vec(arma::span(m - bsize, m - 1), i);
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        Scalar resid = std::sqrt(std::abs(arma::dot(yb, FtF * yb)));
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.end(), true);
+}
+
+// Return the adjusted nev for restarting
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockSymEigsSolver<Scalar, SelectionRule, OpType>::nev_adjusted(int nconv)
+{
+    // At most ncv_act - bsize Ritz vectors can be kept,
+    // since the residual block takes bsize columns
+    const int kmax = ncv_act - bsize;
+    int nev_new = nev;
+
+    // Adjust nev_new, following the rule of the single vector solver
+    nev_new = nev + std::min(nconv, (kmax - nev) / 2);
+    if(nev == 1 && kmax >= 6)
+        nev_new = kmax / 2;
+    else if(nev == 1 && kmax > 2)
+        nev_new = 2;
+
+    return std::min(nev_new, kmax);
+}
+
+// Retrieve and sort ritz values and ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
+{
+    const int m = ncv_act;
+    // H is block tridiagonal, or arrowhead after restarting,
+    // so a dense symmetric eigen solver is used
+    Vector evals(m);
+    Matrix evecs(m, m);
+    Matrix Hm = fac_H.submat(0, 0, m - 1, m - 1);
+    if(!arma::eig_sym(evals, evecs, arma::symmatl(Hm)))
+        throw std::logic_error("BlockSymEigsSolver: failed to compute the eigen decomposition of H");
+
+    SortEigenvalue<Scalar, SelectionRule> sorting(evals.memptr(), m);
+    std::vector<int> ind = sorting.index();
+
+    // For BOTH_ENDS, the eigenvalues are sorted according
+    // to the LARGEST_ALGE rule, so we need to move those smallest
+    // values to the left, as in SymEigsSolver
+    if(SelectionRule == BOTH_ENDS)
+    {
+        std::vector<int> ind_copy(ind);
+        for(int i = 0; i < m; i++)
+        {
+            if(i % 2 == 0)
+                ind[i] = ind_copy[i / 2];
+            else
+                ind[i] = ind_copy[m - 1 - i / 2];
+        }
+    }
+
+    // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
+    ritz_val.zeros();
+    ritz_vec.zeros();
+    for(int i = 0; i < m; i++)
+    {
+        ritz_val[i] = evals[ind[i]];
+        ritz_vec(arma::span(0, m - 1), i) = evecs.col(ind[i]);
+    }
+}
+
+
+
+// Sort the first nev Ritz pairs in decreasing magnitude order
+// This is used to return the final results
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair()
+{
+    SortEigenvalue<Scalar, LARGEST_MAGN> sorting(ritz_val.memptr(), nev);
+    std::vector<int> ind = sorting.index();
+
+    // Only the first nev pairs are permuted, and ritz_vec keeps its
+    // ncv columns, which retrieve_ritzpair() writes to
+    Vector new_ritz_val(nev);
+    Matrix new_ritz_vec(ncv, nev);
+    BoolVector new_ritz_conv(nev);
+
+    for(int i = 0; i < nev; i++)
+    {
+        new_ritz_val[i] = ritz_val[ind[i]];
+        new_ritz_vec.col(i) = ritz_vec.col(ind[i]);
+        new_ritz_conv[i] = ritz_conv[ind[i]];
+    }
+
+    ritz_val.head(nev) = new_ritz_val;
+    ritz_vec.head_cols(nev) = new_ritz_vec;
+    ritz_conv.swap(new_ritz_conv);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_resid)
+{
+    // Reset all matrices/vectors to zero
+    fac_V.zeros(dim_n, ncv);
+    fac_H.zeros(ncv, ncv);
+    fac_F.zeros(dim_n, bsize);
+    ritz_val.zeros(ncv);
+    ritz_vec.zeros(ncv, ncv);
+    ritz_conv.assign(nev, false);
+
+    ncv_act = 0;
+    nmatop = 0;
+    niter = 0;
+
+    // The first block of fac_V
+    Matrix R0(init_resid, dim_n, bsize);
+    if(arma::norm(R0, "fro") < prec)
+        throw std::invalid_argument("initial residual block cannot be zero");
+
+    Matrix R;
+    qr_block(0, R0, R);
+    fac_V.head_cols(bsize) = R0;
+    ncv_act = bsize;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void BlockSymEigsSolver<Scalar, SelectionRule, OpType>::init()
+{
+    Matrix init_resid(dim_n, bsize);
+    rng.uniform(init_resid.memptr(), dim_n * bsize);
+    init(init_resid.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int BlockSymEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+{
+    // The block Lanczos factorization starting from the initial block
+    factorize_from(bsize);
+    retrieve_ritzpair();
+    // Restarting
+    int i, nconv = 0, nev_adj;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nev)
+            break;
+
+        nev_adj = nev_adjusted(nconv);
+        restart(nev_adj);
+    }
+    // If maxit is reached, the convergence flags still refer to
+    // the Ritz pairs before the last restart
+    if(i == maxit)
+        nconv = num_converged(tol);
+    // Sorting results
+    sort_ritzpair();
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename BlockSymEigsSolver<Scalar, SelectionRule, OpType>::Vector BlockSymEigsSolver<Scalar, SelectionRule, OpType>::eigenvalues()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename BlockSymEigsSolver<Scalar, SelectionRule, OpType>::Matrix BlockSymEigsSolver<Scalar, SelectionRule, OpType>::eigenvectors(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    Matrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    const int m = ncv_act;
+    Matrix ritz_vec_conv(m, nvec);
+    int j = 0;
+    for(int i = 0; i < nev && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_vec_conv.col(j) = ritz_vec(arma::span(0, m - 1), i);
+            j++;
+        }
+    }
+
+    Matrix Vs(fac_V.memptr(), dim_n, m, false);
+    res = Vs * ritz_vec_conv;
+
+    return res;
+}
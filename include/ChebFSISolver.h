@@ -0,0 +1,267 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef CHEB_FSI_SOLVER_H
+#define CHEB_FSI_SOLVER_H
+
+#include <armadillo>
+#include <cmath>      // std::abs, std::pow
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "SymEigsSolver.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the Chebyshev-filtered subspace iteration (ChebFSI)
+/// for the extremal eigenvalues of real symmetric matrices.
+///
+/// The solver is designed for the case where many eigenvalues are requested,
+/// say a few hundreds or thousands, at one end of the spectrum. Rather than
+/// building a Krylov subspace, it keeps a block of `nblock` vectors, and in
+/// each iteration applies a Chebyshev polynomial of degree `degree` in \f$A\f$
+/// to the block. The polynomial is small on the unwanted part of the spectrum
+/// and large on the wanted part, so the block quickly approaches the wanted
+/// invariant subspace. A Rayleigh-Ritz step on the block then gives the Ritz pairs.
+///
+/// The interval to be damped by the filter is bounded, on the unwanted side, by
+/// an upper (or lower) bound of the spectrum computed from a few Lanczos steps
+/// of SymEigsSolver, or exactly for matrices of size up to 20, and on the wanted side by the Ritz value at the far end
+/// of the block, which is updated in each iteration. Converged Ritz pairs are
+/// locked and no longer filtered.
+///
+/// Almost all the work is in the filter, which applies the matrix to the whole
+/// block of vectors at once. The columns are independent, so the matrix operation
+/// class can process them in parallel; the dense and sparse wrappers use the
+/// matrix-matrix products of **Armadillo**, and a multithreaded BLAS for dense matrices.
+///
+/// The matrix operation class must implement `rows()` and the block product
+/// `perform_op(const Scalar *x_in, Scalar *y_out, int ncols)`, as in BlockSymEigsSolver,
+/// together with the single vector `perform_op()` used by the Lanczos steps.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule Either `LARGEST_ALGE` or `SMALLEST_ALGE`.
+/// \tparam OpType        The name of the matrix operation class, for example
+///                       DenseGenMatProd or SparseGenMatProd.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <ChebFSISolver.h>
+///
+/// int main()
+/// {
+///     arma::sp_mat A = arma::sprandu(10000, 10000, 0.001);
+///     arma::sp_mat M = A + A.t();
+///
+///     SparseGenMatProd<double> op(M);
+///
+///     // The 200 smallest eigenvalues, with a block of 250 vectors
+///     // and a filter of degree 15
+///     ChebFSISolver< double, SMALLEST_ALGE, SparseGenMatProd<double> > eigs(&op, 200, 250, 15);
+///
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     arma::vec evalues;
+///     if(nconv > 0)
+///         evalues = eigs.eigenvalues();
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = SMALLEST_ALGE,
+           typename OpType = DenseGenMatProd<double> >
+class ChebFSISolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef BasisProduct<Scalar, Scalar> BlockOp;
+
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-matrix product
+    const int dim_n;      // dimension of matrix A
+    const int nev;        // number of eigenvalues requested
+    const int nblock;     // number of vectors in the block
+    const int degree;     // degree of the Chebyshev filter
+    int nmatop;           // number of matrix operations called,
+                          // counted as matrix-vector products
+    int niter;            // number of filtering iterations
+    int nlock;            // number of locked Ritz pairs, which are stored
+                          // in the first nlock columns of X
+    CounterRNG rng;       // random vectors of init()
+
+    Matrix fac_X;         // the block of vectors, orthonormal after Rayleigh-Ritz
+    Matrix fac_W;         // A * X
+    Vector ritz_val;      // Ritz values, from the wanted end to the other
+
+    Scalar bound_unwanted;  // bound of the spectrum at the unwanted end
+    Scalar bound_wanted;    // estimate of the extreme eigenvalue at the wanted end,
+                            // where the filter is normalized to one
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // Workspace, sized in init() and reused in the iterations
+    Matrix ws_Y;          // n x nblock, three-term recurrence of the filter
+    Matrix ws_Z;          // n x nblock, three-term recurrence of the filter
+    Vector ws_panel;      // block_rows x nblock, used to rotate X and W in place
+
+    // Estimate the bounds of the spectrum by a few Lanczos steps
+    inline void spectrum_bounds();
+
+    // Apply the Chebyshev filter to the columns k, ..., nblock - 1 of X
+    inline void filter(int k);
+
+    // Orthonormalize the columns k, ..., nblock - 1 of X, also against
+    // the first k columns
+    inline void orthonormalize(int k);
+
+    // Rayleigh-Ritz on the whole block, where only the columns
+    // k, ..., nblock - 1 of X have changed since the last call
+    inline void rayleigh_ritz(int k);
+
+    // Lock the converged Ritz pairs, and return the number of locked pairs
+    inline int num_converged(Scalar tol);
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_     Pointer to the matrix operation object. Users could either
+    ///                create the object from the DenseGenMatProd or SparseGenMatProd
+    ///                wrapper classes, or define their own that impelemnts all the
+    ///                public member functions as in DenseGenMatProd.
+    /// \param nev_    Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///                where \f$n\f$ is the size of matrix.
+    /// \param nblock_ Number of vectors in the block. This parameter must satisfy
+    ///                \f$nev < nblock \le n\f$. The extra vectors speed up the convergence
+    ///                of the last wanted eigenvalues, and a typical choice is
+    ///                \f$nblock \approx 1.2\cdot nev\f$ plus a few vectors.
+    /// \param degree_ Degree of the Chebyshev polynomial. Higher degrees mean fewer
+    ///                iterations, but more matrix operations in each of them.
+    ///
+    ChebFSISolver(OpType *op_, int nev_, int nblock_, int degree_ = 10) :
+        op(op_),
+        dim_n(op->rows()),
+        nev(nev_),
+        nblock(nblock_),
+        degree(degree_),
+        nmatop(0),
+        niter(0),
+        nlock(0),
+        bound_unwanted(0),
+        bound_wanted(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(SelectionRule != LARGEST_ALGE && SelectionRule != SMALLEST_ALGE)
+            throw std::invalid_argument("ChebFSISolver: unsupported selection rule, must be LARGEST_ALGE or SMALLEST_ALGE");
+
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(nblock_ <= nev_ || nblock_ > dim_n)
+            throw std::invalid_argument("nblock must satisfy nev < nblock <= n, n is the size of matrix");
+
+        if(degree_ < 1)
+            throw std::invalid_argument("degree must be positive");
+    }
+
+    ///
+    /// Providing the initial block of vectors for the algorithm.
+    ///
+    /// \param init_block Pointer to the initial block, an \f$n\times nblock\f$
+    ///                   matrix stored in column-major order. Approximate
+    ///                   eigenvectors, for example from a nearby problem, make
+    ///                   a good initial block.
+    ///
+    inline void init(Scalar *init_block);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial block in init(). This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial block of vectors.
+    ///
+    /// This overloaded function generates a random initial block
+    /// for the algorithm. Elements in the block follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of filtering iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of filtering iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counted as the number of vectors that the matrix has been applied to.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues, from the wanted end of the spectrum,
+    /// i.e., in decreasing order for `LARGEST_ALGE` and increasing order for `SMALLEST_ALGE`.
+    ///
+    /// \return A vector containing the eigenvalues.
+    /// Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Matrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline Matrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "ChebFSISolver_Impl.h"
+
+
+#endif // CHEB_FSI_SOLVER_H
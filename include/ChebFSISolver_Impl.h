@@ -0,0 +1,304 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Estimate the bounds of the spectrum by a few Lanczos steps
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::spectrum_bounds()
+{
+    const int nlan = 20;
+
+    // The Lanczos factorization would span the whole space, and SymEigsSolver
+    // needs n > 2 for two Ritz values, so the small matrix is formed explicitly
+    // and the bounds are exact
+    if(dim_n <= nlan)
+    {
+        Matrix I(dim_n, dim_n, arma::fill::eye);
+        Matrix A(dim_n, dim_n);
+        op->perform_op(I.memptr(), A.memptr(), dim_n);
+        nmatop += dim_n;
+
+        Vector evals = arma::eig_sym(Matrix((A + A.t()) / 2));
+        if(SelectionRule == SMALLEST_ALGE)
+        {
+            bound_unwanted = evals[dim_n - 1];
+            bound_wanted = evals[0];
+        } else {
+            bound_unwanted = evals[0];
+            bound_wanted = evals[dim_n - 1];
+        }
+        return;
+    }
+
+    // Only the Lanczos factorization is needed, without restarting,
+    // and the Ritz values at both ends are taken whether converged or not
+    SymEigsSolver<Scalar, BOTH_ENDS, OpType> lanczos(op, 2, nlan);
+    lanczos.init();
+    lanczos.compute(0);
+    nmatop += lanczos.num_operations();
+
+    Vector theta = lanczos.ritz_values();
+    // Every Ritz value is within ||f|| of an eigenvalue, so the extreme
+    // Ritz values plus ||f|| bound the spectrum in practice
+    const Scalar beta = lanczos.residual_norm();
+    if(SelectionRule == SMALLEST_ALGE)
+    {
+        bound_unwanted = theta.max() + beta;
+        bound_wanted = theta.min();
+    } else {
+        bound_unwanted = theta.min() - beta;
+        bound_wanted = theta.max();
+    }
+}
+
+// Apply the Chebyshev filter to the columns k, ..., nblock - 1 of X
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::filter(int k)
+{
+    // The block spans the whole space, so there is nothing to filter
+    if(nblock >= dim_n)
+        return;
+
+    // The interval [lo, hi] to be damped lies between the Ritz value at
+    // the far end of the block and the bound at the unwanted end
+    const Scalar cut = ritz_val[nblock - 1];
+    Scalar lo, hi;
+    if(SelectionRule == SMALLEST_ALGE)
+    {
+        bound_wanted = std::min(bound_wanted, ritz_val[0]);
+        lo = cut;
+        hi = bound_unwanted;
+    } else {
+        bound_wanted = std::max(bound_wanted, ritz_val[0]);
+        lo = bound_unwanted;
+        hi = cut;
+    }
+    if(!(hi > lo))
+        return;
+
+    // Scaled three-term recurrence of the Chebyshev polynomials on [lo, hi],
+    // normalized to be one at bound_wanted, so that the filtered vectors
+    // neither overflow nor underflow
+    const int na = nblock - k;
+    const Scalar e = (hi - lo) / 2, c = (hi + lo) / 2;
+    Scalar sigma = e / (bound_wanted - c);
+    const Scalar tau = 2 / sigma;
+
+    Scalar *px = fac_X.colptr(k);
+    Scalar *py = ws_Y.memptr();
+    Scalar *pz = ws_Z.memptr();
+
+    // Y = (A - c * I) * X * sigma / e
+    op->perform_op(px, py, na);
+    {
+        Matrix X(px, dim_n, na, false), Y(py, dim_n, na, false);
+        Y = (Y - c * X) * (sigma / e);
+    }
+
+    for(int d = 1; d < degree; d++)
+    {
+        const Scalar sigma_new = 1 / (tau - sigma);
+
+        // Z = (A - c * I) * Y * 2 * sigma_new / e - sigma * sigma_new * X
+        op->perform_op(py, pz, na);
+        Matrix X(px, dim_n, na, false), Y(py, dim_n, na, false), Z(pz, dim_n, na, false);
+        Z = (Z - c * Y) * (2 * sigma_new / e) - (sigma * sigma_new) * X;
+
+        // X <- Y, Y <- Z, and the old X becomes the free buffer
+        Scalar *tmp = px;
+        px = py;
+        py = pz;
+        pz = tmp;
+        sigma = sigma_new;
+    }
+    nmatop += degree * na;
+
+    if(py != fac_X.colptr(k))
+        std::copy(py, py + dim_n * na, fac_X.colptr(k));
+}
+
+// Orthonormalize the columns k, ..., nblock - 1 of X, also against
+// the first k columns
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::orthonormalize(int k)
+{
+    const int na = nblock - k;
+    Matrix Xa(fac_X.colptr(k), dim_n, na, false);
+    Matrix Q, R;
+
+    // The filtered vectors are close to linearly dependent, so the projection
+    // and the QR decomposition are applied twice
+    for(int pass = 0; pass < 2; pass++)
+    {
+        if(k > 0)
+        {
+            Matrix Xl(fac_X.memptr(), dim_n, k, false);
+            Xa -= Xl * (Xl.t() * Xa);
+        }
+        if(!arma::qr_econ(Q, R, Xa))
+            throw std::logic_error("ChebFSISolver: failed to compute the QR decomposition of the block");
+        Xa = Q;
+    }
+}
+
+// Rayleigh-Ritz on the whole block, where only the columns k, ..., nblock - 1
+// of X have changed since the last call
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::rayleigh_ritz(int k)
+{
+    const int na = nblock - k;
+    op->perform_op(fac_X.colptr(k), fac_W.colptr(k), na);
+    nmatop += na;
+
+    // G = X' * A * X is small and dense, so a dense symmetric
+    // eigen solver is used. The locked columns take part as well: the filter
+    // strongly amplifies their small errors in the other columns, and the
+    // projection on the whole block removes them again
+    Matrix G = fac_X.t() * fac_W;
+    G = (G + G.t()) / 2;
+    Vector evals;
+    Matrix evecs;
+    if(!arma::eig_sym(evals, evecs, G))
+        throw std::logic_error("ChebFSISolver: failed to compute the eigen decomposition of X'AX");
+
+    // The wanted end comes first
+    if(SelectionRule == LARGEST_ALGE)
+    {
+        evals = arma::flipud(evals);
+        evecs = arma::fliplr(evecs);
+    }
+
+    // X -> X * Y and W -> W * Y, in place, so that W = A * X still holds
+    BlockOp::mult_inplace(fac_X, nblock, evecs, ws_panel.memptr());
+    BlockOp::mult_inplace(fac_W, nblock, evecs, ws_panel.memptr());
+    ritz_val = evals;
+}
+
+// Lock the converged Ritz pairs, and return the number of locked pairs
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int ChebFSISolver<Scalar, SelectionRule, OpType>::num_converged(Scalar tol)
+{
+    // Only the leading converged pairs are locked, so that the
+    // locked ones are always the most wanted
+    for(int i = nlock; i < nev; i++)
+    {
+        Scalar resid = arma::norm(fac_W.col(i) - ritz_val[i] * fac_X.col(i));
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        if(resid >= thresh)
+            break;
+
+        nlock++;
+    }
+
+    return nlock;
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::init(Scalar *init_block)
+{
+    fac_X = Matrix(init_block, dim_n, nblock);
+    if(arma::norm(fac_X, "fro") < prec)
+        throw std::invalid_argument("initial block cannot be zero");
+
+    fac_W.zeros(dim_n, nblock);
+    ritz_val.zeros(nblock);
+    ws_Y.zeros(dim_n, nblock);
+    ws_Z.zeros(dim_n, nblock);
+    ws_panel.zeros(std::min(dim_n, int(BlockOp::block_rows)) * nblock);
+
+    nmatop = 0;
+    niter = 0;
+    nlock = 0;
+    bound_unwanted = 0;
+    bound_wanted = 0;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void ChebFSISolver<Scalar, SelectionRule, OpType>::init()
+{
+    Matrix init_block(dim_n, nblock);
+    rng.uniform(init_block.memptr(), dim_n * nblock);
+    init(init_block.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int ChebFSISolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+{
+    if(nblock < dim_n)
+        spectrum_bounds();
+
+    orthonormalize(0);
+    rayleigh_ritz(0);
+
+    int i;
+    for(i = 0; i < maxit; i++)
+    {
+        if(num_converged(tol) >= nev)
+            break;
+
+        filter(nlock);
+        orthonormalize(nlock);
+        rayleigh_ritz(nlock);
+    }
+
+    niter = i + 1;
+
+    return std::min(nev, nlock);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename ChebFSISolver<Scalar, SelectionRule, OpType>::Vector ChebFSISolver<Scalar, SelectionRule, OpType>::eigenvalues()
+{
+    const int nconv = std::min(nev, nlock);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    res = ritz_val.head(nconv);
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename ChebFSISolver<Scalar, SelectionRule, OpType>::Matrix ChebFSISolver<Scalar, SelectionRule, OpType>::eigenvectors(int nvec)
+{
+    nvec = std::min(nvec, std::min(nev, nlock));
+    Matrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    res = fac_X.head_cols(nvec);
+
+    return res;
+}
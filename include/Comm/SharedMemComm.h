@@ -0,0 +1,110 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SHARED_MEM_COMM_H
+#define SHARED_MEM_COMM_H
+
+#include <vector>              // std::vector
+#include <algorithm>           // std::copy
+#include <mutex>               // std::mutex, std::unique_lock
+#include <condition_variable>  // std::condition_variable
+#include <stdexcept>           // std::invalid_argument
+
+///
+/// \defgroup Comm Communication
+///
+/// Communication between the ranks of the distributed solvers
+///
+
+///
+/// \ingroup Comm
+///
+/// This class implements the communication interface of DistSymEigsSolver
+/// for ranks that are threads of the same process, with the reduction
+/// carried out in shared memory.
+///
+/// It stands in for a message passing library, and allows the distributed
+/// solvers to be run and tested in a single process. With **MPI**, the same
+/// interface would be implemented by `MPI_Allreduce` with `MPI_SUM`.
+///
+/// One object is shared by all the ranks, and every call of allreduce() is
+/// collective: it returns once all the ranks have made the same call.
+///
+template <typename Scalar>
+class SharedMemComm
+{
+private:
+    const int nrank;      // number of ranks
+    std::mutex mtx;
+    std::condition_variable cond;
+    std::vector<Scalar> sum;  // the reduction in progress
+    int narrived;         // number of ranks that have added their values
+    int ndeparted;        // number of ranks that have copied the sum
+    bool distributing;    // whether the sum is complete and being copied
+
+public:
+    ///
+    /// Constructor to create the communication object.
+    ///
+    /// \param nrank_ Number of ranks, i.e., threads, that take part in the reductions.
+    ///
+    SharedMemComm(int nrank_) :
+        nrank(nrank_),
+        narrived(0),
+        ndeparted(0),
+        distributing(false)
+    {
+        if(nrank_ < 1)
+            throw std::invalid_argument("the number of ranks must be positive");
+    }
+
+    ///
+    /// Return the number of ranks.
+    ///
+    int size() { return nrank; }
+
+    ///
+    /// Sum a vector over all the ranks, in place.
+    ///
+    /// \param buf Pointer to the vector, which is overwritten by the sum.
+    ///            All the ranks receive exactly the same values.
+    /// \param n   Length of the vector, the same on all the ranks.
+    ///
+    void allreduce(Scalar *buf, int n)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        // Wait until the previous reduction has been copied by all the ranks
+        cond.wait(lock, [this]() { return !distributing; });
+
+        if(narrived == 0)
+            sum.assign(n, Scalar(0));
+        for(int i = 0; i < n; i++)
+            sum[i] += buf[i];
+        narrived++;
+
+        if(narrived == nrank)
+        {
+            distributing = true;
+            cond.notify_all();
+        } else {
+            cond.wait(lock, [this]() { return distributing; });
+        }
+
+        std::copy(sum.begin(), sum.begin() + n, buf);
+        ndeparted++;
+
+        if(ndeparted == nrank)
+        {
+            narrived = 0;
+            ndeparted = 0;
+            distributing = false;
+            cond.notify_all();
+        }
+    }
+};
+
+
+#endif // SHARED_MEM_COMM_H
@@ -0,0 +1,326 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIST_SYM_EIGS_SOLVER_H
+#define DIST_SYM_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument
+
+#include "SelectionRule.h"
+#include "LinAlg/UpperHessenbergQR.h"
+#include "LinAlg/TridiagEigen.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "Comm/SharedMemComm.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the eigen solver for real symmetric matrices
+/// whose rows are distributed across several ranks, for example the
+/// processes of an **MPI** program.
+///
+/// Each rank owns a contiguous block of rows of \f$A\f$, and stores the
+/// same rows of the Krylov basis \f$V\f$, of the residual vector and of the
+/// work vectors. Every inner product, including \f$V'w\f$, is computed on
+/// the local rows and then summed over the ranks by the communication object.
+/// The small matrix \f$H\f$ and the Ritz pairs are replicated, and all the
+/// ranks take the same decisions, since they are based on the reduced values.
+///
+/// The algorithm is the same as SymEigsSolver with the implicit restart and
+/// the full reorthogonalization. The projection \f$V'f\f$ and the norm of
+/// \f$f\f$ are reduced together, so each Lanczos step needs two or three
+/// reductions of about `ncv` numbers.
+///
+/// All the ranks must construct the solver and call its member functions
+/// together, since the constructor, init() and compute() are collective.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues. See SymEigsSolver.
+/// \tparam OpType        The name of the matrix operation class. `rows()` returns
+///                       the number of local rows, and `perform_op(x_in, y_out)`
+///                       computes the local rows of \f$y=Ax\f$ from the local
+///                       rows of \f$x\f$, communicating as needed.
+/// \tparam CommType      The name of the communication class, which implements
+///                       `allreduce(Scalar *buf, int n)`, summing `buf` over all
+///                       the ranks in place. All the ranks must receive the
+///                       same values. SharedMemComm implements it for threads.
+///
+/// Below is an example with threads as the ranks. The matrix operation
+/// uses the reduction to gather \f$x\f$ from the ranks.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <thread>
+/// #include <DistSymEigsSolver.h>
+///
+/// // Local rows [start, start + nlocal) of a dense matrix M
+/// class RowBlockProd
+/// {
+/// private:
+///     const arma::mat &M;
+///     SharedMemComm<double> *comm;
+///     int start, nlocal;
+/// public:
+///     RowBlockProd(const arma::mat &M_, SharedMemComm<double> *comm_, int start_, int nlocal_) :
+///         M(M_), comm(comm_), start(start_), nlocal(nlocal_) {}
+///     int rows() { return nlocal; }
+///     void perform_op(double *x_in, double *y_out)
+///     {
+///         arma::vec x(M.n_cols, arma::fill::zeros);
+///         std::copy(x_in, x_in + nlocal, x.memptr() + start);
+///         comm->allreduce(x.memptr(), M.n_cols);
+///         arma::vec y(y_out, nlocal, false);
+///         y = M.rows(start, start + nlocal - 1) * x;
+///     }
+/// };
+///
+/// int main()
+/// {
+///     arma::mat A = arma::randu(1000, 1000);
+///     arma::mat M = A + A.t();
+///
+///     const int nrank = 4;
+///     SharedMemComm<double> comm(nrank);
+///     std::vector<std::thread> ranks;
+///     for(int r = 0; r < nrank; r++)
+///     {
+///         ranks.push_back(std::thread([&, r]() {
+///             RowBlockProd op(M, &comm, r * 250, 250);
+///             DistSymEigsSolver< double, LARGEST_ALGE, RowBlockProd, SharedMemComm<double> >
+///                 eigs(&op, &comm, 10, 30);
+///             eigs.init();
+///             eigs.compute();
+///             // The eigenvalues are the same on all the ranks, and each
+///             // rank has its own rows of the eigenvectors
+///             arma::vec evalues = eigs.eigenvalues();
+///             arma::mat evecs_local = eigs.eigenvectors();
+///         }));
+///     }
+///     for(int r = 0; r < nrank; r++)
+///         ranks[r].join();
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+class DistSymEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+    typedef BasisProduct<Scalar, Scalar> BasisOp;
+
+    OpType *op;           // object to conduct matrix operation on the local rows
+    CommType *comm;       // object to sum the local values over the ranks
+    const int dim_local;  // number of local rows
+    const double dim_n;   // dimension of matrix A, summed over the ranks
+    const int nev;        // number of eigenvalues requested
+    const int ncv;        // number of ritz values
+    int nmatop;           // number of matrix operations called
+    int niter;            // number of restarting iterations
+    int nreduce;          // number of reductions called
+    CounterRNG rng;       // random local rows of init() and of the restarts
+
+    Matrix fac_V;         // local rows of V in the Arnoldi factorization
+    Matrix fac_H;         // H matrix in the Arnoldi factorization, replicated
+    Vector fac_f;         // local rows of the residual
+
+    Vector ritz_val;      // ritz values
+    Matrix ritz_vec;      // ritz vectors
+    BoolVector ritz_conv; // indicator of the convergence of ritz values
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // Workspace, sized in init() and reused in the restarting iterations
+    Vector ws_v;          // local rows of the current basis vector
+    Vector ws_w;          // local rows of A * v
+    Vector ws_h;          // projection coefficients, of length ncv + 1
+    Vector ws_panel;      // block_rows x ncv, a panel of V * Q in the restart
+    Matrix ws_Q;          // ncv x ncv, accumulated orthogonal transformations
+    std::vector<int> ws_ind;       // order index of the Ritz values
+    std::vector<int> ws_ind_copy;  // copy of ws_ind, used by BOTH_ENDS
+    TridiagQR<Scalar> decomp_qr;
+    TridiagEigen<Scalar> decomp_eigen;
+    SortEigenvalue<Scalar, SelectionRule> sorting;
+
+    // Sum the local dimensions over the ranks
+    static double global_dim(CommType *comm, int nlocal)
+    {
+        Scalar n = Scalar(nlocal);
+        comm->allreduce(&n, 1);
+        return double(n);
+    }
+
+    // Sum buf over the ranks
+    inline void allreduce(Scalar *buf, int n)
+    {
+        comm->allreduce(buf, n);
+        nreduce++;
+    }
+
+    // Inner product of two distributed vectors
+    inline Scalar dot(const Vector &x, const Vector &y)
+    {
+        Scalar res = arma::dot(x, y);
+        allreduce(&res, 1);
+        return res;
+    }
+
+    // h[0:ncol-1] <- V' * x, using the first ncol columns of V, and
+    // h[ncol] <- ||x||^2, in one reduction
+    inline void project(int ncol, const Vector &x, Scalar *h);
+
+    // Arnoldi factorization starting from step-k
+    inline void factorize_from(int from_k, int to_m, const Vector &fk);
+
+    // Implicitly restarted Arnoldi factorization
+    inline void restart(int k);
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+    // Return the adjusted nev for restarting
+    inline int nev_adjusted(int nconv);
+
+    // Retrieve and sort ritz values and ritz vectors
+    inline void retrieve_ritzpair();
+
+    // Sort the first nev Ritz pairs in decreasing magnitude order
+    inline void sort_ritzpair();
+
+public:
+    ///
+    /// Constructor to create a solver object. This is collective over the ranks.
+    ///
+    /// \param op_   Pointer to the matrix operation object on the local rows.
+    /// \param comm_ Pointer to the communication object.
+    /// \param nev_  Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///              where \f$n\f$ is the size of matrix, summed over the ranks.
+    /// \param ncv_  Parameter that controls the convergence speed of the algorithm.
+    ///              This parameter must satisfy \f$nev < ncv \le n\f$,
+    ///              and is advised to take \f$ncv \ge 2\cdot nev\f$.
+    ///
+    DistSymEigsSolver(OpType *op_, CommType *comm_, int nev_, int ncv_) :
+        op(op_),
+        comm(comm_),
+        dim_local(op->rows()),
+        dim_n(global_dim(comm_, op->rows())),
+        nev(nev_),
+        ncv(ncv_),
+        nmatop(0),
+        niter(0),
+        nreduce(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(ncv_ <= nev_ || ncv_ > dim_n)
+            throw std::invalid_argument("ncv must satisfy nev < ncv <= n, n is the size of matrix");
+    }
+
+    ///
+    /// Providing the initial residual vector for the algorithm.
+    /// This is collective over the ranks.
+    ///
+    /// \param init_resid Pointer to the local rows of the initial residual vector.
+    ///
+    inline void init(Scalar *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// local rows of the initial residual vector in init() and of the new
+    /// residual vectors when the factorization breaks down. This function
+    /// should be called before init().
+    ///
+    /// Each rank has its own generator, seeded with 0 by default. The ranks
+    /// should be given different seeds, for example a base seed plus the rank
+    /// number, since otherwise they all draw the same numbers for their rows.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial residual vector.
+    /// This is collective over the ranks.
+    ///
+    /// Elements in the vector follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn on each rank for its own rows from the generator
+    /// of the rank, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    /// This is collective over the ranks.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the number of reductions called in the computation,
+    /// not counting those inside the matrix operations.
+    ///
+    inline int num_reductions() { return nreduce; }
+
+    ///
+    /// Returning the converged eigenvalues, which are the same on all the ranks.
+    ///
+    /// \return A vector containing the eigenvalues.
+    ///
+    inline Vector eigenvalues();
+
+    ///
+    /// Returning the local rows of the eigenvectors associated with
+    /// the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A matrix containing the local rows of the eigenvectors.
+    ///
+    inline Matrix eigenvectors(int nvec);
+    ///
+    /// Returning the local rows of all converged eigenvectors.
+    ///
+    inline Matrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "DistSymEigsSolver_Impl.h"
+
+
+#endif // DIST_SYM_EIGS_SOLVER_H
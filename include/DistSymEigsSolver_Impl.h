@@ -0,0 +1,395 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// h[0:ncol-1] <- V' * x, using the first ncol columns of V, and
+// h[ncol] <- ||x||^2, in one reduction
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::project(int ncol, const Vector &x, Scalar *h)
+{
+    BasisOp::trans_mult(fac_V, ncol, x.memptr(), h);
+    h[ncol] = arma::dot(x, x);
+    allreduce(h, ncol + 1);
+}
+
+// Arnoldi factorization starting from step-k
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::factorize_from(int from_k, int to_m, const Vector &fk)
+{
+    if(to_m <= from_k) return;
+
+    fac_f = fk;
+
+    Vector &v = ws_v;
+    Vector &w = ws_w;
+    Scalar *h = ws_h.memptr();
+    Scalar beta = std::sqrt(dot(fac_f, fac_f)), Hii = 0.0;
+    // Keep the upperleft k x k submatrix of H and set other elements to 0
+    fac_H.tail_cols(ncv - from_k).zeros();
+    fac_H.submat(arma::span(from_k, ncv - 1), arma::span(0, from_k - 1)).zeros();
+    for(int i = from_k; i <= to_m - 1; i++)
+    {
+        bool restart = false;
+        // If beta = 0, then the next V is not full rank
+        // We need to generate a new residual vector that is orthogonal
+        // to the current V, which we call a restart
+        if(beta < prec)
+        {
+            rng.uniform(fac_f.memptr(), dim_local);
+            // f <- f - V * V' * f, so that f is orthogonal to V
+            // using the first i columns of V
+            project(i, fac_f, h);
+            BasisOp::mult_sub(fac_V, i, h, fac_f.memptr());
+            // beta <- ||f||
+            beta = std::sqrt(dot(fac_f, fac_f));
+
+            restart = true;
+        }
+
+        // v <- f / ||f||, stored as the (i+1)-th column of V
+        v = fac_f / beta;
+        fac_V.col(i) = v;
+
+        // Note that H[i+1, i] equals to the unrestarted beta
+        if(restart)
+            fac_H(i, i - 1) = 0.0;
+        else
+            fac_H(i, i - 1) = beta;
+
+        // w <- A * v, v = fac_V.col(i)
+        op->perform_op(v.memptr(), w.memptr());
+        nmatop++;
+
+        Hii = dot(v, w);
+        fac_H(i - 1, i) = fac_H(i, i - 1); // Due to symmetry
+        fac_H(i, i) = Hii;
+
+        // f <- w - V * V' * w = w - H[i+1, i] * V{i} - H[i+1, i+1] * V{i+1}
+        // If restarting, we know that H[i+1, i] = 0
+        fac_f = w - Hii * v;
+        if(!restart)
+            BasisOp::axpy(-fac_H(i, i - 1), fac_V, i - 1, fac_f.memptr());
+
+        // f/||f|| is going to be the next column of V, so we need to test
+        // whether V' * (f/||f||) ~= 0, using the first i+1 columns of V
+        // The norm of f is reduced together with V' * f
+        project(i + 1, fac_f, h);
+        beta = std::sqrt(h[i + 1]);
+        Vector Vf(h, i + 1, false);
+        // If not, iteratively correct the residual
+        int count = 0;
+        while(count < 5 && arma::abs(Vf).max() > prec * beta)
+        {
+            // f <- f - V * Vf
+            BasisOp::mult_sub(fac_V, i + 1, h, fac_f.memptr());
+            // h <- h + Vf
+            fac_H(i - 1, i) += Vf[i - 1];
+            fac_H(i, i - 1) = fac_H(i - 1, i);
+            fac_H(i, i) += Vf[i];
+
+            project(i + 1, fac_f, h);
+            beta = std::sqrt(h[i + 1]);
+            count++;
+        }
+    }
+}
+
+// Implicitly restarted Arnoldi factorization
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::restart(int k)
+{
+    if(k >= ncv)
+        return;
+
+    // The QR sweeps only involve H, and are replicated on all the ranks
+    Matrix &Q = ws_Q;
+    Q.eye();
+
+    for(int i = k; i < ncv; i++)
+    {
+        // QR decomposition of H-mu*I, mu is the shift
+        fac_H.diag() -= ritz_val[i];
+        decomp_qr.compute(fac_H);
+
+        // Q -> Q * Qi
+        decomp_qr.apply_YQ(Q);
+
+        // H -> Q'HQ
+        // Since QR = H - mu * I, we have H = QR + mu * I
+        // and therefore Q'HQ = RQ + mu * I
+        decomp_qr.matrix_RQ(fac_H);
+        fac_H.diag() += ritz_val[i];
+    }
+
+    // V -> VQ, only need to update the first k+1 columns
+    // Each rank updates its own rows, without communication
+    Matrix Qk(Q.memptr(), ncv, k + 1, false);
+    BasisOp::mult_inplace(fac_V, ncv, Qk, ws_panel.memptr());
+
+    // f -> f * Q[ncv, k] + V[, k+1] * H[k+1, k]
+    fac_f *= Q(ncv - 1, k - 1);
+    BasisOp::axpy(fac_H(k, k - 1), fac_V, k, fac_f.memptr());
+    factorize_from(k, ncv, fac_f);
+    retrieve_ritzpair();
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline int DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::num_converged(Scalar tol)
+{
+    // thresh = tol * max(prec, abs(theta)), theta for ritz value
+    const Scalar f_norm = std::sqrt(dot(fac_f, fac_f));
+    for(int i = 0; i < nev; i++)
+    {
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        Scalar resid = std::abs(ritz_vec(ncv - 1, i)) * f_norm;
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.end(), true);
+}
+
+// Return the adjusted nev for restarting
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline int DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::nev_adjusted(int nconv)
+{
+    int nev_new = nev;
+
+    // Adjust nev_new, according to dsaup2.f line 677~684 in ARPACK
+    nev_new = nev + std::min(nconv, (ncv - nev) / 2);
+    if(nev == 1 && ncv >= 6)
+        nev_new = ncv / 2;
+    else if(nev == 1 && ncv > 2)
+        nev_new = 2;
+
+    return nev_new;
+}
+
+// Retrieve and sort ritz values and ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::retrieve_ritzpair()
+{
+    decomp_eigen.compute(fac_H);
+    const Vector &evals = decomp_eigen.eigenvalues();
+    const Matrix &evecs = decomp_eigen.eigenvectors();
+
+    sorting.compute(evals.memptr(), ncv);
+    std::vector<int> &ind = ws_ind;
+    sorting.index(ind);
+
+    // For BOTH_ENDS, the eigenvalues are sorted according
+    // to the LARGEST_ALGE rule, so we need to move those smallest
+    // values to the left, see SymEigsSolver
+    if(SelectionRule == BOTH_ENDS)
+    {
+        std::vector<int> &ind_copy = ws_ind_copy;
+        ind_copy = ind;
+        for(int i = 0; i < ncv; i++)
+        {
+            if(i % 2 == 0)
+                ind[i] = ind_copy[i / 2];
+            else
+                ind[i] = ind_copy[ncv - 1 - i / 2];
+        }
+    }
+
+    // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
+    for(int i = 0; i < ncv; i++)
+    {
+        ritz_val[i] = evals[ind[i]];
+    }
+    for(int i = 0; i < nev; i++)
+    {
+        ritz_vec.col(i) = evecs.col(ind[i]);
+    }
+}
+
+// Sort the first nev Ritz pairs in decreasing magnitude order
+// This is used to return the final results
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::sort_ritzpair()
+{
+    SortEigenvalue<Scalar, LARGEST_MAGN> sorting(ritz_val.memptr(), nev);
+    std::vector<int> ind = sorting.index();
+
+    Vector new_ritz_val(ncv);
+    Matrix new_ritz_vec(ncv, nev);
+    BoolVector new_ritz_conv(nev);
+
+    for(int i = 0; i < nev; i++)
+    {
+        new_ritz_val[i] = ritz_val[ind[i]];
+        new_ritz_vec.col(i) = ritz_vec.col(ind[i]);
+        new_ritz_conv[i] = ritz_conv[ind[i]];
+    }
+
+    ritz_val.swap(new_ritz_val);
+    ritz_vec.swap(new_ritz_vec);
+    ritz_conv.swap(new_ritz_conv);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::init(Scalar *init_resid)
+{
+    // Reset all matrices/vectors to zero
+    fac_V.zeros(dim_local, ncv);
+    fac_H.zeros(ncv, ncv);
+    fac_f.zeros(dim_local);
+    ritz_val.zeros(ncv);
+    ritz_vec.zeros(ncv, nev);
+    ritz_conv.assign(nev, false);
+
+    ws_v.set_size(dim_local);
+    ws_w.set_size(dim_local);
+    ws_h.set_size(ncv + 1);
+    ws_panel.set_size(std::min(dim_local, int(BasisOp::block_rows)) * ncv);
+    ws_Q.set_size(ncv, ncv);
+    ws_ind.reserve(ncv);
+    ws_ind_copy.reserve(ncv);
+
+    nmatop = 0;
+    niter = 0;
+    nreduce = 0;
+
+    Vector r(init_resid, dim_local, false);
+    // The first column of fac_V
+    Vector &v = ws_v;
+    Scalar rnorm = std::sqrt(dot(r, r));
+    if(rnorm < prec)
+        throw std::invalid_argument("initial residual vector cannot be zero");
+    v = r / rnorm;
+    fac_V.col(0) = v;
+
+    Vector &w = ws_w;
+    op->perform_op(v.memptr(), w.memptr());
+    nmatop++;
+
+    fac_H(0, 0) = dot(v, w);
+    fac_f = w - v * fac_H(0, 0);
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline void DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::init()
+{
+    Vector init_resid(dim_local);
+    rng.uniform(init_resid.memptr(), dim_local);
+    init(init_resid.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline int DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::compute(int maxit, Scalar tol)
+{
+    // The m-step Arnoldi factorization
+    factorize_from(1, ncv, fac_f);
+    retrieve_ritzpair();
+    // Restarting
+    int i, nconv = 0, nev_adj;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nev)
+            break;
+
+        nev_adj = nev_adjusted(nconv);
+        restart(nev_adj);
+    }
+    // Sorting results
+    sort_ritzpair();
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline typename DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::Vector DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::eigenvalues()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return the local rows of converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename CommType >
+inline typename DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::Matrix DistSymEigsSolver<Scalar, SelectionRule, OpType, CommType>::eigenvectors(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    Matrix res(dim_local, nvec);
+
+    if(!nvec)
+        return res;
+
+    Matrix ritz_vec_conv(ncv, nvec);
+    int j = 0;
+    for(int i = 0; i < nev && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_vec_conv.col(j) = ritz_vec.col(i);
+            j++;
+        }
+    }
+
+    BasisOp::mult(fac_V, ncv, ritz_vec_conv, res);
+
+    return res;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGS_OBSERVER_H
+#define EIGS_OBSERVER_H
+
+#include <armadillo>
+#include <functional>  // std::function
+
+
+///
+/// \ingroup EigenSolver
+///
+/// The state of an eigen solver after one iteration of `compute()`, passed to
+/// the observer set by SymEigsSolver::set_observer() or GenEigsSolver::set_observer().
+///
+/// \tparam ValueType The type of the Ritz values, `Scalar` for the symmetric
+///                   solvers and `std::complex<Scalar>` for the general ones.
+/// \tparam RealType  The real type of the residuals.
+///
+template <typename ValueType, typename RealType>
+struct EigsIteration
+{
+    int iter;                            ///< Index of the iteration, starting from 0.
+                                         ///< Iteration 0 follows the first factorization,
+                                         ///< and iteration \f$i\f$ follows the \f$i\f$-th restart.
+    arma::Col<ValueType> ritz_values;    ///< The `nev` wanted Ritz values, converged or not.
+    arma::Col<RealType> residuals;       ///< Estimates of the residual norms \f$\|Ax-\theta x\|\f$
+                                         ///< of the Ritz pairs, in the same order.
+    int nconv;                           ///< Number of converged Ritz values.
+    int nops;                            ///< Number of matrix operations so far.
+    double elapsed;                      ///< Wall time in seconds since `compute()` was called.
+};
+
+///
+/// \ingroup EigenSolver
+///
+/// The type of the observers of the eigen solvers. The return value indicates
+/// whether to stop the computation.
+///
+template <typename ValueType, typename RealType>
+struct EigsObserver
+{
+    typedef std::function<bool(const EigsIteration<ValueType, RealType>&)> type;
+};
+
+
+#endif // EIGS_OBSERVER_H
@@ -0,0 +1,217 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EIGS_SOLVER_POOL_H
+#define EIGS_SOLVER_POOL_H
+
+#include <vector>              // std::vector
+#include <deque>               // std::deque
+#include <algorithm>           // std::max
+#include <functional>          // std::function
+#include <memory>              // std::shared_ptr
+#include <utility>             // std::declval
+#include <thread>              // std::thread
+#include <mutex>               // std::mutex, std::unique_lock
+#include <condition_variable>  // std::condition_variable
+#include <future>              // std::future, std::packaged_task
+#include <type_traits>         // std::result_of
+#include <stdexcept>           // std::logic_error
+
+
+///
+/// \ingroup EigenSolver
+///
+/// The results of one solve run by EigsSolverPool::solve().
+///
+template <typename SolverType>
+struct EigsSolveResult
+{
+    typedef decltype(std::declval<SolverType&>().eigenvalues()) ValueType;
+    typedef decltype(std::declval<SolverType&>().eigenvectors()) VectorType;
+
+    int nconv;                ///< Number of converged eigenvalues.
+    int niter;                ///< Number of restarting iterations.
+    int nops;                 ///< Number of matrix operations.
+    ValueType eigenvalues;    ///< Converged eigenvalues.
+    VectorType eigenvectors;  ///< Eigenvectors of the converged eigenvalues.
+};
+
+///
+/// \ingroup EigenSolver
+///
+/// This class runs many independent eigen solves concurrently on a fixed
+/// set of threads, for example the requests handled by a service.
+///
+/// The tasks are queued and taken by the threads in the order of
+/// submission. Each task creates its own solver object, which owns its
+/// workspace and its random number generator (see SymEigsSolver::set_seed()),
+/// so the solves share no state and their results only depend on their
+/// seeds, not on the scheduling. The matrix operation objects may be shared
+/// by several tasks, as long as their `perform_op()` only reads the matrix,
+/// which is the case for DenseGenMatProd and SparseGenMatProd.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <SymEigsSolver.h>
+/// #include <EigsSolverPool.h>
+///
+/// int main()
+/// {
+///     arma::mat A = arma::randu(1000, 1000);
+///     arma::mat M = A + A.t();
+///     DenseGenMatProd<double> op(M);
+///
+///     typedef SymEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<double> > Solver;
+///     EigsSolverPool pool(8);
+///     std::vector< std::future< EigsSolveResult<Solver> > > res;
+///     for(int i = 0; i < 100; i++)
+///         res.push_back(pool.solve<Solver>(&op, 5, 20, i));
+///
+///     for(int i = 0; i < 100; i++)
+///         arma::vec evalues = res[i].get().eigenvalues;
+///
+///     return 0;
+/// }
+/// \endcode
+///
+class EigsSolverPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque< std::function<void()> > queue;  // tasks that have not started
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool stopping;        // whether the destructor has been called
+
+    void work()
+    {
+        for(;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cond.wait(lock, [this]() { return stopping || !queue.empty(); });
+                // The queue is drained before the threads exit
+                if(queue.empty())
+                    return;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    ///
+    /// Constructor to create the pool and start its threads.
+    ///
+    /// \param nthread Number of threads. A nonpositive value means the number of
+    ///                concurrent threads supported by the hardware.
+    ///
+    EigsSolverPool(int nthread = 0) :
+        stopping(false)
+    {
+        if(nthread <= 0)
+            nthread = std::max(1, int(std::thread::hardware_concurrency()));
+
+        for(int t = 0; t < nthread; t++)
+            workers.push_back(std::thread(&EigsSolverPool::work, this));
+    }
+
+    ///
+    /// The destructor waits for all the submitted tasks to finish.
+    ///
+    ~EigsSolverPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cond.notify_all();
+        for(size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+    }
+
+    ///
+    /// Return the number of threads.
+    ///
+    int num_threads() { return workers.size(); }
+
+    ///
+    /// Return the number of tasks that have been submitted but not started.
+    ///
+    int num_pending()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        return queue.size();
+    }
+
+    ///
+    /// Submit a task to the pool.
+    ///
+    /// \param task A function object called with no arguments.
+    ///
+    /// \return A future that receives the return value of the task,
+    ///         or the exception thrown by it.
+    ///
+    template <typename Task>
+    std::future<typename std::result_of<Task()>::type> submit(Task task)
+    {
+        typedef typename std::result_of<Task()>::type Result;
+        // std::function requires copyable function objects, so the
+        // packaged task is held by a shared pointer
+        std::shared_ptr< std::packaged_task<Result()> > job(new std::packaged_task<Result()>(task));
+        std::future<Result> res = job->get_future();
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if(stopping)
+                throw std::logic_error("EigsSolverPool: the pool has been stopped");
+            queue.push_back([job]() { (*job)(); });
+        }
+        cond.notify_one();
+
+        return res;
+    }
+
+    ///
+    /// Submit an eigen solve to the pool.
+    ///
+    /// \tparam SolverType The solver class, for example SymEigsSolver or GenEigsSolver.
+    /// \tparam OpType     The matrix operation class, which is shared by the tasks.
+    ///
+    /// \param op    Pointer to the matrix operation object. It must stay alive
+    ///              until the task is finished.
+    /// \param nev   Number of eigenvalues requested.
+    /// \param ncv   Parameter that controls the convergence speed of the algorithm.
+    /// \param seed  Seed of the random initial residual vector.
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol   Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return A future that receives the results of the solve.
+    ///
+    template <typename SolverType, typename OpType>
+    std::future< EigsSolveResult<SolverType> > solve(OpType *op, int nev, int ncv, unsigned long long seed,
+                                                     int maxit = 1000, double tol = 1e-10)
+    {
+        return submit([op, nev, ncv, seed, maxit, tol]()
+        {
+            SolverType eigs(op, nev, ncv);
+            eigs.set_seed(seed);
+            eigs.init();
+
+            EigsSolveResult<SolverType> res;
+            res.nconv = eigs.compute(maxit, tol);
+            res.niter = eigs.num_iterations();
+            res.nops = eigs.num_operations();
+            res.eigenvalues = eigs.eigenvalues();
+            res.eigenvectors = eigs.eigenvectors();
+            return res;
+        });
+    }
+};
+
+
+#endif // EIGS_SOLVER_POOL_H
@@ -0,0 +1,36 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef GEIGS_MODE_H
+#define GEIGS_MODE_H
+
+///
+/// \file GEigsMode.h
+///
+/// This file defines enumeration types for the computational modes of the
+/// generalized eigen solver SymGEigsSolver.
+///
+
+///
+/// The enumeration of the modes of the generalized eigen solver, for the
+/// problem \f$Ax=\lambda Bx\f$, where \f$B\f$ is positive definite.
+///
+enum GEIGS_MODE
+{
+
+    GEIGS_CHOLESKY = 0,     ///< Using the Cholesky decomposition \f$B=LL'\f$ to transform
+                            ///< the problem into the standard one of \f$L^{-1}AL^{-T}\f$.
+                            ///< Each Lanczos step needs two triangular solves.
+
+    GEIGS_REGULAR_INVERSE,  ///< Working on \f$B^{-1}A\f$, which is self-adjoint in the
+                            ///< \f$B\f$-inner product used by the Lanczos process. Each
+                            ///< Lanczos step needs one solve and one product with \f$B\f$.
+
+    GEIGS_SHIFT_INVERT      ///< Working on \f$(A-\sigma B)^{-1}B\f$ in the \f$B\f$-inner product,
+                            ///< which finds the eigenvalues closest to the shift \f$\sigma\f$.
+};
+
+#endif // GEIGS_MODE_H
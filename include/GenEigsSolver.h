@@ -13,14 +13,22 @@
 #include <algorithm>  // std::max, std::min
 #include <complex>    // std::complex, std::conj, std::norm
 #include <limits>     // std::numeric_limits
-#include <stdexcept>  // std::invalid_argument
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+#include <chrono>     // std::chrono::steady_clock
 
 #include "SelectionRule.h"
+#include "RestartMethod.h"
+#include "SolverProfiler.h"
+#include "EigsObserver.h"
 #include "LinAlg/UpperHessenbergQR.h"
 #include "LinAlg/DoubleShiftQR.h"
 #include "LinAlg/UpperHessenbergEigen.h"
+#include "LinAlg/RealSchur.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
 #include "MatOp/DenseGenMatProd.h"
 #include "MatOp/DenseGenRealShiftSolve.h"
+#include "MatOp/DenseGenComplexShiftSolve.h"
 
 
 ///
@@ -91,6 +99,9 @@ private:
     typedef arma::Mat<Complex> ComplexMatrix;
     typedef arma::Col<Complex> ComplexVector;
 
+    typedef EigsIteration<Complex, Scalar> IterationInfo;
+    typedef typename EigsObserver<Complex, Scalar>::type Observer;
+
 protected:
     OpType *op;             // object to conduct matrix operation,
                             // e.g. matrix-vector product
@@ -103,25 +114,57 @@ protected:
 
 private:
     const int ncv;          // number of ritz values
+
+protected:
     int nmatop;             // number of matrix operations called
+
+private:
     int niter;              // number of restarting iterations
+    int restart_method;     // restarting method, see RestartMethod.h
+    int nfac_init;          // number of columns of V set up by init()
+    bool warm_start;        // whether init() has put Schur vectors into V,
+                            // so that H has the form of a Krylov-Schur restart
+    CounterRNG rng;         // random vectors of init() and of the restarts
+#ifdef ARPACK_ARMA_PROFILE
+    SolverProfiler prof;    // timing of the phases, see SolverProfiler.h
+#endif
+    Observer observer;      // called after each iteration, see set_observer()
 
+protected:
     Matrix fac_V;           // V matrix in the Arnoldi factorization
+
+private:
     Matrix fac_H;           // H matrix in the Arnoldi factorization
     Vector fac_f;           // residual in the Arnoldi factorization
 
 protected:
     ComplexVector ritz_val; // ritz values
+    ComplexMatrix ritz_vec; // ritz vectors
 
 private:
-    ComplexMatrix ritz_vec; // ritz vectors
     BoolVector ritz_conv;   // indicator of the convergence of ritz values
+    Vector ritz_resid;      // residual estimates of the ritz values,
+                            // computed in num_converged()
 
     const Scalar prec;      // precision parameter used to test convergence
                             // prec = epsilon^(2/3)
                             // epsilon is the machine precision,
                             // e.g. ~= 1e-16 for the "double" type
 
+    // Workspace, sized in init() and reused in the restarting iterations,
+    // so that no memory is allocated in the main loop of compute()
+    Vector ws_w;            // A * v, of length n
+    Vector ws_h;            // projection coefficients, of length ncv
+    Vector ws_panel;        // block_rows x ncv, a panel of V * Q in the restart
+    Matrix ws_Q;            // ncv x ncv, accumulated orthogonal transformations
+    ComplexVector ws_evals; // eigenvalues of H
+    ComplexMatrix ws_evecs; // eigenvectors of H
+    std::vector<int> ws_ind;  // order index of the Ritz values
+    UpperHessenbergQR<Scalar> decomp_qr;
+    DoubleShiftQR<Scalar> decomp_ds;
+    UpperHessenbergEigen<Scalar> decomp_eigen;
+    SortEigenvalue<Complex, SelectionRule> sorting;
+
     // Arnoldi factorization starting from step-k
     inline void factorize_from(int from_k, int to_m, const Vector &fk);
 
@@ -136,6 +179,21 @@ private:
     }
 
     // Implicitly restarted Arnoldi factorization
+    inline void implicit_restart(int k);
+
+    // Whether H is not upper Hessenberg, either because of the Krylov-Schur
+    // restart, or because init() has started from Schur vectors
+    inline bool thick_form() const { return restart_method == THICK_RESTART || warm_start; }
+
+    // Keep k Schur vectors of the m-step factorization, and extend it by one step
+    // Return the number of Schur vectors kept, which is m or more if
+    // nothing has been done
+    inline int schur_restart(int k, int m);
+
+    // Krylov-Schur restarted Arnoldi factorization
+    inline void thick_restart(int k);
+
+    // Restart the Arnoldi factorization, keeping k Ritz values
     inline void restart(int k);
 
     // Calculate the number of converged Ritz values
@@ -177,7 +235,11 @@ public:
         ncv(ncv_ > dim_n ? dim_n : ncv_),
         nmatop(0),
         niter(0),
-        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+        restart_method(IMPLICIT_RESTART),
+        nfac_init(1),
+        warm_start(false),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3)),
+        decomp_ds(ncv)
     {
         if(nev_ < 1 || nev_ > dim_n - 2)
             throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 2, n is the size of matrix");
@@ -186,6 +248,52 @@ public:
             throw std::invalid_argument("ncv must satisfy nev + 2 <= ncv <= n, n is the size of matrix");
     }
 
+    ///
+    /// Setting the restarting method. This function should be called
+    /// before compute().
+    ///
+    /// \param method An enumeration value defined in RestartMethod.h,
+    ///               either `IMPLICIT_RESTART` (the default), or `THICK_RESTART`.
+    ///               The thick (Krylov-Schur) restart reorders the real Schur form
+    ///               of \f$H\f$ so that the wanted Ritz values come first, and keeps
+    ///               the leading Schur vectors. Complex conjugate Ritz pairs are
+    ///               always kept or discarded together.
+    ///
+    inline void set_restart_method(int method)
+    {
+        if(method != IMPLICIT_RESTART && method != THICK_RESTART)
+            throw std::invalid_argument("unknown restarting method");
+
+        restart_method = method;
+    }
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial residual vector in init() and the new residual vectors when
+    /// the factorization breaks down. This function should be called
+    /// before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Setting a function to be called after each iteration of compute(),
+    /// i.e., after the first Arnoldi factorization and after each restart.
+    ///
+    /// \param obs A function object taking a `const EigsIteration<std::complex<Scalar>, Scalar>&`
+    ///            that describes the current state of the solver, and returning
+    ///            `true` to stop the computation, or `false` to continue. An empty
+    ///            function object removes the observer.
+    ///
+    /// When the observer stops the computation, compute() returns the number of
+    /// Ritz values that have converged so far, and eigenvalues() and eigenvectors()
+    /// return them as usual. See SymEigsSolver::set_observer() for an example.
+    ///
+    inline void set_observer(Observer obs) { observer = obs; }
+
     ///
     /// Providing the initial residual vector for the algorithm.
     ///
@@ -202,10 +310,33 @@ public:
     ///
     /// This overloaded function generates a random initial residual vector
     /// for the algorithm. Elements in the vector follow independent Uniform(-0.5, 0.5)
-    /// distributions.
+    /// distributions, drawn from the generator of the solver, see set_seed().
     ///
     inline void init();
 
+    ///
+    /// Providing a block of approximate eigenvectors as the starting point,
+    /// for example the eigenvectors computed for a nearby matrix.
+    ///
+    /// \param init_vecs Pointer to an \f$n\times p\f$ matrix stored in column-major
+    ///                  order, whose columns are the approximate eigenvectors.
+    /// \param nvec      The number of vectors \f$p\f$, which should satisfy \f$1\le p\le ncv\f$.
+    ///
+    /// The vectors are orthonormalized, and a Rayleigh-Ritz projection of \f$A\f$
+    /// onto the subspace they span gives the Ritz vectors that are wanted according
+    /// to the selection rule. A few Arnoldi steps from their sum then give a Krylov
+    /// subspace that contains good approximations of them, and as in a Krylov-Schur
+    /// restart, its wanted Schur vectors are put into the first columns of \f$V\f$,
+    /// with the corresponding block of the Schur form in \f$H\f$. compute() continues
+    /// the factorization from their residual, and the Krylov-Schur restart is then
+    /// used in all the iterations, whatever the restarting method. The Ritz vectors
+    /// of the projection itself are not used directly, since their residuals are not
+    /// parallel in general, which the factorization cannot represent. The projection
+    /// and the Arnoldi steps cost at most \f$p+k+2\f$ matrix operations, where
+    /// \f$k=\min(nev,p)\f$, which are counted in num_operations().
+    ///
+    inline void init(Scalar *init_vecs, int nvec);
+
     ///
     /// Conducting the major computation procedure.
     ///
@@ -226,6 +357,17 @@ public:
     ///
     inline int num_operations() { return nmatop; }
 
+#ifdef ARPACK_ARMA_PROFILE
+    ///
+    /// Returning the profiler that records the time spent in each phase of
+    /// the solver, see SymEigsSolver::profiler().
+    ///
+    /// This function is only available if the macro `ARPACK_ARMA_PROFILE` is
+    /// defined before including the header.
+    ///
+    inline SolverProfiler& profiler() { return prof; }
+#endif
+
     ///
     /// Returning the converged eigenvalues.
     ///
@@ -321,4 +463,149 @@ public:
     }
 };
 
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the eigen solver for general real matrices with
+/// a complex shift value in the **shift-and-invert mode**. The background
+/// knowledge of the shift-and-invert mode can be found in the documentation
+/// of the SymEigsShiftSolver class.
+///
+/// With a complex shift \f$\sigma\f$, the operator \f$(A-\sigma I)^{-1}\f$ is
+/// complex. Following the mode 3 of **ARPACK**, this solver works on its real part
+/// \f[\mathrm{Re}\{(A-\sigma I)^{-1}\}=\frac{1}{2}\left[(A-\sigma I)^{-1}+(A-\bar{\sigma} I)^{-1}\right],\f]
+/// which is a real operator, so that the Arnoldi process stays in real arithmetic.
+/// An eigenvector \f$x\f$ of \f$A\f$ with eigenvalue \f$\lambda\f$ is also an
+/// eigenvector of this operator, with eigenvalue
+/// \f[\nu=\frac{1}{2}\left(\frac{1}{\lambda-\sigma}+\frac{1}{\lambda-\bar{\sigma}}\right),\f]
+/// which is large when \f$\lambda\f$ is close to \f$\sigma\f$ or \f$\bar{\sigma}\f$.
+/// So the selection rule `LARGEST_MAGN` finds the eigenvalues closest to the shift
+/// and to its conjugate, which both belong to the spectrum of the real matrix \f$A\f$.
+///
+/// \f$\lambda\f$ cannot be recovered from \f$\nu\f$ alone, so it is computed as
+/// the Rayleigh quotient \f$\lambda=x^HAx/x^Hx\f$ of the Ritz vector \f$x\f$.
+/// This needs two products with \f$A\f$ for each of the `nev` Ritz pairs at the end
+/// of compute(), which are counted in num_operations() along with the shift-solve
+/// operations.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the shifted-and-inverted eigenvalues.
+///                       The full list of enumeration values can be found in
+///                       SelectionRule.h .
+/// \tparam OpType        The name of the matrix operation class. Users could either
+///                       use the DenseGenComplexShiftSolve wrapper class, or define their
+///                       own that impelemnts all the public member functions as in
+///                       DenseGenComplexShiftSolve.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <GenEigsSolver.h>  // Also includes <MatOp/DenseGenComplexShiftSolve.h>
+///
+/// int main()
+/// {
+///     arma::mat M = arma::randu(100, 100);
+///
+///     DenseGenComplexShiftSolve<double> op(M);
+///
+///     // Find the 4 eigenvalues that are closest to 0.5 +/- 0.5i
+///     GenEigsComplexShiftSolver< double, LARGEST_MAGN,
+///                                DenseGenComplexShiftSolve<double> > eigs(&op, 4, 10, 0.5, 0.5);
+///     eigs.init();
+///     eigs.compute();
+///     arma::cx_vec evalues = eigs.eigenvalues();
+///     evalues.print("Eigenvalues found:");
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template <typename Scalar = double,
+          int SelectionRule = LARGEST_MAGN,
+          typename OpType = DenseGenComplexShiftSolve<double> >
+class GenEigsComplexShiftSolver: public GenEigsSolver<Scalar, SelectionRule, OpType>
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Col<Complex> ComplexVector;
+
+    Scalar sigmar;
+    Scalar sigmai;
+
+    // Workspace of sort_ritzpair(), sized on its first call
+    Vector ws_yr;           // real part of a Ritz vector in the basis V
+    Vector ws_yi;           // imaginary part of a Ritz vector in the basis V
+    Vector ws_xr;           // real part of a Ritz vector, of length n
+    Vector ws_xi;           // imaginary part of a Ritz vector, of length n
+    Vector ws_Axr;          // A * xr
+    Vector ws_Axi;          // A * xi
+
+    // First compute the eigenvalues of A from the Ritz vectors, and then sort
+    void sort_ritzpair()
+    {
+        const int n = this->fac_V.n_rows;
+        const int ncv = this->fac_V.n_cols;
+        ws_yr.set_size(ncv);
+        ws_yi.set_size(ncv);
+        ws_xr.set_size(n);
+        ws_xi.set_size(n);
+        ws_Axr.set_size(n);
+        ws_Axi.set_size(n);
+        Vector &xr = ws_xr, &xi = ws_xi, &Axr = ws_Axr, &Axi = ws_Axi;
+        for(int i = 0; i < this->nev; i++)
+        {
+            // x = V * y, computed in real arithmetic
+            for(int j = 0; j < ncv; j++)
+            {
+                ws_yr[j] = this->ritz_vec(j, i).real();
+                ws_yi[j] = this->ritz_vec(j, i).imag();
+            }
+            xr = this->fac_V * ws_yr;
+            xi = this->fac_V * ws_yi;
+            this->op->mat_prod(xr.memptr(), Axr.memptr());
+            this->op->mat_prod(xi.memptr(), Axi.memptr());
+            this->nmatop += 2;
+
+            // x^H * A * x = xr'Axr + xi'Axi + i * (xr'Axi - xi'Axr)
+            const Scalar xnorm2 = arma::dot(xr, xr) + arma::dot(xi, xi);
+            const Complex xAx(arma::dot(xr, Axr) + arma::dot(xi, Axi),
+                              arma::dot(xr, Axi) - arma::dot(xi, Axr));
+            this->ritz_val[i] = xAx / xnorm2;
+        }
+        GenEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair();
+    }
+public:
+    ///
+    /// Constructor to create a eigen solver object using the shift-and-invert mode.
+    ///
+    /// \param op_     Pointer to the matrix operation object. This class should implement
+    ///                the complex shift-solve operation of \f$A\f$: calculating
+    ///                \f$\mathrm{Re}\{(A-\sigma I)^{-1}y\}\f$ for any vector \f$y\f$,
+    ///                and the product \f$Ay\f$ in a member function `mat_prod()`.
+    ///                Users could either create the object from the DenseGenComplexShiftSolve
+    ///                wrapper class, or define their own that impelemnts all the public
+    ///                member functions as in DenseGenComplexShiftSolve.
+    /// \param nev_    Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-2\f$,
+    ///                where \f$n\f$ is the size of matrix.
+    /// \param ncv_    Parameter that controls the convergence speed of the algorithm.
+    ///                Typically a larger `ncv_` means faster convergence, but it may
+    ///                also result in greater memory use and more matrix operations
+    ///                in each iteration. This parameter must satisfy \f$nev+2 \le ncv \le n\f$,
+    ///                and is advised to take \f$ncv \ge 2\cdot nev + 1\f$.
+    /// \param sigmar_ The real part of the shift.
+    /// \param sigmai_ The imaginary part of the shift.
+    ///
+    GenEigsComplexShiftSolver(OpType *op_, int nev_, int ncv_, Scalar sigmar_, Scalar sigmai_) :
+        GenEigsSolver<Scalar, SelectionRule, OpType>(op_, nev_, ncv_),
+        sigmar(sigmar_), sigmai(sigmai_)
+    {
+        this->op->set_shift(sigmar, sigmai);
+    }
+};
+
 #endif // GEN_EIGS_SOLVER_H
@@ -12,9 +12,12 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
 {
     if(to_m <= from_k) return;
 
+    // The matrix operations inside are timed separately
+    EIGS_PROFILE(PHASE_ORTH);
+
     fac_f = fk;
 
-    Vector w(dim_n);
+    Vector &w = ws_w;
     Scalar beta = std::sqrt(arma::dot(fac_f, fac_f));
     // Keep the upperleft k x k submatrix of H and set other elements to 0
     fac_H.tail_cols(ncv - from_k).zeros();
@@ -27,10 +30,11 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
         // to the current V, which we call a restart
         if(beta < prec)
         {
-            fac_f.randu();
+            rng.uniform(fac_f.memptr(), dim_n);
             // f <- f - V * V' * f, so that f is orthogonal to V
             Matrix Vs(fac_V.memptr(), dim_n, i, false); // First i columns
-            Vector Vf = Vs.t() * fac_f;
+            Vector Vf(ws_h.memptr(), i, false);
+            Vf = Vs.t() * fac_f;
             fac_f -= Vs * Vf;
             // beta <- ||f||
             beta = std::sqrt(arma::dot(fac_f, fac_f));
@@ -48,7 +52,10 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
             fac_H(i, i - 1) = beta;
 
         // w <- A * v, v = fac_V.col(i)
-        op->perform_op(fac_V.colptr(i), w.memptr());
+        {
+            EIGS_PROFILE(PHASE_OP);
+            op->perform_op(fac_V.colptr(i), w.memptr());
+        }
         nmatop++;
 
         // First i+1 columns of V
@@ -59,7 +66,8 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
         h = Vs.t() * w;
 
         // f <- w - V * h
-        fac_f = w - Vs * h;
+        fac_f = w;
+        fac_f -= Vs * h;
         beta = std::sqrt(arma::dot(fac_f, fac_f));
 
         if(beta > 0.717 * std::sqrt(arma::dot(h, h)))
@@ -67,7 +75,8 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
 
         // f/||f|| is going to be the next column of V, so we need to test
         // whether V' * (f/||f||) ~= 0
-        Vector Vf = Vs.t() * fac_f;
+        Vector Vf(ws_h.memptr(), i + 1, false);
+        Vf = Vs.t() * fac_f;
         // If not, iteratively correct the residual
         int count = 0;
         while(count < 5 && arma::abs(Vf).max() > prec * beta)
@@ -89,73 +98,187 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
 template < typename Scalar,
            int SelectionRule,
            typename OpType >
-inline void GenEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+inline void GenEigsSolver<Scalar, SelectionRule, OpType>::implicit_restart(int k)
 {
     if(k >= ncv)
         return;
 
-    DoubleShiftQR<Scalar> decomp_ds(ncv);
-    UpperHessenbergQR<Scalar> decomp;
-    Matrix Q(ncv, ncv, arma::fill::eye);
+    Matrix &Q = ws_Q;
+    Q.eye();
 
-    for(int i = k; i < ncv; i++)
     {
-        if(is_complex(ritz_val[i], prec) && is_conj(ritz_val[i], ritz_val[i + 1], prec))
+        EIGS_PROFILE(PHASE_RESTART_QR);
+        for(int i = k; i < ncv; i++)
         {
-            // H - mu * I = Q1 * R1
-            // H <- R1 * Q1 + mu * I = Q1' * H * Q1
-            // H - conj(mu) * I = Q2 * R2
-            // H <- R2 * Q2 + conj(mu) * I = Q2' * H * Q2
-            //
-            // (H - mu * I) * (H - conj(mu) * I) = Q1 * Q2 * R2 * R1 = Q * R
-            Scalar s = 2 * ritz_val[i].real();
-            Scalar t = std::norm(ritz_val[i]);
-
-            decomp_ds.compute(fac_H, s, t);
-
-            // Q -> Q * Qi
-            decomp_ds.apply_YQ(Q);
-            //decomp_ds.apply_YQ(fac_V, ncv);
-            // H -> Q'HQ
-            // Matrix Q(ncv, ncv, arma::fill::eye);
-            // decomp_ds.apply_YQ(Q);
-            // fac_H = Q.t() * fac_H * Q;
-            fac_H = decomp_ds.matrix_QtHQ();
-
-            i++;
-        } else {
-            // QR decomposition of H - mu * I, mu is real
-            fac_H.diag() -= ritz_val[i].real();
-            decomp.compute(fac_H);
-
-            // Q -> Q * Qi
-            decomp.apply_YQ(Q);
-            // H -> Q'HQ = RQ + mu * I
-            fac_H = decomp.matrix_RQ();
-            fac_H.diag() += ritz_val[i].real();
+            if(is_complex(ritz_val[i], prec) && is_conj(ritz_val[i], ritz_val[i + 1], prec))
+            {
+                // H - mu * I = Q1 * R1
+                // H <- R1 * Q1 + mu * I = Q1' * H * Q1
+                // H - conj(mu) * I = Q2 * R2
+                // H <- R2 * Q2 + conj(mu) * I = Q2' * H * Q2
+                //
+                // (H - mu * I) * (H - conj(mu) * I) = Q1 * Q2 * R2 * R1 = Q * R
+                Scalar s = 2 * ritz_val[i].real();
+                Scalar t = std::norm(ritz_val[i]);
+
+                decomp_ds.compute(fac_H, s, t);
+
+                // Q -> Q * Qi
+                decomp_ds.apply_YQ(Q);
+                //decomp_ds.apply_YQ(fac_V, ncv);
+                // H -> Q'HQ
+                // Matrix Q(ncv, ncv, arma::fill::eye);
+                // decomp_ds.apply_YQ(Q);
+                // fac_H = Q.t() * fac_H * Q;
+                decomp_ds.matrix_QtHQ(fac_H);
+
+                i++;
+            } else {
+                // QR decomposition of H - mu * I, mu is real
+                fac_H.diag() -= ritz_val[i].real();
+                decomp_qr.compute(fac_H);
+
+                // Q -> Q * Qi
+                decomp_qr.apply_YQ(Q);
+                // H -> Q'HQ = RQ + mu * I
+                decomp_qr.matrix_RQ(fac_H);
+                fac_H.diag() += ritz_val[i].real();
+            }
         }
     }
-    // V -> VQ
-    // Q has some elements being zero
-    // The first (ncv - k + i) elements of the i-th column of Q are non-zero
-    Matrix Vs(dim_n, k + 1);
-    int nnz;
-    for(int i = 0; i < k; i++)
+    // V -> VQ, only need to update the first k+1 columns
+    // This is done in place, one panel of rows at a time
+    Matrix Qk(Q.memptr(), ncv, k + 1, false);
+    {
+        EIGS_PROFILE(PHASE_UPDATE_V);
+        BasisProduct<Scalar, Scalar>::mult_inplace(fac_V, ncv, Qk, ws_panel.memptr());
+    }
+
+    // f -> f * Q[ncv, k] + V[, k+1] * H[k+1, k]
+    fac_f *= Q(ncv - 1, k - 1);
+    fac_f += fac_H(k, k - 1) * fac_V.col(k);
+    factorize_from(k, ncv, fac_f);
+    retrieve_ritzpair();
+}
+
+// Keep k Schur vectors of the m-step factorization, and extend it by one step
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int GenEigsSolver<Scalar, SelectionRule, OpType>::schur_restart(int k, int m)
+{
+    // H = U * T * U', T is the real Schur form of H
+    Matrix U, T;
+    {
+        EIGS_PROFILE(PHASE_RESTART_QR);
+        RealSchur<Scalar> schur(fac_H.submat(0, 0, m - 1, m - 1));
+        ComplexVector evals = schur.eigenvalues();
+
+        // Select the k wanted eigenvalues on the diagonal of T
+        sorting.compute(evals.memptr(), evals.n_elem);
+        std::vector<int> ind = sorting.index();
+        std::vector<int> select(m, 0);
+        for(int i = 0; i < k; i++)
+            select[ind[i]] = 1;
+
+        // Move them to the upperleft corner of T
+        // 2x2 blocks are moved as a whole, so k may increase by one
+        // if the selection splits a conjugate pair
+        k = schur.reorder(select);
+        if(k >= m)
+            return k;
+
+        U = schur.matrix_U();
+        T = schur.matrix_T();
+    }
+
+    // V -> V * U1, U1 contains the first k Schur vectors
+    Matrix U1(U.memptr(), m, k, false);
+    {
+        EIGS_PROFILE(PHASE_UPDATE_V);
+        BasisProduct<Scalar, Scalar>::mult_inplace(fac_V, m, U1, ws_panel.memptr());
+    }
+    Matrix Vs(fac_V.memptr(), dim_n, k, false); // First k columns
+
+    // A * V * U1 = V * U1 * T11 + f * e' * U1
+    // So H becomes
+    // [T11  * ]
+    // [b'   * ]
+    // where b = ||f|| * (last row of U1)'
+    Scalar beta = arma::norm(fac_f);
+    fac_H.zeros();
+    fac_H.submat(0, 0, k - 1, k - 1) = T.submat(0, 0, k - 1, k - 1);
+
+    Vector v(fac_V.colptr(k), dim_n, false); // The (k+1)-th column
+    if(beta < prec)
+    {
+        // f is zero, so V * U1 spans an invariant subspace, and b = 0
+        // Generate a new residual vector that is orthogonal to V * U1
+        rng.uniform(v.memptr(), dim_n);
+        Vector Vf(ws_h.memptr(), k, false);
+        Vf = Vs.t() * v;
+        v -= Vs * Vf;
+        v /= arma::norm(v);
+    } else {
+        v = fac_f / beta;
+        for(int i = 0; i < k; i++)
+            fac_H(k, i) = beta * U(m - 1, i);
+    }
+
+    // The (k+1)-th Arnoldi step, with the basis being the k Schur
+    // vectors and v
+    Vector &w = ws_w;
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(v.memptr(), w.memptr());
+    }
+    nmatop++;
+
     {
-        nnz = ncv - k + i + 1;
-        Matrix V(fac_V.memptr(), dim_n, nnz, false);
-        Vector q(Q.colptr(i), nnz, false);
-        Vector v(Vs.colptr(i), dim_n, false);
-        v = V * q;
+        EIGS_PROFILE(PHASE_ORTH);
+        Matrix Vk(fac_V.memptr(), dim_n, k + 1, false); // First k+1 columns
+        Vector h(fac_H.colptr(k), k + 1, false);
+        h = Vk.t() * w;
+        fac_f = w;
+        fac_f -= Vk * h;
+        Vector Vf(ws_h.memptr(), k + 1, false);
+        Vf = Vk.t() * fac_f;
+        fac_f -= Vk * Vf;
+        h += Vf;
     }
-    Vs.col(k) = fac_V * Q.col(k);
-    fac_V.head_cols(k + 1) = Vs;
 
-    Vector fk = fac_f * Q(ncv - 1, k - 1) + fac_V.col(k) * fac_H(k, k - 1);
-    factorize_from(k, ncv, fk);
+    return k;
+}
+
+// Krylov-Schur restarted Arnoldi factorization
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void GenEigsSolver<Scalar, SelectionRule, OpType>::thick_restart(int k)
+{
+    if(k >= ncv)
+        return;
+
+    k = schur_restart(k, ncv);
+    if(k >= ncv)
+        return;
+
+    factorize_from(k + 1, ncv, fac_f);
     retrieve_ritzpair();
 }
 
+// Restart the Arnoldi factorization, keeping k Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void GenEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+{
+    if(thick_form())
+        thick_restart(k);
+    else
+        implicit_restart(k);
+}
+
 // Calculate the number of converged Ritz values
 template < typename Scalar,
            int SelectionRule,
@@ -169,6 +292,7 @@ inline int GenEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar to
         Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
         Scalar resid = std::abs(ritz_vec(ncv - 1, i)) * f_norm;
         ritz_conv[i] = (resid < thresh);
+        ritz_resid[i] = resid;
     }
 
     return std::count(ritz_conv.begin(), ritz_conv.end(), true);
@@ -215,15 +339,25 @@ template < typename Scalar,
            typename OpType >
 inline void GenEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
 {
-    /*ComplexVector evals(ncv);
-    ComplexMatrix evecs(ncv, ncv);
-    arma::eig_gen(evals, evecs, fac_H);*/
-    UpperHessenbergEigen<Scalar> decomp(fac_H);
-    ComplexVector evals = decomp.eigenvalues();
-    ComplexMatrix evecs = decomp.eigenvectors();
-
-    SortEigenvalue<Complex, SelectionRule> sorting(evals.memptr(), evals.n_elem);
-    std::vector<int> ind = sorting.index();
+    ComplexVector &evals = ws_evals;
+    ComplexMatrix &evecs = ws_evecs;
+    {
+        EIGS_PROFILE(PHASE_RITZ_EIGEN);
+        if(thick_form())
+        {
+            // After a Krylov-Schur restart H is no longer upper Hessenberg
+            if(!arma::eig_gen(evals, evecs, fac_H))
+                throw std::logic_error("GenEigsSolver: failed to compute the eigen decomposition of H");
+        } else {
+            decomp_eigen.compute(fac_H);
+            evals = decomp_eigen.eigenvalues();
+            evecs = decomp_eigen.eigenvectors();
+        }
+    }
+
+    sorting.compute(evals.memptr(), evals.n_elem);
+    std::vector<int> &ind = ws_ind;
+    sorting.index(ind);
 
     // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
     for(int i = 0; i < ncv; i++)
@@ -232,7 +366,7 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
     }
     for(int i = 0; i < nev; i++)
     {
-        ritz_vec.col(i) = evecs.col(ind[i]);
+        std::copy(evecs.colptr(ind[i]), evecs.colptr(ind[i]) + ncv, ritz_vec.colptr(i));
     }
 }
 
@@ -279,9 +413,20 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_resi
     ritz_val.zeros(ncv);
     ritz_vec.zeros(ncv, nev);
     ritz_conv.assign(nev, false);
+    ritz_resid.zeros(nev);
+
+    ws_w.set_size(dim_n);
+    ws_h.set_size(ncv);
+    ws_panel.set_size(std::min(dim_n, int(BasisProduct<Scalar, Scalar>::block_rows)) * ncv);
+    ws_Q.set_size(ncv, ncv);
+    ws_evals.set_size(ncv);
+    ws_evecs.set_size(ncv, ncv);
+    ws_ind.reserve(ncv);
 
     nmatop = 0;
     niter = 0;
+    nfac_init = 1;
+    warm_start = false;
 
     Vector r(init_resid, dim_n, false);
     // The first column of fac_V
@@ -291,8 +436,11 @@ inline void GenEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_resi
         throw std::invalid_argument("initial residual vector cannot be zero");
     v = r / rnorm;
 
-    Vector w(dim_n);
-    op->perform_op(v.memptr(), w.memptr());
+    Vector &w = ws_w;
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(v.memptr(), w.memptr());
+    }
     nmatop++;
 
     fac_H(0, 0) = arma::dot(v, w);
@@ -305,25 +453,108 @@ template < typename Scalar,
            typename OpType >
 inline void GenEigsSolver<Scalar, SelectionRule, OpType>::init()
 {
-    Vector init_resid(dim_n, arma::fill::randu);
-    init_resid -= 0.5;
+    Vector init_resid(dim_n);
+    rng.uniform(init_resid.memptr(), dim_n);
     init(init_resid.memptr());
 }
 
+// Initialization from a block of approximate eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void GenEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_vecs, int nvec)
+{
+    if(nvec < 1 || nvec > ncv)
+        throw std::invalid_argument("nvec must satisfy 1 <= nvec <= ncv");
+
+    // Orthonormal basis of the given vectors
+    // If they are linearly dependent, Q still has orthonormal columns,
+    // which only enlarge the subspace of the projection
+    Matrix X(init_vecs, dim_n, nvec, false);
+    Matrix Q, R;
+    if(!arma::qr_econ(Q, R, X))
+        throw std::logic_error("GenEigsSolver: failed to orthonormalize the initial vectors");
+
+    // Rayleigh-Ritz: G = Q' * A * Q
+    Matrix AQ(dim_n, nvec);
+    for(int i = 0; i < nvec; i++)
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(Q.colptr(i), AQ.colptr(i));
+    }
+    Matrix G = Q.t() * AQ;
+
+    ComplexVector evals;
+    ComplexMatrix evecs;
+    if(!arma::eig_gen(evals, evecs, G))
+        throw std::logic_error("GenEigsSolver: failed to compute the Rayleigh-Ritz projection");
+
+    // Sum of the wanted Ritz vectors, in the coordinates of Q
+    // A complex Ritz vector contributes both its real and imaginary parts,
+    // which span the same invariant subspace as the conjugate pair
+    sorting.compute(evals.memptr(), nvec);
+    std::vector<int> ind = sorting.index();
+    const int nwant = std::min(nev, nvec);
+    Vector y(nvec, arma::fill::zeros);
+    for(int i = 0; i < nwant; i++)
+    {
+        y += arma::real(evecs.col(ind[i]));
+        y += arma::imag(evecs.col(ind[i]));
+    }
+
+    Vector init_resid = Q * y;
+    init(init_resid.memptr());
+    nmatop += nvec;
+
+    // The Ritz vectors of the projection cannot be put into V directly,
+    // since their residuals span up to p directions, while the Arnoldi
+    // factorization only keeps one residual vector
+    // Instead, k+1 Arnoldi steps are taken from their sum, whose Krylov
+    // subspace approximates the span of the k wanted ones, and the Schur
+    // vectors of the k wanted Ritz values of this subspace become the first
+    // columns of V, as in a Krylov-Schur restart
+    // One more vector may be kept to complete a conjugate pair, and if all
+    // of them are, the factorization is kept as it is
+    const int k = std::min(nwant, ncv - 2);
+    factorize_from(1, k + 1, fac_f);
+    const int nkeep = schur_restart(k, k + 1);
+    warm_start = (nkeep < k + 1);
+    nfac_init = warm_start ? nkeep + 1 : k + 1;
+}
+
 // Compute Ritz pairs and return the number of converged eigenvalues
 template < typename Scalar,
            int SelectionRule,
            typename OpType >
 inline int GenEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
 {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+
     // The m-step Arnoldi factorization
-    factorize_from(1, ncv, fac_f);
+    factorize_from(nfac_init, ncv, fac_f);
     retrieve_ritzpair();
     // Restarting
     int i, nconv = 0, nev_adj;
     for(i = 0; i < maxit; i++)
     {
         nconv = num_converged(tol);
+
+        // The observer may stop the computation, and the
+        // Ritz pairs of this iteration are kept
+        if(observer)
+        {
+            IterationInfo info;
+            info.iter = i;
+            info.ritz_values = ritz_val.head(nev);
+            info.residuals = ritz_resid;
+            info.nconv = nconv;
+            info.nops = nmatop;
+            info.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if(observer(info))
+                break;
+        }
+
         if(nconv >= nev)
             break;
 
@@ -387,7 +618,10 @@ inline typename GenEigsSolver<Scalar, SelectionRule, OpType>::ComplexMatrix GenE
         }
     }
 
-    res = fac_V * ritz_vec_conv;
+    {
+        EIGS_PROFILE(PHASE_EIGENVECTORS);
+        res = fac_V * ritz_vec_conv;
+    }
 
     return res;
 }
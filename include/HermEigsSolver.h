@@ -0,0 +1,284 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef HERM_EIGS_SOLVER_H
+#define HERM_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <complex>    // std::complex
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "LinAlg/UpperHessenbergQR.h"
+#include "LinAlg/TridiagEigen.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the eigen solver for complex Hermitian matrices.
+///
+/// A Hermitian matrix \f$A=A^H\f$ of size \f$n\f$ could also be solved by
+/// SymEigsSolver, through the real symmetric matrix
+/// \f[\begin{bmatrix}\mathrm{Re}(A) & -\mathrm{Im}(A)\\ \mathrm{Im}(A) & \mathrm{Re}(A)\end{bmatrix}\f]
+/// of size \f$2n\f$, but this doubles the memory and the work of the matrix
+/// operation, and every eigenvalue appears twice in the spectrum, so that
+/// twice as many Lanczos vectors are needed for the same eigenvalues.
+///
+/// Instead, HermEigsSolver runs the Lanczos process in complex arithmetic.
+/// The Krylov basis \f$V\f$ is complex, and since \f$A\f$ is Hermitian, the
+/// projected matrix \f$H=V^HAV\f$ is a real symmetric tridiagonal matrix,
+/// so that the implicit restart and the eigen decomposition of \f$H\f$ are
+/// exactly those of SymEigsSolver. The eigenvalues are real, and the eigenvectors
+/// are complex and orthonormal.
+///
+/// The matrix operation class computes \f$y=Ax\f$ for complex vectors, for example
+/// DenseGenMatProd or SparseGenMatProd instantiated with `std::complex<double>`,
+/// which wrap `arma::cx_mat` and `arma::sp_cx_mat` objects respectively.
+///
+/// The residual vector is fully reorthogonalized in every step.
+///
+/// \tparam Scalar        The element type of the real and imaginary parts of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues, the same as in SymEigsSolver.
+///                       The full list of enumeration values can be found in
+///                       SelectionRule.h .
+/// \tparam OpType        The name of the matrix operation class, whose `perform_op()`
+///                       takes `std::complex<Scalar>` vectors. Users could either
+///                       use the DenseGenMatProd or SparseGenMatProd wrapper classes,
+///                       or define their own that impelemnts all the public member
+///                       functions as in DenseGenMatProd.
+///
+/// Below is an example that demonstrates the usage of this class.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <HermEigsSolver.h>  // Also includes <MatOp/DenseGenMatProd.h>
+///
+/// int main()
+/// {
+///     // We are going to calculate the eigenvalues of a Hermitian matrix M
+///     arma::cx_mat A = arma::randu<arma::cx_mat>(10, 10);
+///     arma::cx_mat M = A + A.t();
+///
+///     // Construct matrix operation object using the wrapper class DenseGenMatProd
+///     DenseGenMatProd< std::complex<double> > op(M);
+///
+///     // Construct eigen solver object, requesting the largest three eigenvalues
+///     HermEigsSolver< double, LARGEST_ALGE, DenseGenMatProd< std::complex<double> > > eigs(&op, 3, 6);
+///
+///     // Initialize and compute
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     // Retrieve results
+///     arma::vec evalues;
+///     arma::cx_mat evecs;
+///     if(nconv > 0)
+///     {
+///         evalues = eigs.eigenvalues();
+///         evecs = eigs.eigenvectors();
+///     }
+///
+///     evalues.print("Eigenvalues found:");
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = LARGEST_MAGN,
+           typename OpType = DenseGenMatProd< std::complex<double> > >
+class HermEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Mat<Complex> ComplexMatrix;
+    typedef arma::Col<Complex> ComplexVector;
+    typedef BasisProduct<Complex, Complex> BasisOp;
+
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-vector product
+    const int dim_n;      // dimension of matrix A
+    const int nev;        // number of eigenvalues requested
+    const int ncv;        // number of ritz values
+    int nmatop;           // number of matrix operations called
+    int niter;            // number of restarting iterations
+    CounterRNG rng;       // random vectors of init() and of the restarts
+
+    ComplexMatrix fac_V;  // V matrix in the Lanczos factorization, complex
+    Matrix fac_H;         // H matrix in the Lanczos factorization, real tridiagonal
+    ComplexVector fac_f;  // residual in the Lanczos factorization
+
+    Vector ritz_val;      // ritz values
+    Matrix ritz_vec;      // ritz vectors, in the coordinates of V, real
+    BoolVector ritz_conv; // indicator of the convergence of ritz values
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // Workspace, sized in init() and reused in the restarting iterations,
+    // so that no memory is allocated in the main loop of compute()
+    ComplexVector ws_v;   // the current basis vector, of length n
+    ComplexVector ws_w;   // A * v, of length n
+    ComplexVector ws_h;   // projection coefficients, of length ncv
+    ComplexVector ws_panel; // block_rows x ncv, a panel of V * Q in the restart
+    Matrix ws_Q;          // ncv x ncv, accumulated orthogonal transformations
+    ComplexMatrix ws_Qc;  // ncv x ncv, complex copy of Q to update V
+    Vector ws_evals;      // eigenvalues of H
+    Matrix ws_evecs;      // eigenvectors of H
+    std::vector<int> ws_ind;       // order index of the Ritz values
+    std::vector<int> ws_ind_copy;  // copy of ws_ind, used by BOTH_ENDS
+    TridiagQR<Scalar> decomp_qr;
+    TridiagEigen<Scalar> decomp_eigen;
+    SortEigenvalue<Scalar, SelectionRule> sorting;
+
+    // Lanczos factorization starting from step-k
+    inline void factorize_from(int from_k, int to_m, const ComplexVector &fk);
+
+    // Implicitly restarted Lanczos factorization
+    inline void restart(int k);
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+    // Return the adjusted nev for restarting
+    inline int nev_adjusted(int nconv);
+
+    // Retrieve and sort ritz values and ritz vectors
+    inline void retrieve_ritzpair();
+
+    // Sort the first nev Ritz pairs in decreasing magnitude order
+    // This is used to return the final results
+    inline void sort_ritzpair();
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_  Pointer to the matrix operation object, which should implement
+    ///             the matrix-vector multiplication operation of \f$A\f$ on complex
+    ///             vectors. Users could either create the object from the
+    ///             DenseGenMatProd or SparseGenMatProd wrapper classes with
+    ///             `std::complex<Scalar>` elements, or define their own that
+    ///             impelemnts all the public member functions as in DenseGenMatProd.
+    /// \param nev_ Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///             where \f$n\f$ is the size of matrix.
+    /// \param ncv_ Parameter that controls the convergence speed of the algorithm.
+    ///             Typically a larger `ncv_` means faster convergence, but it may
+    ///             also result in greater memory use and more matrix operations
+    ///             in each iteration. This parameter must satisfy \f$nev < ncv \le n\f$,
+    ///             and is advised to take \f$ncv \ge 2\cdot nev\f$.
+    ///
+    HermEigsSolver(OpType *op_, int nev_, int ncv_) :
+        op(op_),
+        dim_n(op->rows()),
+        nev(nev_),
+        ncv(ncv_ > dim_n ? dim_n : ncv_),
+        nmatop(0),
+        niter(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(ncv_ <= nev_ || ncv_ > dim_n)
+            throw std::invalid_argument("ncv must satisfy nev < ncv <= n, n is the size of matrix");
+    }
+
+    ///
+    /// Providing the initial residual vector for the algorithm.
+    ///
+    /// \param init_resid Pointer to the initial residual vector, which is complex.
+    ///
+    inline void init(Complex *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial residual vector in init() and the new residual vectors when
+    /// the factorization breaks down. This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial residual vector.
+    ///
+    /// This overloaded function generates a random initial residual vector
+    /// for the algorithm. The real and imaginary parts of the elements follow
+    /// independent Uniform(-0.5, 0.5) distributions, drawn from the generator
+    /// of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues, which are real.
+    ///
+    /// \return A vector containing the eigenvalues.
+    /// Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::cx_mat` or `arma::cx_fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline ComplexMatrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline ComplexMatrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "HermEigsSolver_Impl.h"
+
+
+#endif // HERM_EIGS_SOLVER_H
@@ -0,0 +1,394 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Lanczos factorization starting from step-k
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int from_k, int to_m, const ComplexVector &fk)
+{
+    if(to_m <= from_k) return;
+
+    fac_f = fk;
+
+    ComplexVector &w = ws_w;
+    Scalar beta = arma::norm(fac_f), Hii = 0.0;
+    // Keep the upperleft k x k submatrix of H and set other elements to 0
+    fac_H.tail_cols(ncv - from_k).zeros();
+    fac_H.submat(arma::span(from_k, ncv - 1), arma::span(0, from_k - 1)).zeros();
+    for(int i = from_k; i <= to_m - 1; i++)
+    {
+        bool restart = false;
+        // If beta = 0, then the next V is not full rank
+        // We need to generate a new residual vector that is orthogonal
+        // to the current V, which we call a restart
+        if(beta < prec)
+        {
+            // The real and imaginary parts are stored contiguously
+            rng.uniform(reinterpret_cast<Scalar*>(fac_f.memptr()), 2 * dim_n);
+            // f <- f - V * V^H * f, so that f is orthogonal to V
+            // using the first i columns of V
+            BasisOp::trans_mult(fac_V, i, fac_f.memptr(), ws_h.memptr());
+            BasisOp::mult_sub(fac_V, i, ws_h.memptr(), fac_f.memptr());
+            // beta <- ||f||
+            beta = arma::norm(fac_f);
+
+            restart = true;
+        }
+
+        // v <- f / ||f||, stored as the (i+1)-th column of V
+        ComplexVector &v = ws_v;
+        v = fac_f / beta;
+        BasisOp::set_col(fac_V, i, v.memptr());
+
+        // Note that H[i+1, i] equals to the unrestarted beta
+        if(restart)
+            fac_H(i, i - 1) = 0.0;
+        else
+            fac_H(i, i - 1) = beta;
+
+        // w <- A * v, v = fac_V.col(i)
+        op->perform_op(v.memptr(), w.memptr());
+        nmatop++;
+
+        // v^H * A * v is real since A is Hermitian, and the imaginary
+        // part is only rounding error
+        Hii = std::real(arma::cdot(v, w));
+        fac_H(i - 1, i) = fac_H(i, i - 1); // Due to symmetry
+        fac_H(i, i) = Hii;
+
+        // f <- w - V * V^H * w = w - H[i+1, i] * V{i} - H[i+1, i+1] * V{i+1}
+        // If restarting, we know that H[i+1, i] = 0
+        fac_f = w - Hii * v;
+        if(!restart)
+            BasisOp::axpy(Complex(-fac_H(i, i - 1)), fac_V, i - 1, fac_f.memptr());
+
+        beta = arma::norm(fac_f);
+
+        // f/||f|| is going to be the next column of V, so we need to test
+        // whether V^H * (f/||f||) ~= 0, using the first i+1 columns of V
+        ComplexVector Vf(ws_h.memptr(), i + 1, false);
+        BasisOp::trans_mult(fac_V, i + 1, fac_f.memptr(), Vf.memptr());
+        // If not, iteratively correct the residual
+        int count = 0;
+        while(count < 5 && arma::abs(Vf).max() > prec * beta)
+        {
+            // f <- f - V * Vf
+            BasisOp::mult_sub(fac_V, i + 1, Vf.memptr(), fac_f.memptr());
+            // h <- h + Vf
+            // The corrections are of the order of the rounding error,
+            // so their imaginary parts are dropped to keep H real
+            fac_H(i - 1, i) += std::real(Vf[i - 1]);
+            fac_H(i, i - 1) = fac_H(i - 1, i);
+            fac_H(i, i) += std::real(Vf[i]);
+            // beta <- ||f||
+            beta = arma::norm(fac_f);
+
+            BasisOp::trans_mult(fac_V, i + 1, fac_f.memptr(), Vf.memptr());
+            count++;
+        }
+    }
+}
+
+// Implicitly restarted Lanczos factorization
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+{
+    if(k >= ncv)
+        return;
+
+    // H is real, so the shifts and the orthogonal transformations are
+    // the same as in SymEigsSolver
+    Matrix &Q = ws_Q;
+    Q.eye();
+
+    for(int i = k; i < ncv; i++)
+    {
+        // QR decomposition of H-mu*I, mu is the shift
+        fac_H.diag() -= ritz_val[i];
+        decomp_qr.compute(fac_H);
+
+        // Q -> Q * Qi
+        decomp_qr.apply_YQ(Q);
+
+        // H -> Q'HQ
+        // Since QR = H - mu * I, we have H = QR + mu * I
+        // and therefore Q'HQ = RQ + mu * I
+        decomp_qr.matrix_RQ(fac_H);
+        fac_H.diag() += ritz_val[i];
+    }
+
+    // V -> VQ, only need to update the first k+1 columns
+    // This is done in place, one panel of rows at a time
+    ComplexMatrix Qk(ws_Qc.memptr(), ncv, k + 1, false);
+    Qk.set_real(Q.head_cols(k + 1));
+    Qk.set_imag(Matrix(ncv, k + 1, arma::fill::zeros));
+    BasisOp::mult_inplace(fac_V, ncv, Qk, ws_panel.memptr());
+
+    // f -> f * Q[ncv, k] + V[, k+1] * H[k+1, k]
+    fac_f *= Q(ncv - 1, k - 1);
+    BasisOp::axpy(Complex(fac_H(k, k - 1)), fac_V, k, fac_f.memptr());
+    factorize_from(k, ncv, fac_f);
+    retrieve_ritzpair();
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int HermEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar tol)
+{
+    // thresh = tol * max(prec, abs(theta)), theta for ritz value
+    const Scalar f_norm = arma::norm(fac_f);
+    for(int i = 0; i < nev; i++)
+    {
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        Scalar resid = std::abs(ritz_vec(ncv - 1, i)) * f_norm;
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.end(), true);
+}
+
+// Return the adjusted nev for restarting
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int HermEigsSolver<Scalar, SelectionRule, OpType>::nev_adjusted(int nconv)
+{
+    int nev_new = nev;
+
+    // Adjust nev_new, according to dsaup2.f line 677~684 in ARPACK
+    nev_new = nev + std::min(nconv, (ncv - nev) / 2);
+    if(nev == 1 && ncv >= 6)
+        nev_new = ncv / 2;
+    else if(nev == 1 && ncv > 2)
+        nev_new = 2;
+
+    return nev_new;
+}
+
+// Retrieve and sort ritz values and ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
+{
+    decomp_eigen.compute(fac_H);
+    Vector &evals = ws_evals;
+    Matrix &evecs = ws_evecs;
+    evals = decomp_eigen.eigenvalues();
+    evecs = decomp_eigen.eigenvectors();
+
+    sorting.compute(evals.memptr(), ncv);
+    std::vector<int> &ind = ws_ind;
+    sorting.index(ind);
+
+    // For BOTH_ENDS, the eigenvalues are sorted according
+    // to the LARGEST_ALGE rule, so we need to move those smallest
+    // values to the left
+    // The order would be
+    // Largest => Smallest => 2nd largest => 2nd smallest => ...
+    // We keep this order since the first k values will always be
+    // the wanted collection, no matter k is nev_updated (used in restart())
+    // or is nev (used in sort_ritzpair())
+    if(SelectionRule == BOTH_ENDS)
+    {
+        std::vector<int> &ind_copy = ws_ind_copy;
+        ind_copy = ind;
+        for(int i = 0; i < ncv; i++)
+        {
+            // If i is even, pick values from the left (large values)
+            // If i is odd, pick values from the right (small values)
+            if(i % 2 == 0)
+                ind[i] = ind_copy[i / 2];
+            else
+                ind[i] = ind_copy[ncv - 1 - i / 2];
+        }
+    }
+
+    // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
+    for(int i = 0; i < ncv; i++)
+    {
+        ritz_val[i] = evals[ind[i]];
+    }
+    for(int i = 0; i < nev; i++)
+    {
+        ritz_vec.col(i) = evecs.col(ind[i]);
+    }
+}
+
+// Sort the first nev Ritz pairs in decreasing magnitude order
+// This is used to return the final results
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair()
+{
+    SortEigenvalue<Scalar, LARGEST_MAGN> sorting(ritz_val.memptr(), nev);
+    std::vector<int> ind = sorting.index();
+
+    Vector new_ritz_val(ncv);
+    Matrix new_ritz_vec(ncv, nev);
+    BoolVector new_ritz_conv(nev);
+
+    for(int i = 0; i < nev; i++)
+    {
+        new_ritz_val[i] = ritz_val[ind[i]];
+        new_ritz_vec.col(i) = ritz_vec.col(ind[i]);
+        new_ritz_conv[i] = ritz_conv[ind[i]];
+    }
+
+    ritz_val.swap(new_ritz_val);
+    ritz_vec.swap(new_ritz_vec);
+    ritz_conv.swap(new_ritz_conv);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::init(Complex *init_resid)
+{
+    // Reset all matrices/vectors to zero
+    fac_V.zeros(dim_n, ncv);
+    fac_H.zeros(ncv, ncv);
+    fac_f.zeros(dim_n);
+    ritz_val.zeros(ncv);
+    ritz_vec.zeros(ncv, nev);
+    ritz_conv.assign(nev, false);
+
+    ws_v.set_size(dim_n);
+    ws_w.set_size(dim_n);
+    ws_h.set_size(ncv);
+    ws_panel.set_size(std::min(dim_n, int(BasisOp::block_rows)) * ncv);
+    ws_Q.set_size(ncv, ncv);
+    ws_Qc.set_size(ncv, ncv);
+    ws_evals.set_size(ncv);
+    ws_evecs.set_size(ncv, ncv);
+    ws_ind.reserve(ncv);
+    ws_ind_copy.reserve(ncv);
+
+    nmatop = 0;
+    niter = 0;
+
+    ComplexVector r(init_resid, dim_n, false);
+    // The first column of fac_V
+    ComplexVector &v = ws_v;
+    Scalar rnorm = arma::norm(r);
+    if(rnorm < prec)
+        throw std::invalid_argument("initial residual vector cannot be zero");
+    v = r / rnorm;
+    BasisOp::set_col(fac_V, 0, v.memptr());
+
+    ComplexVector &w = ws_w;
+    op->perform_op(v.memptr(), w.memptr());
+    nmatop++;
+
+    fac_H(0, 0) = std::real(arma::cdot(v, w));
+    fac_f = w - v * fac_H(0, 0);
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline void HermEigsSolver<Scalar, SelectionRule, OpType>::init()
+{
+    ComplexVector init_resid(dim_n);
+    rng.uniform(reinterpret_cast<Scalar*>(init_resid.memptr()), 2 * dim_n);
+    init(init_resid.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline int HermEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+{
+    // The m-step Lanczos factorization
+    factorize_from(1, ncv, fac_f);
+    retrieve_ritzpair();
+    // Restarting
+    int i, nconv = 0, nev_adj;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nev)
+            break;
+
+        nev_adj = nev_adjusted(nconv);
+        restart(nev_adj);
+    }
+    // Sorting results
+    sort_ritzpair();
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename HermEigsSolver<Scalar, SelectionRule, OpType>::Vector HermEigsSolver<Scalar, SelectionRule, OpType>::eigenvalues()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType >
+inline typename HermEigsSolver<Scalar, SelectionRule, OpType>::ComplexMatrix HermEigsSolver<Scalar, SelectionRule, OpType>::eigenvectors(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    ComplexMatrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    // The Ritz vectors are real in the coordinates of V
+    Matrix ritz_vec_real(ncv, nvec);
+    int j = 0;
+    for(int i = 0; i < nev && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_vec_real.col(j) = ritz_vec.col(i);
+            j++;
+        }
+    }
+    ComplexMatrix ritz_vec_conv(ncv, nvec);
+    ritz_vec_conv.set_real(ritz_vec_real);
+    ritz_vec_conv.set_imag(Matrix(ncv, nvec, arma::fill::zeros));
+
+    BasisOp::mult(fac_V, ncv, ritz_vec_conv, res);
+
+    return res;
+}
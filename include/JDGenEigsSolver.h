@@ -0,0 +1,294 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef JD_GEN_EIGS_SOLVER_H
+#define JD_GEN_EIGS_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <complex>    // std::complex
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+#include "MatOp/IdentityPrecond.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the Jacobi-Davidson method for general real matrices,
+/// in the JDQR form. It is mainly intended for interior eigenvalues, those closest
+/// to a (possibly complex) target \f$\tau\f$, without factorizing \f$A-\tau I\f$
+/// as GenEigsRealShiftSolver does.
+///
+/// The search space \f$V\f$ and the converged Schur vectors \f$Q\f$ are complex.
+/// In each iteration, the Ritz pair \f$(\theta,u)\f$ from \f$V\f$ that best matches the
+/// selection rule is taken, and \f$V\f$ is expanded by an approximate solution
+/// \f$t\perp[Q,u]\f$ of the correction equation
+/// \f[(I-\tilde{U}\tilde{U}^*)(A-\sigma I)(I-\tilde{U}\tilde{U}^*)t=-r,\quad\tilde{U}=[Q,u],\f]
+/// where \f$\sigma\f$ is the target while the residual is large, and \f$\theta\f$
+/// afterwards. For `TARGET_CLOSEST`, \f$u\f$ is a harmonic Ritz vector with respect
+/// to \f$\tau\f$, and \f$\theta=u^*Au\f$, since the ordinary Ritz values are poor
+/// approximations of interior eigenvalues. The correction equation is solved by a
+/// few steps of GMRES, so the method only needs matrix-vector products. If the
+/// target is surrounded by the spectrum, GMRES hardly converges without a
+/// preconditioner. Converged Ritz vectors extend the partial Schur form
+/// \f$AQ=QR\f$, from which the eigenvectors are computed.
+///
+/// The matrix is real, so it is applied to the real and imaginary parts of a complex
+/// vector at once, through the block operation `perform_op(const Scalar *x_in,
+/// Scalar *y_out, int ncols)` with two columns, as in BlockGenEigsSolver. The same
+/// holds for the preconditioner, which approximates \f$(A-\tau I)^{-1}\f$ and is
+/// applied as a right preconditioner of GMRES, projected against \f$\tilde{U}\f$.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues, typically `TARGET_CLOSEST`.
+///                       Other rules for general solvers are also accepted.
+/// \tparam OpType        The name of the matrix operation class, for example
+///                       DenseGenMatProd or SparseGenMatProd.
+/// \tparam PrecondType   The name of the preconditioner class. The default
+///                       IdentityPrecond means no preconditioning.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <JDGenEigsSolver.h>
+///
+/// int main()
+/// {
+///     arma::sp_mat M = arma::sprandu(10000, 10000, 0.001);
+///
+///     SparseGenMatProd<double> op(M);
+///
+///     // The 5 eigenvalues closest to 0.5 + 0.5i, with a search space of dimension 20
+///     JDGenEigsSolver< double, TARGET_CLOSEST, SparseGenMatProd<double> >
+///         eigs(&op, 5, 20, std::complex<double>(0.5, 0.5));
+///
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     arma::cx_vec evalues;
+///     if(nconv > 0)
+///         evalues = eigs.eigenvalues();
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = TARGET_CLOSEST,
+           typename OpType = DenseGenMatProd<double>,
+           typename PrecondType = IdentityPrecond<Scalar> >
+class JDGenEigsSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Mat<Complex> ComplexMatrix;
+    typedef arma::Col<Complex> ComplexVector;
+    typedef BasisProduct<Complex, Complex> BasisOp;
+
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-matrix product
+    PrecondType *precond; // object to apply the preconditioner, or NULL
+    const int dim_n;      // dimension of matrix A
+    const int nev;        // number of eigenvalues requested
+    const int ncv;        // maximum dimension of the search space
+    const Complex target; // target of TARGET_CLOSEST
+    int ninner;           // maximum number of GMRES steps
+    int nmatop;           // number of matrix operations called,
+                          // counted as real matrix-vector products
+    int niter;            // number of outer iterations
+    CounterRNG rng;       // random vectors of init() and of the breakdowns
+    int nconv;            // number of converged eigenpairs
+    int ncv_act;          // current dimension of the search space
+
+    ComplexMatrix fac_Q;  // Schur vectors of the converged eigenvalues, n x nev
+    ComplexMatrix fac_R;  // upper triangular, A * Q = Q * R
+    ComplexMatrix fac_V;  // search space, n x ncv, orthogonal to Q
+    ComplexMatrix fac_AV; // A * V
+    ComplexMatrix fac_H;  // V^* * A * V
+    ComplexVector fac_t;  // the next vector to expand the search space
+    ComplexVector ws_panel; // block_rows x ncv, used to rotate V and AV in place
+    Matrix ws_in;         // n x 2, real and imaginary parts of the input
+    Matrix ws_out;        // n x 2, real and imaginary parts of the output
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    SortEigenvalue<Complex, SelectionRule> sorting;
+
+    // Sort the Ritz values according to the selection rule
+    inline void sort_values(const ComplexVector &evals, std::vector<int> &ind);
+
+    // Ritz pairs of the search space, sorted according to the selection rule,
+    // harmonic ones for TARGET_CLOSEST
+    inline void ritz_pairs(ComplexVector &evals, ComplexMatrix &evecs, std::vector<int> &ind);
+
+    // y <- A * x
+    inline void apply_op(const ComplexVector &x, ComplexVector &y);
+
+    // y <- T * x, where T is the preconditioner
+    inline void apply_precond(const ComplexVector &x, ComplexVector &y);
+
+    // x <- (I - [Q u] * [Q u]^*) * x
+    inline void project(const ComplexVector &u, ComplexVector &x);
+
+    // Orthonormalize t against Q and V, and append it to V
+    inline void expand(ComplexVector &t);
+
+    // V <- V * Z, AV <- AV * Z, and H <- Z^* * H * Z, where Z has orthonormal columns
+    inline void compress(const ComplexMatrix &Z);
+
+    // Approximately solve the correction equation by GMRES
+    inline void solve_correction(const ComplexVector &u, const ComplexVector &r, Complex sigma, Scalar rtol, ComplexVector &t);
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_      Pointer to the matrix operation object. Users could either
+    ///                 create the object from the DenseGenMatProd or SparseGenMatProd
+    ///                 wrapper classes, or define their own that impelemnts all the
+    ///                 public member functions as in DenseGenMatProd.
+    /// \param nev_     Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///                 where \f$n\f$ is the size of matrix.
+    /// \param ncv_     Maximum dimension of the search space. This parameter must satisfy
+    ///                 \f$2\le ncv \le n-nev\f$. When it is reached, the search space is
+    ///                 restarted with the `ncv / 2` best Ritz vectors.
+    /// \param target_  The target \f$\tau\f$ of the `TARGET_CLOSEST` rule.
+    /// \param precond_ Pointer to the preconditioner object, or `NULL` for no preconditioning.
+    ///
+    JDGenEigsSolver(OpType *op_, int nev_, int ncv_, Complex target_ = Complex(0), PrecondType *precond_ = NULL) :
+        op(op_),
+        precond(precond_),
+        dim_n(op->rows()),
+        nev(nev_),
+        ncv(ncv_),
+        target(target_),
+        ninner(10),
+        nmatop(0),
+        niter(0),
+        nconv(0),
+        ncv_act(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(ncv_ < 2 || ncv_ > dim_n - nev_)
+            throw std::invalid_argument("ncv must satisfy 2 <= ncv <= n - nev, n is the size of matrix");
+
+        if(precond_ != NULL && precond_->rows() != dim_n)
+            throw std::invalid_argument("JDGenEigsSolver: preconditioner must have the same size as the matrix");
+    }
+
+    ///
+    /// Setting the maximum number of GMRES steps used to solve each
+    /// correction equation. More steps give better corrections and fewer
+    /// outer iterations, but each step costs one complex matrix operation.
+    ///
+    inline void set_inner_steps(int steps)
+    {
+        if(steps < 1)
+            throw std::invalid_argument("the number of inner steps must be positive");
+
+        ninner = steps;
+    }
+
+    ///
+    /// Providing the initial vector of the search space.
+    ///
+    /// \param init_resid Pointer to the initial vector, which is real.
+    ///
+    inline void init(Scalar *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial vector in init() and the new search directions when the
+    /// correction is in the search space. This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial vector.
+    ///
+    /// This overloaded function generates a random initial vector
+    /// for the algorithm. Elements in the vector follow independent Uniform(-0.5, 0.5)
+    /// distribution, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of outer iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of outer iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counted as real matrix-vector products, and including those
+    /// in the inner GMRES steps.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues, sorted by the selection rule,
+    /// e.g. from the closest to the target for `TARGET_CLOSEST`.
+    ///
+    /// \return A complex-valued vector containing the eigenvalues.
+    /// Returned vector type will be `arma::cx_vec` or `arma::cx_fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline ComplexVector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A complex-valued matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::cx_mat` or `arma::cx_fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline ComplexMatrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline ComplexMatrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "JDGenEigsSolver_Impl.h"
+
+
+#endif // JD_GEN_EIGS_SOLVER_H
@@ -0,0 +1,512 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Sort the Ritz values according to the selection rule
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::sort_values(const ComplexVector &evals, std::vector<int> &ind)
+{
+    if(SelectionRule == TARGET_CLOSEST)
+        sorting.compute(evals.memptr(), evals.n_elem, target);
+    else
+        sorting.compute(evals.memptr(), evals.n_elem);
+
+    sorting.index(ind);
+}
+
+// Ritz pairs of the search space, sorted according to the selection rule
+// For TARGET_CLOSEST, harmonic Ritz pairs are used: the Ritz values of
+// an interior target are poor, and move around from one iteration to
+// the next, while the harmonic ones approach the eigenvalues closest to the
+// target monotonically
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::ritz_pairs(ComplexVector &evals, ComplexMatrix &evecs, std::vector<int> &ind)
+{
+    const int m = ncv_act;
+    if(SelectionRule != TARGET_CLOSEST)
+    {
+        ComplexMatrix Hm = fac_H.submat(0, 0, m - 1, m - 1);
+        if(!arma::eig_gen(evals, evecs, Hm))
+            throw std::logic_error("JDGenEigsSolver: failed to compute the eigen decomposition of H");
+        sort_values(evals, ind);
+        return;
+    }
+
+    // With W = (I - Q * Q^*) * (A - target * I) * V, the deflated operator
+    // applied to V, the harmonic Ritz values target + nu satisfy
+    // W^* * W * s = nu * W^* * V * s. Since W^* * W is positive definite,
+    // mu = 1 / nu is computed from W^* * V * s = mu * W^* * W * s
+    ComplexMatrix Vs(fac_V.memptr(), dim_n, m, false);
+    ComplexMatrix AVs(fac_AV.memptr(), dim_n, m, false);
+    ComplexMatrix W = AVs - target * Vs;
+    if(nconv > 0)
+    {
+        ComplexMatrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+        W -= Qc * (Qc.t() * W);
+    }
+    ComplexMatrix WW = W.t() * W;
+    ComplexMatrix K;
+    if(!arma::solve(K, WW, ComplexMatrix(W.t() * Vs)))
+        throw std::logic_error("JDGenEigsSolver: failed to compute the harmonic Ritz values");
+    if(!arma::eig_gen(evals, evecs, K))
+        throw std::logic_error("JDGenEigsSolver: failed to compute the harmonic Ritz values");
+
+    const Scalar big = std::numeric_limits<Scalar>::max();
+    for(int i = 0; i < m; i++)
+        evals[i] = (evals[i] == Complex(0)) ? Complex(big) : target + Scalar(1) / evals[i];
+    sort_values(evals, ind);
+}
+
+// y <- A * x
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::apply_op(const ComplexVector &x, ComplexVector &y)
+{
+    // The real and imaginary parts are multiplied at once
+    ws_in.col(0) = arma::real(x);
+    ws_in.col(1) = arma::imag(x);
+    op->perform_op(ws_in.memptr(), ws_out.memptr(), 2);
+    nmatop += 2;
+
+    y.set_size(dim_n);
+    y.set_real(ws_out.col(0));
+    y.set_imag(ws_out.col(1));
+}
+
+// y <- T * x, where T is the preconditioner
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::apply_precond(const ComplexVector &x, ComplexVector &y)
+{
+    if(precond == NULL)
+    {
+        y = x;
+        return;
+    }
+
+    ws_in.col(0) = arma::real(x);
+    ws_in.col(1) = arma::imag(x);
+    precond->perform_op(ws_in.memptr(), ws_out.memptr(), 2);
+
+    y.set_size(dim_n);
+    y.set_real(ws_out.col(0));
+    y.set_imag(ws_out.col(1));
+}
+
+// x <- (I - [Q u] * [Q u]^*) * x
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::project(const ComplexVector &u, ComplexVector &x)
+{
+    if(nconv > 0)
+    {
+        ComplexMatrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+        x -= Qc * (Qc.t() * x);
+    }
+    x -= arma::cdot(u, x) * u;
+}
+
+// Orthonormalize t against Q and V, and append it to V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::expand(ComplexVector &t)
+{
+    const int m = ncv_act;
+    for(;;)
+    {
+        const Scalar t_norm = arma::norm(t);
+
+        // Classical Gram-Schmidt is applied twice to maintain orthogonality
+        for(int pass = 0; pass < 2; pass++)
+        {
+            if(nconv > 0)
+            {
+                ComplexMatrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+                t -= Qc * (Qc.t() * t);
+            }
+            if(m > 0)
+            {
+                ComplexMatrix Vs(fac_V.memptr(), dim_n, m, false);
+                t -= Vs * (Vs.t() * t);
+            }
+        }
+
+        const Scalar t_orth = arma::norm(t);
+        if(t_orth > prec * t_norm && t_orth > Scalar(0))
+        {
+            t /= t_orth;
+            break;
+        }
+
+        // t is (nearly) in the span of Q and V, so a random
+        // vector is used instead
+        Vector rand_t(dim_n);
+        rng.uniform(rand_t.memptr(), dim_n);
+        t = arma::conv_to<ComplexVector>::from(rand_t);
+    }
+
+    fac_V.col(m) = t;
+    ComplexVector At;
+    apply_op(t, At);
+    fac_AV.col(m) = At;
+
+    // The new column and row of H = V^* * A * V
+    ComplexMatrix Vs(fac_V.memptr(), dim_n, m + 1, false);
+    ComplexMatrix AVs(fac_AV.memptr(), dim_n, m + 1, false);
+    fac_H(arma::span(0, m), m) = Vs.t() * At;
+    fac_H(m, arma::span(0, m)) = t.t() * AVs;
+
+    ncv_act = m + 1;
+}
+
+// V <- V * Z, AV <- AV * Z, and H <- Z^* * H * Z, where Z has orthonormal columns
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::compress(const ComplexMatrix &Z)
+{
+    const int m = ncv_act;
+    const int k = Z.n_cols;
+
+    ComplexMatrix Hm = fac_H.submat(0, 0, m - 1, m - 1);
+    BasisOp::mult_inplace(fac_V, m, Z, ws_panel.memptr());
+    BasisOp::mult_inplace(fac_AV, m, Z, ws_panel.memptr());
+    fac_H.zeros();
+    fac_H.submat(0, 0, k - 1, k - 1) = Z.t() * Hm * Z;
+
+    ncv_act = k;
+}
+
+// Approximately solve the correction equation by GMRES
+// The preconditioner is applied from the right, in the projected form
+// (I - Y * (U^* * Y)^{-1} * U^*) * T, where U = [Q u] and Y = T * U, so that
+// the preconditioned vectors stay orthogonal to U. Without a preconditioner,
+// it reduces to the projection I - U * U^*
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::solve_correction(const ComplexVector &u, const ComplexVector &r, Complex sigma, Scalar rtol, ComplexVector &t)
+{
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+
+    ComplexMatrix U(dim_n, nconv + 1);
+    if(nconv > 0)
+        U.head_cols(nconv) = fac_Q.head_cols(nconv);
+    U.col(nconv) = u;
+
+    ComplexMatrix Y(dim_n, nconv + 1);
+    ComplexVector x, y;
+    for(int j = 0; j <= nconv; j++)
+    {
+        x = U.col(j);
+        apply_precond(x, y);
+        Y.col(j) = y;
+    }
+    const ComplexMatrix M = U.t() * Y;
+
+    // Solve B * t = -r, starting from t = 0, where B = P * (A - sigma * I) * P
+    ComplexVector b = -r;
+    project(u, b);
+    const Scalar beta = arma::norm(b);
+    if(beta == Scalar(0))
+    {
+        t = b;
+        return;
+    }
+
+    ComplexMatrix W(dim_n, ninner + 1);
+    ComplexMatrix G(ninner + 1, ninner, arma::fill::zeros);
+    W.col(0) = b / beta;
+
+    ComplexVector v, z, w, coef;
+    int k = 0;
+    while(k < ninner)
+    {
+        // z = projected preconditioner applied to the k-th basis vector
+        v = W.col(k);
+        apply_precond(v, z);
+        z -= Y * arma::solve(M, U.t() * z);
+
+        // w = B * z, where z is already orthogonal to U
+        apply_op(z, w);
+        w -= sigma * z;
+        w -= U * (U.t() * w);
+
+        // Arnoldi step, with classical Gram-Schmidt applied twice
+        for(int pass = 0; pass < 2; pass++)
+        {
+            ComplexMatrix Wk(W.memptr(), dim_n, k + 1, false);
+            ComplexVector h = Wk.t() * w;
+            w -= Wk * h;
+            G(arma::span(0, k), k) += h;
+        }
+        const Scalar w_norm = arma::norm(w);
+        G(k + 1, k) = w_norm;
+        k++;
+
+        // Least squares problem min ||beta * e1 - G * coef||
+        ComplexVector e1(k + 1, arma::fill::zeros);
+        e1[0] = beta;
+        ComplexMatrix Gk = G.submat(0, 0, k, k - 1);
+        if(!arma::solve(coef, Gk, e1))
+            throw std::logic_error("JDGenEigsSolver: failed to solve the least squares problem in GMRES");
+        const Scalar res = arma::norm(e1 - Gk * coef);
+
+        if(w_norm <= eps * beta || res < rtol * beta)
+            break;
+
+        W.col(k) = w / w_norm;
+    }
+
+    // t = projected preconditioner applied to W * coef
+    ComplexMatrix Wk(W.memptr(), dim_n, k, false);
+    x = Wk * coef;
+    apply_precond(x, t);
+    t -= Y * arma::solve(M, U.t() * t);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::init(Scalar *init_resid)
+{
+    Vector v(init_resid, dim_n);
+    if(arma::norm(v) < prec)
+        throw std::invalid_argument("initial residual vector cannot be zero");
+    fac_t = arma::conv_to<ComplexVector>::from(v);
+
+    fac_Q.zeros(dim_n, nev);
+    fac_R.zeros(nev, nev);
+    fac_V.zeros(dim_n, ncv);
+    fac_AV.zeros(dim_n, ncv);
+    fac_H.zeros(ncv, ncv);
+    ws_panel.zeros(std::min(dim_n, int(BasisOp::block_rows)) * ncv);
+    ws_in.zeros(dim_n, 2);
+    ws_out.zeros(dim_n, 2);
+
+    nmatop = 0;
+    niter = 0;
+    nconv = 0;
+    ncv_act = 0;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::init()
+{
+    Vector init_resid(dim_n);
+    rng.uniform(init_resid.memptr(), dim_n);
+    init(init_resid.memptr());
+}
+
+// Compute the eigenpairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline int JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::compute(int maxit, Scalar tol)
+{
+    std::vector<int> ind;
+    ComplexVector evals, s, u, Au, r, t = fac_t;
+    ComplexMatrix evecs;
+    Complex theta = 0;
+    Scalar r_norm = 0;
+    // Tolerance of the correction equation, relative to the residual,
+    // which is halved in each iteration on the same eigenpair
+    Scalar rtol = 1;
+
+    int i;
+    for(i = 0; i < maxit; i++)
+    {
+        expand(t);
+
+        // Ritz pairs of the search space
+        ritz_pairs(evals, evecs, ind);
+
+        // Lock the wanted Ritz pairs as long as they converge
+        for(;;)
+        {
+            const int m = ncv_act;
+            ComplexMatrix Vs(fac_V.memptr(), dim_n, m, false);
+            ComplexMatrix AVs(fac_AV.memptr(), dim_n, m, false);
+            s = evecs.col(ind[0]);
+            s /= arma::norm(s);
+            u = Vs * s;
+            Au = AVs * s;
+            // The Rayleigh quotient, which is also the Ritz value
+            // if the pair is not a harmonic one
+            theta = arma::cdot(u, Au);
+            r = Au - theta * u;
+            project(u, r);
+            r_norm = arma::norm(r);
+
+            if(r_norm >= tol * std::max(prec, std::abs(theta)))
+                break;
+
+            // Extend the partial Schur form, A * [Q u] = [Q u] * [R q; 0 theta]
+            if(nconv > 0)
+            {
+                ComplexMatrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+                fac_R(arma::span(0, nconv - 1), nconv) = Qc.t() * Au;
+            }
+            fac_R(nconv, nconv) = theta;
+            fac_Q.col(nconv) = u;
+            nconv++;
+            rtol = 1;
+
+            if(nconv >= nev)
+                break;
+
+            // The search space loses u, and keeps its orthogonal complement,
+            // whose leading directions are the next Ritz vectors
+            if(m == 1)
+            {
+                ncv_act = 0;
+                break;
+            }
+            ComplexMatrix S(m, m);
+            S.col(0) = s;
+            for(int j = 1; j < m; j++)
+                S.col(j) = evecs.col(ind[j]);
+            ComplexMatrix Z, Rz;
+            if(!arma::qr(Z, Rz, S))
+                throw std::logic_error("JDGenEigsSolver: failed to compute the QR decomposition of the Ritz vectors");
+            compress(Z.cols(1, m - 1));
+            ritz_pairs(evals, evecs, ind);
+        }
+
+        if(nconv >= nev)
+            break;
+
+        // The search space is empty after locking
+        if(ncv_act == 0)
+        {
+            Vector rand_t(dim_n);
+            rng.uniform(rand_t.memptr(), dim_n);
+            t = arma::conv_to<ComplexVector>::from(rand_t);
+            continue;
+        }
+
+        // Restart with the best Ritz vectors, whose span includes u
+        if(ncv_act >= ncv)
+        {
+            const int nkeep = std::max(1, ncv / 2);
+            ComplexMatrix S(ncv_act, nkeep);
+            for(int j = 0; j < nkeep; j++)
+                S.col(j) = evecs.col(ind[j]);
+            ComplexMatrix Z, Rz;
+            if(!arma::qr_econ(Z, Rz, S))
+                throw std::logic_error("JDGenEigsSolver: failed to compute the QR decomposition of the Ritz vectors");
+            compress(Z);
+        }
+
+        // Far from convergence, theta may be a poor approximation to the
+        // eigenvalue closest to the target, so the target is used as the shift
+        Complex sigma = theta;
+        if(SelectionRule == TARGET_CLOSEST && r_norm > Scalar(1e-3) * std::max(Scalar(1), std::abs(theta)))
+            sigma = target;
+
+        rtol /= 2;
+        solve_correction(u, r, sigma, rtol, t);
+    }
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::ComplexVector JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvalues()
+{
+    const int n = std::min(nev, nconv);
+    ComplexVector res(n);
+
+    if(!n)
+        return res;
+
+    std::vector<int> ind;
+    ComplexVector vals(n);
+    for(int i = 0; i < n; i++)
+        vals[i] = fac_R(i, i);
+    sort_values(vals, ind);
+    for(int i = 0; i < n; i++)
+        res[i] = vals[ind[i]];
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::ComplexMatrix JDGenEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvectors(int nvec)
+{
+    const int n = std::min(nev, nconv);
+    nvec = std::min(nvec, n);
+    ComplexMatrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    std::vector<int> ind;
+    ComplexVector vals(n);
+    for(int i = 0; i < n; i++)
+        vals[i] = fac_R(i, i);
+    sort_values(vals, ind);
+
+    // The eigenvectors of the upper triangular R are computed by back
+    // substitution, so that they match the order of the diagonal
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    const Scalar r_norm = std::max(arma::norm(fac_R, "fro"), eps);
+    ComplexMatrix Qc(fac_Q.memptr(), dim_n, n, false);
+    for(int i = 0; i < nvec; i++)
+    {
+        const int j = ind[i];
+        ComplexVector y(n, arma::fill::zeros);
+        y[j] = 1;
+        for(int l = j - 1; l >= 0; l--)
+        {
+            Complex sum = 0;
+            for(int c = l + 1; c <= j; c++)
+                sum += fac_R(l, c) * y[c];
+            Complex d = fac_R(l, l) - fac_R(j, j);
+            if(std::abs(d) < eps * r_norm)
+                d = eps * r_norm;
+            y[l] = -sum / d;
+        }
+        res.col(i) = Qc * y;
+        res.col(i) /= arma::norm(res.col(i));
+    }
+
+    return res;
+}
@@ -0,0 +1,399 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Sort the Ritz values according to the selection rule
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::sort_values(const Vector &evals, std::vector<int> &ind)
+{
+    if(SelectionRule == TARGET_CLOSEST)
+        sorting.compute(evals.memptr(), evals.n_elem, target);
+    else
+        sorting.compute(evals.memptr(), evals.n_elem);
+
+    sorting.index(ind);
+}
+
+// x <- (I - [Q u] * [Q u]') * x
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::project(const Vector &u, Vector &x)
+{
+    if(nconv > 0)
+    {
+        Matrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+        x -= Qc * (Qc.t() * x);
+    }
+    x -= arma::dot(u, x) * u;
+}
+
+// Orthonormalize t against Q and V, and append it to V
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::expand(Vector &t)
+{
+    const int m = ncv_act;
+    for(;;)
+    {
+        const Scalar t_norm = arma::norm(t);
+
+        // Classical Gram-Schmidt is applied twice to maintain orthogonality
+        for(int pass = 0; pass < 2; pass++)
+        {
+            if(nconv > 0)
+            {
+                Matrix Qc(fac_Q.memptr(), dim_n, nconv, false);
+                t -= Qc * (Qc.t() * t);
+            }
+            if(m > 0)
+            {
+                Matrix Vs(fac_V.memptr(), dim_n, m, false);
+                t -= Vs * (Vs.t() * t);
+            }
+        }
+
+        const Scalar t_orth = arma::norm(t);
+        if(t_orth > prec * t_norm && t_orth > Scalar(0))
+        {
+            t /= t_orth;
+            break;
+        }
+
+        // t is (nearly) in the span of Q and V, so a random
+        // vector is used instead
+        t.set_size(dim_n);
+        rng.uniform(t.memptr(), dim_n);
+    }
+
+    fac_V.col(m) = t;
+    op->perform_op(fac_V.colptr(m), fac_AV.colptr(m));
+    nmatop++;
+
+    // The new column and row of H = V' * A * V
+    Matrix Vs(fac_V.memptr(), dim_n, m + 1, false);
+    Vector h = Vs.t() * fac_AV.col(m);
+    fac_H(arma::span(0, m), m) = h;
+    fac_H(m, arma::span(0, m)) = h.t();
+
+    ncv_act = m + 1;
+}
+
+// V <- V * S, where S has orthonormal columns, and H <- diag(theta)
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::compress(const Matrix &S, const Vector &theta)
+{
+    const int k = S.n_cols;
+
+    // The columns of S are eigenvectors of H, so the
+    // new H = S' * H * S is diagonal
+    BasisOp::mult_inplace(fac_V, ncv_act, S, ws_panel.memptr());
+    BasisOp::mult_inplace(fac_AV, ncv_act, S, ws_panel.memptr());
+    fac_H.zeros();
+    for(int i = 0; i < k; i++)
+        fac_H(i, i) = theta[i];
+
+    ncv_act = k;
+}
+
+// y <- P * T * P * x, where P = I - [Q u] * [Q u]' and T is the preconditioner
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::apply_precond(const Vector &u, const Vector &x, Vector &y)
+{
+    if(precond == NULL)
+    {
+        y = x;
+        project(u, y);
+        return;
+    }
+
+    Vector px = x;
+    project(u, px);
+    precond->perform_op(px.memptr(), y.memptr());
+    project(u, y);
+}
+
+// Approximately solve the correction equation by MINRES
+// The operator B = P * (A - sigma * I) * P is symmetric, and so is the
+// preconditioner P * T * P, which is positive definite on the range of P,
+// where all the MINRES vectors lie
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::solve_correction(const Vector &u, const Vector &r, Scalar sigma, Scalar rtol, Vector &t)
+{
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+
+    // Solve B * t = -r, starting from t = 0
+    Vector x(dim_n, arma::fill::zeros);
+    Vector r1 = -r;
+    project(u, r1);
+    Vector y(dim_n);
+    apply_precond(u, r1, y);
+
+    const Scalar beta1_sq = arma::dot(r1, y);
+    if(beta1_sq <= Scalar(0))
+    {
+        // No progress is possible, and the projected residual
+        // is used, as in the Davidson method
+        t = r1;
+        return;
+    }
+
+    const Scalar beta1 = std::sqrt(beta1_sq);
+    Scalar beta = beta1, oldb = 0, dbar = 0, epsln = 0, phibar = beta1;
+    Scalar cs = -1, sn = 0;
+    Vector r2 = r1, v(dim_n);
+    Vector w(dim_n, arma::fill::zeros), w1(dim_n, arma::fill::zeros), w2(dim_n, arma::fill::zeros);
+
+    for(int k = 0; k < ninner; k++)
+    {
+        // Lanczos step on the preconditioned operator
+        v = y / beta;
+        op->perform_op(v.memptr(), y.memptr());
+        nmatop++;
+        y -= sigma * v;
+        project(u, y);
+        if(k > 0)
+            y -= (beta / oldb) * r1;
+
+        const Scalar alfa = arma::dot(v, y);
+        y -= (alfa / beta) * r2;
+        r1.swap(r2);
+        r2 = y;
+        apply_precond(u, r2, y);
+        oldb = beta;
+        const Scalar beta_sq = arma::dot(r2, y);
+        beta = (beta_sq > Scalar(0)) ? std::sqrt(beta_sq) : Scalar(0);
+
+        // Apply the previous rotation, and compute the next one
+        const Scalar oldeps = epsln;
+        const Scalar delta = cs * dbar + sn * alfa;
+        const Scalar gbar = sn * dbar - cs * alfa;
+        epsln = sn * beta;
+        dbar = -cs * beta;
+        const Scalar gamma = std::max(std::sqrt(gbar * gbar + beta * beta), eps);
+        cs = gbar / gamma;
+        sn = beta / gamma;
+        const Scalar phi = cs * phibar;
+        phibar = sn * phibar;
+
+        // Update the solution
+        w1.swap(w2);
+        w2.swap(w);
+        w = (v - oldeps * w1 - delta * w2) / gamma;
+        x += phi * w;
+
+        if(beta == Scalar(0) || phibar < rtol * beta1)
+            break;
+    }
+
+    t.swap(x);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::init(Scalar *init_resid)
+{
+    fac_t = Vector(init_resid, dim_n);
+    if(arma::norm(fac_t) < prec)
+        throw std::invalid_argument("initial residual vector cannot be zero");
+
+    fac_Q.zeros(dim_n, nev);
+    eig_val.zeros(nev);
+    fac_V.zeros(dim_n, ncv);
+    fac_AV.zeros(dim_n, ncv);
+    fac_H.zeros(ncv, ncv);
+    ws_panel.zeros(std::min(dim_n, int(BasisOp::block_rows)) * ncv);
+
+    nmatop = 0;
+    niter = 0;
+    nconv = 0;
+    ncv_act = 0;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::init()
+{
+    Vector init_resid(dim_n);
+    rng.uniform(init_resid.memptr(), dim_n);
+    init(init_resid.memptr());
+}
+
+// Compute the eigenpairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline int JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::compute(int maxit, Scalar tol)
+{
+    std::vector<int> ind;
+    Vector evals, u, Au, r, t = fac_t;
+    Matrix evecs;
+    Scalar theta = 0, r_norm = 0;
+    // Tolerance of the correction equation, relative to the residual,
+    // which is halved in each iteration on the same eigenpair
+    Scalar rtol = 1;
+
+    int i;
+    for(i = 0; i < maxit; i++)
+    {
+        expand(t);
+
+        // Ritz pairs of the search space
+        Matrix Hm = fac_H.submat(0, 0, ncv_act - 1, ncv_act - 1);
+        if(!arma::eig_sym(evals, evecs, Hm))
+            throw std::logic_error("JDSymEigsSolver: failed to compute the eigen decomposition of H");
+        sort_values(evals, ind);
+
+        // Lock the wanted Ritz pairs as long as they converge
+        for(;;)
+        {
+            const int m = ncv_act;
+            Matrix Vs(fac_V.memptr(), dim_n, m, false);
+            Matrix AVs(fac_AV.memptr(), dim_n, m, false);
+            theta = evals[ind[0]];
+            u = Vs * evecs.col(ind[0]);
+            Au = AVs * evecs.col(ind[0]);
+            r = Au - theta * u;
+            project(u, r);
+            r_norm = arma::norm(r);
+
+            if(r_norm >= tol * std::max(prec, std::abs(theta)))
+                break;
+
+            fac_Q.col(nconv) = u;
+            eig_val[nconv] = theta;
+            nconv++;
+            rtol = 1;
+
+            if(nconv >= nev)
+                break;
+
+            // The search space loses u, and keeps the other Ritz vectors
+            if(m == 1)
+            {
+                ncv_act = 0;
+                break;
+            }
+            arma::uvec rest(m - 1);
+            for(int j = 1; j < m; j++)
+                rest[j - 1] = ind[j];
+            Vector theta_rest = evals.elem(rest);
+            Matrix S = evecs.cols(rest);
+            compress(S, theta_rest);
+
+            // H is now diagonal and already sorted
+            evals = theta_rest;
+            evecs.eye(m - 1, m - 1);
+            for(int j = 0; j < m - 1; j++)
+                ind[j] = j;
+            ind.resize(m - 1);
+        }
+
+        if(nconv >= nev)
+            break;
+
+        // The search space is empty after locking
+        if(ncv_act == 0)
+        {
+            t.set_size(dim_n);
+            rng.uniform(t.memptr(), dim_n);
+            continue;
+        }
+
+        // Restart with the best Ritz vectors, which include u
+        if(ncv_act >= ncv)
+        {
+            const int nkeep = std::max(1, ncv / 2);
+            arma::uvec keep(nkeep);
+            for(int j = 0; j < nkeep; j++)
+                keep[j] = ind[j];
+            Vector theta_keep = evals.elem(keep);
+            Matrix S = evecs.cols(keep);
+            compress(S, theta_keep);
+        }
+
+        // Far from convergence, theta may be a poor approximation to the
+        // eigenvalue closest to the target, so the target is used as the shift
+        Scalar sigma = theta;
+        if(SelectionRule == TARGET_CLOSEST && r_norm > Scalar(1e-3) * std::max(Scalar(1), std::abs(theta)))
+            sigma = target;
+
+        rtol /= 2;
+        solve_correction(u, r, sigma, rtol, t);
+    }
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::Vector JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvalues()
+{
+    const int n = std::min(nev, nconv);
+    Vector res(n);
+
+    if(!n)
+        return res;
+
+    std::vector<int> ind;
+    Vector vals = eig_val.head(n);
+    sort_values(vals, ind);
+    for(int i = 0; i < n; i++)
+        res[i] = eig_val[ind[i]];
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::Matrix JDSymEigsSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvectors(int nvec)
+{
+    const int n = std::min(nev, nconv);
+    nvec = std::min(nvec, n);
+    Matrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    std::vector<int> ind;
+    Vector vals = eig_val.head(n);
+    sort_values(vals, ind);
+    for(int i = 0; i < nvec; i++)
+        res.col(i) = fac_Q.col(ind[i]);
+
+    return res;
+}
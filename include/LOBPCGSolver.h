@@ -0,0 +1,253 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef LOBPCG_SOLVER_H
+#define LOBPCG_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow
+#include <algorithm>  // std::max, std::min, std::count
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "SelectionRule.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+#include "MatOp/IdentityPrecond.h"
+#include "MatOp/JacobiPrecond.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the locally optimal block preconditioned conjugate
+/// gradient (LOBPCG) method for the extremal eigenvalues of real symmetric matrices.
+///
+/// In each iteration, the Ritz vectors \f$X\f$ are updated by a Rayleigh-Ritz
+/// step on the subspace spanned by \f$X\f$, the preconditioned residuals
+/// \f$W=T(AX-X\Theta)\f$, and the previous search directions \f$P\f$. The memory
+/// use is about three blocks of `nblock` vectors, together with their products
+/// with \f$A\f$, and no factorization of \f$A\f$ is needed. With a good
+/// preconditioner \f$T\approx A^{-1}\f$, for example a Jacobi or an incomplete
+/// Cholesky preconditioner of a symmetric positive definite matrix, the smallest
+/// eigenvalues converge in close to the optimal number of matrix operations.
+///
+/// Converged Ritz pairs are softly locked: they stay in the Rayleigh-Ritz step,
+/// so that they keep improving and the other Ritz vectors remain orthogonal to them,
+/// but no residual or search direction is computed for them.
+///
+/// The matrix operation class and the preconditioner class must implement `rows()`
+/// and the block operation `perform_op(const Scalar *x_in, Scalar *y_out, int ncols)`,
+/// as in BlockSymEigsSolver. DenseGenMatProd, SparseGenMatProd, IdentityPrecond and
+/// JacobiPrecond all implement this function.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule Either `SMALLEST_ALGE` or `LARGEST_ALGE`.
+/// \tparam OpType        The name of the matrix operation class, for example
+///                       DenseGenMatProd or SparseGenMatProd.
+/// \tparam PrecondType   The name of the preconditioner class, for example
+///                       JacobiPrecond. The default IdentityPrecond means no preconditioning.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <LOBPCGSolver.h>
+///
+/// int main()
+/// {
+///     arma::sp_mat A = arma::sprandu(1000, 1000, 0.01);
+///     arma::sp_mat M = A + A.t();
+///     for(int i = 0; i < 1000; i++)
+///         M(i, i) += i + 1;
+///
+///     SparseGenMatProd<double> op(M);
+///     JacobiPrecond<double> precond(M);
+///
+///     // The 10 smallest eigenvalues, with a block of 12 vectors
+///     LOBPCGSolver< double, SMALLEST_ALGE, SparseGenMatProd<double>, JacobiPrecond<double> >
+///         eigs(&op, 10, 12, &precond);
+///
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     arma::vec evalues;
+///     if(nconv > 0)
+///         evalues = eigs.eigenvalues();
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = SMALLEST_ALGE,
+           typename OpType = DenseGenMatProd<double>,
+           typename PrecondType = IdentityPrecond<Scalar> >
+class LOBPCGSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-matrix product
+    PrecondType *precond; // object to apply the preconditioner, or NULL
+    const int dim_n;      // dimension of matrix A
+    const int nev;        // number of eigenvalues requested
+    const int nblock;     // number of vectors in the block
+    int nmatop;           // number of matrix operations called,
+                          // counted as matrix-vector products
+    int niter;            // number of iterations
+    CounterRNG rng;       // random vectors of init()
+    bool has_P;           // whether the search directions are available
+
+    Matrix fac_X;         // Ritz vectors, n x nblock
+    Matrix fac_AX;        // A * X
+    Matrix fac_P;         // search directions, n x nblock
+
+    Vector ritz_val;      // ritz values, from the wanted end to the other
+    BoolVector ritz_conv; // indicator of the convergence of ritz values
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // Rayleigh-Ritz on the initial block
+    inline void rayleigh_ritz_init();
+
+    // Orthonormalize the columns of P, also against X and W,
+    // and return false if P is close to rank deficient
+    inline bool orthonormalize_P(Matrix &P, const Matrix &W);
+
+    // One LOBPCG iteration
+    inline void iterate();
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_      Pointer to the matrix operation object. Users could either
+    ///                 create the object from the DenseGenMatProd or SparseGenMatProd
+    ///                 wrapper classes, or define their own that impelemnts all the
+    ///                 public member functions as in DenseGenMatProd.
+    /// \param nev_     Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///                 where \f$n\f$ is the size of matrix.
+    /// \param nblock_  Number of vectors in the block. This parameter must satisfy
+    ///                 \f$nev \le nblock\f$ and \f$3\cdot nblock \le n\f$. A few
+    ///                 vectors more than `nev` speed up the convergence of the last
+    ///                 wanted eigenvalues.
+    /// \param precond_ Pointer to the preconditioner object, or `NULL` for no preconditioning.
+    ///
+    LOBPCGSolver(OpType *op_, int nev_, int nblock_, PrecondType *precond_ = NULL) :
+        op(op_),
+        precond(precond_),
+        dim_n(op->rows()),
+        nev(nev_),
+        nblock(nblock_),
+        nmatop(0),
+        niter(0),
+        has_P(false),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        if(SelectionRule != LARGEST_ALGE && SelectionRule != SMALLEST_ALGE)
+            throw std::invalid_argument("LOBPCGSolver: unsupported selection rule, must be LARGEST_ALGE or SMALLEST_ALGE");
+
+        if(nev_ < 1 || nev_ > dim_n - 1)
+            throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
+
+        if(nblock_ < nev_ || 3 * nblock_ > dim_n)
+            throw std::invalid_argument("nblock must satisfy nev <= nblock and 3 * nblock <= n, n is the size of matrix");
+
+        if(precond_ != NULL && precond_->rows() != dim_n)
+            throw std::invalid_argument("LOBPCGSolver: preconditioner must have the same size as the matrix");
+    }
+
+    ///
+    /// Providing the initial block of vectors for the algorithm.
+    ///
+    /// \param init_block Pointer to the initial block, an \f$n\times nblock\f$
+    ///                   matrix stored in column-major order.
+    ///
+    inline void init(Scalar *init_block);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial block in init(). This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial block of vectors.
+    ///
+    /// This overloaded function generates a random initial block
+    /// for the algorithm. Elements in the block follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of converged eigenvalues.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counted as the number of vectors that the matrix has been applied to.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged eigenvalues, from the wanted end of the spectrum,
+    /// i.e., in increasing order for `SMALLEST_ALGE` and decreasing order for `LARGEST_ALGE`.
+    ///
+    /// \return A vector containing the eigenvalues.
+    /// Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector eigenvalues();
+
+    ///
+    /// Returning the eigenvectors associated with the converged eigenvalues.
+    ///
+    /// \param nvec The number of eigenvectors to return.
+    ///
+    /// \return A matrix containing the eigenvectors.
+    /// Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Matrix eigenvectors(int nvec);
+    ///
+    /// Returning all converged eigenvectors.
+    ///
+    inline Matrix eigenvectors() { return eigenvectors(nev); }
+};
+
+
+// Implementations
+#include "LOBPCGSolver_Impl.h"
+
+
+#endif // LOBPCG_SOLVER_H
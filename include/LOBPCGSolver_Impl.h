@@ -0,0 +1,310 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Rayleigh-Ritz on the initial block
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::rayleigh_ritz_init()
+{
+    Matrix Q, R;
+    if(!arma::qr_econ(Q, R, fac_X))
+        throw std::logic_error("LOBPCGSolver: failed to compute the QR decomposition of the initial block");
+    fac_X = Q;
+
+    op->perform_op(fac_X.memptr(), fac_AX.memptr(), nblock);
+    nmatop += nblock;
+
+    Matrix G = fac_X.t() * fac_AX;
+    G = (G + G.t()) / 2;
+    Vector evals;
+    Matrix evecs;
+    if(!arma::eig_sym(evals, evecs, G))
+        throw std::logic_error("LOBPCGSolver: failed to compute the eigen decomposition of X'AX");
+
+    // The wanted end comes first
+    if(SelectionRule == LARGEST_ALGE)
+    {
+        evals = arma::flipud(evals);
+        evecs = arma::fliplr(evecs);
+    }
+
+    fac_X = fac_X * evecs;
+    fac_AX = fac_AX * evecs;
+    ritz_val = evals;
+    has_P = false;
+}
+
+// Orthonormalize the columns of P, also against X and W,
+// and return false if P is close to rank deficient
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline bool LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::orthonormalize_P(Matrix &P, const Matrix &W)
+{
+    // Near convergence P is close to the span of X, so the
+    // projection and the QR decomposition are applied twice, as for W
+    Matrix Q, R;
+    for(int pass = 0; pass < 2; pass++)
+    {
+        P -= fac_X * (fac_X.t() * P);
+        P -= W * (W.t() * P);
+        if(!arma::qr_econ(Q, R, P))
+            return false;
+
+        // The diagonal of R measures how much of each search direction
+        // is left outside the span of X, W and the previous directions
+        Vector d = arma::abs(R.diag());
+        if(pass == 0 && d.min() < std::sqrt(std::numeric_limits<Scalar>::epsilon()) * d.max())
+            return false;
+
+        P = Q;
+    }
+
+    return true;
+}
+
+// One LOBPCG iteration
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::iterate()
+{
+    const int m = nblock;
+
+    // Soft locking: the residuals and search directions are only
+    // computed for the Ritz pairs that have not converged
+    const int na = m - std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    arma::uvec act(na);
+    for(int i = 0, j = 0; i < m; i++)
+    {
+        if(!ritz_conv[i])
+        {
+            act[j] = i;
+            j++;
+        }
+    }
+
+    // W = T * (A * X - X * Theta)
+    Vector theta = ritz_val.elem(act);
+    Matrix R = fac_AX.cols(act) - fac_X.cols(act) * arma::diagmat(theta);
+    Matrix W(dim_n, na);
+    if(precond != NULL)
+        precond->perform_op(R.memptr(), W.memptr(), na);
+    else
+        W = R;
+
+    // W is made orthonormal, and orthogonal to X
+    Matrix Q, Rw;
+    for(int pass = 0; pass < 2; pass++)
+    {
+        W -= fac_X * (fac_X.t() * W);
+        if(!arma::qr_econ(Q, Rw, W))
+            throw std::logic_error("LOBPCGSolver: failed to compute the QR decomposition of the residuals");
+        W = Q;
+    }
+    Matrix AW(dim_n, na);
+    op->perform_op(W.memptr(), AW.memptr(), na);
+    nmatop += na;
+
+    // P is made orthonormal, and orthogonal to X and W
+    // A * P is computed explicitly: updating it through the same linear
+    // combinations as P amplifies its rounding errors, since P becomes
+    // small near convergence and is scaled up again here
+    Matrix P, AP;
+    bool use_P = has_P;
+    if(use_P)
+    {
+        P = fac_P.cols(act);
+
+        // If P is close to rank deficient, this step goes without it
+        use_P = orthonormalize_P(P, W);
+    }
+    if(use_P)
+    {
+        AP.set_size(dim_n, na);
+        op->perform_op(P.memptr(), AP.memptr(), na);
+        nmatop += na;
+    }
+
+    // Projected matrix on the subspace spanned by [X, W, P]
+    const int np = use_P ? na : 0;
+    const int k = m + na + np;
+    Matrix G(k, k, arma::fill::zeros);
+    G.submat(0, 0, m - 1, m - 1) = fac_X.t() * fac_AX;
+    G.submat(0, m, m - 1, m + na - 1) = fac_X.t() * AW;
+    G.submat(m, m, m + na - 1, m + na - 1) = W.t() * AW;
+    if(use_P)
+    {
+        G.submat(0, m + na, m - 1, k - 1) = fac_X.t() * AP;
+        G.submat(m, m + na, m + na - 1, k - 1) = W.t() * AP;
+        G.submat(m + na, m + na, k - 1, k - 1) = P.t() * AP;
+    }
+    G = arma::symmatu(G);
+
+    Vector evals;
+    Matrix evecs;
+    if(!arma::eig_sym(evals, evecs, G))
+        throw std::logic_error("LOBPCGSolver: failed to compute the eigen decomposition of the projected matrix");
+
+    // The m wanted Ritz pairs, from the wanted end
+    arma::uvec sel(m);
+    for(int i = 0; i < m; i++)
+        sel[i] = (SelectionRule == SMALLEST_ALGE) ? i : k - 1 - i;
+    Matrix Y = evecs.cols(sel);
+
+    // P <- W * Y_w + P * Y_p, X <- X * Y_x + P
+    Matrix Yx = Y.rows(0, m - 1);
+    Matrix Yw = Y.rows(m, m + na - 1);
+    Matrix Pn = W * Yw;
+    Matrix APn = AW * Yw;
+    if(use_P)
+    {
+        Matrix Yp = Y.rows(m + na, k - 1);
+        Pn += P * Yp;
+        APn += AP * Yp;
+    }
+    fac_X = fac_X * Yx + Pn;
+    fac_AX = fac_AX * Yx + APn;
+    fac_P.swap(Pn);
+    has_P = true;
+
+    ritz_val = evals.elem(sel);
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline int LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::num_converged(Scalar tol)
+{
+    // All the Ritz pairs in the block are tested, since the
+    // converged ones are locked in the next iteration
+    for(int i = 0; i < nblock; i++)
+    {
+        Scalar resid = arma::norm(fac_AX.col(i) - ritz_val[i] * fac_X.col(i));
+        Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.begin() + nev, true);
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::init(Scalar *init_block)
+{
+    fac_X = Matrix(init_block, dim_n, nblock);
+    if(arma::norm(fac_X, "fro") < prec)
+        throw std::invalid_argument("initial block cannot be zero");
+
+    fac_AX.zeros(dim_n, nblock);
+    fac_P.zeros(dim_n, nblock);
+    ritz_val.zeros(nblock);
+    ritz_conv.assign(nblock, false);
+
+    nmatop = 0;
+    niter = 0;
+    has_P = false;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline void LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::init()
+{
+    Matrix init_block(dim_n, nblock);
+    rng.uniform(init_block.memptr(), dim_n * nblock);
+    init(init_block.memptr());
+}
+
+// Compute Ritz pairs and return the number of converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline int LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::compute(int maxit, Scalar tol)
+{
+    rayleigh_ritz_init();
+
+    int i, nconv = 0;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nev)
+            break;
+
+        iterate();
+    }
+
+    niter = i + 1;
+
+    return std::min(nev, nconv);
+}
+
+// Return converged eigenvalues
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::Vector LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvalues()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.begin() + nev, true);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return converged eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename PrecondType >
+inline typename LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::Matrix LOBPCGSolver<Scalar, SelectionRule, OpType, PrecondType>::eigenvectors(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.begin() + nev, true);
+    nvec = std::min(nvec, nconv);
+    Matrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nev && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res.col(j) = fac_X.col(i);
+            j++;
+        }
+    }
+
+    return res;
+}
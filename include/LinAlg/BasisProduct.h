@@ -0,0 +1,306 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BASIS_PRODUCT_H
+#define BASIS_PRODUCT_H
+
+#include <armadillo>
+#include <algorithm>
+
+///
+/// \ingroup LinearAlgebra
+///
+/// Products between a Krylov basis \f$V\f$ and vectors or small matrices,
+/// with the basis possibly stored in a lower precision.
+///
+/// The eigen solvers keep the Krylov basis in a matrix of type
+/// `arma::Mat<BasisScalar>`, and all other quantities in `Scalar`. When
+/// `BasisScalar` is the same as `Scalar`, the operations are carried out by
+/// **Armadillo**, and hence BLAS. Otherwise, for example a `float` basis in a
+/// `double` solver, the elements of \f$V\f$ are converted on the fly, and all
+/// the sums are accumulated in `Scalar`, so that the basis is only read once
+/// in each operation.
+///
+/// All the operations only involve the first `ncol` columns of \f$V\f$.
+/// Vectors are passed as pointers, in the same way as the matrix operation
+/// classes.
+///
+/// Products with a matrix are computed in panels of `block_rows` rows of \f$V\f$,
+/// so that each panel is read from memory only once, and stays in the cache
+/// while it is multiplied by the small matrix.
+///
+/// \tparam Scalar      The element type used in the computation.
+/// \tparam BasisScalar The element type of the basis.
+///
+template <typename Scalar, typename BasisScalar>
+class BasisProduct
+{
+private:
+    typedef arma::Mat<BasisScalar> BasisMatrix;
+
+public:
+    ///
+    /// Number of rows in a panel of \f$V\f$.
+    ///
+    static const int block_rows = 512;
+
+    ///
+    /// \f$y=V'x\f$, where \f$y\f$ is of length `ncol`.
+    ///
+    static void trans_mult(BasisMatrix &V, int ncol, const Scalar *x, Scalar *y)
+    {
+        const int n = V.n_rows;
+        for(int j = 0; j < ncol; j++)
+        {
+            const BasisScalar *vj = V.colptr(j);
+            Scalar sum = 0;
+            for(int r = 0; r < n; r++)
+                sum += Scalar(vj[r]) * x[r];
+            y[j] = sum;
+        }
+    }
+
+    ///
+    /// \f$y=y-Vh\f$, where \f$h\f$ is of length `ncol`.
+    ///
+    static void mult_sub(BasisMatrix &V, int ncol, const Scalar *h, Scalar *y)
+    {
+        const int n = V.n_rows;
+        for(int j = 0; j < ncol; j++)
+        {
+            const BasisScalar *vj = V.colptr(j);
+            const Scalar hj = h[j];
+            for(int r = 0; r < n; r++)
+                y[r] -= hj * Scalar(vj[r]);
+        }
+    }
+
+    ///
+    /// \f$y=y+a\cdot v_j\f$, where \f$v_j\f$ is the j-th column of \f$V\f$.
+    ///
+    static void axpy(Scalar a, BasisMatrix &V, int j, Scalar *y)
+    {
+        const int n = V.n_rows;
+        const BasisScalar *vj = V.colptr(j);
+        for(int r = 0; r < n; r++)
+            y[r] += a * Scalar(vj[r]);
+    }
+
+    ///
+    /// \f$Y=V'X\f$, where \f$Y\f$ is an `ncol` by `X.n_cols` matrix.
+    /// \f$V\f$ is read only once for all the columns of \f$X\f$.
+    ///
+    static void trans_mult(BasisMatrix &V, int ncol, const arma::Mat<Scalar> &X, arma::Mat<Scalar> &Y)
+    {
+        const int n = V.n_rows;
+        const int k = X.n_cols;
+        Y.zeros(ncol, k);
+        for(int r0 = 0; r0 < n; r0 += block_rows)
+        {
+            const int nr = std::min(int(block_rows), n - r0);
+            for(int j = 0; j < ncol; j++)
+            {
+                const BasisScalar *vj = V.colptr(j) + r0;
+                for(int c = 0; c < k; c++)
+                {
+                    const Scalar *xc = X.colptr(c) + r0;
+                    Scalar sum = 0;
+                    for(int r = 0; r < nr; r++)
+                        sum += Scalar(vj[r]) * xc[r];
+                    Y(j, c) += sum;
+                }
+            }
+        }
+    }
+
+    ///
+    /// \f$Y=Y-VH\f$, where \f$H\f$ is an `ncol` by `Y.n_cols` matrix.
+    /// \f$V\f$ is read only once for all the columns of \f$Y\f$.
+    ///
+    static void mult_sub(BasisMatrix &V, int ncol, const arma::Mat<Scalar> &H, arma::Mat<Scalar> &Y)
+    {
+        const int n = V.n_rows;
+        const int k = Y.n_cols;
+        for(int r0 = 0; r0 < n; r0 += block_rows)
+        {
+            const int nr = std::min(int(block_rows), n - r0);
+            for(int j = 0; j < ncol; j++)
+            {
+                const BasisScalar *vj = V.colptr(j) + r0;
+                for(int c = 0; c < k; c++)
+                {
+                    const Scalar hjc = H(j, c);
+                    Scalar *yc = Y.colptr(c) + r0;
+                    for(int r = 0; r < nr; r++)
+                        yc[r] -= hjc * Scalar(vj[r]);
+                }
+            }
+        }
+    }
+
+    ///
+    /// \f$W=VY\f$, where \f$Y\f$ is an `ncol` by `W.n_cols` matrix.
+    /// `W` can be of either the basis type or the computation type.
+    ///
+    template <typename OutScalar>
+    static void mult(BasisMatrix &V, int ncol, const arma::Mat<Scalar> &Y, arma::Mat<OutScalar> &W)
+    {
+        const int n = V.n_rows;
+        const int k = W.n_cols;
+        Scalar acc[block_rows];
+        for(int r0 = 0; r0 < n; r0 += block_rows)
+        {
+            const int nr = std::min(int(block_rows), n - r0);
+            for(int c = 0; c < k; c++)
+            {
+                std::fill(acc, acc + nr, Scalar(0));
+                for(int j = 0; j < ncol; j++)
+                {
+                    const BasisScalar *vj = V.colptr(j) + r0;
+                    const Scalar yjc = Y(j, c);
+                    for(int r = 0; r < nr; r++)
+                        acc[r] += yjc * Scalar(vj[r]);
+                }
+                OutScalar *wc = W.colptr(c) + r0;
+                for(int r = 0; r < nr; r++)
+                    wc[r] = OutScalar(acc[r]);
+            }
+        }
+    }
+
+    ///
+    /// \f$V_{[,1:k]}=VQ\f$ in place, where \f$Q\f$ is an `ncol` by \f$k\f$ matrix
+    /// with \f$k\le ncol\f$.
+    ///
+    /// \param work Workspace of at least `block_rows` \f$\times k\f$ elements.
+    ///
+    static void mult_inplace(BasisMatrix &V, int ncol, const arma::Mat<Scalar> &Q, Scalar *work)
+    {
+        const int n = V.n_rows;
+        const int k = Q.n_cols;
+        for(int r0 = 0; r0 < n; r0 += block_rows)
+        {
+            const int nr = std::min(int(block_rows), n - r0);
+            std::fill(work, work + nr * k, Scalar(0));
+            for(int j = 0; j < ncol; j++)
+            {
+                const BasisScalar *vj = V.colptr(j) + r0;
+                for(int c = 0; c < k; c++)
+                {
+                    const Scalar qjc = Q(j, c);
+                    Scalar *wc = work + c * nr;
+                    for(int r = 0; r < nr; r++)
+                        wc[r] += qjc * Scalar(vj[r]);
+                }
+            }
+            // The panel has been fully read, so it can be overwritten
+            for(int c = 0; c < k; c++)
+            {
+                const Scalar *wc = work + c * nr;
+                BasisScalar *vc = V.colptr(c) + r0;
+                for(int r = 0; r < nr; r++)
+                    vc[r] = BasisScalar(wc[r]);
+            }
+        }
+    }
+
+    ///
+    /// Store \f$x\f$ as the j-th column of \f$V\f$. \f$x\f$ is overwritten by
+    /// the stored values, which may have been rounded to the precision of the basis.
+    ///
+    static void set_col(BasisMatrix &V, int j, Scalar *x)
+    {
+        const int n = V.n_rows;
+        BasisScalar *vj = V.colptr(j);
+        for(int r = 0; r < n; r++)
+        {
+            vj[r] = BasisScalar(x[r]);
+            x[r] = Scalar(vj[r]);
+        }
+    }
+};
+
+// When the basis has the same precision as the computation,
+// everything is delegated to Armadillo
+template <typename Scalar>
+class BasisProduct<Scalar, Scalar>
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+public:
+    static const int block_rows = 512;
+
+    static void trans_mult(Matrix &V, int ncol, const Scalar *x, Scalar *y)
+    {
+        Matrix Vs(V.memptr(), V.n_rows, ncol, false);
+        const Vector xv(const_cast<Scalar *>(x), V.n_rows, false);
+        Vector yv(y, ncol, false);
+        yv = Vs.t() * xv;
+    }
+
+    static void mult_sub(Matrix &V, int ncol, const Scalar *h, Scalar *y)
+    {
+        Matrix Vs(V.memptr(), V.n_rows, ncol, false);
+        const Vector hv(const_cast<Scalar *>(h), ncol, false);
+        Vector yv(y, V.n_rows, false);
+        yv -= Vs * hv;
+    }
+
+    static void trans_mult(Matrix &V, int ncol, const Matrix &X, Matrix &Y)
+    {
+        Matrix Vs(V.memptr(), V.n_rows, ncol, false);
+        Y = Vs.t() * X;
+    }
+
+    static void mult_sub(Matrix &V, int ncol, const Matrix &H, Matrix &Y)
+    {
+        Matrix Vs(V.memptr(), V.n_rows, ncol, false);
+        Y -= Vs * H;
+    }
+
+    static void axpy(Scalar a, Matrix &V, int j, Scalar *y)
+    {
+        Vector vj(V.colptr(j), V.n_rows, false);
+        Vector yv(y, V.n_rows, false);
+        yv += a * vj;
+    }
+
+    static void mult(Matrix &V, int ncol, const Matrix &Y, Matrix &W)
+    {
+        Matrix Vs(V.memptr(), V.n_rows, ncol, false);
+        W = Vs * Y;
+    }
+
+    static void mult_inplace(Matrix &V, int ncol, const Matrix &Q, Scalar *work)
+    {
+        const int n = V.n_rows;
+        const int k = Q.n_cols;
+        const char trans = 'N';
+        const Scalar one = 1, zero = 0;
+        arma::blas_int ldv = n, ldq = Q.n_rows, kk = k, nc = ncol;
+        for(int r0 = 0; r0 < n; r0 += block_rows)
+        {
+            // work <- V[r0:r1, 0:ncol] * Q, with the leading dimension of V
+            // so that the panel is not copied
+            arma::blas_int nr = std::min(int(block_rows), n - r0);
+            arma::blas::gemm(&trans, &trans, &nr, &kk, &nc, &one, V.memptr() + r0, &ldv,
+                             Q.memptr(), &ldq, &zero, work, &nr);
+            for(int c = 0; c < k; c++)
+                std::copy(work + c * nr, work + (c + 1) * nr, V.colptr(c) + r0);
+        }
+    }
+
+    static void set_col(Matrix &V, int j, Scalar *x)
+    {
+        std::copy(x, x + V.n_rows, V.colptr(j));
+    }
+};
+
+
+
+#endif // BASIS_PRODUCT_H
@@ -0,0 +1,127 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <vector>     // std::vector
+#include <algorithm>  // std::min
+#include <thread>     // std::thread
+#include <cstdint>    // uint64_t
+
+///
+/// \ingroup LinearAlgebra
+///
+/// A counter-based random number generator, used by the eigen solvers to
+/// draw their random vectors.
+///
+/// The i-th number of the stream is a hash of the seed and the counter i,
+/// using the output function of SplitMix64 (Steele, Lea and Flood, 2014).
+/// There is no state besides the seed and the counter, so
+///
+/// - each solver object owns its generator, and solvers in different
+///   threads neither share state nor need locks, and
+/// - any part of a random vector can be computed independently of the rest,
+///   so a long vector can be generated in parallel by row blocks, and the
+///   result does not depend on the number of blocks.
+///
+class CounterRNG
+{
+private:
+    uint64_t key;   // hashed seed
+    uint64_t ctr;   // position of the next number in the stream
+
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+public:
+    ///
+    /// Constructor to create a generator with a given seed.
+    ///
+    CounterRNG(uint64_t seed_ = 0)
+    {
+        seed(seed_);
+    }
+
+    ///
+    /// Reset the generator with a new seed, and move to the start of the stream.
+    ///
+    void seed(uint64_t s)
+    {
+        // The seed is hashed, so that nearby seeds give unrelated streams
+        key = mix(s + 0x9e3779b97f4a7c15ULL);
+        ctr = 0;
+    }
+
+    ///
+    /// Return the position of the next number in the stream.
+    ///
+    uint64_t counter() const { return ctr; }
+
+    ///
+    /// Skip the next `n` numbers of the stream.
+    ///
+    void skip(uint64_t n) { ctr += n; }
+
+    ///
+    /// Return the i-th number of the stream, following Uniform(-0.5, 0.5),
+    /// without moving the counter.
+    ///
+    double uniform_at(uint64_t i) const
+    {
+        // 53 random bits give a double in [0, 1)
+        const uint64_t z = mix(key + (i + 1) * 0x9e3779b97f4a7c15ULL);
+        return double(z >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+    }
+
+    ///
+    /// Fill the elements `start` to `end - 1` of a vector with the same
+    /// numbers that uniform() would write to them, without moving the
+    /// counter. This is the building block of the parallel generation.
+    ///
+    template <typename Scalar>
+    void uniform_rows(Scalar *x, int start, int end) const
+    {
+        for(int i = start; i < end; i++)
+            x[i] = Scalar(uniform_at(ctr + i));
+    }
+
+    ///
+    /// Fill a vector with random numbers following Uniform(-0.5, 0.5),
+    /// and move the counter past them.
+    ///
+    /// \param x       Pointer to the vector.
+    /// \param n       Length of the vector.
+    /// \param nthread Number of threads. The rows are split into contiguous
+    ///                blocks, one for each thread, and the result is the same
+    ///                for any number of threads.
+    ///
+    template <typename Scalar>
+    void uniform(Scalar *x, int n, int nthread = 1)
+    {
+        nthread = std::max(1, std::min(nthread, n));
+        if(nthread == 1)
+        {
+            uniform_rows(x, 0, n);
+        } else {
+            std::vector<std::thread> pool;
+            for(int t = 1; t < nthread; t++)
+                pool.push_back(std::thread(&CounterRNG::uniform_rows<Scalar>, this,
+                                           x, (n * t) / nthread, (n * (t + 1)) / nthread));
+            uniform_rows(x, 0, n / nthread);
+            for(size_t t = 0; t < pool.size(); t++)
+                pool[t].join();
+        }
+        ctr += n;
+    }
+};
+
+
+#endif // COUNTER_RNG_H
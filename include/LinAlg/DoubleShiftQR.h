@@ -32,6 +32,8 @@ private:
                         // 3 - A general reflector
                         // 2 - A Givens rotation
                         // 1 - An identity transformation
+    std::vector<int> zero_ind;  // Indices of zero elements in the subdiagonal,
+                                // kept as a member to reuse its memory
     const Scalar prec;  // Approximately zero
     const Scalar eps_rel;
     const Scalar eps_abs;
@@ -275,8 +277,8 @@ public:
 
         // Obtain the indices of zero elements in the subdiagonal,
         // so that H can be divided into several blocks
-        std::vector<int> zero_ind;
-        zero_ind.reserve(n - 1);
+        zero_ind.clear();
+        zero_ind.reserve(n + 1);
         zero_ind.push_back(0);
         Scalar *Hii = mat_H.memptr();
         for(Index i = 0; i < n - 2; i++, Hii += (n + 1))
@@ -313,6 +315,16 @@ public:
         return mat_H;
     }
 
+    // Copy Q'HQ to an existing matrix, which does not allocate
+    // memory if dest already has the correct size
+    void matrix_QtHQ(Matrix &dest)
+    {
+        if(!computed)
+            throw std::logic_error("DoubleShiftQR: need to call compute() first");
+
+        dest = mat_H;
+    }
+
     // Q = P0 * P1 * ...
     // Q'y = P_{n-2} * ... * P1 * P0 * y
     void apply_QtY(Vector &y)
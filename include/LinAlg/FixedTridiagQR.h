@@ -0,0 +1,161 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef FIXED_TRIDIAG_QR_H
+#define FIXED_TRIDIAG_QR_H
+
+#include <armadillo>
+#include <cmath>      // std::sqrt
+#include <algorithm>  // std::fill
+#include <limits>     // std::numeric_limits
+
+/// \cond
+
+// Type of the small ncv x ncv matrices of the solvers: a fixed-size
+// matrix stored inside the object if N > 0, and a dynamic one otherwise
+template <typename Scalar, int N>
+struct SmallMatrixType
+{
+    typedef typename arma::Mat<Scalar>::template fixed<N, N> type;
+};
+
+template <typename Scalar>
+struct SmallMatrixType<Scalar, 0>
+{
+    typedef arma::Mat<Scalar> type;
+};
+
+/// \endcond
+
+///
+/// \ingroup LinearAlgebra
+///
+/// Perform the shifted QR steps of the implicit restart on a symmetric
+/// tridiagonal matrix whose size `N` is known at compile time.
+///
+/// The arithmetic is the same as TridiagQR::compute(), TridiagQR::apply_YQ()
+/// and TridiagQR::matrix_RQ(), but the matrix is kept as its diagonals in
+/// arrays inside the object, and all the loops have compile-time trip counts,
+/// so that the compiler can unroll and vectorize them. Nothing is allocated.
+/// It is meant for small sizes, e.g. \f$N\le 32\f$.
+///
+/// \tparam Scalar The element type of the matrix.
+/// \tparam N      The size of the matrix.
+///
+template <typename Scalar, int N>
+class FixedTridiagQR
+{
+private:
+    Scalar diag[N];     // main diagonal of the matrix
+    Scalar sub[N];      // sub-diagonal of the matrix, the last element unused
+    Scalar super[N];    // first super-diagonal of R, the last element unused
+    Scalar rot_cos[N];  // Gi = [ cos[i]  sin[i]]
+    Scalar rot_sin[N];  //      [-sin[i]  cos[i]]
+
+public:
+    ///
+    /// Read the diagonal and the sub-diagonal of a matrix.
+    ///
+    /// \param H Pointer to an \f$N\times N\f$ matrix stored in column-major order.
+    ///
+    void load(const Scalar *H)
+    {
+        for(int i = 0; i < N; i++)
+            diag[i] = H[i * N + i];
+        for(int i = 0; i < N - 1; i++)
+            sub[i] = H[i * N + i + 1];
+        sub[N - 1] = Scalar(0);
+    }
+
+    ///
+    /// Write the tridiagonal matrix to a dense matrix, zeroing the other elements.
+    ///
+    /// \param H Pointer to an \f$N\times N\f$ matrix stored in column-major order.
+    ///
+    void store(Scalar *H) const
+    {
+        std::fill(H, H + N * N, Scalar(0));
+        for(int i = 0; i < N; i++)
+            H[i * N + i] = diag[i];
+        for(int i = 0; i < N - 1; i++)
+        {
+            H[i * N + i + 1] = sub[i];
+            H[(i + 1) * N + i] = sub[i];
+        }
+    }
+
+    ///
+    /// Apply one shifted QR step to the matrix \f$T\f$:
+    /// with \f$T-\mu I=QR\f$, \f$T\f$ is overwritten by \f$RQ+\mu I\f$.
+    ///
+    /// \param mu The shift.
+    /// \param Y  Pointer to an \f$N\times N\f$ matrix stored in column-major order,
+    ///           overwritten by \f$YQ\f$.
+    ///
+    void shift(Scalar mu, Scalar *Y)
+    {
+        const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+
+        // QR decomposition of T - mu * I, as in TridiagQR::compute()
+        // diag is overwritten by the diagonal of R, and super by its
+        // first super-diagonal
+        for(int i = 0; i < N; i++)
+            diag[i] -= mu;
+        for(int i = 0; i < N - 1; i++)
+            super[i] = sub[i];
+
+        for(int i = 0; i < N - 1; i++)
+        {
+            Scalar r = std::sqrt(diag[i] * diag[i] + sub[i] * sub[i]);
+            Scalar c, s;
+            if(r <= eps)
+            {
+                r = 0;
+                c = 1;
+                s = 0;
+            } else {
+                c =  diag[i] / r;
+                s = -sub[i] / r;
+            }
+            rot_cos[i] = c;
+            rot_sin[i] = s;
+
+            diag[i] = r;
+            const Scalar tmp = super[i];
+            super[i] = c * tmp - s * diag[i + 1];
+            diag[i + 1] = s * tmp + c * diag[i + 1];
+            if(i < N - 2)
+                super[i + 1] *= c;
+        }
+
+        // Y -> YQ = Y * G1 * G2 * ..., as in TridiagQR::apply_YQ()
+        for(int i = 0; i < N - 1; i++)
+        {
+            const Scalar c = rot_cos[i], s = rot_sin[i];
+            Scalar *Yi = Y + i * N, *Yi1 = Yi + N;
+            for(int j = 0; j < N; j++)
+            {
+                const Scalar tmp = Yi[j];
+                Yi[j]  = c * tmp - s * Yi1[j];
+                Yi1[j] = s * tmp + c * Yi1[j];
+            }
+        }
+
+        // T -> RQ + mu * I, as in TridiagQR::matrix_RQ()
+        for(int i = 0; i < N - 1; i++)
+        {
+            const Scalar c = rot_cos[i], s = rot_sin[i];
+            diag[i] = c * diag[i] - s * super[i];
+            sub[i] = -s * diag[i + 1];
+            diag[i + 1] *= c;
+        }
+        for(int i = 0; i < N; i++)
+            diag[i] += mu;
+    }
+};
+
+
+#endif // FIXED_TRIDIAG_QR_H
@@ -37,6 +37,10 @@ namespace arma
         #define arma_strevc strevc
         #define arma_dtrevc dtrevc
 
+        // Reordering a Schur form matrix
+        #define arma_strsen strsen
+        #define arma_dtrsen dtrsen
+
     #else
 
         #define arma_ssytrs SSYTRS
@@ -58,6 +62,9 @@ namespace arma
         #define arma_strevc STREVC
         #define arma_dtrevc DTREVC
 
+        #define arma_strsen STRSEN
+        #define arma_dtrsen DTRSEN
+
     #endif
 
 
@@ -82,6 +89,9 @@ namespace arma
 
         void arma_fortran(arma_strevc)(char* side, char* howmny, blas_int* select, blas_int* n, float*  t, blas_int* ldt, float*  vl, blas_int* ldvl, float*  vr, blas_int* ldvr, blas_int* mm, blas_int* m, float*  work, blas_int* info);
         void arma_fortran(arma_dtrevc)(char* side, char* howmny, blas_int* select, blas_int* n, double* t, blas_int* ldt, double* vl, blas_int* ldvl, double* vr, blas_int* ldvr, blas_int* mm, blas_int* m, double* work, blas_int* info);
+
+        void arma_fortran(arma_strsen)(char* job, char* compq, blas_int* select, blas_int* n, float*  t, blas_int* ldt, float*  q, blas_int* ldq, float*  wr, float*  wi, blas_int* m, float*  s, float*  sep, float*  work, blas_int* lwork, blas_int* iwork, blas_int* liwork, blas_int* info);
+        void arma_fortran(arma_dtrsen)(char* job, char* compq, blas_int* select, blas_int* n, double* t, blas_int* ldt, double* q, blas_int* ldq, double* wr, double* wi, blas_int* m, double* s, double* sep, double* work, blas_int* lwork, blas_int* iwork, blas_int* liwork, blas_int* info);
     }
 
 
@@ -206,6 +216,25 @@ namespace arma
                 arma_fortran(arma_dtrevc)(side, howmny, select, n, (T*)t, ldt, (T*)vl, ldvl, (T*)vr, ldvr, mm, m, (T*)work, info);
             }
         }
+
+        template<typename eT>
+        inline
+        void
+        trsen(char* job, char* compq, blas_int* select, blas_int* n, eT* t, blas_int* ldt, eT* q, blas_int* ldq, eT* wr, eT* wi, blas_int* m, eT* s, eT* sep, eT* work, blas_int* lwork, blas_int* iwork, blas_int* liwork, blas_int* info)
+        {
+            arma_type_check(( is_supported_blas_type<eT>::value == false ));
+            if(is_float<eT>::value == true)
+            {
+                typedef float T;
+                arma_fortran(arma_strsen)(job, compq, select, n, (T*)t, ldt, (T*)q, ldq, (T*)wr, (T*)wi, m, (T*)s, (T*)sep, (T*)work, lwork, iwork, liwork, info);
+            }
+            else
+            if(is_double<eT>::value == true)
+            {
+                typedef double T;
+                arma_fortran(arma_dtrsen)(job, compq, select, n, (T*)t, ldt, (T*)q, ldq, (T*)wr, (T*)wi, m, (T*)s, (T*)sep, (T*)work, lwork, iwork, liwork, info);
+            }
+        }
     }
 
 
@@ -0,0 +1,197 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef REAL_SCHUR_H
+#define REAL_SCHUR_H
+
+#include <armadillo>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include "LapackWrapperExtra.h"
+
+///
+/// \ingroup LinearAlgebra
+///
+/// Compute and reorder the real Schur decomposition of a general real matrix.
+///
+/// For a real square matrix \f$A\f$, the real Schur decomposition is \f$A=UTU'\f$,
+/// where \f$U\f$ is orthogonal and \f$T\f$ is quasi-upper triangular, i.e.,
+/// block upper triangular with \f$1\times 1\f$ and \f$2\times 2\f$ diagonal blocks.
+/// Each \f$2\times 2\f$ block corresponds to a pair of complex conjugate eigenvalues.
+///
+/// \tparam Scalar The element type of the matrix.
+/// Currently supported types are `float` and `double`.
+///
+/// The decomposition is computed by `arma::schur()`, and the reordering
+/// is a wrapper of the Lapack function `_trsen`.
+///
+template <typename Scalar = double>
+class RealSchur
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Col<Complex> ComplexVector;
+
+    int n;
+    Matrix mat_U;  // A = UTU', U is an orthogonal matrix
+    Matrix mat_T;  // T is a quasi-upper triangular matrix
+
+    bool computed;
+
+public:
+    ///
+    /// Default constructor. Computation can
+    /// be performed later by calling the compute() method.
+    ///
+    RealSchur() :
+        n(0), computed(false)
+    {}
+
+    ///
+    /// Constructor to create an object that calculates the real Schur
+    /// decomposition of a matrix `mat`.
+    ///
+    /// \param mat Matrix type can be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    RealSchur(const Matrix &mat) :
+        n(mat.n_rows), computed(false)
+    {
+        compute(mat);
+    }
+
+    ///
+    /// Compute the real Schur decomposition of a matrix.
+    ///
+    /// \param mat Matrix type can be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    void compute(const Matrix &mat)
+    {
+        if(!mat.is_square())
+            throw std::invalid_argument("RealSchur: matrix must be square");
+
+        n = mat.n_rows;
+        if(!arma::schur(mat_U, mat_T, mat))
+            throw std::logic_error("RealSchur: failed to compute the Schur decomposition");
+
+        computed = true;
+    }
+
+    ///
+    /// Retrieve the eigenvalues, in the order that they appear on the
+    /// diagonal of \f$T\f$. Complex conjugate eigenvalues are stored
+    /// consecutively, with the one with positive imaginary part first.
+    ///
+    /// \return Returned vector type will be `arma::cx_vec` or `arma::cx_fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    ComplexVector eigenvalues()
+    {
+        if(!computed)
+            throw std::logic_error("RealSchur: need to call compute() first");
+
+        ComplexVector evals(n);
+        for(int i = 0; i < n; i++)
+        {
+            if(i < n - 1 && mat_T(i + 1, i) != Scalar(0))
+            {
+                // In the standardized form, a 2x2 block [a b; c a]
+                // has the eigenvalues a +/- sqrt(-bc) * i, with bc < 0
+                Scalar re = mat_T(i, i);
+                Scalar im = std::sqrt(std::abs(mat_T(i, i + 1))) *
+                            std::sqrt(std::abs(mat_T(i + 1, i)));
+                evals[i] = Complex(re, im);
+                evals[i + 1] = Complex(re, -im);
+                i++;
+            } else {
+                evals[i] = Complex(mat_T(i, i), 0);
+            }
+        }
+
+        return evals;
+    }
+
+    ///
+    /// Reorder the Schur decomposition, so that a selected set of
+    /// eigenvalues appear in the leading diagonal blocks of \f$T\f$.
+    /// \f$T\f$ and \f$U\f$ are updated accordingly.
+    ///
+    /// \param select A vector of length \f$n\f$, in which a nonzero `select[i]`
+    /// indicates that the eigenvalue on the i-th diagonal position of \f$T\f$
+    /// is selected. A \f$2\times 2\f$ diagonal block is always moved as a whole,
+    /// so selecting either eigenvalue of a conjugate pair selects both.
+    ///
+    /// \return The number of selected eigenvalues, i.e., the dimension of the
+    /// leading invariant subspace spanned by the first columns of \f$U\f$.
+    ///
+    int reorder(const std::vector<int> &select)
+    {
+        if(!computed)
+            throw std::logic_error("RealSchur: need to call compute() first");
+
+        if((int) select.size() != n)
+            throw std::invalid_argument("RealSchur: select must have the same length as the matrix dimension");
+
+        std::vector<int> sel(select);
+        char job = 'N', compq = 'V';
+        Vector wr(n), wi(n);
+        Scalar s, sep;
+        int m, info;
+        // With job = 'N', lwork >= max(1, n) and liwork >= 1
+        int lwork = std::max(1, n), liwork = 1, iwork;
+        Vector work(lwork);
+
+        arma::lapack::trsen(&job, &compq, &sel[0], &n, mat_T.memptr(), &n,
+                            mat_U.memptr(), &n, wr.memptr(), wi.memptr(), &m,
+                            &s, &sep, work.memptr(), &lwork, &iwork, &liwork, &info);
+
+        if(info < 0)
+            throw std::invalid_argument("Lapack trsen: illegal value");
+        if(info > 0)
+            throw std::logic_error("Lapack trsen: failed to reorder the Schur form, since the eigenvalues are too close");
+
+        return m;
+    }
+
+    ///
+    /// Retrieve the quasi-upper triangular matrix \f$T\f$.
+    ///
+    /// \return Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    Matrix matrix_T()
+    {
+        if(!computed)
+            throw std::logic_error("RealSchur: need to call compute() first");
+
+        return mat_T;
+    }
+
+    ///
+    /// Retrieve the orthogonal matrix \f$U\f$ of Schur vectors.
+    ///
+    /// \return Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    Matrix matrix_U()
+    {
+        if(!computed)
+            throw std::logic_error("RealSchur: need to call compute() first");
+
+        return mat_U;
+    }
+};
+
+
+
+#endif // REAL_SCHUR_H
@@ -124,6 +124,49 @@ public:
         if(info < 0)
             throw std::invalid_argument("Lapack sytrs: illegal value");
     }
+
+    ///
+    /// Return the number of negative eigenvalues of the matrix factorized.
+    ///
+    /// By Sylvester's law of inertia, \f$A=LDL'\f$ has the same numbers of
+    /// positive and negative eigenvalues as the block diagonal matrix \f$D\f$,
+    /// which only consists of \f$1\times 1\f$ and \f$2\times 2\f$ blocks.
+    /// In particular, if the matrix factorized is \f$A-\sigma I\f$, this is the
+    /// number of eigenvalues of \f$A\f$ that are less than \f$\sigma\f$.
+    ///
+    int num_negative()
+    {
+        if(!computed)
+            throw std::logic_error("SymmetricLDL: need to call compute() first");
+
+        int nneg = 0;
+        for(int i = 0; i < dim_n; i++)
+        {
+            // A 1x1 block is indicated by a positive pivot index
+            if(vec_fac[i] > 0)
+            {
+                if(mat_fac(i, i) < Scalar(0))
+                    nneg++;
+                continue;
+            }
+
+            // A 2x2 block [a b; b c], with the off-diagonal element stored
+            // in the triangular part being used
+            const Scalar a = mat_fac(i, i);
+            const Scalar b = (mat_uplo == 'L') ? mat_fac(i + 1, i) : mat_fac(i, i + 1);
+            const Scalar c = mat_fac(i + 1, i + 1);
+            const Scalar det = a * c - b * b;
+            // A negative determinant means one positive and one negative eigenvalue,
+            // otherwise both have the sign of a
+            if(det < Scalar(0))
+                nneg++;
+            else if(a < Scalar(0))
+                nneg += 2;
+            i++;
+        }
+
+        return nneg;
+    }
 };
 
 
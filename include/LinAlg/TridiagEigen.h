@@ -8,6 +8,7 @@
 #define TRIDIAG_EIGEN_H
 
 #include <armadillo>
+#include <vector>
 #include <stdexcept>
 #include "LapackWrapperExtra.h"
 
@@ -32,6 +33,8 @@ private:
     Vector main_diag;     // Main diagonal elements of the matrix
     Vector sub_diag;      // Sub-diagonal elements of the matrix
     Matrix evecs;         // To store eigenvectors
+    Vector work;          // Workspace of stedc, reused by later calls of compute()
+    std::vector<int> iwork;
 
     bool computed;
 
@@ -97,14 +100,15 @@ public:
             liwork = 3 + 5 * n;
         }
 
-        Scalar *work = new Scalar[lwork];
-        int *iwork = new int[liwork];
+        // Only grow the workspace, so repeated calls with the same
+        // matrix size do not allocate memory
+        if((int) work.n_elem < lwork)
+            work.set_size(lwork);
+        if((int) iwork.size() < liwork)
+            iwork.resize(liwork);
 
         arma::lapack::stedc(&compz, &n, main_diag.memptr(), sub_diag.memptr(),
-                            evecs.memptr(), &n, work, &lwork, iwork, &liwork, &info);
-
-        delete [] work;
-        delete [] iwork;
+                            evecs.memptr(), &n, work.memptr(), &lwork, &iwork[0], &liwork, &info);
 
         if(info < 0)
             throw std::invalid_argument("Lapack stedc: illegal value");
@@ -120,7 +124,7 @@ public:
     /// \return Returned vector type will be `arma::vec` or `arma::fvec`, depending on
     /// the template parameter `Scalar` defined.
     ///
-    Vector eigenvalues()
+    const Vector& eigenvalues()
     {
         if(!computed)
             throw std::logic_error("TridiagEigen: need to call compute() first");
@@ -135,7 +139,7 @@ public:
     /// \return Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
     /// the template parameter `Scalar` defined.
     ///
-    Matrix eigenvectors()
+    const Matrix& eigenvectors()
     {
         if(!computed)
             throw std::logic_error("TridiagEigen: need to call compute() first");
@@ -40,6 +40,10 @@ private:
                           // In the second stage, Z will be overwritten by the eigenvectors of H
     Matrix mat_T;         // H = ZTZ', T is a Schur form matrix
     ComplexVector evals;  // eigenvalues of H
+    ComplexMatrix evecs;  // eigenvectors of H
+    Vector wr;            // Workspace of lahqr and trevc, reused
+    Vector wi;            // by later calls of compute()
+    Vector work;
 
     bool computed;
 
@@ -94,32 +98,30 @@ public:
         // mat_T = mat;
         std::copy(mat.memptr(), mat.memptr() + mat.n_elem, mat_T.memptr());
 
+        wr.set_size(n);
+        wi.set_size(n);
+        work.set_size(3 * n);
+
         int want_T = 1, want_Z = 1;
         int ilo = 1, ihi = n, iloz = 1, ihiz = n;
-        Scalar *wr = new Scalar[n];
-        Scalar *wi = new Scalar[n];
         int info;
         arma::lapack::lahqr(&want_T, &want_Z, &n, &ilo, &ihi,
-                            mat_T.memptr(), &n, wr, wi, &iloz, &ihiz,
+                            mat_T.memptr(), &n, wr.memptr(), wi.memptr(), &iloz, &ihiz,
                             mat_Z.memptr(), &n, &info);
 
         for(int i = 0; i < n; i++)
         {
             evals[i] = Complex(wr[i], wi[i]);
         }
-        delete [] wr;
-        delete [] wi;
 
         if(info > 0)
             throw std::logic_error("Lapack lahqr: failed to compute all the eigenvalues");
 
         char side = 'R', howmny = 'B';
-        Scalar *work = new Scalar[3 * n];
         int m;
 
         arma::lapack::trevc(&side, &howmny, (int*) NULL, &n, mat_T.memptr(), &n,
-                            (Scalar*) NULL, &n, mat_Z.memptr(), &n, &n, &m, work, &info);
-        delete [] work;
+                            (Scalar*) NULL, &n, mat_Z.memptr(), &n, &n, &m, work.memptr(), &info);
 
         if(info < 0)
             throw std::invalid_argument("Lapack trevc: illegal value");
@@ -133,7 +135,7 @@ public:
     /// \return Returned vector type will be `arma::cx_vec` or `arma::cx_fvec`, depending on
     /// the template parameter `Scalar` defined.
     ///
-    ComplexVector eigenvalues()
+    const ComplexVector& eigenvalues()
     {
         if(!computed)
             throw std::logic_error("UpperHessenbergEigen: need to call compute() first");
@@ -147,13 +149,13 @@ public:
     /// \return Returned matrix type will be `arma::cx_mat` or `arma::cx_fmat`, depending on
     /// the template parameter `Scalar` defined.
     ///
-    ComplexMatrix eigenvectors()
+    const ComplexMatrix& eigenvectors()
     {
         if(!computed)
             throw std::logic_error("UpperHessenbergEigen: need to call compute() first");
 
         Scalar prec = std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3);
-        ComplexMatrix evecs(n, n);
+        evecs.set_size(n, n);
         Complex *col_ptr = evecs.memptr();
         for(int i = 0; i < n; i++)
         {
@@ -159,12 +159,29 @@ public:
     /// the template parameter `Scalar` defined.
     ///
     virtual Matrix matrix_RQ()
+    {
+        Matrix RQ;
+        matrix_RQ(RQ);
+
+        return RQ;
+    }
+
+    ///
+    /// Compute the \f$RQ\f$ matrix and write it to an existing matrix.
+    /// No memory is allocated if `RQ` already has the correct size.
+    ///
+    /// \param RQ A matrix that will be overwritten by \f$RQ\f$.
+    ///
+    /// Matrix type can be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    virtual void matrix_RQ(Matrix &RQ)
     {
         if(!computed)
             throw std::logic_error("UpperHessenbergQR: need to call compute() first");
 
         // Make a copy of the R matrix
-        Matrix RQ = arma::trimatu(mat_T);
+        RQ = arma::trimatu(mat_T);
 
         Scalar *c = rot_cos.memptr(),
                *s = rot_sin.memptr();
@@ -190,8 +207,6 @@ public:
             c++;
             s++;
         }
-
-        return RQ;
     }
 
     ///
@@ -537,12 +552,29 @@ public:
     /// the template parameter `Scalar` defined.
     ///
     Matrix matrix_RQ()
+    {
+        Matrix RQ;
+        matrix_RQ(RQ);
+
+        return RQ;
+    }
+
+    ///
+    /// Compute the \f$RQ\f$ matrix and write it to an existing matrix.
+    /// No memory is allocated if `RQ` already has the correct size.
+    ///
+    /// \param RQ A matrix that will be overwritten by \f$RQ\f$.
+    ///
+    /// Matrix type can be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    void matrix_RQ(Matrix &RQ)
     {
         if(!this->computed)
             throw std::logic_error("TridiagQR: need to call compute() first");
 
         // Make a copy of the R matrix
-        Matrix RQ(this->n, this->n, arma::fill::zeros);
+        RQ.zeros(this->n, this->n);
         RQ.diag() = this->mat_T.diag();
         RQ.diag(1) = this->mat_T.diag(1);
 
@@ -571,9 +603,10 @@ public:
         }
 
         // Copy the below-subdiagonal to above-subdiagonal
-        RQ.diag(1) = RQ.diag(-1);
-
-        return RQ;
+        // Done element-wise, since assigning a diagonal of RQ
+        // to another one would create a temporary copy
+        for(Index i = 0; i < this->n - 1; i++)
+            RQ(i, i + 1) = RQ(i + 1, i);
     }
 };
 
@@ -0,0 +1,119 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DENSE_CHOLESKY_H
+#define DENSE_CHOLESKY_H
+
+#include <armadillo>
+#include <algorithm>  // std::copy
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the operations related to the Cholesky decomposition of a
+/// dense positive definite matrix \f$B=LL'\f$: the product \f$y=Bx\f$, the solve
+/// \f$y=B^{-1}x\f$, and the triangular solves \f$y=L^{-1}x\f$ and \f$y=(L')^{-1}x\f$.
+/// It is mainly used as the `BOpType` of the SymGEigsSolver eigen solver, in all of
+/// its modes.
+///
+template <typename Scalar>
+class DenseCholesky
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    const Matrix mat;
+    const int dim_n;
+    Matrix mat_U;         // upper triangular factor, B = U' * U, so L = U'
+
+    // Solve U * y = x (trans = 'N') or U' * y = x (trans = 'T') in place
+    void triangular_solve(char trans, Scalar *y)
+    {
+        char uplo = 'U', diag = 'N';
+        arma::blas_int n = dim_n, nrhs = 1, info;
+        arma::lapack::trtrs(&uplo, &trans, &diag, &n, &nrhs, mat_U.memptr(), &n, y, &n, &info);
+        if(info != 0)
+            throw std::logic_error("DenseCholesky: failed to solve the triangular system");
+    }
+
+public:
+    ///
+    /// Constructor to create the matrix operation object.
+    ///
+    /// \param mat_ An **Armadillo** matrix object, whose type can be `arma::mat`
+    ///             or `arma::fmat`, depending on the template parameter `Scalar` defined.
+    ///             The matrix must be symmetric positive definite.
+    ///
+    DenseCholesky(Matrix &mat_) :
+        mat(mat_.memptr(), mat_.n_rows, mat_.n_cols, false),
+        dim_n(mat_.n_rows)
+    {
+        if(!mat_.is_square())
+            throw std::invalid_argument("DenseCholesky: matrix must be square");
+
+        if(!arma::chol(mat_U, mat_))
+            throw std::logic_error("DenseCholesky: matrix is not positive definite");
+    }
+
+    ///
+    /// Return the number of rows of the underlying matrix.
+    ///
+    int rows() { return dim_n; }
+    ///
+    /// Return the number of columns of the underlying matrix.
+    ///
+    int cols() { return dim_n; }
+
+    ///
+    /// Perform the matrix-vector multiplication operation \f$y=Bx\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = B * x_in
+    void perform_op(const Scalar *x_in, Scalar *y_out)
+    {
+        const Vector x(const_cast<Scalar *>(x_in), dim_n, false);
+        Vector y(y_out, dim_n, false);
+        y = mat * x;
+    }
+
+    ///
+    /// Perform the solve operation \f$y=B^{-1}x\f$.
+    ///
+    // y_out = inv(B) * x_in
+    void solve(const Scalar *x_in, Scalar *y_out)
+    {
+        std::copy(x_in, x_in + dim_n, y_out);
+        triangular_solve('T', y_out);
+        triangular_solve('N', y_out);
+    }
+
+    ///
+    /// Perform the lower triangular solve \f$y=L^{-1}x\f$.
+    ///
+    // y_out = inv(L) * x_in
+    void lower_triangular_solve(const Scalar *x_in, Scalar *y_out)
+    {
+        std::copy(x_in, x_in + dim_n, y_out);
+        triangular_solve('T', y_out);
+    }
+
+    ///
+    /// Perform the upper triangular solve \f$y=(L')^{-1}x\f$.
+    ///
+    // y_out = inv(L') * x_in
+    void upper_triangular_solve(const Scalar *x_in, Scalar *y_out)
+    {
+        std::copy(x_in, x_in + dim_n, y_out);
+        triangular_solve('N', y_out);
+    }
+};
+
+
+#endif // DENSE_CHOLESKY_H
@@ -0,0 +1,116 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DENSE_GEN_COMPLEX_SHIFT_SOLVE_H
+#define DENSE_GEN_COMPLEX_SHIFT_SOLVE_H
+
+#include <armadillo>
+#include <complex>
+#include <stdexcept>
+#include "../LinAlg/GeneralLU.h"
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the complex shift-solve operation on a general real matrix \f$A\f$,
+/// i.e., calculating \f$y=\mathrm{Re}\{(A-\sigma I)^{-1}x\}\f$ for any complex-valued
+/// \f$\sigma\f$ and real-valued vector \f$x\f$. The matrix \f$A-\sigma I\f$ is factorized
+/// once, in complex arithmetic, when the shift is set.
+/// It also provides the product \f$y=Ax\f$, which is used to recover the eigenvalues.
+/// It is mainly used in the GenEigsComplexShiftSolver eigen solver.
+///
+template <typename Scalar>
+class DenseGenComplexShiftSolve
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    typedef std::complex<Scalar> Complex;
+    typedef arma::Mat<Complex> ComplexMatrix;
+    typedef arma::Col<Complex> ComplexVector;
+
+    const Matrix mat;
+    const int dim_n;
+    GeneralLU<Complex> solver;
+    ComplexVector x_cache;
+    ComplexVector y_cache;
+public:
+    ///
+    /// Constructor to create the matrix operation object.
+    ///
+    /// \param mat_ An **Armadillo** matrix object, whose type can be `arma::mat`
+    ///             or `arma::fmat`, depending on the template parameter `Scalar` defined.
+    ///
+    DenseGenComplexShiftSolve(Matrix &mat_) :
+        mat(mat_.memptr(), mat_.n_rows, mat_.n_cols, false),
+        dim_n(mat_.n_rows),
+        x_cache(mat_.n_rows),
+        y_cache(mat_.n_rows)
+    {
+        if(!mat_.is_square())
+            throw std::invalid_argument("DenseGenComplexShiftSolve: matrix must be square");
+    }
+
+    ///
+    /// Return the number of rows of the underlying matrix.
+    ///
+    int rows() { return dim_n; }
+    ///
+    /// Return the number of columns of the underlying matrix.
+    ///
+    int cols() { return dim_n; }
+
+    ///
+    /// Set the complex shift \f$\sigma\f$.
+    ///
+    /// \param sigmar Real part of \f$\sigma\f$.
+    /// \param sigmai Imaginary part of \f$\sigma\f$.
+    ///
+    void set_shift(Scalar sigmar, Scalar sigmai)
+    {
+        ComplexMatrix cmat(dim_n, dim_n);
+        cmat.set_real(mat);
+        cmat.set_imag(Matrix(dim_n, dim_n, arma::fill::zeros));
+        cmat.diag() -= Complex(sigmar, sigmai);
+        solver.compute(cmat);
+    }
+
+    ///
+    /// Perform the complex shift-solve operation
+    /// \f$y=\mathrm{Re}\{(A-\sigma I)^{-1}x\}\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = Re( inv(A - sigma * I) * x_in )
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        Vector x(x_in,  dim_n, false);
+        Vector y(y_out, dim_n, false);
+        x_cache.set_real(x);
+        x_cache.set_imag(Vector(dim_n, arma::fill::zeros));
+        solver.solve(x_cache, y_cache);
+        y = arma::real(y_cache);
+    }
+
+    ///
+    /// Perform the matrix-vector multiplication operation \f$y=Ax\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = A * x_in
+    void mat_prod(Scalar *x_in, Scalar *y_out)
+    {
+        Vector x(x_in,  dim_n, false);
+        Vector y(y_out, dim_n, false);
+        y = mat * x;
+    }
+};
+
+
+#endif // DENSE_GEN_COMPLEX_SHIFT_SOLVE_H
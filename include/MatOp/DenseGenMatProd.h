@@ -21,7 +21,10 @@
 /// This class defines the matrix-vector multiplication operation on a
 /// general real matrix \f$A\f$, i.e., calculating \f$y=Ax\f$ for any vector
 /// \f$x\f$. It is mainly used in the GenEigsSolver and
-/// SymEigsSolver eigen solvers.
+/// SymEigsSolver eigen solvers, and in the PartialSVDSolver singular value solver.
+///
+/// With `Scalar` being `std::complex<double>` or `std::complex<float>`, it
+/// wraps a complex matrix, and is used in the HermEigsSolver eigen solver.
 ///
 template <typename Scalar>
 class DenseGenMatProd
@@ -65,6 +68,41 @@ public:
         Vector y(y_out, mat.n_rows, false);
         y = mat * x;
     }
+
+    ///
+    /// Perform the transpose matrix-vector multiplication operation \f$y=A'x\f$.
+    /// For complex matrices this is the conjugate transpose.
+    /// It is used by the PartialSVDSolver singular value solver.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector, of length `rows()`.
+    /// \param y_out Pointer to the \f$y\f$ vector, of length `cols()`.
+    ///
+    // y_out = A' * x_in
+    void perform_op_t(Scalar *x_in, Scalar *y_out)
+    {
+        Vector x(x_in, mat.n_rows, false);
+        Vector y(y_out, mat.n_cols, false);
+        y = mat.t() * x;
+    }
+
+    ///
+    /// Perform the matrix-matrix multiplication operation \f$Y=AX\f$.
+    ///
+    /// This is used by the block eigen solvers, which apply the matrix to
+    /// several vectors at once, so that the matrix only needs to be read
+    /// once for all the columns of \f$X\f$.
+    ///
+    /// \param x_in  Pointer to the \f$X\f$ matrix, stored in column-major order.
+    /// \param y_out Pointer to the \f$Y\f$ matrix, stored in column-major order.
+    /// \param ncols Number of columns of \f$X\f$ and \f$Y\f$.
+    ///
+    // Y_out = A * X_in
+    void perform_op(const Scalar *x_in, Scalar *y_out, int ncols)
+    {
+        const Matrix x(const_cast<Scalar *>(x_in), mat.n_cols, ncols, false);
+        Matrix y(y_out, mat.n_rows, ncols, false);
+        y = mat * x;
+    }
 };
 
 
@@ -0,0 +1,97 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DENSE_SYM_G_SHIFT_SOLVE_H
+#define DENSE_SYM_G_SHIFT_SOLVE_H
+
+#include <armadillo>
+#include <stdexcept>
+#include "../LinAlg/SymmetricLDL.h"
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the shift-solve operation of a generalized eigen problem
+/// \f$Ax=\lambda Bx\f$ with real symmetric matrices, i.e., calculating
+/// \f$y=(A-\sigma B)^{-1}x\f$ for any real \f$\sigma\f$ and vector \f$x\f$.
+/// It is mainly used in the SymGEigsSolver eigen solver, in the shift-and-invert mode.
+///
+template <typename Scalar>
+class DenseSymGShiftSolve
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    const Matrix mat_A;
+    const Matrix mat_B;
+    const int dim_n;
+    SymmetricLDL<Scalar> solver;
+public:
+    ///
+    /// Constructor to create the matrix operation object.
+    ///
+    /// \param A_ An **Armadillo** matrix object, whose type can be `arma::mat`
+    ///           or `arma::fmat`, depending on the template parameter `Scalar` defined.
+    /// \param B_ An **Armadillo** matrix object of the same type and size.
+    ///
+    DenseSymGShiftSolve(Matrix &A_, Matrix &B_) :
+        mat_A(A_.memptr(), A_.n_rows, A_.n_cols, false),
+        mat_B(B_.memptr(), B_.n_rows, B_.n_cols, false),
+        dim_n(A_.n_rows)
+    {
+        if(!A_.is_square())
+            throw std::invalid_argument("DenseSymGShiftSolve: matrix must be square");
+
+        if(B_.n_rows != A_.n_rows || B_.n_cols != A_.n_cols)
+            throw std::invalid_argument("DenseSymGShiftSolve: A and B must have the same size");
+    }
+
+    ///
+    /// Return the number of rows of the underlying matrix.
+    ///
+    int rows() { return dim_n; }
+    ///
+    /// Return the number of columns of the underlying matrix.
+    ///
+    int cols() { return dim_n; }
+
+    ///
+    /// Set the real shift \f$\sigma\f$.
+    ///
+    void set_shift(Scalar sigma)
+    {
+        solver.compute(mat_A - sigma * mat_B);
+    }
+
+    ///
+    /// Return the number of eigenvalues of the problem that are less than the
+    /// current shift \f$\sigma\f$, computed from the inertia of the
+    /// factorization of \f$A-\sigma B\f$, when \f$B\f$ is positive definite.
+    /// set_shift() must have been called.
+    ///
+    int num_below_shift()
+    {
+        return solver.num_negative();
+    }
+
+    ///
+    /// Perform the shift-solve operation \f$y=(A-\sigma B)^{-1}x\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = inv(A - sigma * B) * x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        Vector x(x_in,  dim_n, false);
+        Vector y(y_out, dim_n, false);
+        solver.solve(x, y);
+    }
+};
+
+
+#endif // DENSE_SYM_G_SHIFT_SOLVE_H
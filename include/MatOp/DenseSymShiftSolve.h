@@ -60,6 +60,16 @@ public:
         solver.compute(mat - sigma * arma::eye<Matrix>(dim_n, dim_n));
     }
 
+    ///
+    /// Return the number of eigenvalues of \f$A\f$ that are less than the
+    /// current shift \f$\sigma\f$, computed from the inertia of the
+    /// factorization of \f$A-\sigma I\f$. set_shift() must have been called.
+    ///
+    int num_below_shift()
+    {
+        return solver.num_negative();
+    }
+
     ///
     /// Perform the shift-solve operation \f$y=(A-\sigma I)^{-1}x\f$.
     ///
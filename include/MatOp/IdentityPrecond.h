@@ -0,0 +1,68 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef IDENTITY_PRECOND_H
+#define IDENTITY_PRECOND_H
+
+#include <armadillo>
+#include <algorithm>  // std::copy
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the trivial preconditioner \f$T=I\f$, i.e., \f$y=x\f$.
+/// It is the default preconditioner type of LOBPCGSolver, and gives
+/// the unpreconditioned algorithm.
+///
+template <typename Scalar>
+class IdentityPrecond
+{
+private:
+    const int n;
+
+public:
+    ///
+    /// Constructor to create the preconditioner object.
+    ///
+    /// \param n_ Dimension of the matrix.
+    ///
+    IdentityPrecond(int n_) :
+        n(n_)
+    {}
+
+    ///
+    /// Return the number of rows of the preconditioner.
+    ///
+    int rows() { return n; }
+
+    ///
+    /// Apply the preconditioner to a vector, \f$y=x\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        std::copy(x_in, x_in + n, y_out);
+    }
+
+    ///
+    /// Apply the preconditioner to a block of vectors, \f$Y=X\f$.
+    ///
+    /// \param x_in  Pointer to the \f$X\f$ matrix, stored in column-major order.
+    /// \param y_out Pointer to the \f$Y\f$ matrix, stored in column-major order.
+    /// \param ncols Number of columns of \f$X\f$ and \f$Y\f$.
+    ///
+    // Y_out = X_in
+    void perform_op(const Scalar *x_in, Scalar *y_out, int ncols)
+    {
+        std::copy(x_in, x_in + n * ncols, y_out);
+    }
+};
+
+
+#endif // IDENTITY_PRECOND_H
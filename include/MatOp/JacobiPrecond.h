@@ -0,0 +1,93 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef JACOBI_PRECOND_H
+#define JACOBI_PRECOND_H
+
+#include <armadillo>
+#include <stdexcept>  // std::invalid_argument
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the Jacobi (diagonal) preconditioner of a matrix \f$A\f$,
+/// i.e., calculating \f$y=D^{-1}x\f$ for any vector \f$x\f$, where \f$D\f$ is
+/// the diagonal of \f$A\f$. It is mainly used in the LOBPCGSolver eigen solver.
+///
+/// Any class with the same public member functions can be used as a
+/// preconditioner, for example one based on an incomplete Cholesky factorization.
+///
+template <typename Scalar>
+class JacobiPrecond
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    Vector inv_diag;
+
+public:
+    ///
+    /// Constructor to create the preconditioner object.
+    ///
+    /// \param mat An **Armadillo** dense or sparse matrix object, for example of type
+    ///            `arma::mat` or `arma::sp_mat`, depending on the template parameter
+    ///            `Scalar` defined. Only its diagonal is used, which must be nonzero.
+    ///
+    template <typename MatType>
+    JacobiPrecond(const MatType &mat) :
+        inv_diag(mat.n_rows)
+    {
+        if(mat.n_rows != mat.n_cols)
+            throw std::invalid_argument("JacobiPrecond: matrix must be square");
+
+        for(int i = 0; i < int(mat.n_rows); i++)
+        {
+            const Scalar d = mat(i, i);
+            if(d == Scalar(0))
+                throw std::invalid_argument("JacobiPrecond: diagonal elements must be nonzero");
+            inv_diag[i] = Scalar(1) / d;
+        }
+    }
+
+    ///
+    /// Return the number of rows of the preconditioner.
+    ///
+    int rows() { return inv_diag.n_elem; }
+
+    ///
+    /// Apply the preconditioner to a vector, \f$y=D^{-1}x\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = inv(D) * x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        Vector x(x_in, inv_diag.n_elem, false);
+        Vector y(y_out, inv_diag.n_elem, false);
+        y = inv_diag % x;
+    }
+
+    ///
+    /// Apply the preconditioner to a block of vectors, \f$Y=D^{-1}X\f$.
+    ///
+    /// \param x_in  Pointer to the \f$X\f$ matrix, stored in column-major order.
+    /// \param y_out Pointer to the \f$Y\f$ matrix, stored in column-major order.
+    /// \param ncols Number of columns of \f$X\f$ and \f$Y\f$.
+    ///
+    // Y_out = inv(D) * X_in
+    void perform_op(const Scalar *x_in, Scalar *y_out, int ncols)
+    {
+        const Matrix x(const_cast<Scalar *>(x_in), inv_diag.n_elem, ncols, false);
+        Matrix y(y_out, inv_diag.n_elem, ncols, false);
+        y = x;
+        y.each_col() %= inv_diag;
+    }
+};
+
+
+#endif // JACOBI_PRECOND_H
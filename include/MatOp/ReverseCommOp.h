@@ -0,0 +1,327 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef REVERSE_COMM_OP_H
+#define REVERSE_COMM_OP_H
+
+#include <thread>              // std::thread
+#include <mutex>               // std::mutex, std::unique_lock
+#include <condition_variable>  // std::condition_variable
+#include <functional>          // std::function
+#include <exception>           // std::exception_ptr
+#include <stdexcept>           // std::logic_error
+
+///
+/// The enumeration of requests returned by ReverseCommOp::step().
+///
+enum REVERSE_COMM_REQUEST
+{
+    RC_DONE = 0,  ///< The solve has finished, and the results can be retrieved from the solver.
+
+    RC_OP,        ///< Compute \f$Y=AX\f$, with \f$X\f$ given by `input()` and
+                  ///< \f$Y\f$ to be written to `output()`.
+
+    RC_OP_T       ///< Compute \f$Y=A'X\f$, with \f$X\f$ given by `input()` and
+                  ///< \f$Y\f$ to be written to `output()`.
+};
+
+///
+/// \ingroup MatOp
+///
+/// This class provides a reverse communication interface to the solvers.
+/// Instead of computing the matrix operation itself, it hands the input and
+/// output buffers back to the caller, in the same way as the `ido` loop of
+/// **ARPACK** (see `benchmark/F77.cpp`), and the solver only continues when
+/// the caller asks for the next step.
+///
+/// It is passed to a solver as the `OpType`, like DenseGenMatProd. The solve,
+/// typically `init()` followed by `compute()`, is started by start() and runs
+/// in a separate thread, but the two threads never run at the same time:
+/// step() resumes the solver and returns as soon as it needs a matrix operation,
+/// or when it has finished. The solver thread acts as a coroutine, and C++11
+/// is sufficient.
+///
+/// Since the caller has control between the steps, several solves can be
+/// advanced side by side, and their pending products computed together, for
+/// example as one sparse matrix-matrix product, or by an external engine.
+/// Each solve that has been started and has not finished holds its own OS
+/// thread, which stays blocked while the caller has control, so the number of
+/// solves in flight is limited by the threads the system allows, in practice a
+/// few hundred. Many more small problems are better processed in batches.
+///
+/// The solve must have finished, or be cancelled by cancel(), before the solver
+/// object is destroyed. Exceptions thrown by the solver are rethrown by step().
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <SymEigsSolver.h>
+/// #include <MatOp/ReverseCommOp.h>
+///
+/// int main()
+/// {
+///     arma::mat A = arma::randu(10, 10);
+///     arma::mat M = A + A.t();
+///
+///     ReverseCommOp<double> op(10, 10);
+///     SymEigsSolver< double, LARGEST_ALGE, ReverseCommOp<double> > eigs(&op, 3, 6);
+///
+///     int nconv = 0;
+///     op.start([&]() { eigs.init(); nconv = eigs.compute(); });
+///     while(op.step() != RC_DONE)
+///     {
+///         arma::mat X(op.input(), op.input_rows(), op.num_columns(), false);
+///         arma::mat Y(op.output(), op.output_rows(), op.num_columns(), false);
+///         Y = M * X;
+///     }
+///
+///     arma::vec evalues = eigs.eigenvalues();
+///     evalues.print("Eigenvalues found:");
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template <typename Scalar>
+class ReverseCommOp
+{
+private:
+    // Thrown in the solver thread to unwind the solve when it is cancelled
+    struct Cancelled {};
+
+    // Request of a solve that has been started but has not run yet
+    static const int RC_START = -1;
+
+    const int nrow;
+    const int ncol;
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cond;
+
+    bool running;         // whether the solver thread has control
+    bool cancelled;       // whether the solve has been cancelled
+    int request;          // the current request, see REVERSE_COMM_REQUEST
+    Scalar *x_ptr;        // input of the current request
+    Scalar *y_ptr;        // output of the current request
+    int x_rows;           // number of rows of the input
+    int y_rows;           // number of rows of the output
+    int nvec;             // number of columns of the input and the output
+    std::exception_ptr error;  // exception thrown by the solver
+
+    // Post a request from the solver thread, and wait until the caller
+    // has computed it and called step() again
+    void post(int req, const Scalar *x_in, Scalar *y_out, int xr, int yr, int k)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if(cancelled)
+            throw Cancelled();
+
+        request = req;
+        x_ptr = const_cast<Scalar *>(x_in);
+        y_ptr = y_out;
+        x_rows = xr;
+        y_rows = yr;
+        nvec = k;
+
+        running = false;
+        cond.notify_all();
+        cond.wait(lock, [this]() { return running || cancelled; });
+
+        if(cancelled)
+            throw Cancelled();
+    }
+
+    // Body of the solver thread
+    void run(std::function<void()> job)
+    {
+        // Wait for the first step()
+        bool go;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cond.wait(lock, [this]() { return running || cancelled; });
+            go = !cancelled;
+        }
+
+        try {
+            if(go)
+                job();
+        } catch(const Cancelled&) {
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        request = RC_DONE;
+        running = false;
+        cond.notify_all();
+    }
+
+public:
+    ///
+    /// Constructor to create the matrix operation object.
+    ///
+    /// \param nrow_ Number of rows of the matrix \f$A\f$.
+    /// \param ncol_ Number of columns of the matrix \f$A\f$.
+    ///
+    ReverseCommOp(int nrow_, int ncol_) :
+        nrow(nrow_),
+        ncol(ncol_),
+        running(false),
+        cancelled(false),
+        request(RC_DONE),
+        x_ptr(NULL),
+        y_ptr(NULL),
+        x_rows(0),
+        y_rows(0),
+        nvec(0)
+    {}
+
+    ///
+    /// Destructor, which cancels the solve if it has not finished.
+    ///
+    ~ReverseCommOp() { cancel(); }
+
+    ///
+    /// Return the number of rows of the underlying matrix.
+    ///
+    int rows() { return nrow; }
+    ///
+    /// Return the number of columns of the underlying matrix.
+    ///
+    int cols() { return ncol; }
+
+    ///
+    /// Post the request \f$y=Ax\f$ and wait until it has been computed.
+    /// Called by the solver.
+    ///
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        post(RC_OP, x_in, y_out, ncol, nrow, 1);
+    }
+
+    ///
+    /// Post the request \f$Y=AX\f$, where \f$X\f$ has `ncols` columns,
+    /// and wait until it has been computed. Called by the block solvers.
+    ///
+    void perform_op(const Scalar *x_in, Scalar *y_out, int ncols)
+    {
+        post(RC_OP, x_in, y_out, ncol, nrow, ncols);
+    }
+
+    ///
+    /// Post the request \f$y=A'x\f$ and wait until it has been computed.
+    /// Called by the PartialSVDSolver singular value solver.
+    ///
+    void perform_op_t(Scalar *x_in, Scalar *y_out)
+    {
+        post(RC_OP_T, x_in, y_out, nrow, ncol, 1);
+    }
+
+    ///
+    /// Start a solve. The job is run in the solver thread, and
+    /// does not begin before the first call of step().
+    ///
+    /// \param job A callable object that runs the solver, for example a lambda
+    ///            function calling `init()` and `compute()` of the solver object.
+    ///
+    void start(std::function<void()> job)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if(worker.joinable())
+            throw std::logic_error("ReverseCommOp: the previous solve has not finished");
+
+        cancelled = false;
+        error = std::exception_ptr();
+        request = RC_START;
+        running = false;
+        worker = std::thread(&ReverseCommOp::run, this, job);
+    }
+
+    ///
+    /// Resume the solver until it needs a matrix operation or finishes.
+    ///
+    /// The request returned by the previous call, if any, must have been
+    /// computed before calling this function again.
+    ///
+    /// \return An enumeration value defined in REVERSE_COMM_REQUEST,
+    ///         `RC_OP`, `RC_OP_T`, or `RC_DONE` when the solve has finished,
+    ///         or if no solve has been started.
+    ///
+    int step()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if(!worker.joinable())
+            return RC_DONE;
+
+        // The pending request has been computed, or the solve has
+        // not begun, so the solver can go on
+        if(!running && request != RC_DONE)
+        {
+            running = true;
+            cond.notify_all();
+        }
+        cond.wait(lock, [this]() { return !running; });
+
+        if(request == RC_DONE)
+        {
+            lock.unlock();
+            worker.join();
+            if(error)
+            {
+                std::exception_ptr e = error;
+                error = std::exception_ptr();
+                std::rethrow_exception(e);
+            }
+        }
+
+        return request;
+    }
+
+    ///
+    /// Cancel the solve if it has not finished. The solver is left
+    /// in an unspecified state, and must be initialized again before use.
+    ///
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(!worker.joinable())
+                return;
+            cancelled = true;
+            cond.notify_all();
+        }
+        worker.join();
+        request = RC_DONE;
+        error = std::exception_ptr();
+    }
+
+    ///
+    /// Pointer to the input \f$X\f$ of the current request, an
+    /// `input_rows()` by `num_columns()` matrix stored in column-major order.
+    ///
+    Scalar* input() { return x_ptr; }
+    ///
+    /// Pointer to the output \f$Y\f$ of the current request, an
+    /// `output_rows()` by `num_columns()` matrix stored in column-major order.
+    ///
+    Scalar* output() { return y_ptr; }
+    ///
+    /// Number of rows of the input, `cols()` for `RC_OP` and `rows()` for `RC_OP_T`.
+    ///
+    int input_rows() { return x_rows; }
+    ///
+    /// Number of rows of the output, `rows()` for `RC_OP` and `cols()` for `RC_OP_T`.
+    ///
+    int output_rows() { return y_rows; }
+    ///
+    /// Number of columns of the input and the output, which is one
+    /// except for the block solvers.
+    ///
+    int num_columns() { return nvec; }
+};
+
+
+#endif // REVERSE_COMM_OP_H
@@ -0,0 +1,137 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SPARSE_REGULAR_INVERSE_H
+#define SPARSE_REGULAR_INVERSE_H
+
+#include <armadillo>
+#include <cmath>      // std::pow, std::sqrt
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+///
+/// \ingroup MatOp
+///
+/// This class defines the product \f$y=Bx\f$ and the solve \f$y=B^{-1}x\f$ for a
+/// sparse positive definite matrix \f$B\f$. The solve uses the conjugate gradient
+/// method with a Jacobi preconditioner, which converges quickly for well-conditioned
+/// matrices such as the mass matrices of finite element models.
+/// It is mainly used as the `BOpType` of the SymGEigsSolver eigen solver in the
+/// regular inverse mode.
+///
+template <typename Scalar>
+class SparseRegularInverse
+{
+private:
+    typedef arma::Col<Scalar>   Vector;
+    typedef arma::SpMat<Scalar> SpMatrix;
+
+    const SpMatrix* mat;
+    const int dim_n;
+    const Scalar tol;     // relative tolerance of the conjugate gradient method
+    Vector inv_diag;      // Jacobi preconditioner
+    Vector ws_r, ws_z, ws_p, ws_q;
+
+public:
+    ///
+    /// Constructor to create the matrix operation object.
+    ///
+    /// \param mat_ An **Armadillo** sparse matrix object, whose type can be `arma::sp_mat`
+    ///             or `arma::sp_fmat`, depending on the template parameter `Scalar` defined.
+    ///             The matrix must be symmetric positive definite.
+    /// \param tol_ Relative tolerance of the residual in the solve operation.
+    ///             The default is \f$\varepsilon^{3/4}\f$, where \f$\varepsilon\f$ is
+    ///             the machine precision. In SymGEigsSolver it should be smaller than
+    ///             the tolerance given to `compute()`, which the eigenpairs cannot
+    ///             reach otherwise.
+    ///
+    SparseRegularInverse(const SpMatrix &mat_,
+                         Scalar tol_ = std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(0.75))) :
+        mat(&mat_),
+        dim_n(mat_.n_rows),
+        tol(tol_),
+        inv_diag(mat_.n_rows),
+        ws_r(mat_.n_rows), ws_z(mat_.n_rows), ws_p(mat_.n_rows), ws_q(mat_.n_rows)
+    {
+        if(mat_.n_rows != mat_.n_cols)
+            throw std::invalid_argument("SparseRegularInverse: matrix must be square");
+
+        for(int i = 0; i < dim_n; i++)
+        {
+            const Scalar d = mat_(i, i);
+            if(d <= Scalar(0))
+                throw std::invalid_argument("SparseRegularInverse: matrix must be positive definite");
+            inv_diag[i] = Scalar(1) / d;
+        }
+    }
+
+    ///
+    /// Return the number of rows of the underlying matrix.
+    ///
+    int rows() { return dim_n; }
+    ///
+    /// Return the number of columns of the underlying matrix.
+    ///
+    int cols() { return dim_n; }
+
+    ///
+    /// Perform the matrix-vector multiplication operation \f$y=Bx\f$.
+    ///
+    /// \param x_in  Pointer to the \f$x\f$ vector.
+    /// \param y_out Pointer to the \f$y\f$ vector.
+    ///
+    // y_out = B * x_in
+    void perform_op(const Scalar *x_in, Scalar *y_out)
+    {
+        const Vector x(const_cast<Scalar *>(x_in), dim_n, false);
+        Vector y(y_out, dim_n, false);
+        y = (*mat) * x;
+    }
+
+    ///
+    /// Perform the solve operation \f$y=B^{-1}x\f$, by the preconditioned
+    /// conjugate gradient method starting from zero.
+    ///
+    // y_out = inv(B) * x_in
+    void solve(const Scalar *x_in, Scalar *y_out)
+    {
+        const Vector x(const_cast<Scalar *>(x_in), dim_n, false);
+        Vector y(y_out, dim_n, false);
+
+        y.zeros();
+        const Scalar x_norm = arma::norm(x);
+        if(x_norm == Scalar(0))
+            return;
+
+        ws_r = x;
+        ws_z = inv_diag % ws_r;
+        ws_p = ws_z;
+        Scalar rz = arma::dot(ws_r, ws_z);
+        // In exact arithmetic CG converges in n steps, and twice as
+        // many are allowed for the rounding errors
+        const int maxit = 2 * dim_n;
+        for(int i = 0; i < maxit; i++)
+        {
+            ws_q = (*mat) * ws_p;
+            const Scalar alpha = rz / arma::dot(ws_p, ws_q);
+            y += alpha * ws_p;
+            ws_r -= alpha * ws_q;
+
+            if(arma::norm(ws_r) <= tol * x_norm)
+                return;
+
+            ws_z = inv_diag % ws_r;
+            const Scalar rz_new = arma::dot(ws_r, ws_z);
+            ws_p = ws_z + (rz_new / rz) * ws_p;
+            rz = rz_new;
+        }
+
+        throw std::logic_error("SparseRegularInverse: the conjugate gradient method did not converge");
+    }
+};
+
+
+#endif // SPARSE_REGULAR_INVERSE_H
@@ -0,0 +1,272 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef PARTIAL_SVD_SOLVER_H
+#define PARTIAL_SVD_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <algorithm>  // std::max, std::min
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/SparseGenMatProd.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class computes the largest singular values of a real rectangular
+/// matrix \f$A\f$ of size \f$m\times n\f$, together with the associated left
+/// and right singular vectors, i.e., the truncated SVD
+/// \f$A\approx U_k\Sigma_k V_k'\f$.
+///
+/// Rather than finding the eigenvalues of \f$A'A\f$, which squares the condition
+/// number and loses the accuracy of the small singular values, the solver runs
+/// the Golub-Kahan-Lanczos bidiagonalization on \f$A\f$ itself:
+/// \f[AV=UB,\quad A'U=VB'+fe'\f]
+/// where \f$U\f$ and \f$V\f$ have `ncv` orthonormal columns and \f$B\f$ is upper
+/// bidiagonal. The singular triplets of the small matrix \f$B\f$ give the
+/// Ritz approximations of those of \f$A\f$. The factorization is restarted
+/// with the thick restart of Baglama and Reichel (2005), which keeps the wanted
+/// Ritz vectors, so that \f$B\f$ becomes upper triangular after a restart.
+/// Both bases are fully reorthogonalized.
+///
+/// The matrix operation class must implement `rows()`, `cols()`, the product
+/// `perform_op(Scalar *x_in, Scalar *y_out)` computing \f$y=Ax\f$, and the
+/// transpose product `perform_op_t(Scalar *x_in, Scalar *y_out)` computing
+/// \f$y=A'x\f$, as in DenseGenMatProd and SparseGenMatProd. Each Lanczos
+/// step calls each of them once.
+///
+/// \tparam Scalar The element type of the matrix.
+///                Currently supported types are `float` and `double`.
+/// \tparam OpType The name of the matrix operation class, for example
+///                DenseGenMatProd or SparseGenMatProd.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <PartialSVDSolver.h>
+///
+/// int main()
+/// {
+///     arma::sp_mat A = arma::sprandu(10000, 2000, 0.01);
+///
+///     SparseGenMatProd<double> op(A);
+///
+///     // The 20 largest singular values, with 50 Lanczos vectors
+///     PartialSVDSolver< double, SparseGenMatProd<double> > svds(&op, 20, 50);
+///
+///     svds.init();
+///     int nconv = svds.compute();
+///
+///     if(nconv > 0)
+///     {
+///         arma::vec s = svds.singular_values();
+///         arma::mat U = svds.matrix_U();
+///         arma::mat V = svds.matrix_V();
+///     }
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           typename OpType = DenseGenMatProd<double> >
+class PartialSVDSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef std::vector<bool> BoolVector;
+    typedef BasisProduct<Scalar, Scalar> BasisOp;
+
+    OpType *op;           // object to conduct matrix operation,
+                          // e.g. matrix-vector product
+    const int dim_m;      // number of rows of matrix A
+    const int dim_n;      // number of columns of matrix A
+    const int nsv;        // number of singular values requested
+    const int ncv;        // number of Lanczos vectors
+    int nmatop;           // number of matrix operations called, counting
+                          // both the products with A and with A'
+    int niter;            // number of restarting iterations
+    CounterRNG rng;       // random vectors of init() and of the restarts
+
+    Matrix fac_U;         // U matrix in the bidiagonalization, m x ncv
+    Matrix fac_V;         // V matrix in the bidiagonalization, n x ncv
+    Matrix fac_B;         // B matrix in the bidiagonalization, ncv x ncv
+    Vector fac_f;         // residual in the bidiagonalization, of length n
+
+    Vector ritz_val;      // Ritz values, i.e. singular values of B
+    Matrix ritz_P;        // left singular vectors of B
+    Matrix ritz_Q;        // right singular vectors of B
+    BoolVector ritz_conv; // indicator of the convergence of Ritz values
+
+    const Scalar prec;    // precision parameter used to test convergence
+                          // prec = epsilon^(2/3)
+                          // epsilon is the machine precision,
+                          // e.g. ~= 1e-16 for the "double" type
+
+    // Workspace, sized in init() and reused in the restarting iterations
+    Vector ws_v;          // the current right basis vector, of length n
+    Vector ws_u;          // the current left basis vector, of length m
+    Vector ws_h;          // projection coefficients, of length ncv
+    Vector ws_panel;      // block_rows x ncv, a panel of U * P or V * Q in the restart
+
+    // Orthogonalize x against the first ncol columns of W, and
+    // return the norm of the result
+    inline Scalar orthogonalize(Matrix &W, int ncol, Vector &x);
+
+    // Replace x by a random unit vector orthogonal to the first ncol columns of W
+    inline void random_orthogonal(Matrix &W, int ncol, Vector &x);
+
+    // Bidiagonalization from step k, where the first k columns of U
+    // and the first k+1 columns of V are given
+    inline void factorize_from(int from_k);
+
+    // Thick restart of the bidiagonalization, keeping k Ritz triplets
+    inline void restart(int k);
+
+    // Calculate the number of converged Ritz values
+    inline int num_converged(Scalar tol);
+
+    // Return the adjusted nsv for restarting
+    inline int nsv_adjusted(int nconv);
+
+    // Compute the SVD of B
+    inline void retrieve_ritzpair();
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_  Pointer to the matrix operation object. Users could either
+    ///             create the object from the DenseGenMatProd or SparseGenMatProd
+    ///             wrapper classes, or define their own that impelemnts all the
+    ///             public member functions as in DenseGenMatProd, including `perform_op_t()`.
+    /// \param nsv_ Number of singular values requested. This should satisfy
+    ///             \f$1\le nsv \le \min(m, n)-1\f$.
+    /// \param ncv_ Parameter that controls the convergence speed of the algorithm.
+    ///             Typically a larger `ncv_` means faster convergence, but it may
+    ///             also result in greater memory use and more matrix operations
+    ///             in each iteration. This parameter must satisfy \f$nsv < ncv \le \min(m, n)\f$,
+    ///             and is advised to take \f$ncv \ge 2\cdot nsv\f$.
+    ///
+    PartialSVDSolver(OpType *op_, int nsv_, int ncv_) :
+        op(op_),
+        dim_m(op->rows()),
+        dim_n(op->cols()),
+        nsv(nsv_),
+        ncv(ncv_),
+        nmatop(0),
+        niter(0),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+    {
+        const int dim = std::min(dim_m, dim_n);
+
+        if(nsv_ < 1 || nsv_ > dim - 1)
+            throw std::invalid_argument("nsv must satisfy 1 <= nsv <= min(m, n) - 1, m x n is the size of matrix");
+
+        if(ncv_ <= nsv_ || ncv_ > dim)
+            throw std::invalid_argument("ncv must satisfy nsv < ncv <= min(m, n), m x n is the size of matrix");
+    }
+
+    ///
+    /// Providing the initial vector for the algorithm.
+    ///
+    /// \param init_resid Pointer to the initial vector, of length \f$n\f$,
+    ///                   which is the first column of \f$V\f$ after normalization.
+    ///
+    inline void init(Scalar *init_resid);
+
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial vector in init() and the new basis vectors when the
+    /// bidiagonalization breaks down. This function should be called before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Providing a random initial vector.
+    ///
+    /// This overloaded function generates a random initial vector
+    /// for the algorithm. Elements in the vector follow independent Uniform(-0.5, 0.5)
+    /// distributions, drawn from the generator of the solver, see set_seed().
+    ///
+    inline void init();
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the algorithm.
+    /// \param tol Precision parameter for the calculated singular values.
+    ///
+    /// \return Number of converged singular values.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of iterations used in the computation.
+    ///
+    inline int num_iterations() { return niter; }
+
+    ///
+    /// Returning the number of matrix operations used in the computation,
+    /// counting the products with both \f$A\f$ and \f$A'\f$.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the converged singular values, in decreasing order.
+    ///
+    /// \return A vector containing the singular values.
+    /// Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector singular_values();
+
+    ///
+    /// Returning the left singular vectors associated with the converged
+    /// singular values.
+    ///
+    /// \param nvec The number of vectors to return.
+    ///
+    /// \return An \f$m\times nvec\f$ matrix containing the left singular vectors.
+    ///
+    inline Matrix matrix_U(int nvec);
+    ///
+    /// Returning all converged left singular vectors.
+    ///
+    inline Matrix matrix_U() { return matrix_U(nsv); }
+
+    ///
+    /// Returning the right singular vectors associated with the converged
+    /// singular values.
+    ///
+    /// \param nvec The number of vectors to return.
+    ///
+    /// \return An \f$n\times nvec\f$ matrix containing the right singular vectors.
+    ///
+    inline Matrix matrix_V(int nvec);
+    ///
+    /// Returning all converged right singular vectors.
+    ///
+    inline Matrix matrix_V() { return matrix_V(nsv); }
+};
+
+
+// Implementations
+#include "PartialSVDSolver_Impl.h"
+
+
+#endif // PARTIAL_SVD_SOLVER_H
@@ -0,0 +1,341 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Orthogonalize x against the first ncol columns of W, and
+// return the norm of the result
+template < typename Scalar,
+           typename OpType >
+inline Scalar PartialSVDSolver<Scalar, OpType>::orthogonalize(Matrix &W, int ncol, Vector &x)
+{
+    Scalar xnorm = arma::norm(x);
+    if(ncol < 1)
+        return xnorm;
+
+    // Iteratively correct x until W' * x ~= 0
+    Vector Wx(ws_h.memptr(), ncol, false);
+    BasisOp::trans_mult(W, ncol, x.memptr(), Wx.memptr());
+    int count = 0;
+    while(count < 5 && arma::abs(Wx).max() > prec * xnorm)
+    {
+        BasisOp::mult_sub(W, ncol, Wx.memptr(), x.memptr());
+        xnorm = arma::norm(x);
+
+        BasisOp::trans_mult(W, ncol, x.memptr(), Wx.memptr());
+        count++;
+    }
+
+    return xnorm;
+}
+
+// Replace x by a random unit vector orthogonal to the first ncol columns of W
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::random_orthogonal(Matrix &W, int ncol, Vector &x)
+{
+    rng.uniform(x.memptr(), x.n_elem);
+    x /= orthogonalize(W, ncol, x);
+}
+
+// Bidiagonalization from step k, where the first k columns of U
+// and the first k+1 columns of V are given
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::factorize_from(int from_k)
+{
+    Vector &u = ws_u;
+    Vector &v = ws_v;
+    for(int i = from_k; i < ncv; i++)
+    {
+        // u <- A * v - U * B[, i], v = fac_V.col(i)
+        // After a thick restart, the first column computed has nonzero
+        // elements in all the rows above the diagonal, and otherwise B is
+        // bidiagonal, so only the previous column of U is involved
+        op->perform_op(fac_V.colptr(i), u.memptr());
+        nmatop++;
+        if(i == from_k)
+            BasisOp::mult_sub(fac_U, i, fac_B.colptr(i), u.memptr());
+        else
+            BasisOp::axpy(-fac_B(i - 1, i), fac_U, i - 1, u.memptr());
+
+        // alpha <- ||u||, with u orthogonalized against the first i columns of U
+        // If alpha = 0, A * v is in the span of U, and a new left vector
+        // orthogonal to U is generated, with B[i, i] = 0
+        Scalar alpha = orthogonalize(fac_U, i, u);
+        if(alpha < prec)
+        {
+            random_orthogonal(fac_U, i, u);
+            alpha = 0;
+        } else {
+            u /= alpha;
+        }
+        fac_U.col(i) = u;
+        fac_B(i, i) = alpha;
+
+        // f <- A' * u - alpha * v, orthogonalized against the first i+1 columns of V
+        op->perform_op_t(u.memptr(), fac_f.memptr());
+        nmatop++;
+        BasisOp::axpy(-alpha, fac_V, i, fac_f.memptr());
+        Scalar beta = orthogonalize(fac_V, i + 1, fac_f);
+
+        // In the last step f is kept as the residual of the factorization
+        if(i == ncv - 1)
+            break;
+
+        // v <- f / ||f||, stored as the (i+2)-th column of V
+        // If beta = 0, a new right vector orthogonal to V is generated,
+        // with B[i, i+1] = 0
+        if(beta < prec)
+        {
+            random_orthogonal(fac_V, i + 1, v);
+            beta = 0;
+        } else {
+            v = fac_f / beta;
+        }
+        fac_V.col(i + 1) = v;
+        fac_B(i, i + 1) = beta;
+    }
+}
+
+// Thick restart of the bidiagonalization, keeping k Ritz triplets
+// See Baglama, J. and Reichel, L. (2005). Augmented implicitly restarted
+// Lanczos bidiagonalization methods.
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::restart(int k)
+{
+    if(k >= ncv)
+        return;
+
+    // U -> U * P and V -> V * Q, keeping the first k Ritz vectors
+    // This is done in place, one panel of rows at a time
+    Matrix Pk(ritz_P.memptr(), ncv, k, false);
+    Matrix Qk(ritz_Q.memptr(), ncv, k, false);
+    BasisOp::mult_inplace(fac_U, ncv, Pk, ws_panel.memptr());
+    BasisOp::mult_inplace(fac_V, ncv, Qk, ws_panel.memptr());
+
+    // A * V * Q = U * P * Sigma, and A' * U * P = V * Q * Sigma + f * e' * P
+    // So with f / ||f|| as the (k+1)-th column of V, B becomes
+    // [Sigma  rho]
+    // [0      *  ]
+    // where rho = ||f|| * (last row of P)'
+    const Scalar beta = arma::norm(fac_f);
+    fac_B.zeros();
+    for(int i = 0; i < k; i++)
+        fac_B(i, i) = ritz_val[i];
+
+    Vector &v = ws_v;
+    if(beta < prec)
+    {
+        // f is zero, so the kept Ritz vectors span invariant subspaces,
+        // and rho = 0
+        random_orthogonal(fac_V, k, v);
+    } else {
+        v = fac_f / beta;
+        for(int i = 0; i < k; i++)
+            fac_B(i, k) = beta * ritz_P(ncv - 1, i);
+    }
+    fac_V.col(k) = v;
+
+    factorize_from(k);
+    retrieve_ritzpair();
+}
+
+// Calculate the number of converged Ritz values
+template < typename Scalar,
+           typename OpType >
+inline int PartialSVDSolver<Scalar, OpType>::num_converged(Scalar tol)
+{
+    // A * v = sigma * u holds exactly, and the residual of
+    // A' * u = sigma * v is ||f|| * |last element of p|
+    // thresh = tol * max(prec, sigma)
+    const Scalar f_norm = arma::norm(fac_f);
+    for(int i = 0; i < nsv; i++)
+    {
+        Scalar thresh = tol * std::max(prec, ritz_val[i]);
+        Scalar resid = std::abs(ritz_P(ncv - 1, i)) * f_norm;
+        ritz_conv[i] = (resid < thresh);
+    }
+
+    return std::count(ritz_conv.begin(), ritz_conv.end(), true);
+}
+
+// Return the adjusted nsv for restarting
+template < typename Scalar,
+           typename OpType >
+inline int PartialSVDSolver<Scalar, OpType>::nsv_adjusted(int nconv)
+{
+    int nsv_new = nsv;
+
+    // Adjust nsv_new in the same way as nev in SymEigsSolver,
+    // according to dsaup2.f line 677~684 in ARPACK
+    nsv_new = nsv + std::min(nconv, (ncv - nsv) / 2);
+    if(nsv == 1 && ncv >= 6)
+        nsv_new = ncv / 2;
+    else if(nsv == 1 && ncv > 2)
+        nsv_new = 2;
+
+    return nsv_new;
+}
+
+// Compute the SVD of B
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::retrieve_ritzpair()
+{
+    // B is small and upper triangular, so a dense SVD is used
+    // The singular values are returned in decreasing order, which
+    // is the order of the wanted Ritz triplets
+    if(!arma::svd(ritz_P, ritz_val, ritz_Q, fac_B))
+        throw std::logic_error("PartialSVDSolver: failed to compute the SVD of B");
+}
+
+
+
+// Initialization and clean-up
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::init(Scalar *init_resid)
+{
+    // Reset all matrices/vectors to zero
+    fac_U.zeros(dim_m, ncv);
+    fac_V.zeros(dim_n, ncv);
+    fac_B.zeros(ncv, ncv);
+    fac_f.zeros(dim_n);
+    ritz_val.zeros(ncv);
+    ritz_P.zeros(ncv, ncv);
+    ritz_Q.zeros(ncv, ncv);
+    ritz_conv.assign(nsv, false);
+
+    ws_v.set_size(dim_n);
+    ws_u.set_size(dim_m);
+    ws_h.set_size(ncv);
+    ws_panel.set_size(std::min(std::max(dim_m, dim_n), int(BasisOp::block_rows)) * ncv);
+
+    nmatop = 0;
+    niter = 0;
+
+    Vector r(init_resid, dim_n, false);
+    // The first column of fac_V
+    Scalar rnorm = arma::norm(r);
+    if(rnorm < prec)
+        throw std::invalid_argument("initial residual vector cannot be zero");
+    fac_V.col(0) = r / rnorm;
+}
+
+// Initialization with random initial coefficients
+template < typename Scalar,
+           typename OpType >
+inline void PartialSVDSolver<Scalar, OpType>::init()
+{
+    Vector init_resid(dim_n);
+    rng.uniform(init_resid.memptr(), dim_n);
+    init(init_resid.memptr());
+}
+
+// Compute Ritz triplets and return the number of converged singular values
+template < typename Scalar,
+           typename OpType >
+inline int PartialSVDSolver<Scalar, OpType>::compute(int maxit, Scalar tol)
+{
+    // The ncv-step bidiagonalization
+    factorize_from(0);
+    retrieve_ritzpair();
+    // Restarting
+    int i, nconv = 0, nsv_adj;
+    for(i = 0; i < maxit; i++)
+    {
+        nconv = num_converged(tol);
+        if(nconv >= nsv)
+            break;
+
+        nsv_adj = nsv_adjusted(nconv);
+        restart(nsv_adj);
+    }
+
+    niter = i + 1;
+
+    return std::min(nsv, nconv);
+}
+
+// Return converged singular values
+template < typename Scalar,
+           typename OpType >
+inline typename PartialSVDSolver<Scalar, OpType>::Vector PartialSVDSolver<Scalar, OpType>::singular_values()
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    Vector res(nconv);
+
+    if(!nconv)
+        return res;
+
+    int j = 0;
+    for(int i = 0; i < nsv; i++)
+    {
+        if(ritz_conv[i])
+        {
+            res[j] = ritz_val[i];
+            j++;
+        }
+    }
+
+    return res;
+}
+
+// Return converged left singular vectors
+template < typename Scalar,
+           typename OpType >
+inline typename PartialSVDSolver<Scalar, OpType>::Matrix PartialSVDSolver<Scalar, OpType>::matrix_U(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    Matrix res(dim_m, nvec);
+
+    if(!nvec)
+        return res;
+
+    Matrix ritz_P_conv(ncv, nvec);
+    int j = 0;
+    for(int i = 0; i < nsv && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_P_conv.col(j) = ritz_P.col(i);
+            j++;
+        }
+    }
+
+    BasisOp::mult(fac_U, ncv, ritz_P_conv, res);
+
+    return res;
+}
+
+// Return converged right singular vectors
+template < typename Scalar,
+           typename OpType >
+inline typename PartialSVDSolver<Scalar, OpType>::Matrix PartialSVDSolver<Scalar, OpType>::matrix_V(int nvec)
+{
+    int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
+    nvec = std::min(nvec, nconv);
+    Matrix res(dim_n, nvec);
+
+    if(!nvec)
+        return res;
+
+    Matrix ritz_Q_conv(ncv, nvec);
+    int j = 0;
+    for(int i = 0; i < nsv && j < nvec; i++)
+    {
+        if(ritz_conv[i])
+        {
+            ritz_Q_conv.col(j) = ritz_Q.col(i);
+            j++;
+        }
+    }
+
+    BasisOp::mult(fac_V, ncv, ritz_Q_conv, res);
+
+    return res;
+}
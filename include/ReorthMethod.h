@@ -0,0 +1,34 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef REORTH_METHOD_H
+#define REORTH_METHOD_H
+
+///
+/// \file ReorthMethod.h
+///
+/// This file defines enumeration types for the reorthogonalization method
+/// of the Lanczos process.
+///
+
+///
+/// The enumeration of reorthogonalization methods.
+///
+enum REORTH_METHOD
+{
+
+    FULL_REORTH = 0,  ///< In each Lanczos step, the new residual vector is tested
+                      ///< against the whole basis \f$V\f$, and is reorthogonalized
+                      ///< if needed. This is the default method.
+
+    PARTIAL_REORTH    ///< Partial reorthogonalization. The loss of orthogonality is
+                      ///< estimated by Simon's \f$\omega\f$-recurrence, which only involves
+                      ///< the small matrix \f$H\f$, and the residual vector is
+                      ///< reorthogonalized against \f$V\f$ only when the estimate exceeds
+                      ///< \f$\sqrt{\varepsilon}\f$.
+};
+
+#endif // REORTH_METHOD_H
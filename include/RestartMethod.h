@@ -0,0 +1,31 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef RESTART_METHOD_H
+#define RESTART_METHOD_H
+
+///
+/// \file RestartMethod.h
+///
+/// This file defines enumeration types for the restarting method of the eigen solvers.
+///
+
+///
+/// The enumeration of restarting methods.
+///
+enum RESTART_METHOD
+{
+
+    IMPLICIT_RESTART = 0,  ///< Implicit restart, as in **ARPACK**. The unwanted Ritz values
+                           ///< are used as shifts of a sequence of QR sweeps on \f$H\f$.
+                           ///< This is the default method.
+
+    THICK_RESTART          ///< Thick restart, also known as the Krylov-Schur restart.
+                           ///< The wanted Ritz vectors (or Schur vectors) are kept directly,
+                           ///< and the factorization is restarted from them, without any QR sweeps.
+};
+
+#endif // RESTART_METHOD_H
@@ -47,8 +47,12 @@ enum SELECT_EIGENVALUE
 
     SMALLEST_ALGE,     ///< Select eigenvalues with smallest algebraic value. Only for symmetric eigen solvers.
 
-    BOTH_ENDS          ///< Select eigenvalues half from each end of the spectrum. When
+    BOTH_ENDS,         ///< Select eigenvalues half from each end of the spectrum. When
                        ///< `nev` is odd, compute more from the high end. Only for symmetric eigen solvers.
+
+    TARGET_CLOSEST     ///< Select eigenvalues closest to a target value, which is given to the solver.
+                       ///< Used for interior eigenvalues by the Jacobi-Davidson solvers
+                       ///< JDSymEigsSolver and JDGenEigsSolver.
 };
 
 ///
@@ -213,6 +217,20 @@ public:
     }
 };
 
+// Specialization for TARGET_CLOSEST
+// This covers [float, double, complex] x [TARGET_CLOSEST]
+// The values are shifted by the target in SortEigenvalue::compute(),
+// so the distance to the target is the magnitude of the shifted value
+template <typename Scalar>
+class SortingTarget<Scalar, TARGET_CLOSEST>
+{
+public:
+    static typename ElemType<Scalar>::type get(const Scalar &val)
+    {
+        return std::abs(val);
+    }
+};
+
 // Sort eigenvalues and return the order index
 template <typename PairType>
 class PairComparator
@@ -236,9 +254,23 @@ private:
     std::vector<PairType> pair_sort;
 
 public:
-    SortEigenvalue(const T* start, int size) :
-        pair_sort(size)
+    SortEigenvalue() {}
+
+    SortEigenvalue(const T* start, int size)
+    {
+        compute(start, size);
+    }
+
+    SortEigenvalue(const T* start, int size, const T &target)
+    {
+        compute(start, size, target);
+    }
+
+    // Sort the values again, reusing the memory of the previous sorting
+    // if the size does not grow
+    void compute(const T* start, int size)
     {
+        pair_sort.resize(size);
         for(int i = 0; i < size; i++)
         {
             pair_sort[i].first = SortingTarget<T, SelectionRule>::get(start[i]);
@@ -248,14 +280,36 @@ public:
         std::sort(pair_sort.begin(), pair_sort.end(), comp);
     }
 
+    // Sort the values relative to a target, i.e., sort the values
+    // minus the target. With TARGET_CLOSEST, the values closest
+    // to the target come first
+    void compute(const T* start, int size, const T &target)
+    {
+        pair_sort.resize(size);
+        for(int i = 0; i < size; i++)
+        {
+            pair_sort[i].first = SortingTarget<T, SelectionRule>::get(start[i] - target);
+            pair_sort[i].second = i;
+        }
+        PairComparator<PairType> comp;
+        std::sort(pair_sort.begin(), pair_sort.end(), comp);
+    }
+
     std::vector<int> index()
     {
-        std::vector<int> ind(pair_sort.size());
-        for(unsigned int i = 0; i < ind.size(); i++)
-            ind[i] = pair_sort[i].second;
+        std::vector<int> ind;
+        index(ind);
 
         return ind;
     }
+
+    // Write the order index to an existing vector
+    void index(std::vector<int> &ind)
+    {
+        ind.resize(pair_sort.size());
+        for(unsigned int i = 0; i < ind.size(); i++)
+            ind[i] = pair_sort[i].second;
+    }
 };
 
 /// \endcond
@@ -0,0 +1,289 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SOLVER_PROFILER_H
+#define SOLVER_PROFILER_H
+
+#include <vector>     // std::vector
+#include <string>     // std::string
+#include <sstream>    // std::ostringstream
+#include <ostream>    // std::ostream, std::streamsize
+#include <chrono>     // std::chrono::steady_clock
+#include <cstddef>    // std::size_t
+
+///
+/// \defgroup Profiling Profiling
+///
+/// Timing of the phases of the eigen solvers.
+///
+
+///
+/// \ingroup Profiling
+///
+/// The phases of the eigen solvers that are timed by SolverProfiler.
+///
+enum SOLVER_PHASE
+{
+    PHASE_OP = 0,        ///< Matrix operation, i.e., `perform_op()` of the operation object.
+
+    PHASE_ORTH,          ///< The Lanczos/Arnoldi process excluding the matrix operations,
+                         ///< i.e., the orthogonalization of the new basis vectors.
+
+    PHASE_RESTART_QR,    ///< The dense work on \f$H\f$ in a restart: the shifted QR sweeps
+                         ///< of the implicit restart, or the Schur decomposition of the
+                         ///< Krylov-Schur restart of GenEigsSolver.
+
+    PHASE_RITZ_EIGEN,    ///< The eigen decomposition of \f$H\f$ that gives the Ritz pairs.
+
+    PHASE_UPDATE_V,      ///< The update \f$V\leftarrow VQ\f$ of the basis in a restart.
+
+    PHASE_EIGENVECTORS,  ///< The assembly of the eigenvectors from the basis.
+
+    NUM_SOLVER_PHASES
+};
+
+///
+/// \ingroup Profiling
+///
+/// This class records the wall time and the number of calls of each phase
+/// of an eigen solver, see SOLVER_PHASE, and a trace of the individual calls
+/// that can be exported in the trace event format of Chrome
+/// (`chrome://tracing` or Perfetto).
+///
+/// The solvers only contain a profiler if the macro `ARPACK_ARMA_PROFILE`
+/// is defined before including their headers. Otherwise the timers are
+/// not compiled at all, and the solvers do not have a `profiler()` member.
+///
+/// \code{.cpp}
+/// #define ARPACK_ARMA_PROFILE
+/// #include <armadillo>
+/// #include <SymEigsSolver.h>
+/// #include <fstream>
+///
+/// int main()
+/// {
+///     arma::mat A = arma::randu(1000, 1000);
+///     arma::mat M = A + A.t();
+///     DenseGenMatProd<double> op(M);
+///     SymEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(&op, 10, 30);
+///     eigs.init();
+///     eigs.compute();
+///     arma::mat evecs = eigs.eigenvectors();
+///
+///     const SolverProfiler &prof = eigs.profiler();
+///     std::cout << "matrix operations: " << prof.total_time(PHASE_OP) << "s\n";
+///     std::cout << "solver: " << prof.total_time() - prof.total_time(PHASE_OP) << "s\n";
+///
+///     std::ofstream trace("trace.json");
+///     prof.write_chrome_trace(trace);
+///
+///     return 0;
+/// }
+/// \endcode
+///
+/// The phases may be nested, e.g. the matrix operations inside the
+/// Lanczos process. The times given by total_time() exclude the nested
+/// phases, so that the times of all the phases add up to the time spent
+/// in the solver, and the trace shows the nesting.
+///
+class SolverProfiler
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        int phase;
+        double start;     // microseconds since the origin
+        double duration;  // microseconds
+    };
+
+    Clock::time_point origin;          // time zero of the trace
+    double phase_time[NUM_SOLVER_PHASES];
+    long phase_calls[NUM_SOLVER_PHASES];
+    std::vector<Event> events;         // trace of the calls
+    std::size_t max_events;            // the later calls are only counted
+    std::vector<double> nested;        // for each open phase, the time of the
+                                       // phases nested in it so far
+
+    double elapsed(Clock::time_point t) const
+    {
+        return std::chrono::duration<double, std::micro>(t - origin).count();
+    }
+
+public:
+    ///
+    /// Constructor to create an empty profiler.
+    ///
+    /// \param max_events_ Maximum number of calls kept in the trace. The calls
+    ///                    beyond this limit are still included in total_time()
+    ///                    and num_calls().
+    ///
+    SolverProfiler(std::size_t max_events_ = 100000) :
+        max_events(max_events_)
+    {
+        reset();
+    }
+
+    ///
+    /// Clear all the records, and move the origin of the trace to the current time.
+    ///
+    void reset()
+    {
+        origin = Clock::now();
+        for(int i = 0; i < NUM_SOLVER_PHASES; i++)
+        {
+            phase_time[i] = 0;
+            phase_calls[i] = 0;
+        }
+        events.clear();
+        nested.clear();
+    }
+
+    ///
+    /// Start timing a phase, and return the start time. Usually called by ProfileScope.
+    ///
+    Clock::time_point begin()
+    {
+        nested.push_back(0);
+        return Clock::now();
+    }
+
+    ///
+    /// Finish timing a phase started by begin(). Usually called by ProfileScope.
+    ///
+    void end(int phase, Clock::time_point start)
+    {
+        const Clock::time_point stop = Clock::now();
+        const double t0 = elapsed(start);
+        const double duration = elapsed(stop) - t0;
+
+        phase_time[phase] += (duration - nested.back()) * 1e-6;
+        phase_calls[phase]++;
+        nested.pop_back();
+        if(!nested.empty())
+            nested.back() += duration;
+
+        if(events.size() < max_events)
+        {
+            Event e = { phase, t0, duration };
+            events.push_back(e);
+        }
+    }
+
+    ///
+    /// Returning the wall time in seconds spent in a phase, excluding the
+    /// phases nested in it.
+    ///
+    double total_time(int phase) const { return phase_time[phase]; }
+
+    ///
+    /// Returning the wall time in seconds spent in all the phases.
+    ///
+    double total_time() const
+    {
+        double res = 0;
+        for(int i = 0; i < NUM_SOLVER_PHASES; i++)
+            res += phase_time[i];
+        return res;
+    }
+
+    ///
+    /// Returning the number of calls of a phase.
+    ///
+    long num_calls(int phase) const { return phase_calls[phase]; }
+
+    ///
+    /// Returning the number of calls kept in the trace.
+    ///
+    std::size_t num_events() const { return events.size(); }
+
+    ///
+    /// Returning the name of a phase, as shown in the trace.
+    ///
+    static const char* phase_name(int phase)
+    {
+        static const char* names[NUM_SOLVER_PHASES] = {
+            "matrix operation", "orthogonalization", "restart QR",
+            "Ritz eigen decomposition", "basis update", "eigenvectors"
+        };
+        return names[phase];
+    }
+
+    ///
+    /// Write the trace in the JSON trace event format of Chrome, with one
+    /// complete event (`"ph": "X"`) for each call of a phase.
+    ///
+    /// \param os  The output stream.
+    /// \param pid The process ID of the events.
+    /// \param tid The thread ID of the events, which can be used to show several
+    ///            solvers side by side when their traces are merged.
+    ///
+    void write_chrome_trace(std::ostream &os, int pid = 0, int tid = 0) const
+    {
+        const std::streamsize old_prec = os.precision(15);
+        os << "{\"traceEvents\":[";
+        for(std::size_t i = 0; i < events.size(); i++)
+        {
+            const Event &e = events[i];
+            if(i > 0)
+                os << ",";
+            os << "\n{\"name\":\"" << phase_name(e.phase) << "\",\"cat\":\"eigs\",\"ph\":\"X\""
+               << ",\"ts\":" << e.start << ",\"dur\":" << e.duration
+               << ",\"pid\":" << pid << ",\"tid\":" << tid << "}";
+        }
+        os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        os.precision(old_prec);
+    }
+
+    ///
+    /// Returning the trace in the JSON trace event format of Chrome, see write_chrome_trace().
+    ///
+    std::string chrome_trace(int pid = 0, int tid = 0) const
+    {
+        std::ostringstream os;
+        write_chrome_trace(os, pid, tid);
+        return os.str();
+    }
+};
+
+///
+/// \ingroup Profiling
+///
+/// Time a phase from the construction to the destruction of the object.
+///
+class ProfileScope
+{
+private:
+    SolverProfiler &prof;
+    const int phase;
+    const std::chrono::steady_clock::time_point start;
+
+public:
+    ProfileScope(SolverProfiler &prof_, int phase_) :
+        prof(prof_), phase(phase_), start(prof_.begin())
+    {}
+
+    ~ProfileScope() { prof.end(phase, start); }
+};
+
+
+/// \cond
+
+// EIGS_PROFILE(phase) times the rest of the enclosing block, using the
+// member `prof` of the solver, and expands to nothing without ARPACK_ARMA_PROFILE
+#ifdef ARPACK_ARMA_PROFILE
+#define EIGS_PROFILE_CONCAT_(a, b) a ## b
+#define EIGS_PROFILE_CONCAT(a, b) EIGS_PROFILE_CONCAT_(a, b)
+#define EIGS_PROFILE(phase) ProfileScope EIGS_PROFILE_CONCAT(profile_scope_, __LINE__)(prof, phase)
+#else
+#define EIGS_PROFILE(phase)
+#endif
+
+/// \endcond
+
+
+#endif // SOLVER_PROFILER_H
@@ -0,0 +1,206 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SYM_EIGS_SLICING_SOLVER_H
+#define SYM_EIGS_SLICING_SOLVER_H
+
+#include <armadillo>
+#include <vector>     // std::vector
+#include <cmath>      // std::abs, std::sqrt
+#include <algorithm>  // std::max, std::min, std::sort
+#include <limits>     // std::numeric_limits
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+#include <thread>     // std::thread
+#include <atomic>     // std::atomic
+#include <exception>  // std::exception_ptr
+
+#include "SymEigsSolver.h"
+#include "MatOp/DenseSymShiftSolve.h"
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class computes all the eigenvalues of a real symmetric matrix that lie in
+/// an interval \f$[a, b)\f$, together with the eigenvectors, by **spectrum slicing**.
+///
+/// The interval is split into `nslice` slices of equal width, and each slice is
+/// solved independently by a SymEigsShiftSolver, with the shift at the centre of
+/// the slice, so that the eigenvalues closest to the shift are exactly those in the
+/// slice. The number of eigenvalues in each slice is known in advance, from the
+/// inertia of the LDL factorizations of \f$A-\sigma I\f$ at the slice boundaries
+/// (see SymmetricLDL::num_negative()).
+///
+/// The factorizations at the boundaries and the solves on the slices are run by
+/// a pool of threads, each slice with its own DenseSymShiftSolve object. The results
+/// are then merged, and an eigenpair found by two neighbouring slices is only kept once.
+///
+/// Each thread factorizes a dense \f$n\times n\f$ matrix, so the memory use grows
+/// with the number of threads. When the BLAS library is itself multithreaded,
+/// its number of threads should be reduced accordingly.
+///
+/// \tparam Scalar The element type of the matrix.
+///                Currently supported types are `float` and `double`.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <SymEigsSlicingSolver.h>
+///
+/// int main()
+/// {
+///     arma::mat A = arma::randu(1000, 1000);
+///     arma::mat M = A + A.t();
+///
+///     // All eigenvalues in [-1, 1), in 8 slices, using 4 threads
+///     SymEigsSlicingSolver<double> eigs(M, -1.0, 1.0, 8, 4);
+///     eigs.compute();
+///
+///     arma::vec evalues = eigs.eigenvalues();
+///     evalues.print("Eigenvalues found:");
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template <typename Scalar = double>
+class SymEigsSlicingSolver
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+
+    typedef DenseSymShiftSolve<Scalar> OpType;
+    typedef SymEigsShiftSolver<Scalar, LARGEST_MAGN, OpType> SolverType;
+
+    Matrix &mat;                    // the matrix A
+    const int dim_n;                // dimension of matrix A
+    const int nslice;               // number of slices
+    const int nthread;              // number of threads
+    int nmatop;                     // number of matrix operations, in all slices
+
+    std::vector<Scalar> bounds;     // boundaries of the slices, of length nslice + 1
+    std::vector<int> nbelow;        // number of eigenvalues below each boundary
+    std::vector<Vector> slice_val;  // eigenvalues found in each slice
+    std::vector<Matrix> slice_vec;  // eigenvectors found in each slice
+    std::vector<int> slice_nop;     // number of matrix operations in each slice
+    std::vector<int> slice_miss;    // number of eigenvalues not found in each slice
+
+    static const int max_retry = 2; // number of repeated solves of a slice that
+                                    // did not find all its eigenvalues
+
+    Vector eig_val;                 // merged eigenvalues, in increasing order
+    Matrix eig_vec;                 // merged eigenvectors
+
+    // Tolerance for two computed eigenvalues near x to be regarded as equal
+    static Scalar dup_tol(Scalar x)
+    {
+        return std::sqrt(std::numeric_limits<Scalar>::epsilon()) * std::max(Scalar(1), std::abs(x));
+    }
+
+    // Run task(i) for i = 0, ..., ntask - 1 in the thread pool
+    template <typename Task>
+    inline void run_parallel(int ntask, Task task);
+
+    // Compute the number of eigenvalues below the i-th boundary
+    inline void count_boundary(int i);
+
+    // Solve the eigenvalues in the i-th slice
+    inline void solve_slice(int i, int maxit, Scalar tol);
+
+    // Merge the results of the slices and remove duplicates
+    inline void merge();
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param mat_    An **Armadillo** matrix object, whose type can be `arma::mat`
+    ///                or `arma::fmat`, depending on the template parameter `Scalar` defined.
+    ///                Only its lower triangular part is used.
+    /// \param lower   The lower end \f$a\f$ of the interval.
+    /// \param upper   The upper end \f$b\f$ of the interval.
+    /// \param nslice_ Number of slices. Each slice is a separate shift-and-invert solve,
+    ///                so more slices give smaller and more independent jobs.
+    /// \param nthread_ Number of threads. A nonpositive value means the number of
+    ///                concurrent threads supported by the hardware.
+    ///
+    SymEigsSlicingSolver(Matrix &mat_, Scalar lower, Scalar upper, int nslice_, int nthread_ = 0) :
+        mat(mat_),
+        dim_n(mat_.n_rows),
+        nslice(nslice_),
+        nthread(nthread_ > 0 ? nthread_ : std::max(1, int(std::thread::hardware_concurrency()))),
+        nmatop(0)
+    {
+        if(!mat_.is_square())
+            throw std::invalid_argument("SymEigsSlicingSolver: matrix must be square");
+
+        if(!(lower < upper))
+            throw std::invalid_argument("lower must be less than upper");
+
+        if(nslice_ < 1)
+            throw std::invalid_argument("nslice must be positive");
+
+        bounds.resize(nslice + 1);
+        for(int i = 0; i <= nslice; i++)
+            bounds[i] = lower + (upper - lower) * Scalar(i) / Scalar(nslice);
+        bounds[nslice] = upper;
+    }
+
+    ///
+    /// Conducting the major computation procedure.
+    ///
+    /// \param maxit Maximum number of iterations allowed in the solver of each slice.
+    ///              If a slice does not find all of its eigenvalues, which are counted
+    ///              from the inertia at its boundaries, it is solved again with twice
+    ///              the subspace dimension and twice the iterations, up to two times.
+    /// \param tol Precision parameter for the calculated eigenvalues.
+    ///
+    /// \return Number of eigenvalues found in the interval.
+    ///
+    inline int compute(int maxit = 1000, Scalar tol = 1e-10);
+
+    ///
+    /// Returning the number of eigenvalues in the interval, computed from the
+    /// inertia of \f$A-aI\f$ and \f$A-bI\f$. If this is larger than the value
+    /// returned by compute(), some of the slices did not converge.
+    ///
+    inline int num_expected() { return nbelow.empty() ? 0 : nbelow[nslice] - nbelow[0]; }
+
+    ///
+    /// Returning the number of eigenvalues that were not found in each slice,
+    /// after the repeated solves in compute(). A nonzero entry means that the
+    /// slice did not converge, and its eigenvalues found are still returned.
+    ///
+    inline std::vector<int> num_missing() { return slice_miss; }
+
+    ///
+    /// Returning the number of matrix operations used in all the slices.
+    ///
+    inline int num_operations() { return nmatop; }
+
+    ///
+    /// Returning the eigenvalues found, in increasing order.
+    ///
+    /// \return Returned vector type will be `arma::vec` or `arma::fvec`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Vector eigenvalues() { return eig_val; }
+
+    ///
+    /// Returning the eigenvectors associated with the eigenvalues found.
+    ///
+    /// \return Returned matrix type will be `arma::mat` or `arma::fmat`, depending on
+    /// the template parameter `Scalar` defined.
+    ///
+    inline Matrix eigenvectors() { return eig_vec; }
+};
+
+
+// Implementations
+#include "SymEigsSlicingSolver_Impl.h"
+
+
+#endif // SYM_EIGS_SLICING_SOLVER_H
@@ -0,0 +1,235 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <memory>     // std::unique_ptr
+
+// Run task(i) for i = 0, ..., ntask - 1 in the thread pool
+// The tasks are taken one by one by the threads, in the order of i, and
+// the first exception thrown by a task is rethrown in the calling thread
+template <typename Scalar>
+template <typename Task>
+inline void SymEigsSlicingSolver<Scalar>::run_parallel(int ntask, Task task)
+{
+    std::atomic<int> next(0);
+    std::vector<std::exception_ptr> errors(ntask);
+
+    auto worker = [&]()
+    {
+        for(int i = next++; i < ntask; i = next++)
+        {
+            try {
+                task(i);
+            } catch(...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    // The calling thread is also one of the workers
+    const int nworker = std::min(nthread, ntask);
+    std::vector<std::thread> pool;
+    for(int t = 1; t < nworker; t++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for(size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+
+    for(int i = 0; i < ntask; i++)
+    {
+        if(errors[i])
+            std::rethrow_exception(errors[i]);
+    }
+}
+
+// Compute the number of eigenvalues below the i-th boundary
+template <typename Scalar>
+inline void SymEigsSlicingSolver<Scalar>::count_boundary(int i)
+{
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    Scalar &x = bounds[i];
+
+    OpType op(mat);
+    // If the boundary is an eigenvalue, A - x * I is singular,
+    // and the boundary is moved slightly
+    for(int attempt = 0; ; attempt++)
+    {
+        try {
+            op.set_shift(x);
+            break;
+        } catch(const std::logic_error&) {
+            if(attempt >= 10)
+                throw;
+            x += Scalar(100 * (attempt + 1)) * eps * std::max(Scalar(1), std::abs(x));
+        }
+    }
+
+    nbelow[i] = op.num_below_shift();
+}
+
+// Solve the eigenvalues in the i-th slice
+template <typename Scalar>
+inline void SymEigsSlicingSolver<Scalar>::solve_slice(int i, int maxit, Scalar tol)
+{
+    const int nev_slice = nbelow[i + 1] - nbelow[i];
+    if(nev_slice <= 0)
+        return;
+
+    const Scalar lo = bounds[i], hi = bounds[i + 1];
+    // A few more eigenvalues than those in the slice are requested, which helps
+    // the convergence of the ones close to the boundaries, and the extra ones
+    // are dropped at the end
+    const int nev = std::min(nev_slice + 2, dim_n - 1);
+    int ncv = std::min(std::max(2 * nev + 1, nev + 20), dim_n);
+    int maxit_slice = maxit;
+
+    // An eigenvalue on an interior boundary may be computed on either side of it
+    // by both slices, so the interior boundaries are widened slightly, and the
+    // eigenpairs found twice are removed in merge()
+    Scalar lo_keep = lo, hi_keep = hi;
+    if(i > 0)
+        lo_keep -= dup_tol(lo);
+    if(i < nslice - 1)
+        hi_keep += dup_tol(hi);
+
+    // The eigenvalues closest to the shift are those in the slice
+    // If the shift is an eigenvalue, A - sigma * I is singular,
+    // and the shift is moved slightly
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    Scalar sigma = (lo + hi) / 2;
+    OpType op(mat);
+    // The inertia gives the number of eigenvalues in the slice, so a solve that
+    // misses some of them is repeated with a larger subspace and more iterations
+    for(int retry = 0; ; retry++)
+    {
+        std::unique_ptr<SolverType> eigs;
+        for(int attempt = 0; ; attempt++)
+        {
+            try {
+                eigs.reset(new SolverType(&op, nev, ncv, sigma));
+                break;
+            } catch(const std::logic_error&) {
+                if(attempt >= 10)
+                    throw;
+                sigma += Scalar(100 * (attempt + 1)) * eps * std::max(Scalar(1), std::abs(sigma));
+            }
+        }
+
+        // Each slice has its own seed, so the results do not depend on
+        // the order in which the threads take the slices
+        eigs->set_seed(i + 1);
+        eigs->init();
+        eigs->compute(maxit_slice, tol);
+        slice_nop[i] += eigs->num_operations();
+
+        Vector evals = eigs->eigenvalues();
+        Matrix evecs = eigs->eigenvectors();
+        arma::uvec in_slice = arma::find((evals >= lo_keep) % (evals < hi_keep));
+        slice_val[i] = evals.elem(in_slice);
+        slice_vec[i] = evecs.cols(in_slice);
+
+        // Eigenvalues of the neighboring slices within the widened boundaries
+        // may also be found, so only a shortfall is detected
+        slice_miss[i] = std::max(0, nev_slice - int(in_slice.n_elem));
+        if(slice_miss[i] == 0 || retry >= max_retry || ncv >= dim_n)
+            break;
+
+        ncv = std::min(2 * ncv, dim_n);
+        maxit_slice *= 2;
+    }
+}
+
+// Merge the results of the slices and remove duplicates
+template <typename Scalar>
+inline void SymEigsSlicingSolver<Scalar>::merge()
+{
+    int ntotal = 0;
+    for(int i = 0; i < nslice; i++)
+        ntotal += slice_val[i].n_elem;
+
+    Vector all_val(ntotal);
+    Matrix all_vec(dim_n, ntotal);
+    int start = 0;
+    for(int i = 0; i < nslice; i++)
+    {
+        const int m = slice_val[i].n_elem;
+        if(m == 0)
+            continue;
+        all_val.subvec(start, start + m - 1) = slice_val[i];
+        all_vec.cols(start, start + m - 1) = slice_vec[i];
+        start += m;
+    }
+
+    // An eigenpair close to a boundary may be found by both slices
+    // It is regarded as a duplicate if its eigenvalue is equal to some kept ones
+    // up to the precision, and its eigenvector lies in the span of theirs
+    // For a multiple eigenvalue, the two slices may return different
+    // eigenvectors of the same eigenspace, so comparing the vectors one by one
+    // is not sufficient
+    arma::uvec order = arma::sort_index(all_val);
+    std::vector<arma::uword> keep;
+    for(int i = 0; i < ntotal; i++)
+    {
+        const arma::uword cur = order[i];
+        const Scalar thresh = dup_tol(all_val[cur]);
+
+        std::vector<arma::uword> cluster;
+        for(int j = int(keep.size()) - 1; j >= 0 && all_val[cur] - all_val[keep[j]] <= thresh; j--)
+            cluster.push_back(keep[j]);
+
+        bool dup = false;
+        if(!cluster.empty())
+        {
+            arma::uvec cind(cluster.size());
+            for(size_t j = 0; j < cluster.size(); j++)
+                cind[j] = cluster[j];
+            Matrix K = all_vec.cols(cind);
+            Vector x = all_vec.col(cur);
+            // Distance from x to the span of K
+            Vector r = x - K * arma::solve(K.t() * K, K.t() * x);
+            dup = (arma::norm(r) < Scalar(0.5));
+        }
+        if(!dup)
+            keep.push_back(cur);
+    }
+
+    arma::uvec ind(keep.size());
+    for(size_t i = 0; i < keep.size(); i++)
+        ind[i] = keep[i];
+    eig_val = all_val.elem(ind);
+    eig_vec = all_vec.cols(ind);
+}
+
+// Compute the eigenvalues in the interval
+template <typename Scalar>
+inline int SymEigsSlicingSolver<Scalar>::compute(int maxit, Scalar tol)
+{
+    // Inertia at the boundaries
+    nbelow.assign(nslice + 1, 0);
+    run_parallel(nslice + 1, [this](int i) { count_boundary(i); });
+
+    // Slices with more eigenvalues take longer, so they are started first
+    std::vector<int> order(nslice);
+    for(int i = 0; i < nslice; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int i, int j)
+    {
+        return nbelow[i + 1] - nbelow[i] > nbelow[j + 1] - nbelow[j];
+    });
+
+    slice_val.assign(nslice, Vector());
+    slice_vec.assign(nslice, Matrix());
+    slice_nop.assign(nslice, 0);
+    slice_miss.assign(nslice, 0);
+    run_parallel(nslice, [this, &order, maxit, tol](int i) { solve_slice(order[i], maxit, tol); });
+
+    nmatop = 0;
+    for(int i = 0; i < nslice; i++)
+        nmatop += slice_nop[i];
+
+    merge();
+
+    return eig_val.n_elem;
+}
@@ -9,14 +9,22 @@
 
 #include <armadillo>
 #include <vector>     // std::vector
-#include <cmath>      // std::abs, std::pow, std::sqrt
+#include <cmath>      // std::abs, std::pow, std::sqrt, std::log
 #include <algorithm>  // std::max, std::min
 #include <limits>     // std::numeric_limits
-#include <stdexcept>  // std::invalid_argument
+#include <stdexcept>  // std::invalid_argument, std::logic_error
+#include <chrono>     // std::chrono::steady_clock
 
 #include "SelectionRule.h"
+#include "RestartMethod.h"
+#include "ReorthMethod.h"
+#include "SolverProfiler.h"
+#include "EigsObserver.h"
 #include "LinAlg/UpperHessenbergQR.h"
+#include "LinAlg/FixedTridiagQR.h"
 #include "LinAlg/TridiagEigen.h"
+#include "LinAlg/BasisProduct.h"
+#include "LinAlg/CounterRNG.h"
 #include "MatOp/DenseGenMatProd.h"
 #include "MatOp/DenseSymShiftSolve.h"
 
@@ -65,6 +73,24 @@
 ///                       use the DenseGenMatProd wrapper class, or define their
 ///                       own that impelemnts all the public member functions as in
 ///                       DenseGenMatProd.
+/// \tparam BasisScalar   The element type used to store the Krylov basis \f$V\f$,
+///                       `Scalar` by default. The basis is by far the largest object
+///                       of the solver, so for very large problems it can be stored
+///                       as `float` while `Scalar` is `double`, which halves the memory
+///                       and the memory traffic of the operations on \f$V\f$. All other
+///                       quantities, including \f$H\f$, the residual vector and the
+///                       Ritz pairs, are still computed in `Scalar`. The accuracy of the
+///                       eigenvectors is then limited by the precision of `BasisScalar`.
+/// \tparam FixedNcv      The value of `ncv` known at compile time, or 0 (the default)
+///                       if it is only known at run time. When `ncv` is small, e.g.
+///                       not more than 20, the work on the \f$ncv\times ncv\f$ matrices is
+///                       dominated by loop overhead and memory management rather than
+///                       arithmetic. With a positive `FixedNcv`, \f$H\f$ and the accumulated
+///                       rotations of the restart are fixed-size matrices stored inside
+///                       the solver object, and the shifted QR steps of the implicit restart
+///                       run with compile-time loop lengths, see FixedTridiagQR. The `ncv`
+///                       argument of the constructor must then be equal to `FixedNcv`,
+///                       which can be at most 32.
 ///
 /// Below is an example that demonstrates the usage of this class.
 ///
@@ -136,7 +162,9 @@
 ///
 template < typename Scalar = double,
            int SelectionRule = LARGEST_MAGN,
-           typename OpType = DenseGenMatProd<double> >
+           typename OpType = DenseGenMatProd<double>,
+           typename BasisScalar = Scalar,
+           int FixedNcv = 0 >
 class SymEigsSolver
 {
 private:
@@ -144,6 +172,17 @@ private:
     typedef arma::Col<Scalar> Vector;
     typedef std::vector<bool> BoolVector;
 
+    typedef arma::Mat<BasisScalar> BasisMatrix;
+    typedef BasisProduct<Scalar, BasisScalar> BasisOp;
+
+    // ncv x ncv matrices, of fixed size if FixedNcv > 0
+    typedef typename SmallMatrixType<Scalar, FixedNcv>::type SmallMatrix;
+
+    typedef EigsIteration<Scalar, Scalar> IterationInfo;
+    typedef typename EigsObserver<Scalar, Scalar>::type Observer;
+
+    static_assert(FixedNcv >= 0 && FixedNcv <= 32, "FixedNcv must satisfy 0 <= FixedNcv <= 32");
+
 protected:
     OpType *op;           // object to conduct matrix operation,
                           // e.g. matrix-vector product
@@ -158,9 +197,26 @@ private:
     const int ncv;        // number of ritz values
     int nmatop;           // number of matrix operations called
     int niter;            // number of restarting iterations
-
-    Matrix fac_V;         // V matrix in the Arnoldi factorization
-    Matrix fac_H;         // H matrix in the Arnoldi factorization
+    int restart_method;   // restarting method, see RestartMethod.h
+    int reorth_method;    // reorthogonalization method, see ReorthMethod.h
+    int nreorth;          // number of Lanczos steps in which the residual
+                          // was orthogonalized against the whole basis
+    bool locking;         // whether converged Ritz pairs are locked
+    int nlock;            // number of locked Ritz pairs, which are stored
+                          // in the first nlock columns of V
+    int sstep;            // number of basis vectors generated at a time,
+                          // 1 for the standard Lanczos process
+    int nfac_init;        // number of columns of V set up by init()
+    bool warm_start;      // whether init() has put Ritz vectors into V,
+                          // so that H has the form of a thick restart
+    CounterRNG rng;       // random vectors of init() and of the restarts
+#ifdef ARPACK_ARMA_PROFILE
+    SolverProfiler prof;  // timing of the phases, see SolverProfiler.h
+#endif
+    Observer observer;    // called after each iteration, see set_observer()
+
+    BasisMatrix fac_V;    // V matrix in the Arnoldi factorization
+    SmallMatrix fac_H;    // H matrix in the Arnoldi factorization
     Vector fac_f;         // residual in the Arnoldi factorization
 
 protected:
@@ -169,16 +225,107 @@ protected:
 private:
     Matrix ritz_vec;      // ritz vectors
     BoolVector ritz_conv; // indicator of the convergence of ritz values
+    Vector ritz_resid;    // residual estimates of the ritz values,
+                          // computed in num_converged()
 
     const Scalar prec;    // precision parameter used to test convergence
                           // prec = epsilon^(2/3)
                           // epsilon is the machine precision,
                           // e.g. ~= 1e-16 for the "double" type
+    const Scalar orth_prec; // tolerance for the orthogonality of V
+                            // orth_prec = max(prec, epsilon of BasisScalar),
+                            // since V cannot be more orthogonal than the
+                            // precision that it is stored in
+
+    // Workspace, sized in init() and reused in the restarting iterations,
+    // so that no memory is allocated in the main loop of compute()
+    Vector ws_v;          // the current basis vector in Scalar, of length n
+    Vector ws_w;          // A * v, of length n
+    Vector ws_Bv;         // B * v, only used with the B-inner product
+    Vector ws_Bf;         // B * f, only used with the B-inner product
+    Vector ws_h;          // projection coefficients, of length ncv
+    Vector ws_panel;      // block_rows x ncv, a panel of V * Q in the restart
+    SmallMatrix ws_Q;     // ncv x ncv, accumulated orthogonal transformations
+    Matrix ws_K;          // n x (sstep + 1), Newton basis of the s-step mode
+    Vector ws_shifts;     // sstep, shifts of the Newton basis
+    Vector ws_logdist;    // ncv, log-distances of the Ritz values to the shifts
+    std::vector<int> ws_used;      // ncv, whether a Ritz value is already a shift
+    // Storage of the small matrices in the s-step mode, whose dimensions
+    // change with the column that a block starts at
+    Vector ws_T;          // (sstep + 1) x sstep, recurrence of the Newton basis
+    Vector ws_C;          // up to ncv x sstep, projection of a block onto V
+    Vector ws_Cp;         // up to ncv x sstep, the same in one pass
+    Vector ws_R;          // sstep x sstep, R factor of a block
+    Vector ws_Rp;         // sstep x sstep, the same in one pass
+    Vector ws_G;          // sstep x sstep, Gram matrix of a block
+    Vector ws_F;          // up to (ncv + 1) x (sstep + 1), K in the basis [V Q]
+    Vector ws_Hb;         // up to (ncv + 1) x sstep, new columns of H
+    Vector ws_evals;      // eigenvalues of H
+    Matrix ws_evecs;      // eigenvectors of H
+    Vector ws_syev_work;  // workspace of _syevd, used by the thick restart
+    std::vector<int> ws_syev_iwork;  // integer workspace of _syevd
+    std::vector<int> ws_ind;       // order index of the Ritz values
+    std::vector<int> ws_ind_copy;  // copy of ws_ind, used by BOTH_ENDS
+    TridiagQR<Scalar> decomp_qr;
+    FixedTridiagQR<Scalar, (FixedNcv > 0 ? FixedNcv : 1)> fixed_qr;  // used if FixedNcv > 0
+    TridiagEigen<Scalar> decomp_eigen;
+    SortEigenvalue<Scalar, SelectionRule> sorting;
+
+    // States of the omega-recurrence, used by the partial reorthogonalization
+    // omega_cur[j] estimates v_i' * v_j for the current basis vector v_i,
+    // and omega_prev[j] estimates v_{i-1}' * v_j
+    Vector omega_prev;
+    Vector omega_cur;
+    Vector omega_next;
+    Scalar anorm;         // estimate of ||A||
+    bool reorth_next;     // whether the next step must be reorthogonalized
+
+    // B * x for the B-inner product, computed in Bx, or x itself otherwise
+    inline const Vector& B_times(const Vector &x, Vector &Bx);
+
+    // Reset the omega-recurrence, assuming the basis vectors
+    // up to column i are orthogonal to working precision
+    inline void reset_omega(int i);
+
+    // Reset the part of the omega-recurrence of the basis vector i, after
+    // it has been orthogonalized against the previous ones, using the
+    // remaining inner products Vf = V' * f, and beta = ||f||
+    inline void reset_omega_cur(int i, const Vector &Vf, Scalar beta);
+
+    // Update the omega-recurrence in step i, with beta = ||f||, and
+    // return whether orthogonality has been lost
+    inline bool update_omega(int i, Scalar beta);
+
+    // X <- X * inv(U) in place, where U is upper triangular
+    static inline void mult_inv_upper(Matrix &X, const Matrix &U);
+
+    // Shifts of the Newton basis in the s-step mode, chosen among the
+    // Ritz values in Leja order
+    inline void newton_shifts(int nshift, Vector &shifts);
+
+    // Generate the basis vectors i, ..., i+nstep-1 at a time from the
+    // current residual, and return whether this succeeded
+    inline bool factorize_block(int i, int nstep);
 
     // Arnoldi factorization starting from step-k
     inline void factorize_from(int from_k, int to_m, const Vector &fk);
 
     // Implicitly restarted Arnoldi factorization
+    inline void implicit_restart(int k);
+
+    // Whether H is dense, either because of the thick restart, or
+    // because init() has started from Ritz vectors
+    inline bool thick_form() const { return restart_method == THICK_RESTART || warm_start; }
+
+    // Complete the (k+1)-th column of V and H after the first k columns of V
+    // have been replaced by Ritz vectors, whose values are in ritz_val,
+    // and whose last components are last[0], last[inc], ...
+    inline void extend_arrowhead(int k, int nlock_new, const Scalar *last, int inc);
+
+    // Thick restarted Arnoldi factorization
+    inline void thick_restart(int k);
+
+    // Restart the Arnoldi factorization, keeping k Ritz values
     inline void restart(int k);
 
     // Calculate the number of converged Ritz values
@@ -191,10 +338,23 @@ private:
     inline void retrieve_ritzpair();
 
 protected:
+    // Whether the Lanczos process uses the B-inner product <x, y> = x' * B * y,
+    // which is set by the generalized eigen solvers, see SymGEigsSolver
+    // The basis V is then B-orthonormal, and the operator must be
+    // self-adjoint with respect to this inner product
+    bool use_Binner;
+
+    // y_out = B * x_in, called when use_Binner is true
+    inline virtual void B_prod(const Scalar *x_in, Scalar *y_out) {}
+
     // Sort the first nev Ritz pairs in decreasing magnitude order
     // This is used to return the final results
     inline virtual void sort_ritzpair();
 
+    // Transform the eigenvectors computed by eigenvectors() back to the
+    // original problem, in place, for the solvers that work on a transformed one
+    inline virtual void transform_eigenvectors(Matrix &evecs) {}
+
 public:
     ///
     /// Constructor to create a solver object.
@@ -220,15 +380,151 @@ public:
         ncv(ncv_ > dim_n ? dim_n : ncv_),
         nmatop(0),
         niter(0),
-        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3))
+        restart_method(IMPLICIT_RESTART),
+        reorth_method(FULL_REORTH),
+        nreorth(0),
+        locking(false),
+        nlock(0),
+        sstep(1),
+        nfac_init(1),
+        warm_start(false),
+        prec(std::pow(std::numeric_limits<Scalar>::epsilon(), Scalar(2.0) / 3)),
+        orth_prec(std::max(prec, Scalar(std::numeric_limits<BasisScalar>::epsilon()))),
+        use_Binner(false)
     {
         if(nev_ < 1 || nev_ > dim_n - 1)
             throw std::invalid_argument("nev must satisfy 1 <= nev <= n - 1, n is the size of matrix");
 
         if(ncv_ <= nev_ || ncv_ > dim_n)
             throw std::invalid_argument("ncv must satisfy nev < ncv <= n, n is the size of matrix");
+
+        if(FixedNcv > 0 && ncv_ != FixedNcv)
+            throw std::invalid_argument("ncv must be equal to FixedNcv");
+    }
+
+    ///
+    /// Setting the restarting method. This function should be called
+    /// before compute().
+    ///
+    /// \param method An enumeration value defined in RestartMethod.h,
+    ///               either `IMPLICIT_RESTART` (the default), or `THICK_RESTART`.
+    ///               The thick restart keeps the wanted Ritz vectors directly,
+    ///               instead of applying the unwanted Ritz values as shifts one by one.
+    ///
+    inline void set_restart_method(int method)
+    {
+        if(method != IMPLICIT_RESTART && method != THICK_RESTART)
+            throw std::invalid_argument("unknown restarting method");
+
+        restart_method = method;
+    }
+
+    ///
+    /// Setting the reorthogonalization method of the Lanczos process.
+    /// This function should be called before compute().
+    ///
+    /// \param method An enumeration value defined in ReorthMethod.h,
+    ///               either `FULL_REORTH` (the default), or `PARTIAL_REORTH`.
+    ///               The partial reorthogonalization avoids a pass over the
+    ///               basis \f$V\f$ in most of the Lanczos steps, which is
+    ///               preferable when \f$n\f$ and `ncv` are large.
+    ///
+    inline void set_reorth_method(int method)
+    {
+        if(method != FULL_REORTH && method != PARTIAL_REORTH)
+            throw std::invalid_argument("unknown reorthogonalization method");
+
+        reorth_method = method;
+    }
+
+    ///
+    /// Setting whether converged Ritz pairs should be locked. This function
+    /// should be called before compute().
+    ///
+    /// When locking is enabled, a Ritz pair that has converged is frozen
+    /// in the next restart: it is deflated from \f$H\f$, and its Ritz vector
+    /// is kept in \f$V\f$ and only used to orthogonalize the new basis vectors.
+    /// The restart and the eigen decomposition of \f$H\f$ then only work on the
+    /// pairs that are still active, which becomes cheaper as the solver progresses.
+    ///
+    /// Locking requires the thick restart, see set_restart_method().
+    ///
+    /// \param lock Whether to lock converged Ritz pairs. The default is `false`.
+    ///
+    inline void set_locking(bool lock) { locking = lock; }
+
+    ///
+    /// Setting the number of basis vectors that the Lanczos process generates
+    /// at a time. This function should be called before compute().
+    ///
+    /// In the s-step mode, \f$s\f$ matrix operations are applied in a row to build
+    /// a Newton basis of the next \f$s\f$ Krylov vectors, with the Ritz values of
+    /// the previous iteration as shifts. The block is then orthogonalized against
+    /// \f$V\f$ by two block Gram-Schmidt passes and a Cholesky QR, and \f$H\f$ is
+    /// recovered from the change of basis. \f$V\f$ is thus read a few times per
+    /// block, instead of once or twice per vector, which pays off when \f$V\f$
+    /// is much larger than the cache.
+    ///
+    /// The Newton basis becomes ill-conditioned as \f$s\f$ grows, and values
+    /// between 2 and 8 are advised. When the block cannot be orthogonalized
+    /// stably, the remaining vectors are generated one at a time.
+    ///
+    /// The s-step mode requires the full reorthogonalization, see
+    /// set_reorth_method(), and is not available in the generalized eigen solvers.
+    ///
+    /// \param s The number of vectors \f$s\ge 1\f$. The default is 1, the
+    ///          standard Lanczos process.
+    ///
+    inline void set_sstep(int s)
+    {
+        if(s < 1)
+            throw std::invalid_argument("s must be positive");
+
+        sstep = s;
     }
 
+    ///
+    /// Setting the seed of the random number generator, which draws the
+    /// initial residual vector in init() and the new residual vectors when
+    /// the factorization breaks down. This function should be called
+    /// before init().
+    ///
+    /// Each solver object has its own generator, seeded with 0 by default,
+    /// so the results only depend on the seed, and solvers can be run in
+    /// different threads at the same time.
+    ///
+    inline void set_seed(unsigned long long seed) { rng.seed(seed); }
+
+    ///
+    /// Setting a function to be called after each iteration of compute(),
+    /// i.e., after the first Lanczos factorization and after each restart.
+    ///
+    /// \param obs A function object taking a `const EigsIteration<Scalar, Scalar>&`
+    ///            that describes the current state of the solver, and returning
+    ///            `true` to stop the computation, or `false` to continue. An empty
+    ///            function object removes the observer.
+    ///
+    /// This can be used to monitor the progress, and to stop the computation as
+    /// soon as the accuracy is sufficient for the application, or when it stagnates.
+    /// When the observer stops the computation, compute() returns the number of
+    /// Ritz values that have converged so far, and eigenvalues() and eigenvectors()
+    /// return them as usual. ritz_values() still gives the approximations of the
+    /// others.
+    ///
+    /// In SymEigsShiftSolver the Ritz values are those of the transformed
+    /// matrix \f$(A-\sigma I)^{-1}\f$.
+    ///
+    /// \code{.cpp}
+    /// eigs.set_observer([](const EigsIteration<double, double> &it)
+    /// {
+    ///     std::cout << it.iter << ": " << it.nconv << " converged, "
+    ///               << "max residual " << it.residuals.max() << std::endl;
+    ///     return it.residuals.max() < 1e-6 || it.elapsed > 10.0;
+    /// });
+    /// \endcode
+    ///
+    inline void set_observer(Observer obs) { observer = obs; }
+
     ///
     /// Providing the initial residual vector for the algorithm.
     ///
@@ -245,10 +541,33 @@ public:
     ///
     /// This overloaded function generates a random initial residual vector
     /// for the algorithm. Elements in the vector follow independent Uniform(-0.5, 0.5)
-    /// distributions.
+    /// distributions, drawn from the generator of the solver, see set_seed().
     ///
     inline void init();
 
+    ///
+    /// Providing a block of approximate eigenvectors as the starting point,
+    /// for example the eigenvectors computed for a nearby matrix.
+    ///
+    /// \param init_vecs Pointer to an \f$n\times p\f$ matrix stored in column-major
+    ///                  order, whose columns are the approximate eigenvectors.
+    /// \param nvec      The number of vectors \f$p\f$, which should satisfy \f$1\le p\le ncv\f$.
+    ///
+    /// The vectors are orthonormalized, and a Rayleigh-Ritz projection of \f$A\f$
+    /// onto the subspace they span gives the Ritz vectors that are wanted according
+    /// to the selection rule. A few Lanczos steps from their sum then give a Krylov
+    /// subspace that contains good approximations of them, and as in a thick restart,
+    /// its wanted Ritz vectors are put into the first columns of \f$V\f$, with the
+    /// Ritz values on the diagonal of \f$H\f$. compute() continues the factorization
+    /// from their residual, and the thick restart is then used in all the iterations,
+    /// whatever the restarting method. The Ritz vectors of the projection itself are
+    /// not used directly, since their residuals are not parallel in general, which
+    /// the factorization cannot represent. The projection and the Lanczos steps cost
+    /// \f$p+k+2\f$ matrix operations, where \f$k=\min(nev,p)\f$, which are counted
+    /// in num_operations().
+    ///
+    inline void init(Scalar *init_vecs, int nvec);
+
     ///
     /// Conducting the major computation procedure.
     ///
@@ -257,6 +576,11 @@ public:
     ///
     /// \return Number of converged eigenvalues.
     ///
+    /// Calling compute() again without init() continues the iterations from
+    /// the current factorization, for example after the observer has stopped
+    /// the computation or `maxit` has been reached. num_iterations() and
+    /// num_operations() then count both calls.
+    ///
     inline int compute(int maxit = 1000, Scalar tol = 1e-10);
 
     ///
@@ -269,6 +593,45 @@ public:
     ///
     inline int num_operations() { return nmatop; }
 
+    ///
+    /// Returning the number of Lanczos steps in which the residual vector
+    /// was reorthogonalized against the whole basis. With `FULL_REORTH`
+    /// this is every step. The vectors generated in blocks by the s-step mode,
+    /// see set_sstep(), are orthogonalized as a whole and are not counted.
+    ///
+    inline int num_reorthogonalizations() { return nreorth; }
+
+    ///
+    /// Returning the number of Ritz pairs that were locked in the computation.
+    ///
+    inline int num_locked() { return nlock; }
+
+#ifdef ARPACK_ARMA_PROFILE
+    ///
+    /// Returning the profiler that records the time spent in each phase of
+    /// the solver. It accumulates over the calls of init(), compute() and
+    /// eigenvectors(), until SolverProfiler::reset() is called.
+    ///
+    /// This function is only available if the macro `ARPACK_ARMA_PROFILE` is
+    /// defined before including the header.
+    ///
+    inline SolverProfiler& profiler() { return prof; }
+#endif
+
+    ///
+    /// Returning the current Ritz values, whether they have converged or not,
+    /// in the same order as eigenvalues(). Together with residual_norm(), this gives
+    /// cheap estimates of the spectrum after a few Lanczos steps, for example
+    /// by calling compute() with `maxit = 0`.
+    ///
+    inline Vector ritz_values() { return ritz_val.head(nev); }
+
+    ///
+    /// Returning the norm of the residual vector in the Lanczos factorization.
+    /// Every Ritz value is within this distance of an eigenvalue of \f$A\f$.
+    ///
+    inline Scalar residual_norm();
+
     ///
     /// Returning the converged eigenvalues.
     ///
@@ -348,6 +711,10 @@ public:
 ///                       use the DenseSymShiftSolve wrapper class, or define their
 ///                       own that impelemnts all the public member functions as in
 ///                       DenseSymShiftSolve.
+/// \tparam BasisScalar   The element type used to store the Krylov basis.
+///                       See SymEigsSolver for details.
+/// \tparam FixedNcv      The value of `ncv` known at compile time, or 0.
+///                       See SymEigsSolver for details.
 ///
 /// Below is an example that illustrates the use of the shift-and-invert mode:
 ///
@@ -422,8 +789,10 @@ public:
 ///
 template <typename Scalar = double,
           int SelectionRule = LARGEST_MAGN,
-          typename OpType = DenseSymShiftSolve<double> >
-class SymEigsShiftSolver: public SymEigsSolver<Scalar, SelectionRule, OpType>
+          typename OpType = DenseSymShiftSolve<double>,
+          typename BasisScalar = Scalar,
+          int FixedNcv = 0>
+class SymEigsShiftSolver: public SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>
 {
 private:
     typedef arma::Col<Scalar> Vector;
@@ -435,7 +804,7 @@ private:
     {
         Vector ritz_val_org = Scalar(1.0) / this->ritz_val.head(this->nev) + sigma;
         this->ritz_val.head(this->nev) = ritz_val_org;
-        SymEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair();
+        SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::sort_ritzpair();
     }
 public:
     ///
@@ -457,7 +826,7 @@ public:
     /// \param sigma_ The value of the shift.
     ///
     SymEigsShiftSolver(OpType *op_, int nev_, int ncv_, Scalar sigma_) :
-        SymEigsSolver<Scalar, SelectionRule, OpType>(op_, nev_, ncv_),
+        SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>(op_, nev_, ncv_),
         sigma(sigma_)
     {
         this->op->set_shift(sigma);
@@ -4,22 +4,379 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+// B * x for the B-inner product, computed in Bx, or x itself otherwise
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline const typename SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::Vector&
+SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::B_times(const Vector &x, Vector &Bx)
+{
+    if(!use_Binner)
+        return x;
+
+    B_prod(x.memptr(), Bx.memptr());
+    return Bx;
+}
+
+// Reset the omega-recurrence, assuming the basis vectors
+// up to column i are orthogonal to working precision
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::reset_omega(int i)
+{
+    // Orthogonality level of vectors that are explicitly orthogonalized,
+    // limited by the precision of the basis
+    const Scalar eps = std::max(std::numeric_limits<Scalar>::epsilon(),
+                                Scalar(std::numeric_limits<BasisScalar>::epsilon()));
+    const Scalar eps_n = eps * std::sqrt(Scalar(dim_n));
+
+    std::fill(omega_prev.begin(), omega_prev.begin() + i - 1, eps_n);
+    omega_prev[i - 1] = 1;
+    std::fill(omega_cur.begin(), omega_cur.begin() + i, eps_n);
+    omega_cur[i] = 1;
+}
+
+// The reorthogonalization stops at the level orth_prec, not at the
+// working precision, so the estimates of v_i start from the inner
+// products that remain, and those of v_{i-1} are kept
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::reset_omega_cur(int i, const Vector &Vf, Scalar beta)
+{
+    const Scalar eps = std::max(std::numeric_limits<Scalar>::epsilon(),
+                                Scalar(std::numeric_limits<BasisScalar>::epsilon()));
+    const Scalar eps_n = eps * std::sqrt(Scalar(dim_n));
+
+    for(int j = 0; j < i; j++)
+    {
+        const Scalar omega = Vf[j] / beta;
+        omega_cur[j] = (std::abs(omega) > eps_n) ? omega : (omega >= 0 ? eps_n : -eps_n);
+    }
+    omega_cur[i] = 1;
+}
+
+// Update the omega-recurrence in step i, with beta = ||f||, and
+// return whether orthogonality has been lost
+// See Simon, H. D. (1984). The Lanczos algorithm with partial reorthogonalization.
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline bool SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::update_omega(int i, Scalar beta)
+{
+    // Rounding the basis vectors to BasisScalar introduces
+    // errors of the order of its machine precision
+    const Scalar eps = std::max(std::numeric_limits<Scalar>::epsilon(),
+                                Scalar(std::numeric_limits<BasisScalar>::epsilon()));
+    const Scalar eps_n = eps * std::sqrt(Scalar(dim_n));
+    const Scalar alpha = fac_H(i, i);
+    const Scalar beta_prev = fac_H(i, i - 1);
+    anorm = std::max(anorm, std::abs(alpha) + std::abs(beta_prev) + beta);
+
+    // In this case f will be replaced by a random vector that is
+    // orthogonalized against the whole basis in the next step
+    if(beta < prec)
+        return false;
+
+    Scalar omega_max = 0;
+    for(int j = 0; j < i; j++)
+    {
+        // For j < i, A * v_j = V * H[, j], so
+        // v_i' * A * v_j = sum_l H[l, j] * omega_cur[l], l = 0, ..., i
+        // The sum also covers the arrowhead part of H after a thick restart
+        const Scalar *Hj = fac_H.colptr(j);
+        Scalar vAv = 0;
+        for(int l = 0; l <= i; l++)
+            vAv += Hj[l] * omega_cur[l];
+
+        // beta * v_{i+1}' * v_j = v_i' * A * v_j - alpha * v_i' * v_j - beta_prev * v_{i-1}' * v_j,
+        // plus a rounding error term of magnitude eps * ||A||
+        Scalar omega = vAv - alpha * omega_cur[j] - beta_prev * omega_prev[j];
+        omega += (omega >= 0 ? eps : -eps) * anorm;
+        omega /= beta;
+
+        omega_next[j] = omega;
+        omega_max = std::max(omega_max, std::abs(omega));
+    }
+    omega_next[i] = eps_n;
+    omega_next[i + 1] = 1;
+
+    omega_prev.swap(omega_cur);
+    omega_cur.swap(omega_next);
+
+    return omega_max > std::sqrt(eps);
+}
+
+// X <- X * inv(U), where U is upper triangular, computed in place
+// by forward substitution over the columns of X
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::mult_inv_upper(Matrix &X, const Matrix &U)
+{
+    const int b = U.n_cols;
+    for(int j = 0; j < b; j++)
+    {
+        for(int l = 0; l < j; l++)
+            X.col(j) -= U(l, j) * X.col(l);
+        X.col(j) /= U(j, j);
+    }
+}
+
+// Shifts of the Newton basis in the s-step mode, chosen among the
+// Ritz values in Leja order
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::newton_shifts(int nshift, Vector &shifts)
+{
+    // The first shift has the largest magnitude, and each of the next ones
+    // maximizes the product of the distances to the previous ones, so that
+    // the basis vectors are far from parallel
+    // Before the first restart all the Ritz values are zero, and the
+    // Newton basis reduces to the monomial one
+    Vector &logdist = ws_logdist;
+    std::vector<int> &used = ws_used;
+    logdist.zeros();
+    used.assign(ncv, 0);
+    for(int j = 0; j < nshift; j++)
+    {
+        int best = -1;
+        Scalar best_val = 0;
+        for(int l = 0; l < ncv; l++)
+        {
+            if(used[l])
+                continue;
+
+            const Scalar val = (j == 0) ? std::abs(ritz_val[l]) : logdist[l];
+            if(best < 0 || val > best_val)
+            {
+                best = l;
+                best_val = val;
+            }
+        }
+
+        used[best] = 1;
+        shifts[j] = ritz_val[best];
+        for(int l = 0; l < ncv; l++)
+            logdist[l] += std::log(std::abs(ritz_val[l] - shifts[j]));
+    }
+}
+
+// Generate the basis vectors i, ..., i+nstep-1 at a time from the
+// current residual, and return whether this succeeded
+// See Hoemmen, M. (2010). Communication-avoiding Krylov subspace methods.
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline bool SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::factorize_block(int i, int nstep)
+{
+    // The small matrices below are views of the workspace sized in compute(),
+    // since their dimensions change with i
+    const int b = nstep;
+    Matrix &K = ws_K;
+    Vector &shifts = ws_shifts;
+    newton_shifts(b, shifts);
+
+    // v <- f / ||f||, stored as the (i+1)-th column of V, and also
+    // the first column of K
+    const Scalar beta = arma::norm(fac_f);
+    Vector &v = ws_v;
+    v = fac_f / beta;
+    BasisOp::set_col(fac_V, i, v.memptr());
+    fac_H(i, i - 1) = beta;
+    fac_H(i - 1, i) = beta;
+    K.col(0) = v;
+
+    // K[, j+1] <- (A - theta_j * I) * K[, j] / scale_j
+    // so that A * K[, 0:b-1] = K[, 0:b] * T
+    Matrix T(ws_T.memptr(), b + 1, b, false);
+    T.zeros();
+    for(int j = 0; j < b; j++)
+    {
+        {
+            EIGS_PROFILE(PHASE_OP);
+            op->perform_op(K.colptr(j), K.colptr(j + 1));
+        }
+        nmatop++;
+        K.col(j + 1) -= shifts[j] * K.col(j);
+        const Scalar scale = arma::norm(K.col(j + 1));
+        if(scale < prec)
+            return false;
+        K.col(j + 1) /= scale;
+        T(j, j) = shifts[j];
+        T(j + 1, j) = scale;
+    }
+
+    // Two passes of block Gram-Schmidt against the first i+1 columns of V
+    // K[, 1:b] <- K[, 1:b] - V * C
+    Matrix Kn(K.colptr(1), dim_n, b, false);
+    Matrix C(ws_C.memptr(), i + 1, b, false);
+    Matrix Cp(ws_Cp.memptr(), i + 1, b, false);
+    C.zeros();
+    for(int pass = 0; pass < 2; pass++)
+    {
+        BasisOp::trans_mult(fac_V, i + 1, Kn, Cp);
+        BasisOp::mult_sub(fac_V, i + 1, Cp, Kn);
+        C += Cp;
+    }
+
+    // Two passes of Cholesky QR, K[, 1:b] = Q * R
+    // If the block is numerically rank deficient, the vectors are
+    // generated one at a time instead
+    Matrix R(ws_R.memptr(), b, b, false);
+    Matrix Rp(ws_Rp.memptr(), b, b, false);
+    Matrix G(ws_G.memptr(), b, b, false);
+    R.eye();
+    for(int pass = 0; pass < 2; pass++)
+    {
+        G = Kn.t() * Kn;
+        if(!arma::chol(Rp, G))
+            return false;
+        Scalar rmin = Rp(0, 0), rmax = Rp(0, 0);
+        for(int j = 1; j < b; j++)
+        {
+            rmin = std::min(rmin, Rp(j, j));
+            rmax = std::max(rmax, Rp(j, j));
+        }
+        if(rmin < prec * rmax)
+            return false;
+        mult_inv_upper(Kn, Rp);
+        G = Rp * R;
+        R = G;
+    }
+
+    // K[, 0:b] = [V Q] * F, with F upper triangular in its last b+1 rows
+    Matrix F(ws_F.memptr(), i + 1 + b, b + 1, false);
+    F.zeros();
+    F(i, 0) = 1;
+    F.submat(0, 1, i, b) = C;
+    F.submat(i + 1, 1, i + b, b) = R;
+
+    // Let W = [v_i, Q[, 0:b-2]] be the new basis vectors, so that
+    // K[, 0:b-1] = V[, 0:i-1] * F[0:i-1, 0:b-1] + W * F[i:i+b-1, 0:b-1]
+    // Since A * K[, 0:b-1] = [V Q] * F * T and A * V[, 0:i-1] = V[, 0:i] * H[0:i, 0:i-1],
+    // A * W = [V Q] * Hb, where
+    // Hb = (F * T - H[0:i, 0:i-1] * F[0:i-1, 0:b-1]) * inv(F[i:i+b-1, 0:b-1])
+    Matrix Hb(ws_Hb.memptr(), i + 1 + b, b, false);
+    Hb = F * T;
+    for(int c = 0; c < b; c++)
+    {
+        for(int l = 0; l < i; l++)
+        {
+            const Scalar flc = F(l, c);
+            for(int r = 0; r <= i; r++)
+                Hb(r, c) -= fac_H(r, l) * flc;
+        }
+    }
+    G = F.submat(i, 0, i + b - 1, b - 1);
+    mult_inv_upper(Hb, G);
+
+    // Since A is symmetric, only the tridiagonal part of H is kept,
+    // and the other elements of Hb are rounding errors
+    for(int j = 0; j < b; j++)
+    {
+        fac_H(i + j, i + j) = Hb(i + j, j);
+        if(j < b - 1)
+        {
+            fac_H(i + j + 1, i + j) = Hb(i + j + 1, j);
+            fac_H(i + j, i + j + 1) = fac_H(i + j + 1, i + j);
+            BasisOp::set_col(fac_V, i + j + 1, Kn.colptr(j));
+        }
+    }
+
+    // f <- Hb[i+b, b-1] * Q[, b-1]
+    fac_f = Hb(i + b, b - 1) * Kn.col(b - 1);
+
+    return true;
+}
+
 // Arnoldi factorization starting from step-k
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int from_k, int to_m, const Vector &fk)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::factorize_from(int from_k, int to_m, const Vector &fk)
 {
     if(to_m <= from_k) return;
 
+    // The matrix operations inside are timed separately
+    EIGS_PROFILE(PHASE_ORTH);
+
     fac_f = fk;
 
-    Vector w(dim_n);
-    Scalar beta = std::sqrt(arma::dot(fac_f, fac_f)), Hii = 0.0;
+    // With the B-inner product, Bf = B * f is updated whenever f changes,
+    // and all the inner products with f and v use Bf and Bv
+    // Otherwise Bf and Bv refer to f and v themselves
+    Vector &w = ws_w;
+    const Vector &Bf = B_times(fac_f, ws_Bf);
+    const Vector &Bv = use_Binner ? ws_Bv : ws_v;
+
+    // The basis kept from the last restart is orthogonal to the level
+    // maintained by the recurrence, but fk may not be, so fk is
+    // orthogonalized against it, and the first step is always
+    // reorthogonalized
+    if(reorth_method == PARTIAL_REORTH)
+    {
+        reset_omega(from_k);
+        reorth_next = true;
+
+        Scalar beta = std::sqrt(arma::dot(fac_f, Bf));
+        if(from_k > 0 && beta >= prec)
+        {
+            nreorth++;
+            Vector Vf(ws_h.memptr(), from_k, false);
+            BasisOp::trans_mult(fac_V, from_k, Bf.memptr(), Vf.memptr());
+            int count = 0;
+            while(count < 5 && arma::abs(Vf).max() > orth_prec * beta)
+            {
+                BasisOp::mult_sub(fac_V, from_k, Vf.memptr(), fac_f.memptr());
+                B_times(fac_f, ws_Bf);
+                beta = std::sqrt(arma::dot(fac_f, Bf));
+                BasisOp::trans_mult(fac_V, from_k, Bf.memptr(), Vf.memptr());
+                count++;
+            }
+            if(beta >= prec)
+                reset_omega_cur(from_k, Vf, beta);
+        }
+    }
     // Keep the upperleft k x k submatrix of H and set other elements to 0
     fac_H.tail_cols(ncv - from_k).zeros();
     fac_H.submat(arma::span(from_k, ncv - 1), arma::span(0, from_k - 1)).zeros();
-    for(int i = from_k; i <= to_m - 1; i++)
+
+    // In the s-step mode, the vectors are generated in blocks, and the
+    // standard process only completes the last step, or takes over when
+    // a block fails
+    int from_i = from_k;
+    if(sstep > 1)
+    {
+        while(to_m - from_i >= 2 && arma::norm(fac_f) >= prec)
+        {
+            const int nstep = std::min(sstep, to_m - from_i);
+            if(!factorize_block(from_i, nstep))
+                break;
+            from_i += nstep;
+        }
+    }
+
+    Scalar beta = std::sqrt(arma::dot(fac_f, Bf)), Hii = 0.0;
+    for(int i = from_i; i <= to_m - 1; i++)
     {
         bool restart = false;
         // If beta = 0, then the next V is not full rank
@@ -27,20 +384,28 @@ inline void SymEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
         // to the current V, which we call a restart
         if(beta < prec)
         {
-            fac_f.randu();
+            rng.uniform(fac_f.memptr(), dim_n);
             // f <- f - V * V' * f, so that f is orthogonal to V
-            Matrix Vs(fac_V.memptr(), dim_n, i, false); // First i columns
-            Vector Vf = Vs.t() * fac_f;
-            fac_f -= Vs * Vf;
+            // using the first i columns of V
+            B_times(fac_f, ws_Bf);
+            BasisOp::trans_mult(fac_V, i, Bf.memptr(), ws_h.memptr());
+            BasisOp::mult_sub(fac_V, i, ws_h.memptr(), fac_f.memptr());
             // beta <- ||f||
-            beta = std::sqrt(arma::dot(fac_f, fac_f));
+            B_times(fac_f, ws_Bf);
+            beta = std::sqrt(arma::dot(fac_f, Bf));
 
             restart = true;
+            if(reorth_method == PARTIAL_REORTH)
+                reset_omega(i);
         }
 
-        // v <- f / ||f||
-        Vector v(fac_V.colptr(i), dim_n, false); // The (i+1)-th column
+        // v <- f / ||f||, stored as the (i+1)-th column of V
+        // v is updated to the stored values, in case V has a lower precision
+        Vector &v = ws_v;
         v = fac_f / beta;
+        BasisOp::set_col(fac_V, i, v.memptr());
+        if(use_Binner)
+            ws_Bv = Bf / beta;
 
         // Note that H[i+1, i] equals to the unrestarted beta
         if(restart)
@@ -49,106 +414,284 @@ inline void SymEigsSolver<Scalar, SelectionRule, OpType>::factorize_from(int fro
             fac_H(i, i - 1) = beta;
 
         // w <- A * v, v = fac_V.col(i)
-        op->perform_op(v.memptr(), w.memptr());
+        {
+            EIGS_PROFILE(PHASE_OP);
+            op->perform_op(v.memptr(), w.memptr());
+        }
         nmatop++;
 
-        Hii = arma::dot(v, w);
+        Hii = arma::dot(Bv, w);
         fac_H(i - 1, i) = fac_H(i, i - 1); // Due to symmetry
         fac_H(i, i) = Hii;
 
         // f <- w - V * V' * w = w - H[i+1, i] * V{i} - H[i+1, i+1] * V{i+1}
         // If restarting, we know that H[i+1, i] = 0
-        if(restart)
-            fac_f = w - Hii * v;
-        else
-            fac_f = w - fac_H(i, i - 1) * fac_V.col(i - 1) - Hii * v;
+        fac_f = w - Hii * v;
+        if(!restart)
+            BasisOp::axpy(-fac_H(i, i - 1), fac_V, i - 1, fac_f.memptr());
 
-        beta = std::sqrt(arma::dot(fac_f, fac_f));
+        B_times(fac_f, ws_Bf);
+        beta = std::sqrt(arma::dot(fac_f, Bf));
+
+        // With partial reorthogonalization, f is only tested against V
+        // when the omega-recurrence indicates a loss of orthogonality
+        // Following Simon's rule, if this happens in step i, both step i
+        // and step i+1 are reorthogonalized
+        if(reorth_method == PARTIAL_REORTH)
+        {
+            const bool lost = update_omega(i, beta);
+            const bool forced = reorth_next;
+            reorth_next = lost;
+            if(!lost && !forced)
+                continue;
+        }
+        nreorth++;
 
         // f/||f|| is going to be the next column of V, so we need to test
-        // whether V' * (f/||f||) ~= 0
-        Matrix Vs(fac_V.memptr(), dim_n, i + 1, false); // First i+1 columns
-        Vector Vf = Vs.t() * fac_f;
+        // whether V' * (f/||f||) ~= 0, using the first i+1 columns of V
+        Vector Vf(ws_h.memptr(), i + 1, false);
+        BasisOp::trans_mult(fac_V, i + 1, Bf.memptr(), Vf.memptr());
         // If not, iteratively correct the residual
         int count = 0;
-        while(count < 5 && arma::abs(Vf).max() > prec * beta)
+        while(count < 5 && arma::abs(Vf).max() > orth_prec * beta)
         {
             // f <- f - V * Vf
-            fac_f -= Vs * Vf;
+            BasisOp::mult_sub(fac_V, i + 1, Vf.memptr(), fac_f.memptr());
             // h <- h + Vf
             fac_H(i - 1, i) += Vf[i - 1];
             fac_H(i, i - 1) = fac_H(i - 1, i);
             fac_H(i, i) += Vf[i];
             // beta <- ||f||
-            beta = std::sqrt(arma::dot(fac_f, fac_f));
+            B_times(fac_f, ws_Bf);
+            beta = std::sqrt(arma::dot(fac_f, Bf));
 
-            Vf = Vs.t() * fac_f;
+            BasisOp::trans_mult(fac_V, i + 1, Bf.memptr(), Vf.memptr());
             count++;
         }
+
+        // Only the new vector v_{i+1} is orthogonalized, and v_i keeps its
+        // estimates, unless it was orthogonalized in the previous step
+        if(reorth_method == PARTIAL_REORTH && beta >= prec)
+            reset_omega_cur(i + 1, Vf, beta);
     }
 }
 
 // Implicitly restarted Arnoldi factorization
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::restart(int k)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::implicit_restart(int k)
 {
     if(k >= ncv)
         return;
 
-    TridiagQR<Scalar> decomp;
-    Matrix Q = arma::eye<Matrix>(ncv, ncv);
+    Matrix &Q = ws_Q;
+    Q.eye();
 
-    for(int i = k; i < ncv; i++)
     {
-        // QR decomposition of H-mu*I, mu is the shift
-        fac_H.diag() -= ritz_val[i];
-        decomp.compute(fac_H);
+        EIGS_PROFILE(PHASE_RESTART_QR);
+        if(FixedNcv > 0)
+        {
+            // The same QR steps on the diagonals of H, with
+            // loops of compile-time lengths
+            fixed_qr.load(fac_H.memptr());
+            for(int i = k; i < ncv; i++)
+                fixed_qr.shift(ritz_val[i], Q.memptr());
+            fixed_qr.store(fac_H.memptr());
+        } else {
+            for(int i = k; i < ncv; i++)
+            {
+                // QR decomposition of H-mu*I, mu is the shift
+                fac_H.diag() -= ritz_val[i];
+                decomp_qr.compute(fac_H);
 
-        // Q -> Q * Qi
-        decomp.apply_YQ(Q);
+                // Q -> Q * Qi
+                decomp_qr.apply_YQ(Q);
 
-        // H -> Q'HQ
-        // Since QR = H - mu * I, we have H = QR + mu * I
-        // and therefore Q'HQ = RQ + mu * I
-        fac_H = decomp.matrix_RQ();
-        fac_H.diag() += ritz_val[i];
+                // H -> Q'HQ
+                // Since QR = H - mu * I, we have H = QR + mu * I
+                // and therefore Q'HQ = RQ + mu * I
+                decomp_qr.matrix_RQ(fac_H);
+                fac_H.diag() += ritz_val[i];
+            }
+        }
     }
 
     // V -> VQ, only need to update the first k+1 columns
-    // Q has some elements being zero
-    // The first (ncv - k + i) elements of the i-th column of Q are non-zero
-    Matrix Vs(dim_n, k + 1);
-    int nnz;
+    // This is done in place, one panel of rows at a time
+    Matrix Qk(Q.memptr(), ncv, k + 1, false);
+    {
+        EIGS_PROFILE(PHASE_UPDATE_V);
+        BasisOp::mult_inplace(fac_V, ncv, Qk, ws_panel.memptr());
+    }
+
+    // f -> f * Q[ncv, k] + V[, k+1] * H[k+1, k]
+    fac_f *= Q(ncv - 1, k - 1);
+    BasisOp::axpy(fac_H(k, k - 1), fac_V, k, fac_f.memptr());
+    factorize_from(k, ncv, fac_f);
+    retrieve_ritzpair();
+}
+
+// Complete the (k+1)-th column of V and H after the first k columns of V
+// have been replaced by Ritz vectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::extend_arrowhead(int k, int nlock_new, const Scalar *last, int inc)
+{
+    // A * V * Y = V * Y * Theta + f * e' * Y
+    // So H becomes an arrowhead matrix
+    // [Theta  s ]
+    // [s'     * ]
+    // where s = ||f|| * (last row of Y)', given by last
+    // For the locked Ritz pairs s is below the convergence tolerance,
+    // and is set to zero, so that they are decoupled from the rest of H
+    Scalar beta = residual_norm();
+    fac_H.zeros();
     for(int i = 0; i < k; i++)
+        fac_H(i, i) = ritz_val[i];
+
+    // The (k+1)-th column of V
+    Vector &v = ws_v;
+    if(beta < prec)
     {
-        nnz = ncv - k + i + 1;
-        Matrix V(fac_V.memptr(), dim_n, nnz, false);
-        Vector q(Q.colptr(i), nnz, false);
-        Vs.col(i) = V * q;
+        // f is zero, so V * Y spans an invariant subspace, and s = 0
+        // Generate a new residual vector that is orthogonal to V * Y
+        rng.uniform(v.memptr(), dim_n);
+        BasisOp::trans_mult(fac_V, k, B_times(v, ws_Bv).memptr(), ws_h.memptr());
+        BasisOp::mult_sub(fac_V, k, ws_h.memptr(), v.memptr());
+        v /= std::sqrt(arma::dot(v, B_times(v, ws_Bv)));
+    } else {
+        v = fac_f / beta;
+        for(int i = nlock_new; i < k; i++)
+        {
+            fac_H(k, i) = beta * last[i * inc];
+            fac_H(i, k) = fac_H(k, i);
+        }
     }
-    Vs.col(k) = fac_V * Q.col(k);
-    fac_V.head_cols(k + 1) = Vs;
+    nlock = nlock_new;
+    BasisOp::set_col(fac_V, k, v.memptr());
+
+    // w <- A * v
+    Vector &w = ws_w;
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(v.memptr(), w.memptr());
+    }
+    nmatop++;
 
-    Vector fk = fac_f * Q(ncv - 1, k - 1) + fac_V.col(k) * fac_H(k, k - 1);
-    factorize_from(k, ncv, fk);
+    // A * v has components on all the Ritz vectors kept, so v is
+    // orthogonalized against the whole basis in this step, including
+    // the locked vectors
+    // The coefficients on the first k columns are given by s
+    // using the first k+1 columns of V
+    {
+        EIGS_PROFILE(PHASE_ORTH);
+        Scalar *h = ws_h.memptr();
+        fac_f = w;
+        const Vector &Bf = B_times(fac_f, ws_Bf);
+        BasisOp::trans_mult(fac_V, k + 1, Bf.memptr(), h);
+        BasisOp::mult_sub(fac_V, k + 1, h, fac_f.memptr());
+        Scalar hkk = h[k];
+        B_times(fac_f, ws_Bf);
+        BasisOp::trans_mult(fac_V, k + 1, Bf.memptr(), h);
+        BasisOp::mult_sub(fac_V, k + 1, h, fac_f.memptr());
+        fac_H(k, k) = hkk + h[k];
+        // factorize_from() updates B * f, unless there is no step left
+        if(k + 1 >= ncv)
+            B_times(fac_f, ws_Bf);
+    }
+}
+
+// Thick restarted Arnoldi factorization
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::thick_restart(int k)
+{
+    if(k >= ncv)
+        return;
+
+    // Lock the newly converged Ritz pairs, by moving them to
+    // the front of the active ones
+    // The order of the kept Ritz pairs does not matter in a thick restart,
+    // but their convergence flags and residuals are moved with them, so
+    // that they still match if compute() stops before the next estimate
+    int nlock_new = nlock;
+    if(locking)
+    {
+        for(int i = nlock; i < nev; i++)
+        {
+            if(!ritz_conv[i])
+                continue;
+
+            if(i != nlock_new)
+            {
+                std::swap(ritz_val[i], ritz_val[nlock_new]);
+                std::swap_ranges(ritz_vec.colptr(i), ritz_vec.colptr(i) + ncv,
+                                 ritz_vec.colptr(nlock_new));
+                BoolVector::swap(ritz_conv[i], ritz_conv[nlock_new]);
+                std::swap(ritz_resid[i], ritz_resid[nlock_new]);
+            }
+            nlock_new++;
+        }
+    }
+
+    // V -> V * Y, Y contains the first k Ritz vectors
+    // The locked columns of V are not changed, and since H is block diagonal,
+    // the other Ritz vectors only involve the active columns of V
+    const int nact = ncv - nlock;
+    Matrix Y(ws_Q.memptr(), nact, k - nlock, false);
+    Y = ritz_vec.submat(nlock, nlock, ncv - 1, k - 1);
+    BasisMatrix Va(fac_V.colptr(nlock), dim_n, nact, false);
+    {
+        EIGS_PROFILE(PHASE_UPDATE_V);
+        BasisOp::mult_inplace(Va, nact, Y, ws_panel.memptr());
+    }
+
+    extend_arrowhead(k, nlock_new, ritz_vec.memptr() + ncv - 1, ncv);
+
+    // The Lanczos recurrence is three-term again from the next step
+    factorize_from(k + 1, ncv, fac_f);
     retrieve_ritzpair();
 }
 
+// Restart the Arnoldi factorization, keeping k Ritz values
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::restart(int k)
+{
+    if(thick_form())
+        thick_restart(k);
+    else
+        implicit_restart(k);
+}
+
 // Calculate the number of converged Ritz values
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline int SymEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar tol)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline int SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::num_converged(Scalar tol)
 {
     // thresh = tol * max(prec, abs(theta)), theta for ritz value
-    const Scalar f_norm = arma::norm(fac_f);
+    const Scalar f_norm = residual_norm();
     for(int i = 0; i < nev; i++)
     {
         Scalar thresh = tol * std::max(prec, std::abs(ritz_val[i]));
         Scalar resid = std::abs(ritz_vec(ncv - 1, i)) * f_norm;
         ritz_conv[i] = (resid < thresh);
+        ritz_resid[i] = resid;
     }
 
     return std::count(ritz_conv.begin(), ritz_conv.end(), true);
@@ -157,8 +700,10 @@ inline int SymEigsSolver<Scalar, SelectionRule, OpType>::num_converged(Scalar to
 // Return the adjusted nev for restarting
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline int SymEigsSolver<Scalar, SelectionRule, OpType>::nev_adjusted(int nconv)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline int SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::nev_adjusted(int nconv)
 {
     int nev_new = nev;
 
@@ -175,18 +720,42 @@ inline int SymEigsSolver<Scalar, SelectionRule, OpType>::nev_adjusted(int nconv)
 // Retrieve and sort ritz values and ritz vectors
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::retrieve_ritzpair()
 {
-    /*Vector evals(ncv);
-    Matrix evecs(ncv, ncv);
-    arma::eig_sym(evals, evecs, arma::symmatl(fac_H));*/
-    TridiagEigen<Scalar> decomp(fac_H);
-    Vector evals = decomp.eigenvalues();
-    Matrix evecs = decomp.eigenvectors();
-
-    SortEigenvalue<Scalar, SelectionRule> sorting(evals.memptr(), evals.n_elem);
-    std::vector<int> ind = sorting.index();
+    // Size of the active block of H
+    const int nact = ncv - nlock;
+    // The eigen decomposition of the active block, stored in the workspace
+    Vector evals(ws_evals.memptr(), nact, false);
+    Matrix evecs(ws_evecs.memptr(), nact, nact, false);
+    {
+        EIGS_PROFILE(PHASE_RITZ_EIGEN);
+        if(thick_form())
+        {
+            // After a thick restart H is no longer tridiagonal
+            // The locked Ritz pairs are decoupled from the rest of H,
+            // so only the active block needs to be decomposed
+            // It is overwritten by its eigenvectors in _syevd, which only
+            // reads the lower triangular part
+            evecs = fac_H.submat(nlock, nlock, ncv - 1, ncv - 1);
+            char jobz = 'V', uplo = 'L';
+            int n = nact, lwork = ws_syev_work.n_elem, liwork = ws_syev_iwork.size(), info;
+            arma::lapack::syevd(&jobz, &uplo, &n, evecs.memptr(), &n, evals.memptr(),
+                                ws_syev_work.memptr(), &lwork, &ws_syev_iwork[0], &liwork, &info);
+            if(info != 0)
+                throw std::logic_error("SymEigsSolver: failed to compute the eigen decomposition of H");
+        } else {
+            decomp_eigen.compute(fac_H);
+            evals = decomp_eigen.eigenvalues();
+            evecs = decomp_eigen.eigenvectors();
+        }
+    }
+
+    sorting.compute(evals.memptr(), nact);
+    std::vector<int> &ind = ws_ind;
+    sorting.index(ind);
 
     // For BOTH_ENDS, the eigenvalues are sorted according
     // to the LARGEST_ALGE rule, so we need to move those smallest
@@ -198,26 +767,40 @@ inline void SymEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
     // or is nev (used in sort_ritzpair())
     if(SelectionRule == BOTH_ENDS)
     {
-        std::vector<int> ind_copy(ind);
-        for(int i = 0; i < ncv; i++)
+        std::vector<int> &ind_copy = ws_ind_copy;
+        ind_copy = ind;
+        for(int i = 0; i < nact; i++)
         {
             // If i is even, pick values from the left (large values)
             // If i is odd, pick values from the right (small values)
             if(i % 2 == 0)
                 ind[i] = ind_copy[i / 2];
             else
-                ind[i] = ind_copy[ncv - 1 - i / 2];
+                ind[i] = ind_copy[nact - 1 - i / 2];
         }
     }
 
+    // The locked Ritz pairs always stay in the front, and their
+    // Ritz vectors are the corresponding columns of V
+    for(int i = 0; i < nlock; i++)
+    {
+        ritz_val[i] = fac_H(i, i);
+        ritz_vec.col(i).zeros();
+        ritz_vec(i, i) = Scalar(1);
+    }
+
     // Copy the ritz values and vectors to ritz_val and ritz_vec, respectively
-    for(int i = 0; i < ncv; i++)
+    for(int i = 0; i < nact; i++)
     {
-        ritz_val[i] = evals[ind[i]];
+        ritz_val[nlock + i] = evals[ind[i]];
     }
-    for(int i = 0; i < nev; i++)
+    // All the ritz vectors are kept, since the thick restart needs
+    // more than nev of them
+    for(int i = 0; i < nact; i++)
     {
-        ritz_vec.col(i) = evecs.col(ind[i]);
+        Scalar *y = ritz_vec.colptr(nlock + i);
+        std::fill(y, y + nlock, Scalar(0));
+        std::copy(evecs.colptr(ind[i]), evecs.colptr(ind[i]) + nact, y + nlock);
     }
 }
 
@@ -227,26 +810,33 @@ inline void SymEigsSolver<Scalar, SelectionRule, OpType>::retrieve_ritzpair()
 // This is used to return the final results
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair()
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::sort_ritzpair()
 {
     SortEigenvalue<Scalar, LARGEST_MAGN> sorting(ritz_val.memptr(), nev);
     std::vector<int> ind = sorting.index();
 
-    Vector new_ritz_val(ncv);
+    // Only the first nev pairs are permuted, and ritz_vec keeps its
+    // ncv columns, which a later compute() still writes to
+    Vector new_ritz_val(nev);
     Matrix new_ritz_vec(ncv, nev);
     BoolVector new_ritz_conv(nev);
+    Vector new_ritz_resid(nev);
 
     for(int i = 0; i < nev; i++)
     {
         new_ritz_val[i] = ritz_val[ind[i]];
         new_ritz_vec.col(i) = ritz_vec.col(ind[i]);
         new_ritz_conv[i] = ritz_conv[ind[i]];
+        new_ritz_resid[i] = ritz_resid[ind[i]];
     }
 
-    ritz_val.swap(new_ritz_val);
-    ritz_vec.swap(new_ritz_vec);
+    ritz_val.head(nev) = new_ritz_val;
+    ritz_vec.head_cols(nev) = new_ritz_vec;
     ritz_conv.swap(new_ritz_conv);
+    ritz_resid.swap(new_ritz_resid);
 }
 
 
@@ -254,61 +844,243 @@ inline void SymEigsSolver<Scalar, SelectionRule, OpType>::sort_ritzpair()
 // Initialization and clean-up
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::init(Scalar *init_resid)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::init(Scalar *init_resid)
 {
     // Reset all matrices/vectors to zero
     fac_V.zeros(dim_n, ncv);
     fac_H.zeros(ncv, ncv);
     fac_f.zeros(dim_n);
     ritz_val.zeros(ncv);
-    ritz_vec.zeros(ncv, nev);
+    ritz_vec.zeros(ncv, ncv);
     ritz_conv.assign(nev, false);
+    ritz_resid.zeros(nev);
+
+    ws_v.set_size(dim_n);
+    ws_w.set_size(dim_n);
+    if(use_Binner)
+    {
+        ws_Bv.set_size(dim_n);
+        ws_Bf.set_size(dim_n);
+    }
+    ws_h.set_size(ncv);
+    ws_panel.set_size(std::min(dim_n, int(BasisOp::block_rows)) * ncv);
+    ws_Q.set_size(ncv, ncv);
+    ws_evals.set_size(ncv);
+    ws_evecs.set_size(ncv, ncv);
+    ws_ind.reserve(ncv);
+    ws_ind_copy.reserve(ncv);
+
+    // The omega-recurrence may refer to column ncv, i.e., the residual
+    omega_prev.zeros(ncv + 1);
+    omega_cur.zeros(ncv + 1);
+    omega_next.zeros(ncv + 1);
+    anorm = 0;
+    reorth_next = false;
 
     nmatop = 0;
     niter = 0;
+    nreorth = 0;
+    nlock = 0;
+    nfac_init = 1;
+    warm_start = false;
 
     Vector r(init_resid, dim_n, false);
     // The first column of fac_V
-    Vector v(fac_V.colptr(0), dim_n, false);
-    Scalar rnorm = arma::norm(r);
+    Vector &v = ws_v;
+    Scalar rnorm = std::sqrt(arma::dot(r, B_times(r, ws_Bv)));
     if(rnorm < prec)
         throw std::invalid_argument("initial residual vector cannot be zero");
     v = r / rnorm;
+    BasisOp::set_col(fac_V, 0, v.memptr());
+    if(use_Binner)
+        ws_Bv /= rnorm;
 
-    Vector w(dim_n);
-    op->perform_op(v.memptr(), w.memptr());
+    Vector &w = ws_w;
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(v.memptr(), w.memptr());
+    }
     nmatop++;
 
-    fac_H(0, 0) = arma::dot(v, w);
+    const Vector &Bv = use_Binner ? ws_Bv : v;
+    fac_H(0, 0) = arma::dot(Bv, w);
     fac_f = w - v * fac_H(0, 0);
 }
 
 // Initialization with random initial coefficients
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline void SymEigsSolver<Scalar, SelectionRule, OpType>::init()
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::init()
+{
+    Vector init_resid(dim_n);
+    rng.uniform(init_resid.memptr(), dim_n);
+    init(init_resid.memptr());
+}
+
+// Initialization from a block of approximate eigenvectors
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline void SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::init(Scalar *init_vecs, int nvec)
 {
-    Vector init_resid(dim_n, arma::fill::randu);
-    init_resid -= 0.5;
+    if(nvec < 1 || nvec > ncv)
+        throw std::invalid_argument("nvec must satisfy 1 <= nvec <= ncv");
+
+    // Orthonormal basis of the given vectors
+    // If they are linearly dependent, Q still has orthonormal columns,
+    // which only enlarge the subspace of the projection
+    Matrix X(init_vecs, dim_n, nvec, false);
+    Matrix Q, R;
+    if(!arma::qr_econ(Q, R, X))
+        throw std::logic_error("SymEigsSolver: failed to orthonormalize the initial vectors");
+
+    // Rayleigh-Ritz: G = Q' * A * Q
+    Matrix AQ(dim_n, nvec);
+    for(int i = 0; i < nvec; i++)
+    {
+        EIGS_PROFILE(PHASE_OP);
+        op->perform_op(Q.colptr(i), AQ.colptr(i));
+    }
+    Matrix G = Q.t() * AQ;
+    G = Scalar(0.5) * (G + G.t());
+
+    Vector evals;
+    Matrix evecs;
+    if(!arma::eig_sym(evals, evecs, G))
+        throw std::logic_error("SymEigsSolver: failed to compute the Rayleigh-Ritz projection");
+
+    // Sum of the wanted Ritz vectors, in the coordinates of Q
+    // For BOTH_ENDS, they are taken alternately from the two ends
+    sorting.compute(evals.memptr(), nvec);
+    std::vector<int> ind = sorting.index();
+    const int nwant = std::min(nev, nvec);
+    Vector y(nvec, arma::fill::zeros);
+    for(int i = 0; i < nwant; i++)
+    {
+        int j = ind[i];
+        if(SelectionRule == BOTH_ENDS)
+            j = (i % 2 == 0) ? ind[i / 2] : ind[nvec - 1 - i / 2];
+        y += evecs.col(j);
+    }
+
+    Vector init_resid = Q * y;
     init(init_resid.memptr());
+    nmatop += nvec;
+
+    // The Ritz vectors of the projection cannot be put into V directly,
+    // since their residuals span up to p directions, while the Lanczos
+    // factorization only keeps one residual vector
+    // Instead, k+1 Lanczos steps are taken from their sum, whose Krylov
+    // subspace approximates the span of the k wanted ones, and the k wanted
+    // Ritz vectors of this subspace become the first columns of V, as in a
+    // thick restart
+    // The short process runs one step at a time, since the workspace of the
+    // s-step mode is only set up in compute()
+    const int k = std::min(nwant, ncv - 1);
+    const int sstep_user = sstep;
+    sstep = 1;
+    factorize_from(1, k + 1, fac_f);
+    sstep = sstep_user;
+
+    Matrix T = fac_H.submat(0, 0, k, k);
+    if(!arma::eig_sym(evals, evecs, T))
+        throw std::logic_error("SymEigsSolver: failed to compute the eigen decomposition of H");
+    sorting.compute(evals.memptr(), k + 1);
+    sorting.index(ind);
+    Matrix Y(k + 1, k);
+    for(int i = 0; i < k; i++)
+    {
+        int j = ind[i];
+        if(SelectionRule == BOTH_ENDS)
+            j = (i % 2 == 0) ? ind[i / 2] : ind[k - i / 2];
+        ritz_val[i] = evals[j];
+        Y.col(i) = evecs.col(j);
+    }
+
+    // V -> V * Y, and H becomes an arrowhead matrix
+    BasisMatrix Va(fac_V.colptr(0), dim_n, k + 1, false);
+    BasisOp::mult_inplace(Va, k + 1, Y, ws_panel.memptr());
+    extend_arrowhead(k, 0, Y.memptr() + k, k + 1);
+
+    nfac_init = k + 1;
+    warm_start = true;
 }
 
 // Compute Ritz pairs and return the number of converged eigenvalues
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline int SymEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scalar tol)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline int SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::compute(int maxit, Scalar tol)
 {
+    if(locking && !thick_form())
+        throw std::logic_error("locking requires the thick restart");
+
+    if(sstep > 1 && (reorth_method != FULL_REORTH || use_Binner))
+        throw std::logic_error("the s-step mode requires the full reorthogonalization and the standard inner product");
+    if(sstep > 1)
+    {
+        // The blocks of factorize_block() end at column ncv at most
+        ws_K.set_size(dim_n, sstep + 1);
+        ws_shifts.set_size(sstep);
+        ws_logdist.set_size(ncv);
+        ws_used.reserve(ncv);
+        ws_T.set_size((sstep + 1) * sstep);
+        ws_C.set_size(ncv * sstep);
+        ws_Cp.set_size(ncv * sstep);
+        ws_R.set_size(sstep * sstep);
+        ws_Rp.set_size(sstep * sstep);
+        ws_G.set_size(sstep * sstep);
+        ws_F.set_size((ncv + 1) * (sstep + 1));
+        ws_Hb.set_size((ncv + 1) * sstep);
+    }
+    if(thick_form())
+    {
+        // Minimal workspace of _syevd with eigenvectors, for the largest
+        // active block of H
+        ws_syev_work.set_size(1 + 6 * ncv + 2 * ncv * ncv);
+        ws_syev_iwork.resize(3 + 5 * ncv);
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+
     // The m-step Arnoldi factorization
-    factorize_from(1, ncv, fac_f);
+    // If compute() has been called before, the factorization is complete,
+    // and the iterations continue from it
+    if(niter == 0)
+        factorize_from(nfac_init, ncv, fac_f);
     retrieve_ritzpair();
     // Restarting
     int i, nconv = 0, nev_adj;
     for(i = 0; i < maxit; i++)
     {
         nconv = num_converged(tol);
+
+        // The observer may stop the computation, and the
+        // Ritz pairs of this iteration are kept
+        if(observer)
+        {
+            IterationInfo info;
+            info.iter = i;
+            info.ritz_values = ritz_val.head(nev);
+            info.residuals = ritz_resid;
+            info.nconv = nconv;
+            info.nops = nmatop;
+            info.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            if(observer(info))
+                break;
+        }
+
         if(nconv >= nev)
             break;
 
@@ -318,16 +1090,33 @@ inline int SymEigsSolver<Scalar, SelectionRule, OpType>::compute(int maxit, Scal
     // Sorting results
     sort_ritzpair();
 
-    niter = i + 1;
+    niter += i + 1;
 
     return std::min(nev, nconv);
 }
 
+// Norm of the residual vector, in the inner product of the Lanczos process
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline Scalar SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::residual_norm()
+{
+    if(!use_Binner)
+        return arma::norm(fac_f);
+
+    // Bf is kept up to date with f
+    return std::sqrt(std::max(Scalar(0), arma::dot(fac_f, ws_Bf)));
+}
+
 // Return converged eigenvalues
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline typename SymEigsSolver<Scalar, SelectionRule, OpType>::Vector SymEigsSolver<Scalar, SelectionRule, OpType>::eigenvalues()
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline typename SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::Vector SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::eigenvalues()
 {
     int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
     Vector res(nconv);
@@ -351,8 +1140,10 @@ inline typename SymEigsSolver<Scalar, SelectionRule, OpType>::Vector SymEigsSolv
 // Return converged eigenvectors
 template < typename Scalar,
            int SelectionRule,
-           typename OpType >
-inline typename SymEigsSolver<Scalar, SelectionRule, OpType>::Matrix SymEigsSolver<Scalar, SelectionRule, OpType>::eigenvectors(int nvec)
+           typename OpType,
+           typename BasisScalar,
+           int FixedNcv >
+inline typename SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::Matrix SymEigsSolver<Scalar, SelectionRule, OpType, BasisScalar, FixedNcv>::eigenvectors(int nvec)
 {
     int nconv = std::count(ritz_conv.begin(), ritz_conv.end(), true);
     nvec = std::min(nvec, nconv);
@@ -372,7 +1163,11 @@ inline typename SymEigsSolver<Scalar, SelectionRule, OpType>::Matrix SymEigsSolv
         }
     }
 
-    res = fac_V * ritz_vec_conv;
+    {
+        EIGS_PROFILE(PHASE_EIGENVECTORS);
+        BasisOp::mult(fac_V, ncv, ritz_vec_conv, res);
+        transform_eigenvectors(res);
+    }
 
     return res;
 }
@@ -0,0 +1,380 @@
+// Copyright (C) 2015 Yixuan Qiu
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SYM_GEIGS_SOLVER_H
+#define SYM_GEIGS_SOLVER_H
+
+#include <armadillo>
+#include <stdexcept>  // std::invalid_argument
+
+#include "SymEigsSolver.h"
+#include "GEigsMode.h"
+#include "MatOp/DenseGenMatProd.h"
+#include "MatOp/DenseCholesky.h"
+
+
+// Operator L^{-1} * A * L^{-T} of the Cholesky mode, where B = L * L'
+template <typename Scalar, typename OpType, typename BOpType>
+class SymGEigsCholeskyOp
+{
+private:
+    typedef arma::Col<Scalar> Vector;
+
+    OpType *op;
+    BOpType *Bop;
+    Vector ws_x, ws_y;
+
+public:
+    SymGEigsCholeskyOp(OpType *op_, BOpType *Bop_) :
+        op(op_), Bop(Bop_), ws_x(op_->rows()), ws_y(op_->rows())
+    {
+        if(Bop_->rows() != op_->rows())
+            throw std::invalid_argument("SymGEigsSolver: A and B must have the same size");
+    }
+
+    int rows() { return op->rows(); }
+    int cols() { return op->rows(); }
+
+    // y_out = inv(L) * A * inv(L') * x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        Bop->upper_triangular_solve(x_in, ws_x.memptr());
+        op->perform_op(ws_x.memptr(), ws_y.memptr());
+        Bop->lower_triangular_solve(ws_y.memptr(), y_out);
+    }
+};
+
+// Operator B^{-1} * A of the regular inverse mode
+template <typename Scalar, typename OpType, typename BOpType>
+class SymGEigsRegInvOp
+{
+private:
+    typedef arma::Col<Scalar> Vector;
+
+    OpType *op;
+    BOpType *Bop;
+    Vector ws_y;
+
+public:
+    SymGEigsRegInvOp(OpType *op_, BOpType *Bop_) :
+        op(op_), Bop(Bop_), ws_y(op_->rows())
+    {
+        if(Bop_->rows() != op_->rows())
+            throw std::invalid_argument("SymGEigsSolver: A and B must have the same size");
+    }
+
+    int rows() { return op->rows(); }
+    int cols() { return op->rows(); }
+
+    // y_out = inv(B) * A * x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        op->perform_op(x_in, ws_y.memptr());
+        Bop->solve(ws_y.memptr(), y_out);
+    }
+};
+
+// Operator (A - sigma * B)^{-1} * B of the shift-and-invert mode
+template <typename Scalar, typename OpType, typename BOpType>
+class SymGEigsShiftInvertOp
+{
+private:
+    typedef arma::Col<Scalar> Vector;
+
+    OpType *op;
+    BOpType *Bop;
+    Vector ws_y;
+
+public:
+    SymGEigsShiftInvertOp(OpType *op_, BOpType *Bop_) :
+        op(op_), Bop(Bop_), ws_y(op_->rows())
+    {
+        if(Bop_->rows() != op_->rows())
+            throw std::invalid_argument("SymGEigsSolver: A and B must have the same size");
+    }
+
+    int rows() { return op->rows(); }
+    int cols() { return op->rows(); }
+
+    void set_shift(Scalar sigma) { op->set_shift(sigma); }
+
+    // y_out = inv(A - sigma * B) * B * x_in
+    void perform_op(Scalar *x_in, Scalar *y_out)
+    {
+        Bop->perform_op(x_in, ws_y.memptr());
+        op->perform_op(ws_y.memptr(), y_out);
+    }
+};
+
+
+///
+/// \ingroup EigenSolver
+///
+/// This class implements the eigen solver for the generalized eigen problem
+/// \f$Ax=\lambda Bx\f$, where \f$A\f$ is real symmetric and \f$B\f$ is real
+/// symmetric positive definite, for example the stiffness and mass matrices
+/// \f$Kx=\lambda Mx\f$ of a vibration problem.
+///
+/// The problem is solved by SymEigsSolver on a transformed operator, chosen by
+/// the template parameter `GEigsMode`, see GEigsMode.h:
+///
+/// - `GEIGS_CHOLESKY`: the operator is \f$L^{-1}AL^{-T}\f$ with \f$B=LL'\f$,
+///   whose eigenvectors \f$y\f$ give \f$x=L^{-T}y\f$. `OpType` computes \f$Ax\f$,
+///   and `BOpType` implements `lower_triangular_solve()` and `upper_triangular_solve()`,
+///   as in DenseCholesky.
+/// - `GEIGS_REGULAR_INVERSE`: the operator is \f$B^{-1}A\f$, and the Lanczos process
+///   uses the \f$B\f$-inner product, in which the operator is self-adjoint. No
+///   factorization of \f$B\f$ is formed if the solve is iterative. `OpType` computes
+///   \f$Ax\f$, and `BOpType` implements `perform_op()` for \f$Bx\f$ and `solve()`
+///   for \f$B^{-1}x\f$, as in DenseCholesky and SparseRegularInverse. With an
+///   iterative solve, the residuals of the eigenpairs cannot be smaller than the
+///   error of the solve, so its tolerance should be below the `tol` of compute().
+///   For SparseRegularInverse it is the relative tolerance of the conjugate gradient
+///   method, given to its constructor, which defaults to \f$\varepsilon^{3/4}\f$,
+///   about \f$2\times 10^{-12}\f$ for `double`, below the default `tol` of \f$10^{-10}\f$.
+/// - `GEIGS_SHIFT_INVERT`: the operator is \f$(A-\sigma B)^{-1}B\f$, again in the
+///   \f$B\f$-inner product, so that the selection rule applies to \f$1/(\lambda-\sigma)\f$
+///   as in SymEigsShiftSolver. `OpType` implements `set_shift()` and computes
+///   \f$(A-\sigma B)^{-1}x\f$, as in DenseSymGShiftSolve, and `BOpType` computes
+///   \f$Bx\f$, for example DenseGenMatProd or SparseGenMatProd.
+///
+/// In the last two modes the eigenvectors are \f$B\f$-orthonormal, \f$X'BX=I\f$,
+/// and the same holds for the Cholesky mode. The eigenvalues() method always
+/// returns \f$\lambda\f$ of the original problem.
+///
+/// All the other settings of SymEigsSolver, such as the restarting method,
+/// are available.
+///
+/// \tparam Scalar        The element type of the matrix.
+///                       Currently supported types are `float` and `double`.
+/// \tparam SelectionRule An enumeration value indicating the selection rule of
+///                       the requested eigenvalues. See SelectionRule.h.
+/// \tparam OpType        The name of the matrix operation class of \f$A\f$.
+/// \tparam BOpType       The name of the matrix operation class of \f$B\f$.
+/// \tparam GEigsMode     The mode of the solver, see GEigsMode.h.
+///
+/// \code{.cpp}
+/// #include <armadillo>
+/// #include <SymGEigsSolver.h>
+/// #include <MatOp/SparseGenMatProd.h>
+/// #include <MatOp/SparseRegularInverse.h>
+///
+/// int main()
+/// {
+///     // Stiffness and mass matrices of a 1-D vibration problem
+///     const int n = 1000;
+///     arma::sp_mat K(n, n), M(n, n);
+///     for(int i = 0; i < n; i++)
+///     {
+///         K(i, i) = 2;
+///         M(i, i) = 4.0 / 6;
+///         if(i > 0)
+///         {
+///             K(i, i - 1) = K(i - 1, i) = -1;
+///             M(i, i - 1) = M(i - 1, i) = 1.0 / 6;
+///         }
+///     }
+///
+///     SparseGenMatProd<double> op(K);
+///     SparseRegularInverse<double> Bop(M);
+///
+///     // The 5 largest eigenvalues of K x = lambda M x
+///     SymGEigsSolver< double, LARGEST_ALGE, SparseGenMatProd<double>,
+///                     SparseRegularInverse<double>, GEIGS_REGULAR_INVERSE >
+///         eigs(&op, &Bop, 5, 20);
+///
+///     eigs.init();
+///     int nconv = eigs.compute();
+///
+///     arma::vec evalues;
+///     if(nconv > 0)
+///         evalues = eigs.eigenvalues();
+///
+///     return 0;
+/// }
+/// \endcode
+///
+template < typename Scalar = double,
+           int SelectionRule = LARGEST_MAGN,
+           typename OpType = DenseGenMatProd<double>,
+           typename BOpType = DenseCholesky<double>,
+           int GEigsMode = GEIGS_CHOLESKY >
+class SymGEigsSolver;
+
+
+///
+/// \ingroup EigenSolver
+///
+/// The Cholesky mode of SymGEigsSolver.
+///
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BOpType >
+class SymGEigsSolver<Scalar, SelectionRule, OpType, BOpType, GEIGS_CHOLESKY>:
+    public SymEigsSolver< Scalar, SelectionRule, SymGEigsCholeskyOp<Scalar, OpType, BOpType> >
+{
+private:
+    typedef arma::Mat<Scalar> Matrix;
+    typedef arma::Col<Scalar> Vector;
+    typedef SymGEigsCholeskyOp<Scalar, OpType, BOpType> ComboOpType;
+    typedef SymEigsSolver<Scalar, SelectionRule, ComboOpType> BaseSolver;
+
+    BOpType *Bop;
+
+    // The transformed operator is owned by the solver
+    SymGEigsSolver(const SymGEigsSolver&);
+    SymGEigsSolver& operator=(const SymGEigsSolver&);
+
+    // The eigenvectors y of the transformed problem give x = L^{-T} y,
+    // which satisfy X' * B * X = I
+    inline void transform_eigenvectors(Matrix &evecs)
+    {
+        Vector x(evecs.n_rows);
+        for(int j = 0; j < int(evecs.n_cols); j++)
+        {
+            Bop->upper_triangular_solve(evecs.colptr(j), x.memptr());
+            evecs.col(j) = x;
+        }
+    }
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_  Pointer to the matrix operation object of \f$A\f$.
+    /// \param Bop_ Pointer to the Cholesky operation object of \f$B\f$, for example DenseCholesky.
+    /// \param nev_ Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///             where \f$n\f$ is the size of matrix.
+    /// \param ncv_ Parameter that controls the convergence speed of the algorithm,
+    ///             which must satisfy \f$nev < ncv \le n\f$. See SymEigsSolver.
+    ///
+    SymGEigsSolver(OpType *op_, BOpType *Bop_, int nev_, int ncv_) :
+        BaseSolver(new ComboOpType(op_, Bop_), nev_, ncv_),
+        Bop(Bop_)
+    {}
+
+    ~SymGEigsSolver() { delete this->op; }
+};
+
+
+///
+/// \ingroup EigenSolver
+///
+/// The regular inverse mode of SymGEigsSolver.
+///
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BOpType >
+class SymGEigsSolver<Scalar, SelectionRule, OpType, BOpType, GEIGS_REGULAR_INVERSE>:
+    public SymEigsSolver< Scalar, SelectionRule, SymGEigsRegInvOp<Scalar, OpType, BOpType> >
+{
+private:
+    typedef SymGEigsRegInvOp<Scalar, OpType, BOpType> ComboOpType;
+    typedef SymEigsSolver<Scalar, SelectionRule, ComboOpType> BaseSolver;
+
+    BOpType *Bop;
+
+    // The transformed operator is owned by the solver
+    SymGEigsSolver(const SymGEigsSolver&);
+    SymGEigsSolver& operator=(const SymGEigsSolver&);
+
+    // y_out = B * x_in, for the B-inner product of the Lanczos process
+    inline void B_prod(const Scalar *x_in, Scalar *y_out)
+    {
+        Bop->perform_op(const_cast<Scalar *>(x_in), y_out);
+    }
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_  Pointer to the matrix operation object of \f$A\f$.
+    /// \param Bop_ Pointer to the operation object of \f$B\f$, which computes \f$Bx\f$
+    ///             and \f$B^{-1}x\f$, for example DenseCholesky or SparseRegularInverse.
+    /// \param nev_ Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///             where \f$n\f$ is the size of matrix.
+    /// \param ncv_ Parameter that controls the convergence speed of the algorithm,
+    ///             which must satisfy \f$nev < ncv \le n\f$. See SymEigsSolver.
+    ///
+    SymGEigsSolver(OpType *op_, BOpType *Bop_, int nev_, int ncv_) :
+        BaseSolver(new ComboOpType(op_, Bop_), nev_, ncv_),
+        Bop(Bop_)
+    {
+        this->use_Binner = true;
+    }
+
+    ~SymGEigsSolver() { delete this->op; }
+};
+
+
+///
+/// \ingroup EigenSolver
+///
+/// The shift-and-invert mode of SymGEigsSolver.
+///
+template < typename Scalar,
+           int SelectionRule,
+           typename OpType,
+           typename BOpType >
+class SymGEigsSolver<Scalar, SelectionRule, OpType, BOpType, GEIGS_SHIFT_INVERT>:
+    public SymEigsSolver< Scalar, SelectionRule, SymGEigsShiftInvertOp<Scalar, OpType, BOpType> >
+{
+private:
+    typedef arma::Col<Scalar> Vector;
+    typedef SymGEigsShiftInvertOp<Scalar, OpType, BOpType> ComboOpType;
+    typedef SymEigsSolver<Scalar, SelectionRule, ComboOpType> BaseSolver;
+
+    BOpType *Bop;
+    Scalar sigma;
+
+    // The transformed operator is owned by the solver
+    SymGEigsSolver(const SymGEigsSolver&);
+    SymGEigsSolver& operator=(const SymGEigsSolver&);
+
+    // y_out = B * x_in, for the B-inner product of the Lanczos process
+    inline void B_prod(const Scalar *x_in, Scalar *y_out)
+    {
+        Bop->perform_op(const_cast<Scalar *>(x_in), y_out);
+    }
+
+    // First transform back the ritz values, and then sort
+    inline void sort_ritzpair()
+    {
+        Vector ritz_val_org = Scalar(1.0) / this->ritz_val.head(this->nev) + sigma;
+        this->ritz_val.head(this->nev) = ritz_val_org;
+        BaseSolver::sort_ritzpair();
+    }
+
+public:
+    ///
+    /// Constructor to create a solver object.
+    ///
+    /// \param op_    Pointer to the shift-solve operation object, which computes
+    ///               \f$(A-\sigma B)^{-1}x\f$, for example DenseSymGShiftSolve.
+    /// \param Bop_   Pointer to the matrix operation object of \f$B\f$, for example
+    ///               DenseGenMatProd or SparseGenMatProd.
+    /// \param nev_   Number of eigenvalues requested. This should satisfy \f$1\le nev \le n-1\f$,
+    ///               where \f$n\f$ is the size of matrix.
+    /// \param ncv_   Parameter that controls the convergence speed of the algorithm,
+    ///               which must satisfy \f$nev < ncv \le n\f$. See SymEigsSolver.
+    /// \param sigma_ The value of the shift.
+    ///
+    SymGEigsSolver(OpType *op_, BOpType *Bop_, int nev_, int ncv_, Scalar sigma_) :
+        BaseSolver(new ComboOpType(op_, Bop_), nev_, ncv_),
+        Bop(Bop_),
+        sigma(sigma_)
+    {
+        this->use_Binner = true;
+        this->op->set_shift(sigma);
+    }
+
+    ~SymGEigsSolver() { delete this->op; }
+};
+
+
+#endif // SYM_GEIGS_SOLVER_H
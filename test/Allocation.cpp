@@ -0,0 +1,166 @@
+// Test that the restarting iterations of ../include/SymEigsSolver.h and
+// ../include/GenEigsSolver.h do not allocate memory
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+// GCC flags the free() in the replaced operator delete below once it is
+// inlined into a delete expression, although the memory comes from the
+// malloc() in the replaced operator new
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Allocation counter, updated by both the Armadillo memory functions
+// and the global operator new
+static long alloc_count = 0;
+
+inline void* counted_malloc(std::size_t n)
+{
+    alloc_count++;
+    return std::malloc(n);
+}
+
+#define ARMA_ALIEN_MEM_ALLOC_FUNCTION counted_malloc
+#define ARMA_ALIEN_MEM_FREE_FUNCTION  std::free
+#include <armadillo>
+
+void* operator new(std::size_t n)
+{
+    alloc_count++;
+    void *p = std::malloc(n ? n : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+#include <SymEigsSolver.h>
+#include <GenEigsSolver.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+
+// Number of allocations in compute(), with at most maxit restarts
+// With tol = 0 no Ritz value converges, and all maxit iterations are run
+template <typename SolverType>
+long count_allocations(SolverType &eigs, Vector &init_resid, int maxit, double tol)
+{
+    eigs.init(init_resid.memptr());
+
+    long start = alloc_count;
+    eigs.compute(maxit, tol);
+
+    return alloc_count - start;
+}
+
+// The first restart may still size the internal storage of the
+// decomposition objects, so we compare solves with different numbers
+// of restarts, each on a fresh solver object
+// setup() selects the options of the solver before init()
+template <typename SolverType>
+void run_test(Matrix &mat, int k, int m, void (*setup)(SolverType &) = NULL, double tol = 0.0)
+{
+    DenseGenMatProd<double> op(mat);
+    Vector init_resid(mat.n_rows, arma::fill::randu);
+    init_resid -= 0.5;
+
+    // Warm up, so that one-off allocations of the libraries are not counted
+    SolverType eigs0(&op, k, m);
+    if(setup) setup(eigs0);
+    count_allocations(eigs0, init_resid, 2, tol);
+
+    SolverType eigs1(&op, k, m);
+    if(setup) setup(eigs1);
+    long nalloc1 = count_allocations(eigs1, init_resid, 2, tol);
+
+    SolverType eigs2(&op, k, m);
+    if(setup) setup(eigs2);
+    long nalloc2 = count_allocations(eigs2, init_resid, 20, tol);
+
+    INFO( "allocations with 2 restarts = " << nalloc1 );
+    INFO( "allocations with 20 restarts = " << nalloc2 );
+    REQUIRE( nalloc2 == nalloc1 );
+}
+
+typedef SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > SymSolver;
+
+void use_thick_restart(SymSolver &eigs)
+{
+    eigs.set_restart_method(THICK_RESTART);
+}
+
+void use_partial_reorth(SymSolver &eigs)
+{
+    eigs.set_reorth_method(PARTIAL_REORTH);
+}
+
+void use_locking(SymSolver &eigs)
+{
+    eigs.set_restart_method(THICK_RESTART);
+    eigs.set_locking(true);
+}
+
+void use_sstep(SymSolver &eigs)
+{
+    eigs.set_sstep(4);
+}
+
+TEST_CASE("Allocations of symmetric eigen solver [100x100]", "[alloc]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    SECTION( "Largest Value" )
+    {
+        run_test< SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > >(mat, 10, 30);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test< SymEigsSolver<double, BOTH_ENDS, DenseGenMatProd<double> > >(mat, 10, 30);
+    }
+    SECTION( "Thick restart" )
+    {
+        run_test<SymSolver>(mat, 10, 30, use_thick_restart);
+    }
+    SECTION( "Partial reorthogonalization" )
+    {
+        run_test<SymSolver>(mat, 10, 30, use_partial_reorth);
+    }
+    SECTION( "Locking" )
+    {
+        // Ritz pairs are only locked once they converge, so the
+        // tolerance is set to let some of them converge within the
+        // restarts counted
+        run_test<SymSolver>(mat, 10, 30, use_locking, 1e-10);
+    }
+    SECTION( "S-step mode" )
+    {
+        run_test<SymSolver>(mat, 10, 30, use_sstep);
+    }
+}
+
+TEST_CASE("Allocations of general eigen solver [100x100]", "[alloc]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix mat = arma::randu(100, 100);
+
+    SECTION( "Largest Magnitude" )
+    {
+        run_test< GenEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double> > >(mat, 10, 20);
+    }
+    SECTION( "Largest Real Part" )
+    {
+        run_test< GenEigsSolver<double, LARGEST_REAL, DenseGenMatProd<double> > >(mat, 10, 20);
+    }
+}
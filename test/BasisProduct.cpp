@@ -0,0 +1,93 @@
+// Test ../include/LinAlg/BasisProduct.h
+#include <LinAlg/BasisProduct.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+using arma::mat;
+using arma::vec;
+
+// The reference results are computed in double precision, from
+// the basis converted to double
+template <typename BasisScalar>
+void run_test(int n, int ncol, int k)
+{
+    typedef BasisProduct<double, BasisScalar> BasisOp;
+    typedef arma::Mat<BasisScalar> BasisMatrix;
+
+    BasisMatrix V = arma::conv_to<BasisMatrix>::from(mat(n, ncol, arma::fill::randn));
+    mat V0 = arma::conv_to<mat>::from(V);
+    vec x(n, arma::fill::randn);
+    vec h(ncol, arma::fill::randn);
+    mat Q(ncol, k, arma::fill::randn);
+
+    // Errors of rounding the results to the basis type
+    const double prec = 100 * std::numeric_limits<BasisScalar>::epsilon() * n;
+
+    SECTION( "V' * x" )
+    {
+        vec y(ncol);
+        BasisOp::trans_mult(V, ncol, x.memptr(), y.memptr());
+        vec y0 = V0.t() * x;
+        INFO( "max|y - y0| = " << arma::abs(y - y0).max() );
+        REQUIRE( arma::abs(y - y0).max() < prec );
+    }
+    SECTION( "x - V * h" )
+    {
+        vec y = x;
+        BasisOp::mult_sub(V, ncol, h.memptr(), y.memptr());
+        vec y0 = x - V0 * h;
+        INFO( "max|y - y0| = " << arma::abs(y - y0).max() );
+        REQUIRE( arma::abs(y - y0).max() < prec );
+    }
+    SECTION( "V' * X" )
+    {
+        mat X(n, k, arma::fill::randn);
+        mat Y;
+        BasisOp::trans_mult(V, ncol, X, Y);
+        mat Y0 = V0.t() * X;
+        INFO( "max|Y - Y0| = " << arma::abs(Y - Y0).max() );
+        REQUIRE( arma::abs(Y - Y0).max() < prec );
+    }
+    SECTION( "X - V * H" )
+    {
+        mat X(n, k, arma::fill::randn);
+        mat Y = X;
+        BasisOp::mult_sub(V, ncol, Q, Y);
+        mat Y0 = X - V0 * Q;
+        INFO( "max|Y - Y0| = " << arma::abs(Y - Y0).max() );
+        REQUIRE( arma::abs(Y - Y0).max() < prec );
+    }
+    SECTION( "V * Q" )
+    {
+        mat W(n, k);
+        BasisOp::mult(V, ncol, Q, W);
+        mat W0 = V0 * Q;
+        INFO( "max|W - W0| = " << arma::abs(W - W0).max() );
+        REQUIRE( arma::abs(W - W0).max() < prec );
+    }
+    SECTION( "V * Q in place" )
+    {
+        arma::Col<double> work(BasisOp::block_rows * k);
+        BasisOp::mult_inplace(V, ncol, Q, work.memptr());
+        mat W0 = V0 * Q;
+        mat W = arma::conv_to<mat>::from(V.head_cols(k));
+        INFO( "max|W - W0| = " << arma::abs(W - W0).max() );
+        REQUIRE( arma::abs(W - W0).max() < prec );
+        // The remaining columns are not changed
+        REQUIRE( arma::abs(arma::conv_to<mat>::from(V.tail_cols(ncol - k)) - V0.tail_cols(ncol - k)).max() == 0.0 );
+    }
+}
+
+TEST_CASE("Products with a 'double' basis", "[BasisProduct]")
+{
+    arma::arma_rng::set_seed(123);
+    // n is not a multiple of the panel size
+    run_test<double>(1300, 20, 8);
+}
+
+TEST_CASE("Products with a 'float' basis", "[BasisProduct]")
+{
+    arma::arma_rng::set_seed(123);
+    run_test<float>(1300, 20, 8);
+}
@@ -0,0 +1,192 @@
+#include <armadillo>
+#include <iostream>
+#include <vector>
+
+#include <BatchSymEigsSolver.h>
+#include <SymEigsSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+// A batch of symmetric matrices of different sizes
+template <typename MatType>
+std::vector<MatType> gen_batch(int nprob, int nmin, int nmax);
+
+template <>
+std::vector<Matrix> gen_batch<Matrix>(int nprob, int nmin, int nmax)
+{
+    std::vector<Matrix> mats(nprob);
+    for(int i = 0; i < nprob; i++)
+    {
+        const int n = nmin + (i * 7) % (nmax - nmin + 1);
+        Matrix A = arma::randu(n, n);
+        mats[i] = A + A.t();
+    }
+    return mats;
+}
+
+template <>
+std::vector<SpMatrix> gen_batch<SpMatrix>(int nprob, int nmin, int nmax)
+{
+    std::vector<SpMatrix> mats(nprob);
+    for(int i = 0; i < nprob; i++)
+    {
+        const int n = nmin + (i * 7) % (nmax - nmin + 1);
+        SpMatrix A = arma::sprandu(n, n, 0.1);
+        mats[i] = A + A.t();
+    }
+    return mats;
+}
+
+template <typename MatType, int SelectionRule>
+void run_test(std::vector<MatType> &mats, int k, int m, int nthread, int lanes)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    const int nprob = mats.size();
+    std::vector<OpType*> ops(nprob);
+    for(int i = 0; i < nprob; i++)
+        ops[i] = new OpType(mats[i]);
+
+    BatchSymEigsSolver<double, SelectionRule, OpType> eigs(ops, k, m, nthread, lanes);
+    eigs.init();
+    int nsolved = eigs.compute();
+
+    INFO( "nsolved = " << nsolved );
+    REQUIRE( nsolved == nprob );
+
+    for(int i = 0; i < nprob; i++)
+    {
+        Vector evals = eigs.eigenvalues(i);
+        Matrix evecs = eigs.eigenvectors(i);
+
+        Matrix err = mats[i] * evecs - evecs * arma::diagmat(evals);
+        INFO( "problem " << i );
+        INFO( "niter = " << eigs.num_iterations(i) );
+        INFO( "nops = " << eigs.num_operations(i) );
+        INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+        REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+        // The eigenvalues are the wanted ones, as returned by SymEigsSolver
+        // with the same initial vector
+        OpType op(mats[i]);
+        SymEigsSolver<double, SelectionRule, OpType> ref(&op, k, m);
+        ref.set_seed(i);
+        ref.init();
+        ref.compute();
+        Vector ref_evals = ref.eigenvalues();
+        REQUIRE( arma::abs(evals - ref_evals).max() == Approx(0.0) );
+    }
+
+    for(int i = 0; i < nprob; i++)
+        delete ops[i];
+}
+
+template <typename MatType>
+void run_test_sets(std::vector<MatType> &mats, int k, int m, int nthread, int lanes)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<MatType, LARGEST_MAGN>(mats, k, m, nthread, lanes);
+    }
+    SECTION( "Largest Value" )
+    {
+        run_test<MatType, LARGEST_ALGE>(mats, k, m, nthread, lanes);
+    }
+    SECTION( "Smallest Magnitude" )
+    {
+        run_test<MatType, SMALLEST_MAGN>(mats, k, m, nthread, lanes);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test<MatType, SMALLEST_ALGE>(mats, k, m, nthread, lanes);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test<MatType, BOTH_ENDS>(mats, k, m, nthread, lanes);
+    }
+}
+
+TEST_CASE("Batch eigensolver of dense matrices [20 x 50~100]", "[eigs_batch]")
+{
+    arma::arma_rng::set_seed(123);
+    std::vector<Matrix> mats = gen_batch<Matrix>(20, 50, 100);
+
+    run_test_sets(mats, 5, 15, 4, 8);
+}
+
+TEST_CASE("Batch eigensolver of sparse matrices [30 x 100~200]", "[eigs_batch]")
+{
+    arma::arma_rng::set_seed(123);
+    std::vector<SpMatrix> mats = gen_batch<SpMatrix>(30, 100, 200);
+
+    // The last group is not full
+    // The smallest eigenvalues in magnitude are interior ones here, and
+    // need a larger ncv to converge within maxit
+    run_test_sets(mats, 4, 25, 3, 8);
+}
+
+TEST_CASE("Batch eigensolver with one lane per group", "[eigs_batch]")
+{
+    arma::arma_rng::set_seed(123);
+    std::vector<Matrix> mats = gen_batch<Matrix>(5, 30, 60);
+
+    run_test<Matrix, LARGEST_ALGE>(mats, 3, 10, 2, 1);
+}
+
+TEST_CASE("Batch eigensolver results do not depend on the threads", "[eigs_batch]")
+{
+    arma::arma_rng::set_seed(123);
+    std::vector<Matrix> mats = gen_batch<Matrix>(12, 40, 80);
+    std::vector< DenseGenMatProd<double>* > ops(mats.size());
+    for(size_t i = 0; i < mats.size(); i++)
+        ops[i] = new DenseGenMatProd<double>(mats[i]);
+
+    BatchSymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs1(ops, 4, 12, 1);
+    eigs1.set_seed(1);
+    eigs1.init();
+    eigs1.compute();
+
+    BatchSymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs4(ops, 4, 12, 4);
+    eigs4.set_seed(1);
+    eigs4.init();
+    eigs4.compute();
+
+    for(size_t i = 0; i < mats.size(); i++)
+    {
+        REQUIRE( eigs1.num_operations(i) == eigs4.num_operations(i) );
+        REQUIRE( arma::abs(eigs1.eigenvalues(i) - eigs4.eigenvalues(i)).max() == 0.0 );
+    }
+
+    for(size_t i = 0; i < mats.size(); i++)
+        delete ops[i];
+}
+
+TEST_CASE("Batch eigensolver requires init()", "[eigs_batch]")
+{
+    Matrix A = arma::randu(20, 20);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+    std::vector< DenseGenMatProd<double>* > ops(1, &op);
+
+    BatchSymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(ops, 3, 10);
+    REQUIRE_THROWS( eigs.compute() );
+}
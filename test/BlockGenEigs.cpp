@@ -0,0 +1,100 @@
+#include <armadillo>
+#include <iostream>
+
+#include <BlockGenEigsSolver.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::cx_mat ComplexMatrix;
+typedef arma::cx_vec ComplexVector;
+
+template <int SelectionRule>
+void run_test(Matrix &mat, int k, int m, int b)
+{
+    DenseGenMatProd<double> op(mat);
+    BlockGenEigsSolver<double, SelectionRule, DenseGenMatProd<double>> eigs(&op, k, m, b);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    REQUIRE( nconv > 0 );
+
+    ComplexVector evals = eigs.eigenvalues();
+    ComplexMatrix evecs = eigs.eigenvectors();
+
+    ComplexMatrix err = mat * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+}
+
+void run_test_sets(Matrix &A, int k, int m, int b)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<LARGEST_MAGN>(A, k, m, b);
+    }
+    SECTION( "Largest Real Part" )
+    {
+        run_test<LARGEST_REAL>(A, k, m, b);
+    }
+    SECTION( "Largest Imaginary Part" )
+    {
+        run_test<LARGEST_IMAG>(A, k, m, b);
+    }
+    SECTION( "Smallest Magnitude" )
+    {
+        run_test<SMALLEST_MAGN>(A, k, m, b);
+    }
+    SECTION( "Smallest Real Part" )
+    {
+        run_test<SMALLEST_REAL>(A, k, m, b);
+    }
+    SECTION( "Smallest Imaginary Part" )
+    {
+        run_test<SMALLEST_IMAG>(A, k, m, b);
+    }
+}
+
+TEST_CASE("Block eigensolver of general real matrix [10x10]", "[eigs_gen_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    int k = 3;
+    int m = 8;
+    int b = 2;
+
+    run_test_sets(A, k, m, b);
+}
+
+TEST_CASE("Block eigensolver of general real matrix [100x100]", "[eigs_gen_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    int k = 10;
+    int m = 30;
+    int b = 3;
+
+    run_test_sets(A, k, m, b);
+}
+
+TEST_CASE("Block eigensolver of general real matrix [1000x1000]", "[eigs_gen_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(1000, 1000);
+    int k = 20;
+    int m = 56;
+    int b = 4;
+
+    run_test_sets(A, k, m, b);
+}
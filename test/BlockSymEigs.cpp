@@ -0,0 +1,133 @@
+#include <armadillo>
+#include <iostream>
+
+#include <BlockSymEigsSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+
+template <typename MatType, int SelectionRule>
+void run_test(MatType &mat, int k, int m, int b)
+{
+    typename OpTypeTrait<MatType>::OpType op(mat);
+    BlockSymEigsSolver<double, SelectionRule, typename OpTypeTrait<MatType>::OpType> eigs(&op, k, m, b);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+}
+
+template <typename MatType>
+void run_test_sets(MatType &mat, int k, int m, int b)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<MatType, LARGEST_MAGN>(mat, k, m, b);
+    }
+    SECTION( "Largest Value" )
+    {
+        run_test<MatType, LARGEST_ALGE>(mat, k, m, b);
+    }
+    SECTION( "Smallest Magnitude" )
+    {
+        run_test<MatType, SMALLEST_MAGN>(mat, k, m, b);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test<MatType, SMALLEST_ALGE>(mat, k, m, b);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test<MatType, BOTH_ENDS>(mat, k, m, b);
+    }
+}
+
+TEST_CASE("Block eigensolver of symmetric real matrix [10x10]", "[eigs_sym_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+    int k = 3;
+    int m = 8;
+    int b = 2;
+
+    run_test_sets(mat, k, m, b);
+}
+
+TEST_CASE("Block eigensolver of symmetric real matrix [100x100]", "[eigs_sym_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 32;
+    int b = 4;
+
+    run_test_sets(mat, k, m, b);
+}
+
+TEST_CASE("Block eigensolver of symmetric matrix with repeated eigenvalues [100x100]", "[eigs_sym_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    // Eigenvalues 1, 1, 1, 2, 3, ..., 98
+    Vector d = arma::linspace<Vector>(-1, 98, 100);
+    d.head(3).fill(1.0);
+    Matrix Q, R;
+    arma::qr(Q, R, Matrix(100, 100, arma::fill::randn));
+    Matrix mat = Q * arma::diagmat(d) * Q.t();
+    mat = (mat + mat.t()) / 2;
+    int k = 3;
+    int m = 24;
+    int b = 4;
+
+    run_test<Matrix, SMALLEST_ALGE>(mat, k, m, b);
+}
+
+TEST_CASE("Block eigensolver of sparse symmetric real matrix [1000x1000]", "[eigs_sym_block]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 10;
+    int m = 40;
+    int b = 4;
+
+    run_test_sets(mat, k, m, b);
+}
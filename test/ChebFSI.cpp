@@ -0,0 +1,133 @@
+#include <armadillo>
+#include <iostream>
+
+#include <ChebFSISolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+
+template <typename MatType, int SelectionRule>
+void run_test(MatType &mat, int k, int b, int deg)
+{
+    typename OpTypeTrait<MatType>::OpType op(mat);
+    ChebFSISolver<double, SelectionRule, typename OpTypeTrait<MatType>::OpType> eigs(&op, k, b, deg);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    REQUIRE( nconv == k );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // The eigenvalues must be the wanted ones, from the wanted end
+    Vector true_evals = arma::eig_sym(Matrix(mat));
+    if(SelectionRule == LARGEST_ALGE)
+        true_evals = arma::flipud(true_evals);
+    Vector diff = evals - true_evals.head(k);
+    INFO( "max|lambda - lambda_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+}
+
+template <typename MatType>
+void run_test_sets(MatType &mat, int k, int b, int deg)
+{
+    SECTION( "Largest Value" )
+    {
+        run_test<MatType, LARGEST_ALGE>(mat, k, b, deg);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test<MatType, SMALLEST_ALGE>(mat, k, b, deg);
+    }
+}
+
+TEST_CASE("ChebFSI of symmetric real matrix [10x10]", "[chebfsi]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+
+    run_test_sets(mat, 3, 6, 8);
+}
+
+TEST_CASE("ChebFSI of symmetric real matrix [100x100]", "[chebfsi]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    run_test_sets(mat, 10, 20, 10);
+}
+
+TEST_CASE("ChebFSI of sparse symmetric real matrix [1000x1000]", "[chebfsi]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+
+    // Many eigenvalues, which is the intended use of the solver
+    run_test_sets(mat, 50, 70, 15);
+}
+
+TEST_CASE("ChebFSI with a block spanning the whole space [10x10]", "[chebfsi]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+
+    // Rayleigh-Ritz alone is exact, and no filtering is needed
+    run_test<Matrix, SMALLEST_ALGE>(mat, 4, 10, 8);
+}
+
+TEST_CASE("ChebFSI of a very small matrix [3x3]", "[chebfsi]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(3, 3);
+    Matrix mat = A + A.t();
+
+    // Too small for the Lanczos estimate of the spectrum bounds
+    run_test_sets(mat, 1, 2, 8);
+}
+
+TEST_CASE("ChebFSI with an unsupported selection rule", "[chebfsi]")
+{
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+
+    REQUIRE_THROWS_AS( (ChebFSISolver<double, LARGEST_MAGN, DenseGenMatProd<double> >(&op, 3, 6)), std::invalid_argument& );
+}
@@ -0,0 +1,191 @@
+#include <armadillo>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <DistSymEigsSolver.h>
+#include <Comm/SharedMemComm.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+typedef SharedMemComm<double> Comm;
+
+// Local rows [start, start + nlocal) of a dense or sparse matrix
+// x is gathered from all the ranks by a reduction
+template <typename MatType>
+class RowBlockProd
+{
+private:
+    const MatType &mat;
+    Comm *comm;
+    const int start;
+    const int nlocal;
+    MatType mat_local;
+
+public:
+    RowBlockProd(const MatType &mat_, Comm *comm_, int start_, int nlocal_) :
+        mat(mat_), comm(comm_), start(start_), nlocal(nlocal_),
+        mat_local(mat_.rows(start_, start_ + nlocal_ - 1))
+    {}
+
+    int rows() { return nlocal; }
+
+    void perform_op(double *x_in, double *y_out)
+    {
+        Vector x(mat.n_cols, arma::fill::zeros);
+        std::copy(x_in, x_in + nlocal, x.memptr() + start);
+        comm->allreduce(x.memptr(), mat.n_cols);
+        Vector y(y_out, nlocal, false);
+        y = mat_local * x;
+    }
+};
+
+// Results of one rank, checked in the main thread
+struct RankResult
+{
+    int nconv;
+    int nreduce;
+    Vector evals;
+    Matrix evecs;
+};
+
+template <typename MatType, int SelectionRule>
+void run_test(const MatType &mat, int k, int m, int nrank)
+{
+    const int n = mat.n_rows;
+    Comm comm(nrank);
+    std::vector<RankResult> res(nrank);
+
+    // The rows are split as evenly as possible
+    std::vector<std::thread> ranks;
+    for(int r = 0; r < nrank; r++)
+    {
+        ranks.push_back(std::thread([&, r]() {
+            const int start = (n * r) / nrank;
+            const int nlocal = (n * (r + 1)) / nrank - start;
+            RowBlockProd<MatType> op(mat, &comm, start, nlocal);
+            DistSymEigsSolver<double, SelectionRule, RowBlockProd<MatType>, Comm> eigs(&op, &comm, k, m);
+            eigs.set_seed(r);
+            eigs.init();
+            res[r].nconv = eigs.compute();
+            res[r].nreduce = eigs.num_reductions();
+            res[r].evals = eigs.eigenvalues();
+            res[r].evecs = eigs.eigenvectors();
+        }));
+    }
+    for(int r = 0; r < nrank; r++)
+        ranks[r].join();
+
+    INFO( "nconv = " << res[0].nconv );
+    INFO( "nreduce = " << res[0].nreduce );
+    REQUIRE( res[0].nconv == k );
+
+    // All the ranks take the same path, and get the same eigenvalues
+    Matrix evecs = res[0].evecs;
+    for(int r = 1; r < nrank; r++)
+    {
+        REQUIRE( res[r].nconv == res[0].nconv );
+        REQUIRE( res[r].nreduce == res[0].nreduce );
+        REQUIRE( arma::abs(res[r].evals - res[0].evals).max() == 0.0 );
+        evecs = arma::join_cols(evecs, res[r].evecs);
+    }
+
+    Vector evals = res[0].evals;
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    Vector all_evals = arma::eig_sym(Matrix(mat));
+    for(int i = 0; i < k; i++)
+        REQUIRE( arma::abs(all_evals - evals[i]).min() == Approx(0.0) );
+}
+
+template <typename MatType>
+void run_test_sets(const MatType &mat, int k, int m, int nrank)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<MatType, LARGEST_MAGN>(mat, k, m, nrank);
+    }
+    SECTION( "Largest Value" )
+    {
+        run_test<MatType, LARGEST_ALGE>(mat, k, m, nrank);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test<MatType, SMALLEST_ALGE>(mat, k, m, nrank);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test<MatType, BOTH_ENDS>(mat, k, m, nrank);
+    }
+}
+
+TEST_CASE("Distributed eigensolver on a single rank [100x100]", "[eigs_dist]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    run_test_sets(mat, 10, 30, 1);
+}
+
+TEST_CASE("Distributed eigensolver on 4 ranks [100x100]", "[eigs_dist]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    run_test_sets(mat, 10, 30, 4);
+}
+
+TEST_CASE("Distributed eigensolver on 3 ranks, sparse [1000x1000]", "[eigs_dist]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+
+    // The rows are not evenly divisible among the ranks
+    run_test_sets(mat, 20, 50, 3);
+}
+
+TEST_CASE("Shared memory reduction", "[eigs_dist]")
+{
+    const int nrank = 8, n = 5, nround = 100;
+    Comm comm(nrank);
+    std::vector<Matrix> res(nrank, Matrix(n, nround));
+
+    std::vector<std::thread> ranks;
+    for(int r = 0; r < nrank; r++)
+    {
+        ranks.push_back(std::thread([&, r]() {
+            for(int t = 0; t < nround; t++)
+            {
+                Vector x(n);
+                for(int i = 0; i < n; i++)
+                    x[i] = r + i + t;
+                comm.allreduce(x.memptr(), n);
+                res[r].col(t) = x;
+            }
+        }));
+    }
+    for(int r = 0; r < nrank; r++)
+        ranks[r].join();
+
+    // sum_r (r + i + t) = nrank * (nrank - 1) / 2 + nrank * (i + t)
+    for(int r = 0; r < nrank; r++)
+    {
+        for(int t = 0; t < nround; t++)
+        {
+            for(int i = 0; i < n; i++)
+                REQUIRE( res[r](i, t) == nrank * (nrank - 1) / 2.0 + nrank * (i + t) );
+        }
+    }
+}
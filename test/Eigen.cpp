@@ -1,6 +1,8 @@
-// Test ../include/LinAlg/UpperHessenbergEigen.h and ../include/LinAlg/TridiagEigen.h
+// Test ../include/LinAlg/UpperHessenbergEigen.h, ../include/LinAlg/TridiagEigen.h
+// and ../include/LinAlg/RealSchur.h
 #include <LinAlg/UpperHessenbergEigen.h>
 #include <LinAlg/TridiagEigen.h>
+#include <LinAlg/RealSchur.h>
 
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
@@ -93,3 +95,48 @@ TEST_CASE("Eigen decomposition of symmetric tridiagonal matrix", "[Eigen]")
     std::cout << "elapsed time for arma::eig_sym: "
               << double(t2 - t1) / CLOCKS_PER_SEC << " secs\n";
 }
+
+TEST_CASE("Reordered real Schur decomposition", "[Eigen]")
+{
+    arma::arma_rng::set_seed(123);
+    int n = 100;
+    mat A(n, n, arma::fill::randn);
+
+    RealSchur<double> decomp(A);
+    cx_vec evals = decomp.eigenvalues();
+
+    // Select the eigenvalues with positive real parts
+    std::vector<int> select(n, 0);
+    int nsel = 0;
+    for(int i = 0; i < n; i++)
+    {
+        if(evals[i].real() > 0)
+        {
+            select[i] = 1;
+            nsel++;
+        }
+    }
+
+    int m = decomp.reorder(select);
+    REQUIRE( m == nsel );
+
+    mat U = decomp.matrix_U();
+    mat T = decomp.matrix_T();
+
+    mat err = A - U * T * U.t();
+    INFO( "||A - UTU'||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // The leading m Schur vectors span an invariant subspace of A,
+    // whose eigenvalues are the selected ones
+    mat U1 = U.head_cols(m);
+    mat err_inv = A * U1 - U1 * T.submat(0, 0, m - 1, m - 1);
+    INFO( "||AU1 - U1T11||_inf = " << arma::abs(err_inv).max() );
+    REQUIRE( arma::abs(err_inv).max() == Approx(0.0) );
+
+    cx_vec evals_new = decomp.eigenvalues();
+    for(int i = 0; i < m; i++)
+        REQUIRE( evals_new[i].real() > 0 );
+    for(int i = m; i < n; i++)
+        REQUIRE( evals_new[i].real() <= 0 );
+}
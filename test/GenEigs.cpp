@@ -12,13 +12,14 @@ typedef arma::cx_mat ComplexMatrix;
 typedef arma::cx_vec ComplexVector;
 
 template <int SelectionRule>
-void run_test(Matrix &mat, int k, int m)
+void run_test(Matrix &mat, int k, int m, int restart_method)
 {
     // ComplexVector all_eval = arma::eig_gen(mat);
     // all_eval.t().print("all eigenvalues =");
 
     DenseGenMatProd<double> op(mat);
     GenEigsSolver<double, SelectionRule, DenseGenMatProd<double>> eigs(&op, k, m);
+    eigs.set_restart_method(restart_method);
     eigs.init();
     int nconv = eigs.compute();
     int niter = eigs.num_iterations();
@@ -40,31 +41,31 @@ void run_test(Matrix &mat, int k, int m)
     REQUIRE( arma::abs(err).max() == Approx(0.0) );
 }
 
-void run_test_sets(Matrix &A, int k, int m)
+void run_test_sets(Matrix &A, int k, int m, int restart_method = IMPLICIT_RESTART)
 {
     SECTION( "Largest Magnitude" )
     {
-        run_test<LARGEST_MAGN>(A, k, m);
+        run_test<LARGEST_MAGN>(A, k, m, restart_method);
     }
     SECTION( "Largest Real Part" )
     {
-        run_test<LARGEST_REAL>(A, k, m);
+        run_test<LARGEST_REAL>(A, k, m, restart_method);
     }
     SECTION( "Largest Imaginary Part" )
     {
-        run_test<LARGEST_IMAG>(A, k, m);
+        run_test<LARGEST_IMAG>(A, k, m, restart_method);
     }
     SECTION( "Smallest Magnitude" )
     {
-        run_test<SMALLEST_MAGN>(A, k, m);
+        run_test<SMALLEST_MAGN>(A, k, m, restart_method);
     }
     SECTION( "Smallest Real Part" )
     {
-        run_test<SMALLEST_REAL>(A, k, m);
+        run_test<SMALLEST_REAL>(A, k, m, restart_method);
     }
     SECTION( "Smallest Imaginary Part" )
     {
-        run_test<SMALLEST_IMAG>(A, k, m);
+        run_test<SMALLEST_IMAG>(A, k, m, restart_method);
     }
 }
 
@@ -100,3 +101,104 @@ TEST_CASE("Eigensolver of general real matrix [1000x1000]", "[eigs_gen]")
 
     run_test_sets(A, k, m);
 }
+
+TEST_CASE("Eigensolver of general real matrix with Krylov-Schur restart [10x10]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    int k = 3;
+    int m = 6;
+
+    run_test_sets(A, k, m, THICK_RESTART);
+}
+
+TEST_CASE("Eigensolver of general real matrix with Krylov-Schur restart [100x100]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    int k = 10;
+    int m = 20;
+
+    run_test_sets(A, k, m, THICK_RESTART);
+}
+
+TEST_CASE("Warm start of general eigen solver [100x100]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix mat1 = arma::randu(100, 100);
+    Matrix E = arma::randu(100, 100) - 0.5;
+    // A slightly perturbed matrix
+    Matrix mat2 = mat1 + 1e-4 * E;
+    int k = 10;
+    int m = 30;
+
+    DenseGenMatProd<double> op1(mat1);
+    GenEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double> > eigs1(&op1, k, m);
+    eigs1.init();
+    eigs1.compute();
+    ComplexMatrix evecs1 = eigs1.eigenvectors();
+    // The real and imaginary parts span the invariant subspace
+    Matrix X = arma::join_rows(arma::real(evecs1), arma::imag(evecs1));
+
+    DenseGenMatProd<double> op2(mat2);
+    GenEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double> > cold(&op2, k, m);
+    cold.init();
+    cold.compute();
+
+    // Start from the eigenvectors of the first matrix
+    GenEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double> > warm(&op2, k, m);
+    warm.init(X.memptr(), X.n_cols);
+    int nconv = warm.compute();
+
+    REQUIRE( nconv == k );
+
+    ComplexVector evals = warm.eigenvalues();
+    ComplexMatrix evecs = warm.eigenvectors();
+    ComplexMatrix err = mat2 * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nops of cold start = " << cold.num_operations() );
+    INFO( "nops of warm start = " << warm.num_operations() );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( warm.num_operations() < cold.num_operations() );
+}
+
+TEST_CASE("Observer of the iterations [400x400]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix mat = arma::randu(400, 400);
+    DenseGenMatProd<double> op(mat);
+
+    const int k = 8, m = 20;
+    typedef GenEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double> > Solver;
+
+    int ncall = 0, last_nconv = -1;
+    Solver eigs(&op, k, m);
+    eigs.set_observer([&](const EigsIteration<std::complex<double>, double> &it)
+    {
+        REQUIRE( it.iter == ncall );
+        REQUIRE( (int) it.ritz_values.n_elem == k );
+        REQUIRE( (int) it.residuals.n_elem == k );
+        ncall++;
+        last_nconv = it.nconv;
+        return false;
+    });
+    eigs.init();
+    int nconv = eigs.compute();
+    REQUIRE( ncall == eigs.num_iterations() );
+    REQUIRE( last_nconv == nconv );
+
+    // Stop after the first iteration, keeping what has converged
+    Solver eigs_stop(&op, k, m);
+    eigs_stop.set_observer([](const EigsIteration<std::complex<double>, double> &)
+    {
+        return true;
+    });
+    eigs_stop.init();
+    int nconv_stop = eigs_stop.compute();
+    REQUIRE( eigs_stop.num_iterations() == 1 );
+    REQUIRE( (int) eigs_stop.eigenvalues().n_elem == nconv_stop );
+}
@@ -0,0 +1,154 @@
+#include <armadillo>
+#include <iostream>
+#include <algorithm>
+
+#include <GenEigsSolver.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::cx_mat ComplexMatrix;
+typedef arma::cx_vec ComplexVector;
+
+template <int SelectionRule>
+void run_test(Matrix &mat, int k, int m, double sigmar, double sigmai)
+{
+    // ComplexVector all_eval = arma::eig_gen(mat);
+    // all_eval.t().print("all eigenvalues =");
+
+    DenseGenComplexShiftSolve<double> op(mat);
+    GenEigsComplexShiftSolver<double, SelectionRule, DenseGenComplexShiftSolve<double>> eigs(&op, k, m, sigmar, sigmai);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    REQUIRE( nconv > 0 );
+
+    ComplexVector evals = eigs.eigenvalues();
+    ComplexMatrix evecs = eigs.eigenvectors();
+
+    // evals.print("computed eigenvalues D =");
+    // evecs.print("computed eigenvectors U =");
+    ComplexMatrix err = mat * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+}
+
+
+void run_test_sets(Matrix &A, int k, int m, double sigmar, double sigmai)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<LARGEST_MAGN>(A, k, m, sigmar, sigmai);
+    }
+    SECTION( "Largest Real Part" )
+    {
+        run_test<LARGEST_REAL>(A, k, m, sigmar, sigmai);
+    }
+    SECTION( "Smallest Magnitude" )
+    {
+        run_test<SMALLEST_MAGN>(A, k, m, sigmar, sigmai);
+    }
+}
+
+TEST_CASE("Eigensolver of general real matrix [10x10]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(10, 10);
+    int k = 3;
+    int m = 6;
+
+    run_test_sets(A, k, m, 0.5, 0.5);
+}
+
+TEST_CASE("Eigensolver of general real matrix [100x100]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    int k = 10;
+    int m = 20;
+
+    run_test_sets(A, k, m, 0.5, 1.0);
+}
+
+TEST_CASE("Eigensolver of general real matrix [1000x1000]", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(1000, 1000);
+    int k = 20;
+    int m = 50;
+
+    run_test_sets(A, k, m, 0.5, 2.0);
+}
+
+TEST_CASE("The eigenvalue closest to the complex shift is found", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    const std::complex<double> sigma(0.5, 1.0);
+    ComplexVector all_eval = arma::eig_gen(A);
+    // The spectrum of A is symmetric about the real axis,
+    // so the distance to sigma and its conjugate is the same
+    const arma::uword imin = arma::abs(all_eval - sigma).index_min();
+    const std::complex<double> closest = all_eval[imin];
+
+    DenseGenComplexShiftSolve<double> op(A);
+    GenEigsComplexShiftSolver<double, LARGEST_MAGN, DenseGenComplexShiftSolve<double>>
+        eigs(&op, 4, 12, sigma.real(), sigma.imag());
+    eigs.init();
+    REQUIRE( eigs.compute() > 0 );
+
+    ComplexVector evals = eigs.eigenvalues();
+    double dist = std::min(arma::abs(evals - closest).min(),
+                           arma::abs(evals - std::conj(closest)).min());
+    INFO( "closest eigenvalue = " << closest );
+    REQUIRE( dist == Approx(0.0).epsilon(1e-8) );
+}
+
+// Counts both the shift-solve operations and the products with A
+class CountingShiftSolve: public DenseGenComplexShiftSolve<double>
+{
+public:
+    int nop;
+
+    CountingShiftSolve(arma::mat &mat) :
+        DenseGenComplexShiftSolve<double>(mat), nop(0)
+    {}
+
+    void perform_op(double *x_in, double *y_out)
+    {
+        nop++;
+        DenseGenComplexShiftSolve<double>::perform_op(x_in, y_out);
+    }
+
+    void mat_prod(double *x_in, double *y_out)
+    {
+        nop++;
+        DenseGenComplexShiftSolve<double>::mat_prod(x_in, y_out);
+    }
+};
+
+TEST_CASE("The products with A are counted as matrix operations", "[eigs_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    CountingShiftSolve op(A);
+    GenEigsComplexShiftSolver<double, LARGEST_MAGN, CountingShiftSolve> eigs(&op, 4, 12, 0.5, 1.0);
+    eigs.init();
+    REQUIRE( eigs.compute() > 0 );
+
+    INFO( "operations counted by the operator = " << op.nop );
+    REQUIRE( eigs.num_operations() == op.nop );
+}
@@ -0,0 +1,157 @@
+#include <armadillo>
+#include <iostream>
+#include <complex>
+
+#include <HermEigsSolver.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef std::complex<double> Complex;
+typedef arma::cx_mat ComplexMatrix;
+typedef arma::sp_cx_mat SpComplexMatrix;
+typedef arma::vec Vector;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<Complex> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpComplexMatrix>
+{
+    typedef SparseGenMatProd<Complex> OpType;
+};
+
+
+template <typename MatType, int SelectionRule>
+void run_test(MatType &mat, int k, int m)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    OpType op(mat);
+    HermEigsSolver<double, SelectionRule, OpType> eigs(&op, k, m);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    ComplexMatrix evecs = eigs.eigenvectors();
+
+    ComplexMatrix err = mat * evecs - evecs * arma::diagmat(arma::conv_to<arma::cx_vec>::from(evals));
+    ComplexMatrix orth = evecs.t() * evecs - arma::eye<ComplexMatrix>(nconv, nconv);
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    INFO( "||U^H U - I||_inf = " << arma::abs(orth).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( arma::abs(orth).max() == Approx(0.0) );
+}
+
+template <typename MatType>
+void run_test_sets(MatType &mat, int k, int m)
+{
+    SECTION( "Largest Magnitude" )
+    {
+        run_test<MatType, LARGEST_MAGN>(mat, k, m);
+    }
+    SECTION( "Largest Value" )
+    {
+        run_test<MatType, LARGEST_ALGE>(mat, k, m);
+    }
+    SECTION( "Smallest Magnitude" )
+    {
+        run_test<MatType, SMALLEST_MAGN>(mat, k, m);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test<MatType, SMALLEST_ALGE>(mat, k, m);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test<MatType, BOTH_ENDS>(mat, k, m);
+    }
+}
+
+ComplexMatrix gen_dense_data(int n)
+{
+    ComplexMatrix A = arma::randu<ComplexMatrix>(n, n) - Complex(0.5, 0.5);
+    return A + A.t();
+}
+
+SpComplexMatrix gen_sparse_data(int n, double prob = 0.1)
+{
+    SpComplexMatrix A(n, n);
+    for(int j = 0; j < n; j++)
+    {
+        A(j, j) = Complex(arma::randu() - 0.5, 0.0);
+        for(int i = j + 1; i < n; i++)
+        {
+            if(arma::randu() < prob)
+            {
+                const Complex a(arma::randu() - 0.5, arma::randu() - 0.5);
+                A(i, j) = a;
+                A(j, i) = std::conj(a);
+            }
+        }
+    }
+    return A;
+}
+
+TEST_CASE("Eigensolver of Hermitian matrix [10x10]", "[eigs_herm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    ComplexMatrix A = gen_dense_data(10);
+    int k = 3;
+    int m = 6;
+
+    run_test_sets(A, k, m);
+}
+
+TEST_CASE("Eigensolver of Hermitian matrix [100x100]", "[eigs_herm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    ComplexMatrix A = gen_dense_data(100);
+    int k = 10;
+    int m = 20;
+
+    run_test_sets(A, k, m);
+}
+
+TEST_CASE("Eigensolver of sparse Hermitian matrix [100x100]", "[eigs_herm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpComplexMatrix A = gen_sparse_data(100);
+    int k = 10;
+    int m = 30;
+
+    run_test_sets(A, k, m);
+}
+
+TEST_CASE("Eigenvalues agree with the dense Hermitian solver", "[eigs_herm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    ComplexMatrix A = gen_dense_data(200);
+    Vector all_evals = arma::eig_sym(A);
+    const int k = 5;
+
+    DenseGenMatProd<Complex> op(A);
+    HermEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<Complex> > eigs(&op, k, 20);
+    eigs.init();
+    REQUIRE( eigs.compute() == k );
+
+    // Each eigenvalue is found once, unlike in the real embedding of A
+    Vector diff = eigs.eigenvalues() - arma::flipud(all_evals.tail(k));
+    REQUIRE( arma::abs(diff).max() == Approx(0.0).epsilon(1e-8) );
+}
@@ -0,0 +1,199 @@
+#include <armadillo>
+#include <iostream>
+#include <complex>
+
+#include <JDSymEigsSolver.h>
+#include <JDGenEigsSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::cx_mat ComplexMatrix;
+typedef arma::cx_vec ComplexVector;
+typedef arma::sp_mat SpMatrix;
+typedef std::complex<double> Complex;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+// Preconditioner 1 / |a_ii - target|, which is positive definite
+class ShiftedDiagPrecond
+{
+private:
+    Vector inv_diag;
+
+public:
+    ShiftedDiagPrecond(const SpMatrix &mat, double target) :
+        inv_diag(1.0 / arma::abs(Vector(mat.diag()) - target))
+    {}
+
+    int rows() { return inv_diag.n_elem; }
+
+    void perform_op(const double *x_in, double *y_out)
+    {
+        for(int i = 0; i < rows(); i++)
+            y_out[i] = inv_diag[i] * x_in[i];
+    }
+
+    void perform_op(const double *x_in, double *y_out, int ncols)
+    {
+        for(int j = 0; j < ncols; j++)
+            perform_op(x_in + j * rows(), y_out + j * rows());
+    }
+};
+
+
+template <typename MatType, typename PrecondType>
+void run_sym_test(MatType &mat, int k, int m, double target, PrecondType *precond)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    OpType op(mat);
+    JDSymEigsSolver<double, TARGET_CLOSEST, OpType, PrecondType> eigs(&op, k, m, target, precond);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    REQUIRE( nconv == k );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // The eigenvalues must be the ones closest to the target
+    Vector true_evals = arma::eig_sym(Matrix(mat));
+    arma::uvec ind = arma::sort_index(arma::abs(true_evals - target));
+    Vector diff = evals - true_evals.elem(ind.head(k));
+    INFO( "max|lambda - lambda_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+}
+
+template <typename MatType, typename PrecondType>
+void run_gen_test(MatType &mat, int k, int m, Complex target, PrecondType *precond)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    OpType op(mat);
+    JDGenEigsSolver<double, TARGET_CLOSEST, OpType, PrecondType> eigs(&op, k, m, target, precond);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    REQUIRE( nconv == k );
+
+    ComplexVector evals = eigs.eigenvalues();
+    ComplexMatrix evecs = eigs.eigenvectors();
+
+    ComplexMatrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // The eigenvalues must be the ones closest to the target
+    ComplexVector true_evals = arma::eig_gen(Matrix(mat));
+    arma::uvec ind = arma::sort_index(arma::abs(true_evals - target));
+    ComplexVector diff = evals - true_evals.elem(ind.head(k));
+    INFO( "max|lambda - lambda_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+}
+
+TEST_CASE("Jacobi-Davidson of symmetric matrix [100x100]", "[jd_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    IdentityPrecond<double> *none = NULL;
+
+    SECTION( "Interior values" )
+    {
+        run_sym_test(mat, 3, 20, 0.5, none);
+    }
+    SECTION( "Small search space" )
+    {
+        run_sym_test(mat, 3, 10, -1.0, none);
+    }
+}
+
+TEST_CASE("Jacobi-Davidson with a diagonal preconditioner [1000x1000]", "[jd_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.01);
+    SpMatrix mat = A + A.t();
+    for(int i = 0; i < 1000; i++)
+        mat(i, i) += i + 1;
+
+    const double target = 500.5;
+    ShiftedDiagPrecond precond(mat, target);
+
+    run_sym_test(mat, 5, 20, target, &precond);
+}
+
+TEST_CASE("Jacobi-Davidson of general matrix with a diagonal preconditioner [1000x1000]", "[jd_gen]")
+{
+    arma::arma_rng::set_seed(123);
+
+    // Without a preconditioner, GMRES hardly reduces the residual of the
+    // correction equation when the target is surrounded by the spectrum,
+    // as for interior eigenvalues of a random matrix
+    SpMatrix mat = arma::sprandu(1000, 1000, 0.01);
+    for(int i = 0; i < 1000; i++)
+        mat(i, i) += i + 1;
+
+    SECTION( "Complex target" )
+    {
+        // The eigenvalues are close to the integers, so the target is
+        // kept off the midpoints, where the third closest one is a tie
+        const Complex target(500.4, 0.5);
+        ShiftedDiagPrecond precond(mat, target.real());
+        run_gen_test(mat, 3, 20, target, &precond);
+    }
+    SECTION( "Real target" )
+    {
+        const Complex target(250.3, 0.0);
+        ShiftedDiagPrecond precond(mat, target.real());
+        run_gen_test(mat, 3, 20, target, &precond);
+    }
+}
+
+TEST_CASE("Jacobi-Davidson with invalid parameters", "[jd_sym][jd_gen]")
+{
+    Matrix A = arma::randu(30, 30);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+    IdentityPrecond<double> precond(20);
+
+    typedef JDSymEigsSolver<double, TARGET_CLOSEST, DenseGenMatProd<double> > SymSolver;
+    typedef JDGenEigsSolver<double, TARGET_CLOSEST, DenseGenMatProd<double> > GenSolver;
+    // ncv is too large for the matrix
+    REQUIRE_THROWS_AS( SymSolver(&op, 5, 26), std::invalid_argument& );
+    REQUIRE_THROWS_AS( GenSolver(&op, 5, 26), std::invalid_argument& );
+    // The preconditioner has a wrong size
+    REQUIRE_THROWS_AS( SymSolver(&op, 5, 10, 0.0, &precond), std::invalid_argument& );
+    REQUIRE_THROWS_AS( GenSolver(&op, 5, 10, Complex(0.0), &precond), std::invalid_argument& );
+    // Unsupported selection rule
+    REQUIRE_THROWS_AS( (JDSymEigsSolver<double, BOTH_ENDS, DenseGenMatProd<double> >(&op, 5, 10)), std::invalid_argument& );
+}
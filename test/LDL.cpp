@@ -28,6 +28,9 @@ void run_test(arma::Mat<Scalar> &A, arma::Col<Scalar> &b)
 
         INFO( "max|x - x0| = " << arma::abs(x - x0).max() );
         REQUIRE( arma::abs(x - x0).max() == Approx(0.0).epsilon(prec) );
+
+        arma::Col<Scalar> evals = arma::eig_sym(arma::symmatl(A));
+        REQUIRE( solver.num_negative() == int(arma::accu(evals < Scalar(0))) );
     }
     SECTION( "Using Upper Triangular Part" )
     {
@@ -38,6 +41,9 @@ void run_test(arma::Mat<Scalar> &A, arma::Col<Scalar> &b)
 
         INFO( "max|x - x0| = " << arma::abs(x - x0).max() );
         REQUIRE( arma::abs(x - x0).max() == Approx(0.0).epsilon(prec) );
+
+        arma::Col<Scalar> evals = arma::eig_sym(arma::symmatu(A));
+        REQUIRE( solver.num_negative() == int(arma::accu(evals < Scalar(0))) );
     }
 }
 
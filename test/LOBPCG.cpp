@@ -0,0 +1,118 @@
+#include <armadillo>
+#include <iostream>
+
+#include <LOBPCGSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+#include <MatOp/JacobiPrecond.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+
+template <typename MatType, int SelectionRule, typename PrecondType>
+int run_test(MatType &mat, int k, int b, PrecondType *precond)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    OpType op(mat);
+    LOBPCGSolver<double, SelectionRule, OpType, PrecondType> eigs(&op, k, b, precond);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    REQUIRE( nconv == k );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // The eigenvalues must be the wanted ones, from the wanted end
+    Vector true_evals = arma::eig_sym(Matrix(mat));
+    if(SelectionRule == LARGEST_ALGE)
+        true_evals = arma::flipud(true_evals);
+    Vector diff = evals - true_evals.head(k);
+    INFO( "max|lambda - lambda_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+
+    return nops;
+}
+
+TEST_CASE("LOBPCG of symmetric positive definite matrix [100x100]", "[lobpcg]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A.t() * A + arma::diagmat(arma::linspace<Vector>(1, 100, 100));
+    IdentityPrecond<double> *none = NULL;
+
+    SECTION( "Smallest Value" )
+    {
+        run_test<Matrix, SMALLEST_ALGE>(mat, 5, 8, none);
+    }
+    SECTION( "Largest Value" )
+    {
+        run_test<Matrix, LARGEST_ALGE>(mat, 5, 8, none);
+    }
+}
+
+TEST_CASE("LOBPCG with a Jacobi preconditioner [1000x1000]", "[lobpcg]")
+{
+    arma::arma_rng::set_seed(123);
+
+    // Strongly varying diagonal, as in a stiffness matrix with
+    // very different element sizes
+    SpMatrix A = arma::sprandu(1000, 1000, 0.01);
+    SpMatrix mat = A + A.t();
+    for(int i = 0; i < 1000; i++)
+        mat(i, i) += i + 1;
+
+    JacobiPrecond<double> jacobi(mat);
+    IdentityPrecond<double> identity(1000);
+
+    int nops_jacobi = run_test<SpMatrix, SMALLEST_ALGE>(mat, 10, 12, &jacobi);
+    int nops_identity = run_test<SpMatrix, SMALLEST_ALGE>(mat, 10, 12, &identity);
+
+    INFO( "nops with Jacobi = " << nops_jacobi );
+    INFO( "nops without preconditioner = " << nops_identity );
+    REQUIRE( nops_jacobi < nops_identity );
+}
+
+TEST_CASE("LOBPCG with invalid parameters", "[lobpcg]")
+{
+    Matrix A = arma::randu(30, 30);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+    IdentityPrecond<double> precond(20);
+
+    typedef LOBPCGSolver<double, SMALLEST_ALGE, DenseGenMatProd<double> > Solver;
+    // nblock is too large for the matrix
+    REQUIRE_THROWS_AS( Solver(&op, 5, 11), std::invalid_argument& );
+    // The preconditioner has a wrong size
+    REQUIRE_THROWS_AS( Solver(&op, 5, 8, &precond), std::invalid_argument& );
+    // Unsupported selection rule
+    REQUIRE_THROWS_AS( (LOBPCGSolver<double, LARGEST_MAGN, DenseGenMatProd<double> >(&op, 5, 8)), std::invalid_argument& );
+}
@@ -0,0 +1,117 @@
+#include <armadillo>
+#include <iostream>
+
+#include <PartialSVDSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Traits to obtain operation type from matrix type
+template <typename MatType>
+struct OpTypeTrait
+{
+    typedef DenseGenMatProd<double> OpType;
+};
+
+template <>
+struct OpTypeTrait<SpMatrix>
+{
+    typedef SparseGenMatProd<double> OpType;
+};
+
+
+template <typename MatType>
+void run_test(MatType &mat, int k, int m)
+{
+    typename OpTypeTrait<MatType>::OpType op(mat);
+    PartialSVDSolver<double, typename OpTypeTrait<MatType>::OpType> svds(&op, k, m);
+    svds.init();
+    int nconv = svds.compute();
+    int niter = svds.num_iterations();
+    int nops = svds.num_operations();
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    REQUIRE( nconv == k );
+
+    Vector svals = svds.singular_values();
+    Matrix U = svds.matrix_U();
+    Matrix V = svds.matrix_V();
+
+    Matrix err = mat * V - U * arma::diagmat(svals);
+    INFO( "||AV - US||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    Matrix err_t = mat.t() * U - V * arma::diagmat(svals);
+    INFO( "||A'U - VS||_inf = " << arma::abs(err_t).max() );
+    REQUIRE( arma::abs(err_t).max() == Approx(0.0) );
+
+    // The singular values must be the largest ones
+    Vector true_svals = arma::svd(Matrix(mat));
+    Vector diff = svals - true_svals.head(k);
+    INFO( "max|sigma - sigma_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+}
+
+TEST_CASE("Partial SVD of tall real matrix [100x10]", "[svds]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix mat = arma::randu(100, 10);
+
+    run_test(mat, 3, 6);
+}
+
+TEST_CASE("Partial SVD of wide real matrix [10x100]", "[svds]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix mat = arma::randu(10, 100);
+
+    run_test(mat, 3, 6);
+}
+
+TEST_CASE("Partial SVD of real matrix [200x100]", "[svds]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix mat = arma::randn(200, 100);
+
+    run_test(mat, 10, 30);
+}
+
+TEST_CASE("Partial SVD of sparse real matrix [1000x300]", "[svds]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix mat = arma::sprandu(1000, 300, 0.1);
+
+    run_test(mat, 20, 50);
+}
+
+TEST_CASE("Partial SVD of rank deficient real matrix [50x40]", "[svds]")
+{
+    arma::arma_rng::set_seed(123);
+
+    // Rank 5, so the bidiagonalization breaks down before ncv steps
+    Matrix mat = arma::randn(50, 5) * arma::randn(5, 40);
+
+    run_test(mat, 3, 10);
+}
+
+TEST_CASE("Partial SVD with invalid parameters", "[svds]")
+{
+    Matrix mat = arma::randu(20, 10);
+    DenseGenMatProd<double> op(mat);
+
+    // ncv cannot exceed min(m, n)
+    REQUIRE_THROWS_AS( (PartialSVDSolver< double, DenseGenMatProd<double> >(&op, 3, 11)), std::invalid_argument& );
+    REQUIRE_THROWS_AS( (PartialSVDSolver< double, DenseGenMatProd<double> >(&op, 10, 10)), std::invalid_argument& );
+}
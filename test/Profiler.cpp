@@ -0,0 +1,132 @@
+// The solvers only contain the profiler with this macro
+#define ARPACK_ARMA_PROFILE
+
+#include <armadillo>
+#include <iostream>
+#include <string>
+
+#include <SymEigsSolver.h>
+#include <GenEigsSolver.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Common checks of the records of a solver
+void check_profile(const SolverProfiler &prof, int nops, double wall)
+{
+    long ncall = 0;
+    for(int i = 0; i < NUM_SOLVER_PHASES; i++)
+    {
+        INFO( "phase " << SolverProfiler::phase_name(i) );
+        REQUIRE( prof.total_time(i) >= 0.0 );
+        ncall += prof.num_calls(i);
+    }
+    REQUIRE( prof.num_calls(PHASE_OP) == nops );
+    REQUIRE( prof.num_calls(PHASE_EIGENVECTORS) == 1 );
+    REQUIRE( prof.num_events() == (std::size_t) ncall );
+
+    // The phases do not overlap, since nested phases are excluded
+    REQUIRE( prof.total_time() > 0.0 );
+    REQUIRE( prof.total_time() <= wall );
+
+    std::string trace = prof.chrome_trace();
+    REQUIRE( trace.find("{\"traceEvents\":[") == 0 );
+    REQUIRE( trace.find("\"name\":\"matrix operation\"") != std::string::npos );
+    REQUIRE( trace.find("\"name\":\"Ritz eigen decomposition\"") != std::string::npos );
+    REQUIRE( trace.find("\"ph\":\"X\"") != std::string::npos );
+}
+
+TEST_CASE("Profile of the symmetric solver", "[profiler]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(300, 300);
+    Matrix M = A + A.t();
+    DenseGenMatProd<double> op(M);
+
+    arma::wall_clock timer;
+    timer.tic();
+    SymEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(&op, 10, 25);
+    eigs.init();
+    int nconv = eigs.compute();
+    Matrix evecs = eigs.eigenvectors();
+    double wall = timer.toc();
+    REQUIRE( nconv == 10 );
+
+    const SolverProfiler &prof = eigs.profiler();
+    check_profile(prof, eigs.num_operations(), wall);
+
+    // The Ritz pairs are computed after the factorization and after
+    // every restart, and the last iteration does not restart
+    const int niter = eigs.num_iterations();
+    REQUIRE( prof.num_calls(PHASE_RITZ_EIGEN) == niter );
+    REQUIRE( prof.num_calls(PHASE_RESTART_QR) == niter - 1 );
+    REQUIRE( prof.num_calls(PHASE_UPDATE_V) == niter - 1 );
+    REQUIRE( prof.num_calls(PHASE_ORTH) == niter );
+
+    eigs.profiler().reset();
+    REQUIRE( prof.total_time() == 0.0 );
+    REQUIRE( prof.num_calls(PHASE_OP) == 0 );
+    REQUIRE( prof.num_events() == 0 );
+}
+
+TEST_CASE("Profile of the symmetric solver with the thick restart", "[profiler]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(300, 300);
+    Matrix M = A + A.t();
+    DenseGenMatProd<double> op(M);
+
+    arma::wall_clock timer;
+    timer.tic();
+    SymEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(&op, 10, 25);
+    eigs.set_restart_method(THICK_RESTART);
+    eigs.init();
+    eigs.compute();
+    Matrix evecs = eigs.eigenvectors();
+    double wall = timer.toc();
+
+    const SolverProfiler &prof = eigs.profiler();
+    check_profile(prof, eigs.num_operations(), wall);
+    // No QR sweeps in the thick restart
+    REQUIRE( prof.num_calls(PHASE_RESTART_QR) == 0 );
+    REQUIRE( prof.num_calls(PHASE_UPDATE_V) == eigs.num_iterations() - 1 );
+}
+
+TEST_CASE("Profile of the general solver", "[profiler]")
+{
+    arma::arma_rng::set_seed(123);
+    SpMatrix M = arma::sprandu(400, 400, 0.05);
+    SparseGenMatProd<double> op(M);
+
+    arma::wall_clock timer;
+    timer.tic();
+    GenEigsSolver< double, LARGEST_MAGN, SparseGenMatProd<double> > eigs(&op, 6, 20);
+    eigs.init();
+    int nconv = eigs.compute();
+    arma::cx_mat evecs = eigs.eigenvectors();
+    double wall = timer.toc();
+    REQUIRE( nconv > 0 );
+
+    const SolverProfiler &prof = eigs.profiler();
+    check_profile(prof, eigs.num_operations(), wall);
+    REQUIRE( prof.num_calls(PHASE_RITZ_EIGEN) == eigs.num_iterations() );
+}
+
+TEST_CASE("Limit on the length of the trace", "[profiler]")
+{
+    SolverProfiler prof(3);
+    for(int i = 0; i < 5; i++)
+    {
+        ProfileScope outer(prof, PHASE_ORTH);
+        ProfileScope inner(prof, PHASE_OP);
+    }
+    REQUIRE( prof.num_calls(PHASE_ORTH) == 5 );
+    REQUIRE( prof.num_calls(PHASE_OP) == 5 );
+    REQUIRE( prof.num_events() == 3 );
+}
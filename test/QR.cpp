@@ -1,6 +1,8 @@
-// Test ../include/LinAlg/UpperHessenbergQR.h and ../include/LinAlg/DoubleShiftQR.h
+// Test ../include/LinAlg/UpperHessenbergQR.h, ../include/LinAlg/DoubleShiftQR.h
+// and ../include/LinAlg/FixedTridiagQR.h
 #include <LinAlg/UpperHessenbergQR.h>
 #include <LinAlg/DoubleShiftQR.h>
+#include <LinAlg/FixedTridiagQR.h>
 
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
@@ -108,6 +110,44 @@ TEST_CASE("QR of Tridiagonal matrix", "[QR]")
     run_test< TridiagQR<double> >(H);
 }
 
+TEST_CASE("Shifted QR steps of a fixed-size tridiagonal matrix", "[QR]")
+{
+    arma::arma_rng::set_seed(123);
+    const int n = 20;
+    mat m(n, n, arma::fill::randn);
+    mat H(n, n, arma::fill::zeros);
+    H.diag(-1) = m.diag(-1);
+    H.diag(0) = m.diag(0);
+    H.diag(1) = m.diag(-1);
+    vec shifts(5, arma::fill::randn);
+
+    // Reference: the steps of TridiagQR on a dynamic matrix
+    mat H0 = H, Q0(n, n, arma::fill::eye);
+    TridiagQR<double> decomp;
+    for(int i = 0; i < 5; i++)
+    {
+        H0.diag() -= shifts[i];
+        decomp.compute(H0);
+        decomp.apply_YQ(Q0);
+        decomp.matrix_RQ(H0);
+        H0.diag() += shifts[i];
+    }
+
+    mat::fixed<n, n> H1 = H, Q1(arma::fill::eye);
+    FixedTridiagQR<double, n> fixed_decomp;
+    fixed_decomp.load(H1.memptr());
+    for(int i = 0; i < 5; i++)
+        fixed_decomp.shift(shifts[i], Q1.memptr());
+    fixed_decomp.store(H1.memptr());
+
+    INFO( "max error of H = " << arma::abs(H1 - H0).max() );
+    INFO( "max error of Q = " << arma::abs(Q1 - Q0).max() );
+    REQUIRE( arma::abs(H1 - H0).max() == Approx(0.0) );
+    REQUIRE( arma::abs(Q1 - Q0).max() == Approx(0.0) );
+    // Q'HQ equals the new H
+    REQUIRE( arma::abs(Q1.t() * H * Q1 - H1).max() == Approx(0.0) );
+}
+
 
 TEST_CASE("QR decomposition with double shifts", "QR")
 {
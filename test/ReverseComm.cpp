@@ -0,0 +1,179 @@
+#include <armadillo>
+#include <iostream>
+
+#include <SymEigsSolver.h>
+#include <PartialSVDSolver.h>
+#include <MatOp/ReverseCommOp.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+typedef ReverseCommOp<double> RCOp;
+typedef SymEigsSolver<double, LARGEST_ALGE, RCOp> RCSolver;
+
+// Compute the pending request of op with the matrix mat
+template <typename MatType>
+void serve(RCOp &op, int request, const MatType &mat)
+{
+    Matrix X(op.input(), op.input_rows(), op.num_columns(), false);
+    Matrix Y(op.output(), op.output_rows(), op.num_columns(), false);
+    if(request == RC_OP)
+        Y = mat * X;
+    else
+        Y = mat.t() * X;
+}
+
+void check_eigs(RCSolver &eigs, int nconv, const Matrix &mat, int k)
+{
+    INFO( "nconv = " << nconv );
+    REQUIRE( nconv == k );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    Vector true_evals = arma::flipud(arma::eig_sym(mat));
+    Vector diff = evals - true_evals.head(k);
+    INFO( "max|lambda - lambda_true| = " << arma::abs(diff).max() );
+    REQUIRE( arma::abs(diff).max() == Approx(0.0) );
+}
+
+TEST_CASE("Reverse communication with SymEigsSolver [100x100]", "[reverse_comm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    RCOp op(100, 100);
+    RCSolver eigs(&op, 5, 15);
+
+    int nconv = 0, nreq = 0;
+    op.start([&]() { eigs.init(); nconv = eigs.compute(); });
+    int request;
+    while((request = op.step()) != RC_DONE)
+    {
+        REQUIRE( request == RC_OP );
+        serve(op, request, mat);
+        nreq++;
+    }
+
+    REQUIRE( nreq == eigs.num_operations() );
+    check_eigs(eigs, nconv, mat, 5);
+
+    // Nothing left to do
+    REQUIRE( op.step() == RC_DONE );
+}
+
+TEST_CASE("Interleaved solves with batched products [100x100]", "[reverse_comm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+
+    // Two solves of the same matrix, with different parameters
+    RCOp op1(100, 100), op2(100, 100);
+    RCSolver eigs1(&op1, 3, 10), eigs2(&op2, 6, 20);
+
+    int nconv1 = 0, nconv2 = 0;
+    op1.start([&]() { eigs1.init(); nconv1 = eigs1.compute(); });
+    op2.start([&]() { eigs2.init(); nconv2 = eigs2.compute(); });
+
+    int req1 = op1.step(), req2 = op2.step();
+    while(req1 != RC_DONE || req2 != RC_DONE)
+    {
+        // All the pending products are computed as one matrix product
+        std::vector<RCOp*> pending;
+        if(req1 != RC_DONE)
+            pending.push_back(&op1);
+        if(req2 != RC_DONE)
+            pending.push_back(&op2);
+
+        Matrix X(100, pending.size());
+        for(size_t i = 0; i < pending.size(); i++)
+            X.col(i) = Vector(pending[i]->input(), 100);
+        Matrix Y = mat * X;
+        for(size_t i = 0; i < pending.size(); i++)
+            std::copy(Y.colptr(i), Y.colptr(i) + 100, pending[i]->output());
+
+        if(req1 != RC_DONE)
+            req1 = op1.step();
+        if(req2 != RC_DONE)
+            req2 = op2.step();
+    }
+
+    check_eigs(eigs1, nconv1, mat, 3);
+    check_eigs(eigs2, nconv2, mat, 6);
+}
+
+TEST_CASE("Reverse communication with PartialSVDSolver [200x50]", "[reverse_comm]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix mat = arma::sprandu(200, 50, 0.2);
+
+    RCOp op(200, 50);
+    PartialSVDSolver<double, RCOp> svds(&op, 5, 15);
+
+    int nconv = 0, nop = 0, nop_t = 0;
+    op.start([&]() { svds.init(); nconv = svds.compute(); });
+    int request;
+    while((request = op.step()) != RC_DONE)
+    {
+        serve(op, request, mat);
+        if(request == RC_OP)
+            nop++;
+        else
+            nop_t++;
+    }
+
+    REQUIRE( nconv == 5 );
+    REQUIRE( nop == nop_t );
+
+    Vector svals = svds.singular_values();
+    Matrix U = svds.matrix_U();
+    Matrix V = svds.matrix_V();
+    Matrix err = mat * V - U * arma::diagmat(svals);
+    INFO( "||AV - US||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+}
+
+TEST_CASE("Exceptions and cancellation in reverse communication", "[reverse_comm]")
+{
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+
+    RCOp op(10, 10);
+    RCSolver eigs(&op, 3, 6);
+
+    // The exception of the solver is rethrown by step()
+    op.start([&]() { Vector zero(10, arma::fill::zeros); eigs.init(zero.memptr()); });
+    REQUIRE_THROWS_AS( op.step(), std::invalid_argument& );
+
+    // A solve can be abandoned after a few steps
+    op.start([&]() { eigs.init(); eigs.compute(); });
+    for(int i = 0; i < 3; i++)
+    {
+        int request = op.step();
+        REQUIRE( request == RC_OP );
+        serve(op, request, mat);
+    }
+    op.cancel();
+    REQUIRE( op.step() == RC_DONE );
+
+    // And the same object can start a new solve
+    int nconv = 0;
+    op.start([&]() { eigs.init(); nconv = eigs.compute(); });
+    int request;
+    while((request = op.step()) != RC_DONE)
+        serve(op, request, mat);
+    REQUIRE( nconv == 3 );
+}
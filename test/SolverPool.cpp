@@ -0,0 +1,170 @@
+#include <armadillo>
+#include <iostream>
+#include <vector>
+#include <thread>
+
+#include <SymEigsSolver.h>
+#include <GenEigsSolver.h>
+#include <EigsSolverPool.h>
+#include <MatOp/DenseGenMatProd.h>
+#include <MatOp/SparseGenMatProd.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::cx_vec ComplexVector;
+typedef arma::sp_mat SpMatrix;
+
+typedef SymEigsSolver< double, LARGEST_ALGE, DenseGenMatProd<double> > SymSolver;
+typedef GenEigsSolver< double, LARGEST_MAGN, SparseGenMatProd<double> > GenSolver;
+
+TEST_CASE("Counter-based random number generator", "[solver_pool]")
+{
+    const int n = 10007;
+    CounterRNG rng(123);
+    Vector x(n);
+    rng.uniform(x.memptr(), n);
+    REQUIRE( rng.counter() == (uint64_t) n );
+    REQUIRE( x.min() >= -0.5 );
+    REQUIRE( x.max() < 0.5 );
+    REQUIRE( std::abs(arma::mean(x)) < 0.02 );
+
+    // The same seed gives the same stream, in any number of row blocks
+    for(int nthread = 1; nthread <= 8; nthread++)
+    {
+        CounterRNG rng2(123);
+        Vector y(n);
+        rng2.uniform(y.memptr(), n, nthread);
+        REQUIRE( arma::abs(x - y).max() == 0.0 );
+    }
+
+    // Row blocks generated separately
+    CounterRNG rng3(123);
+    Vector z(n);
+    rng3.uniform_rows(z.memptr(), 5000, n);
+    rng3.uniform_rows(z.memptr(), 0, 5000);
+    REQUIRE( arma::abs(x - z).max() == 0.0 );
+
+    // The next vector continues the stream
+    Vector x2(n);
+    rng.uniform(x2.memptr(), n);
+    REQUIRE( arma::abs(x - x2).max() > 0.0 );
+
+    // Nearby seeds give different streams
+    CounterRNG rng4(124);
+    Vector w(n);
+    rng4.uniform(w.memptr(), n);
+    REQUIRE( std::abs(arma::dot(x, w)) / n < 0.01 );
+}
+
+TEST_CASE("Solvers are reproducible with their own seeds", "[solver_pool]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(200, 200);
+    Matrix M = A + A.t();
+    DenseGenMatProd<double> op(M);
+
+    SymSolver eigs1(&op, 5, 20);
+    eigs1.set_seed(42);
+    arma::arma_rng::set_seed(1);
+    eigs1.init();
+    eigs1.compute();
+
+    // The global generator of Armadillo is not used
+    SymSolver eigs2(&op, 5, 20);
+    eigs2.set_seed(42);
+    arma::arma_rng::set_seed(2);
+    eigs2.init();
+    eigs2.compute();
+
+    REQUIRE( eigs1.num_operations() == eigs2.num_operations() );
+    REQUIRE( arma::abs(eigs1.eigenvalues() - eigs2.eigenvalues()).max() == 0.0 );
+    REQUIRE( arma::abs(eigs1.eigenvectors() - eigs2.eigenvectors()).max() == 0.0 );
+
+    // A different seed gives the same eigenvalues up to the precision
+    SymSolver eigs3(&op, 5, 20);
+    eigs3.set_seed(43);
+    eigs3.init();
+    eigs3.compute();
+    REQUIRE( arma::abs(eigs1.eigenvalues() - eigs3.eigenvalues()).max() == Approx(0.0) );
+}
+
+// The results of the pool must be exactly those of the sequential solves
+TEST_CASE("Concurrent symmetric solves on a shared operator", "[solver_pool]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(300, 300);
+    Matrix M = A + A.t();
+    DenseGenMatProd<double> op(M);
+
+    const int nsolve = 40;
+    EigsSolverPool pool(4);
+    REQUIRE( pool.num_threads() == 4 );
+
+    std::vector< std::future< EigsSolveResult<SymSolver> > > futures;
+    for(int i = 0; i < nsolve; i++)
+        futures.push_back(pool.solve<SymSolver>(&op, 6, 20, i));
+
+    for(int i = 0; i < nsolve; i++)
+    {
+        EigsSolveResult<SymSolver> res = futures[i].get();
+        INFO( "solve " << i );
+        REQUIRE( res.nconv == 6 );
+
+        Matrix err = M * res.eigenvectors - res.eigenvectors * arma::diagmat(res.eigenvalues);
+        REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+        SymSolver eigs(&op, 6, 20);
+        eigs.set_seed(i);
+        eigs.init();
+        eigs.compute();
+        REQUIRE( res.nops == eigs.num_operations() );
+        REQUIRE( arma::abs(res.eigenvalues - eigs.eigenvalues()).max() == 0.0 );
+    }
+}
+
+TEST_CASE("Concurrent general solves on a shared operator", "[solver_pool]")
+{
+    arma::arma_rng::set_seed(123);
+    SpMatrix M = arma::sprandu(400, 400, 0.05);
+    SparseGenMatProd<double> op(M);
+
+    const int nsolve = 20;
+    EigsSolverPool pool(3);
+    std::vector< std::future< EigsSolveResult<GenSolver> > > futures;
+    for(int i = 0; i < nsolve; i++)
+        futures.push_back(pool.solve<GenSolver>(&op, 5, 20, i));
+
+    for(int i = 0; i < nsolve; i++)
+    {
+        EigsSolveResult<GenSolver> res = futures[i].get();
+        INFO( "solve " << i );
+        REQUIRE( res.nconv > 0 );
+
+        GenSolver eigs(&op, 5, 20);
+        eigs.set_seed(i);
+        eigs.init();
+        eigs.compute();
+        REQUIRE( res.nops == eigs.num_operations() );
+        REQUIRE( arma::abs(res.eigenvalues - eigs.eigenvalues()).max() == 0.0 );
+    }
+}
+
+TEST_CASE("Errors of the tasks are returned by the futures", "[solver_pool]")
+{
+    Matrix A = arma::randu(20, 20);
+    Matrix M = A + A.t();
+    DenseGenMatProd<double> op(M);
+
+    EigsSolverPool pool(2);
+    // ncv is larger than the size of the matrix
+    std::future< EigsSolveResult<SymSolver> > bad = pool.solve<SymSolver>(&op, 5, 30, 0);
+    std::future< EigsSolveResult<SymSolver> > good = pool.solve<SymSolver>(&op, 5, 15, 0);
+    std::future<int> other = pool.submit([]() { return 7; });
+
+    REQUIRE_THROWS_AS( bad.get(), std::invalid_argument& );
+    REQUIRE( good.get().nconv == 5 );
+    REQUIRE( other.get() == 7 );
+}
@@ -1,5 +1,6 @@
 #include <armadillo>
 #include <iostream>
+#include <vector>
 
 #include <SymEigsSolver.h>
 #include <MatOp/DenseGenMatProd.h>
@@ -27,14 +28,20 @@ struct OpTypeTrait<SpMatrix>
 
 
 template <typename MatType, int SelectionRule>
-void run_test(MatType &mat, int k, int m)
+void run_test(MatType &mat, int k, int m, int restart_method, int reorth_method, bool locking, int sstep)
 {
     typename OpTypeTrait<MatType>::OpType op(mat);
     SymEigsSolver<double, SelectionRule, typename OpTypeTrait<MatType>::OpType> eigs(&op, k, m);
+    eigs.set_restart_method(restart_method);
+    eigs.set_reorth_method(reorth_method);
+    eigs.set_locking(locking);
+    eigs.set_sstep(sstep);
     eigs.init();
     int nconv = eigs.compute();
     int niter = eigs.num_iterations();
     int nops = eigs.num_operations();
+    int nreorth = eigs.num_reorthogonalizations();
+    int nlock = eigs.num_locked();
 
     REQUIRE( nconv > 0 );
 
@@ -48,32 +55,73 @@ void run_test(MatType &mat, int k, int m)
     INFO( "nconv = " << nconv );
     INFO( "niter = " << niter );
     INFO( "nops = " << nops );
+    INFO( "nreorth = " << nreorth );
+    INFO( "nlock = " << nlock );
     INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
     REQUIRE( arma::abs(err).max() == Approx(0.0) );
+
+    // Partial reorthogonalization should skip most of the full passes over V
+    if(reorth_method == PARTIAL_REORTH)
+        REQUIRE( nreorth < nops );
+}
+
+// The Krylov basis is stored in single precision, so the
+// eigenvectors are only accurate to that precision
+template <typename MatType, int SelectionRule>
+void run_test_float_basis(MatType &mat, int k, int m, int restart_method)
+{
+    typedef typename OpTypeTrait<MatType>::OpType OpType;
+    OpType op(mat);
+    SymEigsSolver<double, SelectionRule, OpType, float> eigs(&op, k, m);
+    eigs.set_restart_method(restart_method);
+    eigs.init();
+    int nconv = eigs.compute();
+    int niter = eigs.num_iterations();
+    int nops = eigs.num_operations();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    const double tol = 1000 * std::numeric_limits<float>::epsilon() * arma::norm(mat, "fro");
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() < tol );
+
+    // Each computed eigenvalue is within the residual norm of an exact one
+    Vector all_evals = arma::eig_sym(Matrix(mat));
+    for(int i = 0; i < nconv; i++)
+        REQUIRE( arma::abs(all_evals - evals[i]).min() < tol );
 }
 
 template <typename MatType>
-void run_test_sets(MatType &mat, int k, int m)
+void run_test_sets(MatType &mat, int k, int m, int restart_method = IMPLICIT_RESTART,
+                   int reorth_method = FULL_REORTH, bool locking = false, int sstep = 1)
 {
     SECTION( "Largest Magnitude" )
     {
-        run_test<MatType, LARGEST_MAGN>(mat, k, m);
+        run_test<MatType, LARGEST_MAGN>(mat, k, m, restart_method, reorth_method, locking, sstep);
     }
     SECTION( "Largest Value" )
     {
-        run_test<MatType, LARGEST_ALGE>(mat, k, m);
+        run_test<MatType, LARGEST_ALGE>(mat, k, m, restart_method, reorth_method, locking, sstep);
     }
     SECTION( "Smallest Magnitude" )
     {
-        run_test<MatType, SMALLEST_MAGN>(mat, k, m);
+        run_test<MatType, SMALLEST_MAGN>(mat, k, m, restart_method, reorth_method, locking, sstep);
     }
     SECTION( "Smallest Value" )
     {
-        run_test<MatType, SMALLEST_ALGE>(mat, k, m);
+        run_test<MatType, SMALLEST_ALGE>(mat, k, m, restart_method, reorth_method, locking, sstep);
     }
     SECTION( "Both Ends" )
     {
-        run_test<MatType, BOTH_ENDS>(mat, k, m);
+        run_test<MatType, BOTH_ENDS>(mat, k, m, restart_method, reorth_method, locking, sstep);
     }
 }
 
@@ -124,3 +172,409 @@ TEST_CASE("Eigensolver of sparse symmetric real matrix [1000x1000]", "[eigs_sym]
 
     run_test_sets(mat, k, m);
 }
+
+TEST_CASE("Eigensolver of symmetric real matrix with thick restart [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    run_test_sets(mat, k, m, THICK_RESTART);
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix with thick restart [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    run_test_sets(mat, k, m, THICK_RESTART);
+}
+
+TEST_CASE("Eigensolver of symmetric real matrix with partial reorthogonalization [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 40;
+
+    run_test_sets(mat, k, m, IMPLICIT_RESTART, PARTIAL_REORTH);
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix with partial reorthogonalization [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 10;
+    int m = 60;
+
+    run_test_sets(mat, k, m, IMPLICIT_RESTART, PARTIAL_REORTH);
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix with thick restart and partial reorthogonalization [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 10;
+    int m = 60;
+
+    run_test_sets(mat, k, m, THICK_RESTART, PARTIAL_REORTH);
+}
+
+TEST_CASE("Eigensolver of symmetric real matrix with single precision basis [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    SECTION( "Largest Value" )
+    {
+        run_test_float_basis<Matrix, LARGEST_ALGE>(mat, k, m, IMPLICIT_RESTART);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test_float_basis<Matrix, SMALLEST_ALGE>(mat, k, m, IMPLICIT_RESTART);
+    }
+    SECTION( "Both Ends, thick restart" )
+    {
+        run_test_float_basis<Matrix, BOTH_ENDS>(mat, k, m, THICK_RESTART);
+    }
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix with single precision basis [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    SECTION( "Largest Magnitude" )
+    {
+        run_test_float_basis<SpMatrix, LARGEST_MAGN>(mat, k, m, IMPLICIT_RESTART);
+    }
+    SECTION( "Largest Value, thick restart" )
+    {
+        run_test_float_basis<SpMatrix, LARGEST_ALGE>(mat, k, m, THICK_RESTART);
+    }
+}
+
+TEST_CASE("Eigensolver of symmetric real matrix with locking [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    run_test_sets(mat, k, m, THICK_RESTART, FULL_REORTH, true);
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix with locking [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 20;
+    int m = 50;
+
+    run_test_sets(mat, k, m, THICK_RESTART, PARTIAL_REORTH, true);
+}
+
+TEST_CASE("Eigensolver of symmetric real matrix in s-step mode [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat = A + A.t();
+    int k = 10;
+    int m = 30;
+
+    run_test_sets(mat, k, m, IMPLICIT_RESTART, FULL_REORTH, false, 4);
+}
+
+TEST_CASE("Eigensolver of sparse symmetric real matrix in s-step mode [1000x1000]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    SpMatrix A = arma::sprandu(1000, 1000, 0.1);
+    SpMatrix mat = A + A.t();
+    int k = 20;
+    int m = 50;
+
+    SECTION( "Implicit restart" )
+    {
+        run_test_sets(mat, k, m, IMPLICIT_RESTART, FULL_REORTH, false, 5);
+    }
+    SECTION( "Thick restart with locking" )
+    {
+        run_test_sets(mat, k, m, THICK_RESTART, FULL_REORTH, true, 5);
+    }
+}
+
+TEST_CASE("The s-step mode requires the full reorthogonalization", "[eigs_sym]")
+{
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+    SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(&op, 3, 6);
+    eigs.set_reorth_method(PARTIAL_REORTH);
+    eigs.set_sstep(3);
+    eigs.init();
+
+    REQUIRE_THROWS( eigs.compute() );
+}
+
+TEST_CASE("Locking requires the thick restart", "[eigs_sym]")
+{
+    Matrix A = arma::randu(10, 10);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+    SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs(&op, 3, 6);
+    eigs.set_locking(true);
+    eigs.init();
+
+    REQUIRE_THROWS( eigs.compute() );
+}
+
+TEST_CASE("Warm start of symmetric eigen solver [100x100]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(100, 100);
+    Matrix mat1 = A + A.t();
+    Matrix E = arma::randu(100, 100) - 0.5;
+    // A slightly perturbed matrix
+    Matrix mat2 = mat1 + 1e-4 * (E + E.t());
+    int k = 10;
+    int m = 30;
+
+    DenseGenMatProd<double> op1(mat1);
+    SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > eigs1(&op1, k, m);
+    eigs1.init();
+    eigs1.compute();
+    Matrix evecs1 = eigs1.eigenvectors();
+
+    DenseGenMatProd<double> op2(mat2);
+    SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > cold(&op2, k, m);
+    cold.init();
+    cold.compute();
+
+    // Start from the eigenvectors of the first matrix
+    SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > warm(&op2, k, m);
+    warm.init(evecs1.memptr(), evecs1.n_cols);
+    int nconv = warm.compute();
+
+    REQUIRE( nconv == k );
+
+    Vector evals = warm.eigenvalues();
+    Matrix evecs = warm.eigenvectors();
+    Matrix err = mat2 * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nops of cold start = " << cold.num_operations() );
+    INFO( "nops of warm start = " << warm.num_operations() );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( arma::abs(evals - cold.eigenvalues()).max() == Approx(0.0) );
+    REQUIRE( warm.num_operations() < cold.num_operations() );
+}
+
+// The solver with a compile-time ncv runs the same arithmetic as
+// the one with a run-time ncv
+template <int SelectionRule>
+void run_test_fixed_ncv(Matrix &mat, int restart_method)
+{
+    const int k = 6, m = 20;
+    DenseGenMatProd<double> op(mat);
+
+    SymEigsSolver<double, SelectionRule, DenseGenMatProd<double> > eigs(&op, k, m);
+    eigs.set_restart_method(restart_method);
+    eigs.init();
+    eigs.compute();
+
+    SymEigsSolver<double, SelectionRule, DenseGenMatProd<double>, double, 20> eigs_fixed(&op, k, m);
+    eigs_fixed.set_restart_method(restart_method);
+    eigs_fixed.init();
+    int nconv = eigs_fixed.compute();
+
+    REQUIRE( nconv == k );
+
+    Vector evals = eigs_fixed.eigenvalues();
+    Matrix evecs = eigs_fixed.eigenvectors();
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+
+    INFO( "nops = " << eigs_fixed.num_operations() );
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( eigs_fixed.num_operations() == eigs.num_operations() );
+    REQUIRE( arma::abs(evals - eigs.eigenvalues()).max() == Approx(0.0) );
+}
+
+TEST_CASE("Eigensolver with a compile-time ncv [200x200]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(200, 200);
+    Matrix mat = A + A.t();
+
+    SECTION( "Largest Magnitude" )
+    {
+        run_test_fixed_ncv<LARGEST_MAGN>(mat, IMPLICIT_RESTART);
+    }
+    SECTION( "Smallest Value" )
+    {
+        run_test_fixed_ncv<SMALLEST_ALGE>(mat, IMPLICIT_RESTART);
+    }
+    SECTION( "Both Ends" )
+    {
+        run_test_fixed_ncv<BOTH_ENDS>(mat, IMPLICIT_RESTART);
+    }
+    SECTION( "Thick Restart" )
+    {
+        run_test_fixed_ncv<LARGEST_ALGE>(mat, THICK_RESTART);
+    }
+}
+
+TEST_CASE("The compile-time ncv must match the argument", "[eigs_sym]")
+{
+    Matrix A = arma::randu(50, 50);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+
+    typedef SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double>, double, 20> SolverFixed;
+    REQUIRE_THROWS_AS( SolverFixed(&op, 5, 15), std::invalid_argument& );
+}
+
+TEST_CASE("Observer of the iterations [400x400]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(400, 400);
+    Matrix mat = A + A.t();
+    DenseGenMatProd<double> op(mat);
+
+    const int k = 10, m = 22;
+    typedef SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > Solver;
+
+    // Record all the iterations of a full solve
+    std::vector< EigsIteration<double, double> > history;
+    Solver eigs(&op, k, m);
+    eigs.set_observer([&history](const EigsIteration<double, double> &it)
+    {
+        history.push_back(it);
+        return false;
+    });
+    eigs.init();
+    int nconv = eigs.compute();
+    REQUIRE( nconv == k );
+    REQUIRE( (int) history.size() == eigs.num_iterations() );
+    for(size_t i = 0; i < history.size(); i++)
+    {
+        REQUIRE( history[i].iter == (int) i );
+        REQUIRE( (int) history[i].ritz_values.n_elem == k );
+        REQUIRE( (int) history[i].residuals.n_elem == k );
+        if(i > 0)
+        {
+            REQUIRE( history[i].nops > history[i - 1].nops );
+            REQUIRE( history[i].elapsed >= history[i - 1].elapsed );
+        }
+    }
+    REQUIRE( history.back().nconv == k );
+    REQUIRE( history.back().nops == eigs.num_operations() );
+
+    // The observer does not change the results
+    Solver eigs_plain(&op, k, m);
+    eigs_plain.init();
+    eigs_plain.compute();
+    REQUIRE( arma::abs(eigs.eigenvalues() - eigs_plain.eigenvalues()).max() == 0.0 );
+
+    // Stop early once the dominant eigenvalue has converged
+    Solver eigs_stop(&op, k, m);
+    eigs_stop.set_observer([](const EigsIteration<double, double> &it)
+    {
+        return it.nconv >= 1;
+    });
+    eigs_stop.init();
+    int nconv_stop = eigs_stop.compute();
+    REQUIRE( nconv_stop >= 1 );
+    REQUIRE( eigs_stop.num_iterations() < eigs.num_iterations() );
+
+    // The converged pairs are kept
+    Vector evals = eigs_stop.eigenvalues();
+    Matrix evecs = eigs_stop.eigenvectors();
+    REQUIRE( (int) evals.n_elem == nconv_stop );
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+}
+
+template <int RestartMethod>
+void run_test_twice(Matrix &mat, int k, int m)
+{
+    DenseGenMatProd<double> op(mat);
+    typedef SymEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double> > Solver;
+
+    Solver eigs_once(&op, k, m);
+    eigs_once.set_restart_method(RestartMethod);
+    eigs_once.init();
+    eigs_once.compute();
+    Vector evals_once = eigs_once.eigenvalues();
+
+    // Stop after a few iterations, and continue from there
+    Solver eigs(&op, k, m);
+    eigs.set_restart_method(RestartMethod);
+    eigs.init();
+    int nconv = eigs.compute(3);
+    REQUIRE( nconv < k );
+    int niter = eigs.num_iterations();
+    nconv = eigs.compute();
+    REQUIRE( nconv == k );
+    REQUIRE( eigs.num_iterations() > niter );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( arma::abs(evals - evals_once).max() == Approx(0.0) );
+
+    // Once converged, another call keeps the results
+    nconv = eigs.compute();
+    REQUIRE( nconv == k );
+    REQUIRE( arma::abs(eigs.eigenvalues() - evals).max() == Approx(0.0) );
+}
+
+TEST_CASE("Calling compute() again continues the iterations [400x400]", "[eigs_sym]")
+{
+    arma::arma_rng::set_seed(123);
+    Matrix A = arma::randu(400, 400);
+    Matrix mat = A + A.t();
+
+    const int k = 10, m = 22;
+
+    SECTION( "Implicit Restart" )
+    {
+        run_test_twice<IMPLICIT_RESTART>(mat, k, m);
+    }
+    SECTION( "Thick Restart" )
+    {
+        run_test_twice<THICK_RESTART>(mat, k, m);
+    }
+}
@@ -0,0 +1,101 @@
+#include <armadillo>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+#include <SymEigsSlicingSolver.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+
+void run_test(Matrix &mat, double lower, double upper, int nslice, int nthread)
+{
+    SymEigsSlicingSolver<double> eigs(mat, lower, upper, nslice, nthread);
+    int nconv = eigs.compute();
+    int nexp = eigs.num_expected();
+    int nops = eigs.num_operations();
+
+    Vector all_evals = arma::eig_sym(mat);
+    Vector true_evals = all_evals.elem(arma::find((all_evals >= lower) % (all_evals < upper)));
+
+    INFO( "nconv = " << nconv );
+    INFO( "nexpected = " << nexp );
+    INFO( "nops = " << nops );
+    REQUIRE( nexp == int(true_evals.n_elem) );
+    REQUIRE( nconv == nexp );
+    std::vector<int> nmiss = eigs.num_missing();
+    REQUIRE( std::count(nmiss.begin(), nmiss.end(), 0) == nslice );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+
+    Matrix err = mat * evecs - evecs * arma::diagmat(evals);
+    INFO( "||AU - UD||_inf = " << arma::abs(err).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    INFO( "max|D - D0| = " << arma::abs(evals - true_evals).max() );
+    REQUIRE( arma::abs(evals - true_evals).max() == Approx(0.0) );
+}
+
+TEST_CASE("Spectrum slicing of symmetric real matrix [200x200]", "[eigs_slicing]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(200, 200);
+    Matrix mat = A + A.t();
+
+    SECTION( "One slice" )
+    {
+        run_test(mat, -2.0, 2.0, 1, 1);
+    }
+    SECTION( "Four slices, two threads" )
+    {
+        run_test(mat, -4.0, 4.0, 4, 2);
+    }
+    SECTION( "Eight slices, four threads" )
+    {
+        run_test(mat, -6.0, 6.0, 8, 4);
+    }
+}
+
+TEST_CASE("Spectrum slicing with multiple eigenvalues on the boundaries", "[eigs_slicing]")
+{
+    arma::arma_rng::set_seed(123);
+
+    // Double eigenvalues 0, 0, 1, 1, 2, 2, ..., and with the interval
+    // [10.5, 20.5) in 4 slices, 13 and 18 are slice boundaries
+    const int n = 100;
+    Vector d(n);
+    for(int i = 0; i < n; i++)
+        d[i] = i / 2;
+    Matrix Q, R;
+    arma::qr(Q, R, Matrix(n, n, arma::fill::randn));
+    Matrix mat = Q * arma::diagmat(d) * Q.t();
+    mat = 0.5 * (mat + mat.t());
+
+    run_test(mat, 10.5, 20.5, 4, 3);
+}
+
+TEST_CASE("Spectrum slicing with slices that do not converge", "[eigs_slicing]")
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix A = arma::randu(200, 200);
+    Matrix mat = A + A.t();
+
+    // With tol = 0 no eigenvalue converges, even after the repeated
+    // solves, and all of them are reported as missing
+    SymEigsSlicingSolver<double> eigs(mat, -4.0, 4.0, 4, 2);
+    int nconv = eigs.compute(5, 0.0);
+    int nexp = eigs.num_expected();
+    std::vector<int> nmiss = eigs.num_missing();
+
+    INFO( "nconv = " << nconv );
+    INFO( "nexpected = " << nexp );
+    REQUIRE( nconv == 0 );
+    REQUIRE( int(nmiss.size()) == 4 );
+    REQUIRE( std::accumulate(nmiss.begin(), nmiss.end(), 0) == nexp );
+}
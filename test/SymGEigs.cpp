@@ -0,0 +1,235 @@
+#include <armadillo>
+#include <iostream>
+
+#include <SymGEigsSolver.h>
+#include <MatOp/SparseGenMatProd.h>
+#include <MatOp/SparseRegularInverse.h>
+#include <MatOp/DenseSymGShiftSolve.h>
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+typedef arma::mat Matrix;
+typedef arma::vec Vector;
+typedef arma::sp_mat SpMatrix;
+
+// Check A * X = B * X * D and X' * B * X = I
+template <typename MatA, typename MatB>
+void check_result(const MatA &A, const MatB &B, const Vector &evals, const Matrix &evecs,
+                  int nconv, int niter, int nops)
+{
+    Matrix err = A * evecs - B * evecs * arma::diagmat(evals);
+    Matrix Bnorm = evecs.t() * (B * evecs) - arma::eye<Matrix>(nconv, nconv);
+
+    INFO( "nconv = " << nconv );
+    INFO( "niter = " << niter );
+    INFO( "nops = " << nops );
+    INFO( "||AX - BXD||_inf = " << arma::abs(err).max() );
+    INFO( "||X'BX - I||_inf = " << arma::abs(Bnorm).max() );
+    REQUIRE( arma::abs(err).max() == Approx(0.0) );
+    REQUIRE( arma::abs(Bnorm).max() == Approx(0.0) );
+}
+
+// Eigenvalues of the generalized problem, from the standard problem of inv(L) * A * inv(L')
+Vector reference_eigenvalues(const Matrix &A, const Matrix &B)
+{
+    Matrix U = arma::chol(B);
+    Matrix Uinv = arma::inv(arma::trimatu(U));
+    Matrix C = Uinv.t() * A * Uinv;
+    return arma::eig_sym(0.5 * (C + C.t()));
+}
+
+template <int SelectionRule>
+void run_test_cholesky(Matrix &A, Matrix &B, int k, int m)
+{
+    DenseGenMatProd<double> op(A);
+    DenseCholesky<double> Bop(B);
+    SymGEigsSolver<double, SelectionRule, DenseGenMatProd<double>, DenseCholesky<double>, GEIGS_CHOLESKY>
+        eigs(&op, &Bop, k, m);
+    eigs.init();
+    int nconv = eigs.compute();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+    check_result(A, B, evals, evecs, nconv, eigs.num_iterations(), eigs.num_operations());
+}
+
+template <int SelectionRule>
+void run_test_reginv(Matrix &A, Matrix &B, int k, int m)
+{
+    DenseGenMatProd<double> op(A);
+    DenseCholesky<double> Bop(B);
+    SymGEigsSolver<double, SelectionRule, DenseGenMatProd<double>, DenseCholesky<double>, GEIGS_REGULAR_INVERSE>
+        eigs(&op, &Bop, k, m);
+    eigs.init();
+    int nconv = eigs.compute();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+    check_result(A, B, evals, evecs, nconv, eigs.num_iterations(), eigs.num_operations());
+}
+
+template <int SelectionRule>
+void run_test_shift_invert(Matrix &A, Matrix &B, int k, int m, double sigma)
+{
+    DenseSymGShiftSolve<double> op(A, B);
+    DenseGenMatProd<double> Bop(B);
+    SymGEigsSolver<double, SelectionRule, DenseSymGShiftSolve<double>, DenseGenMatProd<double>, GEIGS_SHIFT_INVERT>
+        eigs(&op, &Bop, k, m, sigma);
+    eigs.init();
+    int nconv = eigs.compute();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+    check_result(A, B, evals, evecs, nconv, eigs.num_iterations(), eigs.num_operations());
+}
+
+void gen_problem(int n, Matrix &A, Matrix &B)
+{
+    arma::arma_rng::set_seed(123);
+
+    Matrix M = arma::randu(n, n);
+    A = M + M.t();
+    Matrix R = arma::randu(n, n);
+    B = R.t() * R / n + arma::eye<Matrix>(n, n);
+}
+
+void run_test_sets(int n, int k, int m, double sigma)
+{
+    Matrix A, B;
+    gen_problem(n, A, B);
+
+    SECTION( "Cholesky, Largest Magnitude" )
+    {
+        run_test_cholesky<LARGEST_MAGN>(A, B, k, m);
+    }
+    SECTION( "Cholesky, Smallest Value" )
+    {
+        run_test_cholesky<SMALLEST_ALGE>(A, B, k, m);
+    }
+    SECTION( "Cholesky, Both Ends" )
+    {
+        run_test_cholesky<BOTH_ENDS>(A, B, k, m);
+    }
+    SECTION( "Regular Inverse, Largest Magnitude" )
+    {
+        run_test_reginv<LARGEST_MAGN>(A, B, k, m);
+    }
+    SECTION( "Regular Inverse, Largest Value" )
+    {
+        run_test_reginv<LARGEST_ALGE>(A, B, k, m);
+    }
+    SECTION( "Regular Inverse, Both Ends" )
+    {
+        run_test_reginv<BOTH_ENDS>(A, B, k, m);
+    }
+    SECTION( "Shift-Invert, Largest Magnitude" )
+    {
+        run_test_shift_invert<LARGEST_MAGN>(A, B, k, m, sigma);
+    }
+    SECTION( "Shift-Invert, Smallest Magnitude" )
+    {
+        run_test_shift_invert<SMALLEST_MAGN>(A, B, k, m, sigma);
+    }
+}
+
+TEST_CASE("Generalized eigensolver of symmetric real matrix [10x10]", "[geigs_sym]")
+{
+    run_test_sets(10, 3, 6, 1.0);
+}
+
+TEST_CASE("Generalized eigensolver of symmetric real matrix [100x100]", "[geigs_sym]")
+{
+    run_test_sets(100, 10, 30, 1.0);
+}
+
+TEST_CASE("Generalized eigensolver of symmetric real matrix [1000x1000]", "[geigs_sym]")
+{
+    run_test_sets(1000, 20, 50, 1.0);
+}
+
+TEST_CASE("The three modes agree with the Cholesky-transformed problem", "[geigs_sym]")
+{
+    Matrix A, B;
+    gen_problem(100, A, B);
+    Vector all_evals = reference_eigenvalues(A, B);
+    const int k = 5, m = 20;
+    const double sigma = all_evals[50];
+
+    DenseGenMatProd<double> op(A);
+    DenseCholesky<double> Bop(B);
+
+    SymGEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double>, DenseCholesky<double>, GEIGS_CHOLESKY>
+        eigs_chol(&op, &Bop, k, m);
+    eigs_chol.init();
+    REQUIRE( eigs_chol.compute() == k );
+    Vector diff = eigs_chol.eigenvalues() - arma::flipud(all_evals.tail(k));
+    REQUIRE( arma::abs(diff).max() == Approx(0.0).epsilon(1e-8) );
+
+    SymGEigsSolver<double, LARGEST_ALGE, DenseGenMatProd<double>, DenseCholesky<double>, GEIGS_REGULAR_INVERSE>
+        eigs_inv(&op, &Bop, k, m);
+    eigs_inv.init();
+    REQUIRE( eigs_inv.compute() == k );
+    diff = eigs_inv.eigenvalues() - arma::flipud(all_evals.tail(k));
+    REQUIRE( arma::abs(diff).max() == Approx(0.0).epsilon(1e-8) );
+
+    // The eigenvalue equal to the shift is the closest one, so perturb the shift slightly
+    DenseSymGShiftSolve<double> sop(A, B);
+    DenseGenMatProd<double> Bprod(B);
+    SymGEigsSolver<double, LARGEST_MAGN, DenseSymGShiftSolve<double>, DenseGenMatProd<double>, GEIGS_SHIFT_INVERT>
+        eigs_si(&sop, &Bprod, 1, m, sigma + 1e-3);
+    eigs_si.init();
+    REQUIRE( eigs_si.compute() == 1 );
+    REQUIRE( eigs_si.eigenvalues()[0] == Approx(sigma) );
+}
+
+TEST_CASE("Regular inverse mode with a sparse mass matrix", "[geigs_sym]")
+{
+    // Stiffness and mass matrices of a 1-D vibration problem
+    const int n = 500;
+    SpMatrix K(n, n), M(n, n);
+    for(int i = 0; i < n; i++)
+    {
+        K(i, i) = 2;
+        M(i, i) = 4.0 / 6;
+        if(i > 0)
+        {
+            K(i, i - 1) = K(i - 1, i) = -1;
+            M(i, i - 1) = M(i - 1, i) = 1.0 / 6;
+        }
+    }
+
+    SparseGenMatProd<double> op(K);
+    SparseRegularInverse<double> Bop(M);
+    SymGEigsSolver<double, LARGEST_ALGE, SparseGenMatProd<double>, SparseRegularInverse<double>, GEIGS_REGULAR_INVERSE>
+        eigs(&op, &Bop, 5, 20);
+    eigs.init();
+    int nconv = eigs.compute();
+
+    REQUIRE( nconv > 0 );
+
+    Vector evals = eigs.eigenvalues();
+    Matrix evecs = eigs.eigenvectors();
+    check_result(K, M, evals, evecs, nconv, eigs.num_iterations(), eigs.num_operations());
+}
+
+TEST_CASE("Invalid parameters of the generalized eigensolver", "[geigs_sym]")
+{
+    Matrix A, B;
+    gen_problem(10, A, B);
+    Matrix B2 = arma::eye<Matrix>(8, 8);
+    Matrix Bind = -arma::eye<Matrix>(10, 10);
+
+    DenseGenMatProd<double> op(A);
+    DenseCholesky<double> Bop(B2);
+
+    typedef SymGEigsSolver<double, LARGEST_MAGN, DenseGenMatProd<double>, DenseCholesky<double>, GEIGS_CHOLESKY> SolverType;
+    REQUIRE_THROWS_AS( SolverType(&op, &Bop, 3, 6), std::invalid_argument& );
+    REQUIRE_THROWS_AS( (DenseCholesky<double>(Bind)), std::logic_error& );
+}